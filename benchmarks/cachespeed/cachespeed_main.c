@@ -33,7 +33,9 @@
 #include <malloc.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <time.h>
+#include <unistd.h>
 
 /****************************************************************************
  * Pre-processor Definitions
@@ -42,6 +44,30 @@
 #define CACHESPEED_PREFIX "CACHE Speed: "
 #define REPEAT_NUM 1000
 
+/* Pointer chase: working sets grow from CHASE_MIN_SIZE up to the largest
+ * allocation, by alternating steps of x1.5 and x1.33 (1K, 1.5K, 2K, 3K...).
+ */
+
+#define CHASE_MIN_SIZE     1024
+#define CHASE_MAX_SIZE     (64 * 1024 * 1024)
+#define CHASE_MAX_POINTS   64
+
+/* Minimum number of dependent loads timed for one working set */
+
+#define CHASE_MIN_STEPS    (256 * 1024)
+
+/* Line size used when the architecture doesn't report one */
+
+#define CHASE_DEFAULT_LINE 64
+
+/* A latency this much higher than the current level starts a new one */
+
+#define CHASE_LEVEL_RATIO  1.5
+
+#define CHASE_STEP  p = *(FAR void **)p;
+#define CHASE_STEP8 CHASE_STEP CHASE_STEP CHASE_STEP CHASE_STEP \
+                    CHASE_STEP CHASE_STEP CHASE_STEP CHASE_STEP
+
 #ifdef CACHESPEED_PERFTIME
   #define TIME uint64_t
 
@@ -87,6 +113,10 @@ struct cachespeed_s
  * Private Data
  ****************************************************************************/
 
+/* The end of every chase is stored here, so the loads can't be dropped */
+
+static FAR void * volatile g_chase_sink;
+
 /****************************************************************************
  * Private Functions
  ****************************************************************************/
@@ -231,6 +261,204 @@ static void cachespeed_common(struct cachespeed_s *cs)
                 up_invalidate_icache, "icache invalidate");
 }
 
+/****************************************************************************
+ * Name: chase_build
+ *
+ * Description:
+ *   Link the cache lines of the working set into a single random cycle.
+ *   Every load then depends on the previous one, and the hardware
+ *   prefetcher can't guess the next line.  Sattolo's algorithm shuffles
+ *   the line indices in place into a cyclic permutation, which is then
+ *   turned into pointers.
+ *
+ ****************************************************************************/
+
+static void chase_build(uintptr_t base, size_t size, size_t line,
+                        FAR uint32_t *seed)
+{
+  size_t nlines = size / line;
+  uintptr_t tmp;
+  size_t i;
+  size_t j;
+
+#define CHASE_LINE(n) (*(FAR uintptr_t *)(base + (n) * line))
+
+  for (i = 0; i < nlines; i++)
+    {
+      CHASE_LINE(i) = i;
+    }
+
+  for (i = nlines - 1; i > 0; i--)
+    {
+      /* xorshift32 */
+
+      *seed ^= *seed << 13;
+      *seed ^= *seed >> 17;
+      *seed ^= *seed << 5;
+
+      j = *seed % i;
+      tmp = CHASE_LINE(i);
+      CHASE_LINE(i) = CHASE_LINE(j);
+      CHASE_LINE(j) = tmp;
+    }
+
+  for (i = 0; i < nlines; i++)
+    {
+      CHASE_LINE(i) = base + CHASE_LINE(i) * line;
+    }
+
+#undef CHASE_LINE
+}
+
+/****************************************************************************
+ * Name: chase_latency
+ *
+ * Description:
+ *   Return the average latency of one dependent load, in nanoseconds,
+ *   over a working set of 'size' bytes.
+ *
+ ****************************************************************************/
+
+static double chase_latency(uintptr_t base, size_t size, size_t line,
+                            FAR uint32_t *seed)
+{
+  size_t nlines = size / line;
+  size_t steps = nlines > CHASE_MIN_STEPS ? nlines : CHASE_MIN_STEPS;
+  FAR void *p = (FAR void *)base;
+  TIME start;
+  TIME end;
+  TIME cost;
+  size_t i;
+
+  chase_build(base, size, line, seed);
+
+  /* Walk the whole cycle once, so the working set is as cached as it
+   * can be.
+   */
+
+  for (i = 0; i < nlines; i++)
+    {
+      CHASE_STEP;
+    }
+
+  TIMESTAMP(start);
+  for (i = 0; i < steps; i += 8)
+    {
+      CHASE_STEP8;
+    }
+
+  TIMESTAMP(end);
+
+  g_chase_sink = p;
+  cost = end - start;
+  CONVERT(cost);
+  return (double)cost / i;
+}
+
+/****************************************************************************
+ * Name: chase_report
+ *
+ * Description:
+ *   Split the latency curve into levels.  A point whose latency is
+ *   CHASE_LEVEL_RATIO times the one of the first point of the current
+ *   level starts a new level.  A single point between two jumps is a
+ *   transition (a partially fitting working set), not a level.  The
+ *   capacity of a level is its largest working set, and its latency is
+ *   its median.
+ *
+ ****************************************************************************/
+
+static void chase_report(FAR const size_t *sizes,
+                         FAR const double *latency, int npoints)
+{
+  size_t capacity = 0;
+  int first = 0;
+  int level = 1;
+  int i;
+
+  printf("** pointer chase levels [capacity, latency] **\n");
+
+  for (i = 1; i <= npoints; i++)
+    {
+      if (i < npoints && latency[i] < latency[first] * CHASE_LEVEL_RATIO)
+        {
+          continue;
+        }
+
+      /* Points first..i-1 make one level, unless it is a transition */
+
+      if (i - first > 1 || i == npoints)
+        {
+          if (i == npoints && level > 1)
+            {
+              printf("RAM: above %zu Bytes, %.2f ns\n",
+                     capacity, latency[(first + i - 1) / 2]);
+            }
+          else if (i == npoints)
+            {
+              printf("L%d: at least %zu Bytes, %.2f ns\n", level,
+                     sizes[i - 1], latency[(first + i - 1) / 2]);
+            }
+          else
+            {
+              printf("L%d: up to %zu Bytes, %.2f ns\n", level,
+                     sizes[i - 1], latency[(first + i - 1) / 2]);
+              capacity = sizes[i - 1];
+              level++;
+            }
+        }
+
+      first = i;
+    }
+}
+
+/****************************************************************************
+ * Name: cachespeed_chase
+ ****************************************************************************/
+
+static void cachespeed_chase(FAR struct cachespeed_s *cs, size_t max_size)
+{
+  size_t sizes[CHASE_MAX_POINTS];
+  double latency[CHASE_MAX_POINTS];
+  uint32_t seed = 2463534242u;
+  size_t line = GET_DCACHE_LINE;
+  size_t size;
+  int npoints = 0;
+
+  if (line < sizeof(uintptr_t))
+    {
+      line = CHASE_DEFAULT_LINE;
+    }
+
+  if (max_size == 0 || max_size > cs->alloc)
+    {
+      max_size = cs->alloc < CHASE_MAX_SIZE ? cs->alloc : CHASE_MAX_SIZE;
+    }
+
+  printf("** pointer chase [working set, latency] %zu bytes lines **\n",
+         line);
+
+  for (size = CHASE_MIN_SIZE;
+       size <= max_size && npoints < CHASE_MAX_POINTS;
+       size = (size & (size - 1)) == 0 ? size / 2 * 3 : size / 3 * 4)
+    {
+      if (size < 2 * line)
+        {
+          continue;
+        }
+
+      sizes[npoints] = size;
+      latency[npoints] = chase_latency(cs->addr, size, line, &seed);
+      printf("%zu Bytes: %.2f ns\n", size, latency[npoints]);
+      npoints++;
+    }
+
+  if (npoints > 0)
+    {
+      chase_report(sizes, latency, npoints);
+    }
+}
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -247,8 +475,41 @@ int main(int argc, FAR char *argv[])
       .alloc = 0
     };
 
+  size_t max_size = 0;
+  bool chase = false;
+  int ch;
+
+  while ((ch = getopt(argc, argv, "cs:")) != ERROR)
+    {
+      switch (ch)
+        {
+          case 'c':
+            chase = true;
+            break;
+          case 's':
+            max_size = strtoul(optarg, NULL, 0);
+            break;
+          default:
+            printf("Usage: %s [-c] [-s <max working set>]\n"
+                   "  -c measure the load latency with a pointer chase\n"
+                   "     instead of the cache maintenance operations\n"
+                   "  -s largest working set of the pointer chase"
+                   " in bytes\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
   setup(&cs);
-  cachespeed_common(&cs);
+
+  if (chase)
+    {
+      cachespeed_chase(&cs, max_size);
+    }
+  else
+    {
+      cachespeed_common(&cs);
+    }
+
   teardown(&cs);
   return 0;
 }
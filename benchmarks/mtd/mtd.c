@@ -27,12 +27,20 @@
 #include <nuttx/config.h>
 
 #include <sys/stat.h>
+#include <sys/types.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdbool.h>
+#include <stdint.h>
 #include <unistd.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
 
+#include <nuttx/fs/fs.h>
 #include <nuttx/mtd/mtd.h>
 #include <nuttx/fs/smart.h>
 #include <nuttx/fs/ioctl.h>
@@ -41,167 +49,941 @@
  * Pre-processor Definitions
  ****************************************************************************/
 
+/* Latency histogram buckets: bucket 0 counts [0, 2) us and bucket n counts
+ * [2^n, 2^(n+1)) us.  The last bucket also counts everything longer.
+ */
+
+#define MTD_HIST_SIZE       24
+
+/* Size of one random read */
+
+#define MTD_RANDOM_SIZE     4096
+
+/* Default number of random reads and of reads of the mixed test reader */
+
+#define MTD_DEFAULT_COUNT   1000
+
+/* Period of the mixed test reader */
+
+#define MTD_READER_PERIOD   1000
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* Latency statistics of one kind of operation */
+
+struct mtd_stats_s
+{
+  uint32_t count;
+  uint32_t min;
+  uint32_t max;
+  uint64_t total;
+  uint64_t bytes;
+  uint32_t hist[MTD_HIST_SIZE];
+};
+
+/* The device under test.  Either an MTD driver, or a block driver whose
+ * erase blocks are handled by the driver itself.
+ */
+
+struct mtd_bench_s
+{
+  FAR struct inode *inode;
+  FAR struct mtd_dev_s *mtd;
+  struct mtd_geometry_s geo;
+  uint32_t pages_per_block;
+  uint32_t npages;
+  uint32_t count;
+  FAR uint8_t *buffer;
+};
+
+/* The reader thread of the mixed test */
+
+struct mtd_reader_s
+{
+  FAR struct mtd_bench_s *bench;
+  FAR uint8_t *buffer;
+  uint32_t npages;
+  volatile bool done;
+  struct mtd_stats_s stats;
+};
+
+/****************************************************************************
+ * Private Function Prototypes
+ ****************************************************************************/
+
+/* These are internal OS interfaces, see the note in the Kconfig help */
+
+extern int find_mtddriver(FAR const char *pathname,
+                          FAR struct inode **ppinode);
+extern int close_mtddriver(FAR struct inode *pinode);
+
 /****************************************************************************
  * Private data
  ****************************************************************************/
 
+#ifdef CONFIG_RAMMTD
+/* A RAM MTD device can't be torn down, so it is kept for the next run */
+
+static FAR uint8_t *g_ramflash;
+static FAR struct mtd_dev_s *g_rammtd;
+#endif
+
 /****************************************************************************
- * Public Functions
+ * Private Functions
  ****************************************************************************/
 
-int main(int argc, FAR char *argv[])
+/****************************************************************************
+ * Name: mtd_usage
+ ****************************************************************************/
+
+static void mtd_usage(void)
 {
-  struct inode            *inode;
-  struct timespec         start;
-  struct timespec         end;
-  struct mtd_geometry_s   geo;
-  struct partition_info_s info;
-  int                     ret;
-  int                     x;
-  double                  elapsed_time;
-  double                  transfer_rate;
-  size_t                  total_bytes_written = 0;
-  size_t                  total_bytes_read = 0;
-  char                    *buffer;
+  fprintf(stderr, "usage: mtd [-t test] [-n count] <flash_device>\n");
+#ifdef CONFIG_RAMMTD
+  fprintf(stderr, "       mtd [-t test] [-n count] -r\n");
+#endif
+  fprintf(stderr, "\nWhere:\n");
+  fprintf(stderr, "  -t <test> seq, random, partial, mixed or all"
+                  " [default: all]\n");
+  fprintf(stderr, "  -n <count> number of random reads and of reads of"
+                  " the mixed test [default: %d]\n", MTD_DEFAULT_COUNT);
+#ifdef CONFIG_RAMMTD
+  fprintf(stderr, "  -r use a %d bytes RAM MTD device\n",
+          CONFIG_BENCHMARK_MTD_RAMSIZE);
+#endif
+  fprintf(stderr, "\nAll the content of the device is destroyed.\n");
+}
+
+/****************************************************************************
+ * Name: mtd_now
+ *
+ * Description:
+ *   Get the monotonic time in microseconds.
+ *
+ ****************************************************************************/
+
+static uint64_t mtd_now(void)
+{
+  struct timespec ts;
 
-  /* Argument given? */
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
 
-  if (argc < 2)
+/****************************************************************************
+ * Name: mtd_stats_add
+ ****************************************************************************/
+
+static void mtd_stats_add(FAR struct mtd_stats_s *stats, uint64_t start,
+                          size_t bytes)
+{
+  uint64_t elapsed = mtd_now() - start;
+  uint32_t us = elapsed > UINT32_MAX ? UINT32_MAX : (uint32_t)elapsed;
+  int bucket = 0;
+
+  while (bucket < MTD_HIST_SIZE - 1 && (us >> (bucket + 1)) != 0)
     {
-      fprintf(stderr, "usage: mtd flash_block_device\n");
-      return -1;
+      bucket++;
+    }
+
+  if (stats->count == 0 || us < stats->min)
+    {
+      stats->min = us;
     }
 
-  /* Find the inode of the block driver identified by 'source' */
+  if (us > stats->max)
+    {
+      stats->max = us;
+    }
 
-  ret = open_blockdriver(argv[1], 0, &inode);
-  if (ret < 0)
+  stats->count++;
+  stats->total += us;
+  stats->bytes += bytes;
+  stats->hist[bucket]++;
+}
+
+/****************************************************************************
+ * Name: mtd_stats_print
+ ****************************************************************************/
+
+static void mtd_stats_print(FAR const char *name,
+                            FAR const struct mtd_stats_s *stats)
+{
+  int i;
+
+  if (stats->count == 0)
     {
-      fprintf(stderr, "Failed to open %s\n", argv[1]);
-      return ret;
+      return;
     }
 
-  /* Get the low-level format from the device. */
+  printf("%s: %" PRIu32 " ops, latency min %" PRIu32 " avg %" PRIu64
+         " max %" PRIu32 " us\n", name, stats->count, stats->min,
+         stats->total / stats->count, stats->max);
 
-  ret = inode->u.i_bops->ioctl(inode, BIOC_PARTINFO, (unsigned long) &info);
-  if (ret != OK)
+  if (stats->total > 0)
     {
-      fprintf(stderr, "Device is not a block device\n");
-      goto errout_with_driver;
+      printf("   %.2f ops/s", stats->count * 1e6 / stats->total);
+      if (stats->bytes > 0)
+        {
+          printf(", %.2f KiB/s", stats->bytes * 1e6 / 1024 /
+                 stats->total);
+        }
+
+      printf("\n");
     }
 
-  /* Get the MTD geometry */
+  for (i = 0; i < MTD_HIST_SIZE; i++)
+    {
+      if (stats->hist[i] != 0)
+        {
+          printf("   %8lu us%s %10" PRIu32 "\n", i == 0 ? 0ul : 1ul << i,
+                 i == MTD_HIST_SIZE - 1 ? "+" : " ", stats->hist[i]);
+        }
+    }
+}
 
-  ret = inode->u.i_bops->ioctl(inode, MTDIOC_GEOMETRY, (unsigned long) &geo);
-  if (ret != OK)
+/****************************************************************************
+ * Name: mtd_erase
+ ****************************************************************************/
+
+static int mtd_erase(FAR struct mtd_bench_s *bench, off_t block,
+                     size_t nblocks)
+{
+  if (bench->mtd == NULL)
     {
-      fprintf(stderr, "Device is not a MTD device");
-      goto errout_with_driver;
+      /* The block driver erases by itself when writing */
+
+      return nblocks;
     }
 
-  /* Report the device structure */
+  return MTD_ERASE(bench->mtd, block, nblocks);
+}
 
-  printf("FLASH device parameters:\n");
-  printf("   Sector size:      %10d\n", info.sectorsize);
-  printf("   Sector count:     %10d\n", info.numsectors);
-  printf("   Erase block size: %10" PRIu32 "\n", geo.erasesize);
-  printf("   Total size:       %10d\n", info.sectorsize * info.numsectors);
+/****************************************************************************
+ * Name: mtd_bwrite
+ ****************************************************************************/
 
-  if (info.sectorsize != geo.erasesize)
+static ssize_t mtd_bwrite(FAR struct mtd_bench_s *bench, off_t page,
+                          size_t npages, FAR const uint8_t *buffer)
+{
+  if (bench->mtd == NULL)
     {
-      fprintf(stderr, "Sector size does not match the erase block size.\n"
-             "Please adjust the sector size to enable erasing and writing "
-             "without using an intermediary read buffer.\n");
-      goto errout_with_driver;
+      return bench->inode->u.i_bops->write(bench->inode, buffer, page,
+                                           npages);
     }
 
-  /* Allocate buffers to use */
+  return MTD_BWRITE(bench->mtd, page, npages, buffer);
+}
 
-  buffer = (char *)malloc(info.sectorsize);
-  if (buffer == NULL)
+/****************************************************************************
+ * Name: mtd_bread
+ ****************************************************************************/
+
+static ssize_t mtd_bread(FAR struct mtd_bench_s *bench, off_t page,
+                         size_t npages, FAR uint8_t *buffer)
+{
+  if (bench->mtd == NULL)
     {
-      fprintf(stderr, "Error allocating buffer\n");
-      goto errout_with_driver;
+      return bench->inode->u.i_bops->read(bench->inode, buffer, page,
+                                          npages);
+    }
+
+  return MTD_BREAD(bench->mtd, page, npages, buffer);
+}
+
+/****************************************************************************
+ * Name: mtd_fill
+ *
+ * Description:
+ *   Fill pages with a pattern that differs from page to page, so that
+ *   data read back from the wrong page is detected.
+ *
+ ****************************************************************************/
+
+static void mtd_fill(FAR struct mtd_bench_s *bench, FAR uint8_t *buffer,
+                     off_t page, size_t npages)
+{
+  size_t size = npages * bench->geo.blocksize;
+  size_t i;
+
+  for (i = 0; i < size; i++)
+    {
+      buffer[i] = (uint8_t)(i + page * 7);
+    }
+}
+
+/****************************************************************************
+ * Name: mtd_verify
+ ****************************************************************************/
+
+static int mtd_verify(FAR struct mtd_bench_s *bench,
+                      FAR const uint8_t *buffer, off_t page, size_t npages)
+{
+  size_t size = npages * bench->geo.blocksize;
+  size_t i;
+
+  for (i = 0; i < size; i++)
+    {
+      if (buffer[i] != (uint8_t)(i + page * 7))
+        {
+          printf("Data mismatch in page %jd at byte %zu: expected %02X,"
+                 " got %02X\n", (intmax_t)(page + i / bench->geo.blocksize),
+                 i % bench->geo.blocksize, (uint8_t)(i + page * 7),
+                 buffer[i]);
+          return -EIO;
+        }
+    }
+
+  return OK;
+}
+
+/****************************************************************************
+ * Name: mtd_test_seq
+ *
+ * Description:
+ *   Erase the whole device, program it page by page and read it back,
+ *   timing every operation.
+ *
+ ****************************************************************************/
+
+static int mtd_test_seq(FAR struct mtd_bench_s *bench)
+{
+  struct mtd_stats_s erase;
+  struct mtd_stats_s program;
+  struct mtd_stats_s read;
+  uint64_t start;
+  uint32_t i;
+  int ret;
+
+  printf("\nSequential erase, program and read...\n");
+
+  memset(&erase, 0, sizeof(erase));
+  memset(&program, 0, sizeof(program));
+  memset(&read, 0, sizeof(read));
+
+  for (i = 0; i < bench->geo.neraseblocks; i++)
+    {
+      start = mtd_now();
+      ret = mtd_erase(bench, i, 1);
+      mtd_stats_add(&erase, start, bench->geo.erasesize);
+      if (ret < 0)
+        {
+          printf("Failed to erase block %" PRIu32 ": %d\n", i, ret);
+          return ret;
+        }
+    }
+
+  for (i = 0; i < bench->npages; i++)
+    {
+      mtd_fill(bench, bench->buffer, i, 1);
+
+      start = mtd_now();
+      ret = mtd_bwrite(bench, i, 1, bench->buffer);
+      mtd_stats_add(&program, start, bench->geo.blocksize);
+      if (ret != 1)
+        {
+          printf("Failed to program page %" PRIu32 ": %d\n", i, ret);
+          return ret < 0 ? ret : -EIO;
+        }
+    }
+
+  for (i = 0; i < bench->npages; i++)
+    {
+      start = mtd_now();
+      ret = mtd_bread(bench, i, 1, bench->buffer);
+      mtd_stats_add(&read, start, bench->geo.blocksize);
+      if (ret != 1)
+        {
+          printf("Failed to read page %" PRIu32 ": %d\n", i, ret);
+          return ret < 0 ? ret : -EIO;
+        }
+
+      ret = mtd_verify(bench, bench->buffer, i, 1);
+      if (ret < 0)
+        {
+          return ret;
+        }
+    }
+
+  if (bench->mtd != NULL)
+    {
+      mtd_stats_print("Erase block", &erase);
+    }
+
+  mtd_stats_print("Program page", &program);
+  mtd_stats_print("Read page", &read);
+  printf("Data verification successful\n");
+  return OK;
+}
+
+/****************************************************************************
+ * Name: mtd_test_random
+ *
+ * Description:
+ *   Read 4 KiB at random aligned offsets.  The byte read method is used
+ *   when the device has one, otherwise the pages covering 4 KiB are read.
+ *
+ ****************************************************************************/
+
+static int mtd_test_random(FAR struct mtd_bench_s *bench)
+{
+  struct mtd_stats_s stats;
+  uint64_t start;
+  size_t devsize = (size_t)bench->npages * bench->geo.blocksize;
+  size_t size = MTD_RANDOM_SIZE;
+  size_t nunits;
+  off_t offset;
+  uint32_t i;
+  ssize_t ret;
+  bool byteread = bench->mtd != NULL && bench->mtd->read != NULL;
+
+  if (size > devsize)
+    {
+      size = devsize;
+    }
+
+  if (!byteread)
+    {
+      size = (size + bench->geo.blocksize - 1) / bench->geo.blocksize *
+             bench->geo.blocksize;
+    }
+
+  nunits = devsize / size;
+
+  printf("\nRandom %zu bytes reads...\n", size);
+
+  memset(&stats, 0, sizeof(stats));
+
+  for (i = 0; i < bench->count; i++)
+    {
+      offset = (off_t)(rand() % nunits) * size;
+
+      start = mtd_now();
+      if (byteread)
+        {
+          ret = MTD_READ(bench->mtd, offset, size, bench->buffer);
+          ret = ret == (ssize_t)size ? OK : ret;
+        }
+      else
+        {
+          ret = mtd_bread(bench, offset / bench->geo.blocksize,
+                          size / bench->geo.blocksize, bench->buffer);
+          ret = ret == (ssize_t)(size / bench->geo.blocksize) ? OK : ret;
+        }
+
+      mtd_stats_add(&stats, start, size);
+
+      if (ret != OK)
+        {
+          printf("Failed to read at %jd: %zd\n", (intmax_t)offset, ret);
+          return ret < 0 ? ret : -EIO;
+        }
+    }
+
+  mtd_stats_print("Random read", &stats);
+  return OK;
+}
+
+/****************************************************************************
+ * Name: mtd_test_partial
+ *
+ * Description:
+ *   Program 1, 2, 4... pages of a freshly erased block in a single call,
+ *   up to the whole erase block.  This shows the fixed cost of a program
+ *   operation, and how much larger writes gain.
+ *
+ ****************************************************************************/
+
+static int mtd_test_partial(FAR struct mtd_bench_s *bench)
+{
+  struct mtd_stats_s stats;
+  uint64_t start;
+  uint32_t npages;
+  int ret;
+
+  printf("\nPartial block programs...\n");
+
+  for (npages = 1; ; npages <<= 1)
+    {
+      if (npages > bench->pages_per_block)
+        {
+          npages = bench->pages_per_block;
+        }
+
+      ret = mtd_erase(bench, 0, 1);
+      if (ret < 0)
+        {
+          printf("Failed to erase block 0: %d\n", ret);
+          return ret;
+        }
+
+      mtd_fill(bench, bench->buffer, 0, npages);
+      memset(&stats, 0, sizeof(stats));
+
+      start = mtd_now();
+      ret = mtd_bwrite(bench, 0, npages, bench->buffer);
+      mtd_stats_add(&stats, start, npages * bench->geo.blocksize);
+      if (ret != (int)npages)
+        {
+          printf("Failed to program %" PRIu32 " pages: %d\n", npages, ret);
+          return ret < 0 ? ret : -EIO;
+        }
+
+      ret = mtd_bread(bench, 0, npages, bench->buffer);
+      if (ret != (int)npages)
+        {
+          printf("Failed to read %" PRIu32 " pages: %d\n", npages, ret);
+          return ret < 0 ? ret : -EIO;
+        }
+
+      ret = mtd_verify(bench, bench->buffer, 0, npages);
+      if (ret < 0)
+        {
+          return ret;
+        }
+
+      printf("Program %6" PRIu32 " pages: %10" PRIu32 " us, %.2f KiB/s\n",
+             npages, stats.max, stats.max > 0 ?
+             stats.bytes * 1e6 / 1024 / stats.max : 0.0);
+
+      if (npages == bench->pages_per_block)
+        {
+          break;
+        }
     }
 
-  /* Fill the buffer with known data */
+  return OK;
+}
+
+/****************************************************************************
+ * Name: mtd_reader
+ *
+ * Description:
+ *   Periodically read a random page of the first half of the device, like
+ *   a real-time task would, and record the latency of every read.
+ *
+ ****************************************************************************/
+
+static FAR void *mtd_reader(FAR void *arg)
+{
+  FAR struct mtd_reader_s *reader = arg;
+  uint64_t start;
+  uint32_t i;
+  ssize_t ret;
 
-  for (int i = 0; i < info.sectorsize; i++)
+  for (i = 0; i < reader->bench->count; i++)
     {
-      buffer[i] = (char)(i & 0xff);
+      start = mtd_now();
+      ret = mtd_bread(reader->bench, rand() % reader->npages, 1,
+                      reader->buffer);
+      mtd_stats_add(&reader->stats, start, reader->bench->geo.blocksize);
+      if (ret != 1)
+        {
+          printf("Reader failed: %zd\n", ret);
+          break;
+        }
+
+      usleep(MTD_READER_PERIOD);
     }
 
-  /* Now write some data to the sector */
+  reader->done = true;
+  return NULL;
+}
+
+/****************************************************************************
+ * Name: mtd_run_reader
+ *
+ * Description:
+ *   Run the reader at a higher priority than the caller.  If 'write' is
+ *   true, keep erasing and programming the second half of the device
+ *   until the reader is done.
+ *
+ ****************************************************************************/
 
-  printf("\nStarting write operation...\n");
+static int mtd_run_reader(FAR struct mtd_bench_s *bench,
+                          FAR struct mtd_reader_s *reader, bool write,
+                          FAR struct mtd_stats_s *erase,
+                          FAR struct mtd_stats_s *program)
+{
+  uint32_t first = bench->geo.neraseblocks / 2;
+  uint32_t block = first;
+  struct sched_param param;
+  pthread_attr_t attr;
+  pthread_t tid;
+  uint64_t start;
+  uint32_t page;
+  int ret;
+
+  memset(&reader->stats, 0, sizeof(reader->stats));
+  reader->done = false;
+
+  sched_getparam(0, &param);
+  param.sched_priority++;
+  pthread_attr_init(&attr);
+  pthread_attr_setschedparam(&attr, &param);
+  ret = pthread_create(&tid, &attr, mtd_reader, reader);
+  pthread_attr_destroy(&attr);
+  if (ret != 0)
+    {
+      printf("Failed to create the reader: %d\n", ret);
+      return -ret;
+    }
 
-  clock_gettime(CLOCK_MONOTONIC, &start);
-  for (x = 0; x < info.numsectors; x++)
+  while (!reader->done)
     {
-      inode->u.i_bops->write(inode, (const unsigned char *)buffer, x, 1);
+      if (!write)
+        {
+          usleep(MTD_READER_PERIOD);
+          continue;
+        }
+
+      start = mtd_now();
+      ret = mtd_erase(bench, block, 1);
+      mtd_stats_add(erase, start, bench->geo.erasesize);
+      if (ret < 0)
+        {
+          printf("Failed to erase block %" PRIu32 ": %d\n", block, ret);
+          break;
+        }
+
+      page = block * bench->pages_per_block;
+      mtd_fill(bench, bench->buffer, page, 1);
+
+      for (; page < (block + 1) * bench->pages_per_block; page++)
+        {
+          start = mtd_now();
+          ret = mtd_bwrite(bench, page, 1, bench->buffer);
+          mtd_stats_add(program, start, bench->geo.blocksize);
+          if (ret != 1)
+            {
+              printf("Failed to program page %" PRIu32 ": %d\n", page,
+                     ret);
+              break;
+            }
+        }
 
-      total_bytes_written += info.sectorsize;
+      if (ret != 1)
+        {
+          ret = ret < 0 ? ret : -EIO;
+          break;
+        }
+
+      if (++block >= bench->geo.neraseblocks)
+        {
+          block = first;
+        }
+
+      ret = OK;
     }
 
-  clock_gettime(CLOCK_MONOTONIC, &end);
+  pthread_join(tid, NULL);
+  return ret < 0 ? ret : OK;
+}
 
-  elapsed_time = (end.tv_sec - start.tv_sec) + \
-                 (end.tv_nsec - start.tv_nsec) / 1e9;
-  transfer_rate = (total_bytes_written / elapsed_time) / 1024;
+/****************************************************************************
+ * Name: mtd_test_mixed
+ *
+ * Description:
+ *   Measure the read latency seen by a periodic reader, first alone and
+ *   then while the second half of the device is being erased and
+ *   programmed.
+ *
+ ****************************************************************************/
 
-  printf("\nWrite operation completed in %.2f seconds\n", elapsed_time);
-  printf("Total bytes written: %zu\n", total_bytes_written);
-  printf("Transfer rate [write]: %.2f KiB/s\n", transfer_rate);
+static int mtd_test_mixed(FAR struct mtd_bench_s *bench)
+{
+  struct mtd_reader_s reader;
+  struct mtd_stats_s erase;
+  struct mtd_stats_s program;
+  int ret;
+
+  if (bench->geo.neraseblocks < 2)
+    {
+      printf("\nMixed test needs at least 2 erase blocks\n");
+      return OK;
+    }
+
+  printf("\nMixed read/write...\n");
 
-  /* Now read the data back to validate everything was written and can
-   * be read.
-   */
+  memset(&reader, 0, sizeof(reader));
+  memset(&erase, 0, sizeof(erase));
+  memset(&program, 0, sizeof(program));
 
-  printf("\nStarting read operation...\n");
+  reader.bench  = bench;
+  reader.npages = bench->geo.neraseblocks / 2 * bench->pages_per_block;
+  reader.buffer = malloc(bench->geo.blocksize);
+  if (reader.buffer == NULL)
+    {
+      printf("Error allocating the reader buffer\n");
+      return -ENOMEM;
+    }
+
+  ret = mtd_run_reader(bench, &reader, false, &erase, &program);
+  if (ret < 0)
+    {
+      goto out;
+    }
 
-  clock_gettime(CLOCK_MONOTONIC, &start);
+  mtd_stats_print("Read page, idle device", &reader.stats);
 
-  for (x = 0; x < info.numsectors; x++)
+  ret = mtd_run_reader(bench, &reader, true, &erase, &program);
+  if (ret < 0)
     {
-      inode->u.i_bops->read(inode, (unsigned char *)buffer, x, 1);
+      goto out;
+    }
+
+  mtd_stats_print("Read page, concurrent writes", &reader.stats);
 
-      total_bytes_read += info.sectorsize;
+  if (bench->mtd != NULL)
+    {
+      mtd_stats_print("Erase block, concurrent reads", &erase);
     }
 
-  clock_gettime(CLOCK_MONOTONIC, &end);
+  mtd_stats_print("Program page, concurrent reads", &program);
 
-  elapsed_time = (end.tv_sec - start.tv_sec) + \
-                 (end.tv_nsec - start.tv_nsec) / 1e9;
-  transfer_rate = (total_bytes_written / elapsed_time) / 1024;
+out:
+  free(reader.buffer);
+  return ret;
+}
 
-  printf("\nRead operation completed in %.2f seconds\n", elapsed_time);
-  printf("Total bytes read: %zu\n", total_bytes_read);
-  printf("Transfer rate [read]: %.2f KiB/s\n", transfer_rate);
+/****************************************************************************
+ * Name: mtd_open
+ ****************************************************************************/
 
-  /* Compare the read data with the written data */
+static int mtd_open(FAR struct mtd_bench_s *bench, FAR const char *path)
+{
+  struct partition_info_s info;
+  int ret;
 
-  for (int i = 0; i < info.sectorsize; i++)
+#ifdef CONFIG_RAMMTD
+  if (path == NULL)
     {
-      if (buffer[i] != (char)(i & 0xff))
+      if (g_rammtd == NULL)
+        {
+          g_ramflash = malloc(CONFIG_BENCHMARK_MTD_RAMSIZE);
+          if (g_ramflash == NULL)
+            {
+              fprintf(stderr, "Error allocating the RAM MTD\n");
+              return -ENOMEM;
+            }
+
+          g_rammtd = rammtd_initialize(g_ramflash,
+                                       CONFIG_BENCHMARK_MTD_RAMSIZE);
+          if (g_rammtd == NULL)
+            {
+              fprintf(stderr, "Failed to create the RAM MTD\n");
+              free(g_ramflash);
+              g_ramflash = NULL;
+              return -ENODEV;
+            }
+        }
+
+      bench->mtd = g_rammtd;
+      return MTD_IOCTL(bench->mtd, MTDIOC_GEOMETRY,
+                       (unsigned long)((uintptr_t)&bench->geo));
+    }
+#endif
+
+  /* Use the MTD driver directly when there is one */
+
+  ret = find_mtddriver(path, &bench->inode);
+  if (ret >= 0)
+    {
+      bench->mtd = bench->inode->u.i_mtd;
+      ret = MTD_IOCTL(bench->mtd, MTDIOC_GEOMETRY,
+                      (unsigned long)((uintptr_t)&bench->geo));
+      if (ret < 0)
+        {
+          fprintf(stderr, "Device is not a MTD device\n");
+          close_mtddriver(bench->inode);
+          bench->inode = NULL;
+        }
+
+      return ret;
+    }
+
+  /* Otherwise go through the block driver, which erases by itself */
+
+  ret = open_blockdriver(path, 0, &bench->inode);
+  if (ret < 0)
+    {
+      fprintf(stderr, "Failed to open %s\n", path);
+      return ret;
+    }
+
+  ret = bench->inode->u.i_bops->ioctl(bench->inode, BIOC_PARTINFO,
+                                      (unsigned long)((uintptr_t)&info));
+  if (ret != OK)
+    {
+      fprintf(stderr, "Device is not a block device\n");
+      close_blockdriver(bench->inode);
+      bench->inode = NULL;
+      return ret;
+    }
+
+  bench->geo.blocksize    = info.sectorsize;
+  bench->geo.erasesize    = info.sectorsize;
+  bench->geo.neraseblocks = info.numsectors;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: mtd_close
+ ****************************************************************************/
+
+static void mtd_close(FAR struct mtd_bench_s *bench)
+{
+  if (bench->inode == NULL)
+    {
+      return;
+    }
+
+  if (bench->mtd != NULL)
+    {
+      close_mtddriver(bench->inode);
+    }
+  else
+    {
+      close_blockdriver(bench->inode);
+    }
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+int main(int argc, FAR char *argv[])
+{
+  struct mtd_bench_s bench;
+  FAR const char *path = NULL;
+  FAR const char *test = "all";
+  bool all;
+  bool ram = false;
+  int ret;
+  int ch;
+
+  memset(&bench, 0, sizeof(bench));
+  bench.count = MTD_DEFAULT_COUNT;
+
+  while ((ch = getopt(argc, argv, "n:rt:h")) != ERROR)
+    {
+      switch (ch)
+        {
+          case 'n':
+            bench.count = strtoul(optarg, NULL, 0);
+            break;
+
+#ifdef CONFIG_RAMMTD
+          case 'r':
+            ram = true;
+            break;
+#endif
+
+          case 't':
+            test = optarg;
+            break;
+
+          default:
+            mtd_usage();
+            return -1;
+        }
+    }
+
+  if (optind < argc)
+    {
+      path = argv[optind];
+    }
+
+  all = strcmp(test, "all") == 0;
+  if ((path == NULL) == !ram || bench.count == 0 ||
+      (!all && strcmp(test, "seq") != 0 && strcmp(test, "random") != 0 &&
+       strcmp(test, "partial") != 0 && strcmp(test, "mixed") != 0))
+    {
+      mtd_usage();
+      return -1;
+    }
+
+  ret = mtd_open(&bench, path);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  if (bench.geo.blocksize == 0 || bench.geo.erasesize < bench.geo.blocksize)
+    {
+      fprintf(stderr, "Invalid geometry\n");
+      ret = -EINVAL;
+      goto errout_with_driver;
+    }
+
+  bench.pages_per_block = bench.geo.erasesize / bench.geo.blocksize;
+  bench.npages = bench.geo.neraseblocks * bench.pages_per_block;
+
+  /* Report the device structure */
+
+  printf("FLASH device parameters:\n");
+  printf("   Page size:        %10" PRIu32 "\n", bench.geo.blocksize);
+  printf("   Page count:       %10" PRIu32 "\n", bench.npages);
+  printf("   Erase block size: %10" PRIu32 "\n", bench.geo.erasesize);
+  printf("   Erase block count:%10" PRIu32 "\n", bench.geo.neraseblocks);
+  printf("   Total size:       %10" PRIu64 "\n",
+         (uint64_t)bench.npages * bench.geo.blocksize);
+
+  /* Allocate a buffer for one erase block, the largest transfer */
+
+  bench.buffer = malloc(bench.geo.erasesize > MTD_RANDOM_SIZE ?
+                        bench.geo.erasesize : MTD_RANDOM_SIZE);
+  if (bench.buffer == NULL)
+    {
+      fprintf(stderr, "Error allocating buffer\n");
+      ret = -ENOMEM;
+      goto errout_with_driver;
+    }
+
+  if (all || strcmp(test, "seq") == 0)
+    {
+      ret = mtd_test_seq(&bench);
+      if (ret < 0)
+        {
+          goto errout_with_buffers;
+        }
+    }
+
+  if (all || strcmp(test, "random") == 0)
+    {
+      ret = mtd_test_random(&bench);
+      if (ret < 0)
         {
-          printf("\nData mismatch at byte %d: expected %02X, got %02X\n",
-                 i, (unsigned char)(i & 0xff), (unsigned char)buffer[i]);
           goto errout_with_buffers;
         }
     }
 
-  printf("\nData verification successful: read data matches written data\n");
+  if (all || strcmp(test, "partial") == 0)
+    {
+      ret = mtd_test_partial(&bench);
+      if (ret < 0)
+        {
+          goto errout_with_buffers;
+        }
+    }
+
+  if (all || strcmp(test, "mixed") == 0)
+    {
+      ret = mtd_test_mixed(&bench);
+    }
 
 errout_with_buffers:
 
   /* Free the allocated buffers */
 
-  free(buffer);
+  free(bench.buffer);
 
 errout_with_driver:
 
-  /* Now close the block device and exit */
+  /* Now close the device and exit */
 
-  close_blockdriver(inode);
-  return 0;
+  mtd_close(&bench);
+  return ret < 0 ? EXIT_FAILURE : EXIT_SUCCESS;
 }
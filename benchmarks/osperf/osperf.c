@@ -25,10 +25,13 @@
  ****************************************************************************/
 
 #include <assert.h>
+#include <fcntl.h>
 #include <limits.h>
+#include <mqueue.h>
 #include <pthread.h>
 #include <sched.h>
 #include <semaphore.h>
+#include <signal.h>
 #include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
@@ -37,14 +40,48 @@
 #include <string.h>
 #include <sys/param.h>
 #include <sys/poll.h>
+#include <unistd.h>
+
+#ifdef CONFIG_EVENT_FD
+#  include <sys/eventfd.h>
+#endif
+
+#ifdef CONFIG_TIMER_FD
+#  include <sys/timerfd.h>
+#endif
 
 #include <nuttx/sched.h>
 #include <nuttx/spinlock.h>
 
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* The test hands off between two threads and has a cross-CPU variant */
+
+#define PERFORMANCE_IPC         (1 << 0)
+
+/* Histogram buckets are powers of two nanoseconds */
+
+#define PERFORMANCE_HIST_SIZE   32
+
+/* Sleep requested by the usleep and timerfd tests */
+
+#define PERFORMANCE_SLEEP_USEC  1000
+
+#define PERFORMANCE_MQ_NAME     "/osperf"
+
 /****************************************************************************
  * Private Types
  ****************************************************************************/
 
+enum performance_format_e
+{
+  PERFORMANCE_FORMAT_TEXT,
+  PERFORMANCE_FORMAT_CSV,
+  PERFORMANCE_FORMAT_JSON
+};
+
 struct performance_time_s
 {
   clock_t start;
@@ -61,6 +98,17 @@ struct performance_entry_s
 {
   const char name[NAME_MAX];
   CODE size_t (*entry)(void);
+  uint8_t flags;
+};
+
+struct performance_result_s
+{
+  size_t max;
+  size_t min;
+  size_t avg;
+  size_t p50;
+  size_t p99;
+  size_t hist[PERFORMANCE_HIST_SIZE];
 };
 
 /****************************************************************************
@@ -75,6 +123,21 @@ static size_t poll_performance(void);
 static size_t pipe_performance(void);
 static size_t semwait_performance(void);
 static size_t sempost_performance(void);
+static size_t mutex_performance(void);
+static size_t condvar_performance(void);
+#ifndef CONFIG_DISABLE_MQUEUE
+static size_t mqueue_performance(void);
+#endif
+#ifdef CONFIG_EVENT_FD
+static size_t eventfd_performance(void);
+#endif
+#ifndef CONFIG_DISABLE_ALL_SIGNALS
+static size_t signal_performance(void);
+#endif
+#ifdef CONFIG_TIMER_FD
+static size_t timerfd_performance(void);
+#endif
+static size_t usleep_performance(void);
 
 /****************************************************************************
  * Private Data
@@ -82,16 +145,41 @@ static size_t sempost_performance(void);
 
 static const struct performance_entry_s g_entry_list[] =
 {
-  {"pthread-create", pthread_create_performance},
-  {"pthread-switch", pthread_switch_performance},
-  {"context-switch", context_switch_performance},
-  {"hpwork", hpwork_performance},
-  {"poll-write", poll_performance},
-  {"pipe-rw", pipe_performance},
-  {"semwait", semwait_performance},
-  {"sempost", sempost_performance},
+  {"pthread-create", pthread_create_performance, 0},
+  {"pthread-switch", pthread_switch_performance, PERFORMANCE_IPC},
+  {"context-switch", context_switch_performance, 0},
+  {"hpwork", hpwork_performance, 0},
+  {"poll-write", poll_performance, PERFORMANCE_IPC},
+  {"pipe-rw", pipe_performance, 0},
+  {"semwait", semwait_performance, 0},
+  {"sempost", sempost_performance, 0},
+  {"mutex-handoff", mutex_performance, PERFORMANCE_IPC},
+  {"condvar-signal", condvar_performance, PERFORMANCE_IPC},
+#ifndef CONFIG_DISABLE_MQUEUE
+  {"mqueue", mqueue_performance, PERFORMANCE_IPC},
+#endif
+#ifdef CONFIG_EVENT_FD
+  {"eventfd", eventfd_performance, PERFORMANCE_IPC},
+#endif
+#ifndef CONFIG_DISABLE_ALL_SIGNALS
+  {"signal", signal_performance, PERFORMANCE_IPC},
+#endif
+#ifdef CONFIG_TIMER_FD
+  {"timerfd-overshoot", timerfd_performance, 0},
+#endif
+  {"usleep-overshoot", usleep_performance, 0},
 };
 
+/* CPU of the second thread in the cross-CPU variants, or -1 while other
+ * tests run.  The measuring thread runs on CPU 0.
+ */
+
+static int g_peer_cpu = -1;
+
+#ifdef CONFIG_SMP
+static int g_xcpu_peer = 1;
+#endif
+
 /****************************************************************************
  * Private Functions
  ****************************************************************************/
@@ -107,11 +195,36 @@ static int performance_thread_create(FAR void *(*entry)(FAR void *),
   pthread_attr_init(&attr);
   pthread_attr_setschedpolicy(&attr, SCHED_FIFO);
   pthread_attr_setschedparam(&attr, &param);
+
+#ifdef CONFIG_SMP
+  if (g_peer_cpu >= 0)
+    {
+      cpu_set_t cpuset;
+
+      CPU_ZERO(&cpuset);
+      CPU_SET(g_peer_cpu, &cpuset);
+      pthread_attr_setaffinity_np(&attr, sizeof(cpu_set_t), &cpuset);
+    }
+#endif
+
   pthread_create(&tid, &attr, entry, arg);
+  pthread_attr_destroy(&attr);
   DEBUGASSERT(tid > 0);
   return tid;
 }
 
+/* A thread created on another CPU does not preempt its creator.  Give it
+ * time to block before the measurement starts.
+ */
+
+static void performance_settle(void)
+{
+  if (g_peer_cpu >= 0)
+    {
+      usleep(PERFORMANCE_SLEEP_USEC);
+    }
+}
+
 static void performance_start(FAR struct performance_time_s *result)
 {
   result->start = perf_gettime();
@@ -151,6 +264,7 @@ static size_t pthread_switch_performance(void)
   sem_init(&perf.sem, 0, 0);
   tid = performance_thread_create(pthread_switch_task, &perf,
                                   CONFIG_BENCHMARK_OSPERF_PRIORITY + 1);
+  performance_settle();
 
   performance_start(&perf.time);
   sem_post(&perf.sem);
@@ -262,6 +376,9 @@ static FAR void *poll_task(FAR void *arg)
   FAR struct performance_time_s *time = argv[0];
   int pipefd = (int)(uintptr_t)argv[1];
 
+  /* Let the other CPU enter poll() first */
+
+  performance_settle();
   performance_start(time);
   write(pipefd, "a", 1);
   return 0;
@@ -355,6 +472,290 @@ static size_t sempost_performance(void)
   return performance_gettime(&result);
 }
 
+/****************************************************************************
+ * mutex handoff performance
+ ****************************************************************************/
+
+static FAR void *mutex_task(FAR void *arg)
+{
+  FAR void **argv = arg;
+  FAR pthread_mutex_t *mutex = argv[0];
+  FAR struct performance_time_s *time = argv[1];
+
+  pthread_mutex_lock(mutex);
+  performance_end(time);
+  pthread_mutex_unlock(mutex);
+  return NULL;
+}
+
+static size_t mutex_performance(void)
+{
+  struct performance_time_s result;
+  pthread_mutex_t mutex;
+  FAR void *argv[2];
+  pthread_t tid;
+
+  pthread_mutex_init(&mutex, NULL);
+  argv[0] = &mutex;
+  argv[1] = &result;
+
+  /* The thread blocks on the mutex we hold.  Measure the time from
+   * unlocking it until the waiter owns it.
+   */
+
+  pthread_mutex_lock(&mutex);
+  tid = performance_thread_create(mutex_task, argv,
+                                  CONFIG_BENCHMARK_OSPERF_PRIORITY + 1);
+  performance_settle();
+
+  performance_start(&result);
+  pthread_mutex_unlock(&mutex);
+  pthread_join(tid, NULL);
+
+  pthread_mutex_destroy(&mutex);
+  return performance_gettime(&result);
+}
+
+/****************************************************************************
+ * condvar signal performance
+ ****************************************************************************/
+
+struct condvar_perf_s
+{
+  pthread_mutex_t mutex;
+  pthread_cond_t cond;
+  bool signaled;
+  struct performance_time_s time;
+};
+
+static FAR void *condvar_task(FAR void *arg)
+{
+  FAR struct condvar_perf_s *perf = arg;
+
+  pthread_mutex_lock(&perf->mutex);
+  while (!perf->signaled)
+    {
+      pthread_cond_wait(&perf->cond, &perf->mutex);
+    }
+
+  performance_end(&perf->time);
+  pthread_mutex_unlock(&perf->mutex);
+  return NULL;
+}
+
+static size_t condvar_performance(void)
+{
+  struct condvar_perf_s perf;
+  pthread_t tid;
+
+  pthread_mutex_init(&perf.mutex, NULL);
+  pthread_cond_init(&perf.cond, NULL);
+  perf.signaled = false;
+
+  tid = performance_thread_create(condvar_task, &perf,
+                                  CONFIG_BENCHMARK_OSPERF_PRIORITY + 1);
+  performance_settle();
+
+  performance_start(&perf.time);
+  pthread_mutex_lock(&perf.mutex);
+  perf.signaled = true;
+  pthread_cond_signal(&perf.cond);
+  pthread_mutex_unlock(&perf.mutex);
+  pthread_join(tid, NULL);
+
+  pthread_cond_destroy(&perf.cond);
+  pthread_mutex_destroy(&perf.mutex);
+  return performance_gettime(&perf.time);
+}
+
+/****************************************************************************
+ * message queue performance
+ ****************************************************************************/
+
+#ifndef CONFIG_DISABLE_MQUEUE
+static FAR void *mqueue_task(FAR void *arg)
+{
+  FAR void **argv = arg;
+  mqd_t mq = (mqd_t)(uintptr_t)argv[0];
+  FAR struct performance_time_s *time = argv[1];
+  char msg;
+
+  mq_receive(mq, &msg, sizeof(msg), NULL);
+  performance_end(time);
+  return NULL;
+}
+
+static size_t mqueue_performance(void)
+{
+  struct performance_time_s result;
+  struct mq_attr attr;
+  FAR void *argv[2];
+  pthread_t tid;
+  mqd_t mq;
+
+  attr.mq_maxmsg  = 1;
+  attr.mq_msgsize = 1;
+  attr.mq_flags   = 0;
+
+  mq = mq_open(PERFORMANCE_MQ_NAME, O_RDWR | O_CREAT, 0644, &attr);
+  DEBUGASSERT(mq != (mqd_t)-1);
+  argv[0] = (FAR void *)(uintptr_t)mq;
+  argv[1] = &result;
+
+  tid = performance_thread_create(mqueue_task, argv,
+                                  CONFIG_BENCHMARK_OSPERF_PRIORITY + 1);
+  performance_settle();
+
+  performance_start(&result);
+  mq_send(mq, "a", 1, 0);
+  pthread_join(tid, NULL);
+
+  mq_close(mq);
+  mq_unlink(PERFORMANCE_MQ_NAME);
+  return performance_gettime(&result);
+}
+#endif
+
+/****************************************************************************
+ * eventfd performance
+ ****************************************************************************/
+
+#ifdef CONFIG_EVENT_FD
+static FAR void *eventfd_task(FAR void *arg)
+{
+  FAR void **argv = arg;
+  int fd = (int)(uintptr_t)argv[0];
+  FAR struct performance_time_s *time = argv[1];
+  eventfd_t value;
+
+  eventfd_read(fd, &value);
+  performance_end(time);
+  return NULL;
+}
+
+static size_t eventfd_performance(void)
+{
+  struct performance_time_s result;
+  FAR void *argv[2];
+  pthread_t tid;
+  int fd;
+
+  fd = eventfd(0, 0);
+  DEBUGASSERT(fd >= 0);
+  argv[0] = (FAR void *)(uintptr_t)fd;
+  argv[1] = &result;
+
+  tid = performance_thread_create(eventfd_task, argv,
+                                  CONFIG_BENCHMARK_OSPERF_PRIORITY + 1);
+  performance_settle();
+
+  performance_start(&result);
+  eventfd_write(fd, 1);
+  pthread_join(tid, NULL);
+
+  close(fd);
+  return performance_gettime(&result);
+}
+#endif
+
+/****************************************************************************
+ * signal performance
+ ****************************************************************************/
+
+#ifndef CONFIG_DISABLE_ALL_SIGNALS
+static FAR void *signal_task(FAR void *arg)
+{
+  FAR struct performance_time_s *time = arg;
+  sigset_t set;
+  int sig;
+
+  sigemptyset(&set);
+  sigaddset(&set, SIGUSR1);
+  sigwait(&set, &sig);
+  performance_end(time);
+  return NULL;
+}
+
+static size_t signal_performance(void)
+{
+  struct performance_time_s result;
+  sigset_t oldset;
+  sigset_t set;
+  pthread_t tid;
+
+  /* Block the signal before creating the thread, which inherits the mask.
+   * Otherwise an early signal would run the default action.
+   */
+
+  sigemptyset(&set);
+  sigaddset(&set, SIGUSR1);
+  pthread_sigmask(SIG_BLOCK, &set, &oldset);
+
+  tid = performance_thread_create(signal_task, &result,
+                                  CONFIG_BENCHMARK_OSPERF_PRIORITY + 1);
+  performance_settle();
+
+  performance_start(&result);
+  pthread_kill(tid, SIGUSR1);
+  pthread_join(tid, NULL);
+
+  pthread_sigmask(SIG_SETMASK, &oldset, NULL);
+  return performance_gettime(&result);
+}
+#endif
+
+/****************************************************************************
+ * timerfd overshoot
+ ****************************************************************************/
+
+#ifdef CONFIG_TIMER_FD
+static size_t timerfd_performance(void)
+{
+  struct performance_time_s result;
+  struct itimerspec spec;
+  uint64_t expirations;
+  size_t elapsed;
+  int fd;
+
+  fd = timerfd_create(CLOCK_MONOTONIC, 0);
+  DEBUGASSERT(fd >= 0);
+
+  memset(&spec, 0, sizeof(spec));
+  spec.it_value.tv_nsec = PERFORMANCE_SLEEP_USEC * NSEC_PER_USEC;
+
+  /* Report how late the expiration is seen, not the requested delay */
+
+  performance_start(&result);
+  timerfd_settime(fd, 0, &spec, NULL);
+  read(fd, &expirations, sizeof(expirations));
+  performance_end(&result);
+
+  close(fd);
+
+  elapsed = performance_gettime(&result);
+  return elapsed > PERFORMANCE_SLEEP_USEC * NSEC_PER_USEC ?
+         elapsed - PERFORMANCE_SLEEP_USEC * NSEC_PER_USEC : 0;
+}
+#endif
+
+/****************************************************************************
+ * usleep overshoot
+ ****************************************************************************/
+
+static size_t usleep_performance(void)
+{
+  struct performance_time_s result;
+  size_t elapsed;
+
+  performance_start(&result);
+  usleep(PERFORMANCE_SLEEP_USEC);
+  performance_end(&result);
+
+  elapsed = performance_gettime(&result);
+  return elapsed > PERFORMANCE_SLEEP_USEC * NSEC_PER_USEC ?
+         elapsed - PERFORMANCE_SLEEP_USEC * NSEC_PER_USEC : 0;
+}
+
 /****************************************************************************
  * performance_help
  ****************************************************************************/
@@ -365,47 +766,219 @@ static void performance_help(void)
   printf("OPTIONS:\n");
   printf("\t-c, \tNumber of times to run each test\n");
   printf("\t-d, \tShow detail of each test\n");
+  printf("\t-f, \tOutput format: text, csv or json\n");
+  printf("\t-H, \tShow the latency histogram of each test\n");
+#ifdef CONFIG_SMP
+  printf("\t-x, \tCPU of the peer thread in -xcpu tests (default 1)\n");
+#endif
   printf("\t-h, \tShow this help message\n");
   printf("\t-l, \tList all tests\n");
 }
 
+/****************************************************************************
+ * performance_analyze
+ ****************************************************************************/
+
+static int performance_compare(FAR const void *a, FAR const void *b)
+{
+  size_t x = *(FAR const size_t *)a;
+  size_t y = *(FAR const size_t *)b;
+
+  return x < y ? -1 : x > y;
+}
+
+static int performance_bucket(size_t time)
+{
+  int bucket = 0;
+
+  while (time > 1 && bucket < PERFORMANCE_HIST_SIZE - 1)
+    {
+      time >>= 1;
+      bucket++;
+    }
+
+  return bucket;
+}
+
+static size_t performance_percentile(FAR const size_t *sorted,
+                                     size_t count, size_t percent)
+{
+  /* Nearest-rank percentile */
+
+  size_t rank = (count * percent + 99) / 100;
+
+  return sorted[rank > 0 ? rank - 1 : 0];
+}
+
+static void performance_analyze(FAR size_t *samples, size_t count,
+                                FAR struct performance_result_s *result)
+{
+  uint64_t total = 0;
+  size_t i;
+
+  memset(result, 0, sizeof(*result));
+
+  for (i = 0; i < count; i++)
+    {
+      total += samples[i];
+      result->hist[performance_bucket(samples[i])]++;
+    }
+
+  qsort(samples, count, sizeof(size_t), performance_compare);
+
+  result->min = samples[0];
+  result->max = samples[count - 1];
+  result->avg = total / count;
+  result->p50 = performance_percentile(samples, count, 50);
+  result->p99 = performance_percentile(samples, count, 99);
+}
+
+/****************************************************************************
+ * performance_print
+ ****************************************************************************/
+
+static void performance_print(FAR const char *name, size_t count,
+                              FAR const struct performance_result_s *result,
+                              enum performance_format_e format, bool hist,
+                              FAR bool *first)
+{
+  int last;
+  int i;
+
+  for (last = PERFORMANCE_HIST_SIZE - 1; last > 0; last--)
+    {
+      if (result->hist[last] != 0)
+        {
+          break;
+        }
+    }
+
+  switch (format)
+    {
+      case PERFORMANCE_FORMAT_TEXT:
+        printf("%-*s %10zu %10zu %10zu %10zu %10zu\n", NAME_MAX, name,
+               result->max, result->min, result->avg, result->p50,
+               result->p99);
+
+        for (i = 0; hist && i <= last; i++)
+          {
+            if (result->hist[i] != 0)
+              {
+                printf("\t%10zu - %10zu: %zu\n",
+                       i ? (size_t)1 << i : 0, ((size_t)2 << i) - 1,
+                       result->hist[i]);
+              }
+          }
+        break;
+
+      case PERFORMANCE_FORMAT_CSV:
+        printf("%s,%zu,%zu,%zu,%zu,%zu,%zu\n", name, count, result->max,
+               result->min, result->avg, result->p50, result->p99);
+        break;
+
+      case PERFORMANCE_FORMAT_JSON:
+        printf("%s\n  {\"name\": \"%s\", \"count\": %zu, \"max\": %zu, "
+               "\"min\": %zu, \"avg\": %zu, \"p50\": %zu, \"p99\": %zu",
+               *first ? "" : ",", name, count, result->max, result->min,
+               result->avg, result->p50, result->p99);
+
+        if (hist)
+          {
+            /* Bucket i counts the times in [2^i, 2^(i+1)) ns */
+
+            printf(", \"hist\": [");
+            for (i = 0; i <= last; i++)
+              {
+                printf("%s%zu", i ? ", " : "", result->hist[i]);
+              }
+
+            printf("]");
+          }
+
+        printf("}");
+        break;
+    }
+
+  *first = false;
+}
+
 /****************************************************************************
  * performance_run
  ****************************************************************************/
 
 static void performance_run(const FAR struct performance_entry_s *item,
-                            size_t count, bool detail)
+                            size_t count, bool detail, bool xcpu,
+                            enum performance_format_e format, bool hist,
+                            FAR bool *first)
 {
-  size_t total = 0;
-  size_t max = 0;
-  size_t min = 0;
+  struct performance_result_s result;
+  char name[NAME_MAX];
+  FAR size_t *samples;
+#ifdef CONFIG_SMP
+  cpu_set_t oldset;
+  cpu_set_t cpuset;
+#endif
   size_t i;
 
+  samples = malloc(count * sizeof(size_t));
+  if (samples == NULL)
+    {
+      fprintf(stderr, "Not enough memory for %zu samples\n", count);
+      return;
+    }
+
+  snprintf(name, sizeof(name), xcpu ? "%s-xcpu" : "%s", item->name);
+
+#ifdef CONFIG_SMP
+  if (xcpu)
+    {
+      /* Measure on CPU 0 against a peer thread on another CPU */
+
+      sched_getaffinity(gettid(), sizeof(cpu_set_t), &oldset);
+      CPU_ZERO(&cpuset);
+      CPU_SET(0, &cpuset);
+      sched_setaffinity(gettid(), sizeof(cpu_set_t), &cpuset);
+      g_peer_cpu = g_xcpu_peer;
+    }
+#endif
+
   for (i = 0; i < count; i++)
     {
-      irqstate_t flags = enter_critical_section();
-      size_t time = item->entry();
-      leave_critical_section(flags);
+      irqstate_t flags = 0;
+      size_t time;
+
+      /* A critical section would serialize the two CPUs */
 
-      total += time;
-      if (time > max)
+      if (!xcpu)
         {
-          max = time;
+          flags = enter_critical_section();
         }
 
-      if (time < min || min == 0)
+      time = item->entry();
+
+      if (!xcpu)
         {
-          min = time;
+          leave_critical_section(flags);
         }
 
-      if (detail)
+      samples[i] = time;
+      if (detail && format == PERFORMANCE_FORMAT_TEXT)
         {
           printf("\t%zu: %zu\n", i, time);
         }
     }
 
-  printf("%-*s %10zu %10zu %10zu\n", NAME_MAX, item->name, max, min,
-         total / count);
+#ifdef CONFIG_SMP
+  if (xcpu)
+    {
+      g_peer_cpu = -1;
+      sched_setaffinity(gettid(), sizeof(cpu_set_t), &oldset);
+    }
+#endif
+
+  performance_analyze(samples, count, &result);
+  performance_print(name, count, &result, format, hist, first);
+  free(samples);
 }
 
 /****************************************************************************
@@ -413,13 +986,27 @@ static void performance_run(const FAR struct performance_entry_s *item,
  ****************************************************************************/
 
 static const FAR
-struct performance_entry_s *find_entry(FAR const char *name)
+struct performance_entry_s *find_entry(FAR const char *name,
+                                       FAR bool *xcpu)
 {
+  size_t len = strlen(name);
   size_t i;
 
+  *xcpu = false;
+
+#ifdef CONFIG_SMP
+  if (len > 5 && strcmp(name + len - 5, "-xcpu") == 0)
+    {
+      *xcpu = true;
+      len  -= 5;
+    }
+#endif
+
   for (i = 0; i < nitems(g_entry_list); i++)
     {
-      if (strcmp(name, g_entry_list[i].name) == 0)
+      if (strncmp(name, g_entry_list[i].name, len) == 0 &&
+          g_entry_list[i].name[len] == '\0' &&
+          (!*xcpu || (g_entry_list[i].flags & PERFORMANCE_IPC) != 0))
         {
           return &g_entry_list[i];
         }
@@ -436,6 +1023,16 @@ void performance_list(void)
     {
       printf("%s\n", g_entry_list[i].name);
     }
+
+#ifdef CONFIG_SMP
+  for (i = 0; i < nitems(g_entry_list); i++)
+    {
+      if (g_entry_list[i].flags & PERFORMANCE_IPC)
+        {
+          printf("%s-xcpu\n", g_entry_list[i].name);
+        }
+    }
+#endif
 }
 
 /****************************************************************************
@@ -444,13 +1041,17 @@ void performance_list(void)
 
 int main(int argc, FAR char *argv[])
 {
+  enum performance_format_e format = PERFORMANCE_FORMAT_TEXT;
   const FAR struct performance_entry_s *item = NULL;
   bool detail = false;
+  bool first = true;
+  bool hist = false;
+  bool xcpu = false;
   size_t count = 100;
   size_t i;
   int opt;
 
-  while ((opt = getopt(argc, argv, "dc:hl")) != -1)
+  while ((opt = getopt(argc, argv, "dc:f:Hhlx:")) != -1)
     {
       switch (opt)
         {
@@ -460,6 +1061,38 @@ int main(int argc, FAR char *argv[])
           case 'c':
             count = strtoul(optarg, NULL, 0);
             break;
+          case 'f':
+            if (strcmp(optarg, "text") == 0)
+              {
+                format = PERFORMANCE_FORMAT_TEXT;
+              }
+            else if (strcmp(optarg, "csv") == 0)
+              {
+                format = PERFORMANCE_FORMAT_CSV;
+              }
+            else if (strcmp(optarg, "json") == 0)
+              {
+                format = PERFORMANCE_FORMAT_JSON;
+              }
+            else
+              {
+                performance_help();
+                return EXIT_FAILURE;
+              }
+            break;
+          case 'H':
+            hist = true;
+            break;
+#ifdef CONFIG_SMP
+          case 'x':
+            g_xcpu_peer = atoi(optarg);
+            if (g_xcpu_peer <= 0 || g_xcpu_peer >= CONFIG_SMP_NCPUS)
+              {
+                printf("Peer CPU must be 1-%d\n", CONFIG_SMP_NCPUS - 1);
+                return EXIT_FAILURE;
+              }
+            break;
+#endif
           case 'h':
             performance_help();
             return EXIT_SUCCESS;
@@ -472,9 +1105,15 @@ int main(int argc, FAR char *argv[])
         }
     }
 
+  if (count == 0)
+    {
+      performance_help();
+      return EXIT_FAILURE;
+    }
+
   if (optind < argc)
     {
-      item = find_entry(argv[optind]);
+      item = find_entry(argv[optind], &xcpu);
       if (item == NULL)
         {
           printf("Can't find %s\n", argv[optind]);
@@ -482,22 +1121,58 @@ int main(int argc, FAR char *argv[])
         }
     }
 
-  printf("OS performance args: count:%zu, detail:%s\n", count,
-         detail ? "true" : "false");
+  /* All times are in nanoseconds */
 
-  printf("==============================================================\n");
-  printf("%-*s %10s %10s %10s\n", NAME_MAX, "Describe", "Max", "Min", "Avg");
+  switch (format)
+    {
+      case PERFORMANCE_FORMAT_TEXT:
+        printf("OS performance args: count:%zu, detail:%s\n", count,
+               detail ? "true" : "false");
+
+        printf("=================================================="
+               "============================\n");
+        printf("%-*s %10s %10s %10s %10s %10s\n", NAME_MAX, "Describe",
+               "Max", "Min", "Avg", "P50", "P99");
+        break;
+
+      case PERFORMANCE_FORMAT_CSV:
+        printf("name,count,max,min,avg,p50,p99\n");
+        break;
+
+      case PERFORMANCE_FORMAT_JSON:
+        printf("[");
+        break;
+    }
 
   if (item != NULL)
     {
-      performance_run(item, count, detail);
-      return EXIT_SUCCESS;
+      performance_run(item, count, detail, xcpu, format, hist, &first);
     }
+  else
+    {
+      for (i = 0; i < nitems(g_entry_list); i++)
+        {
+          item = &g_entry_list[i];
+          performance_run(item, count, detail, false, format, hist,
+                          &first);
+        }
 
-  for (i = 0; i < nitems(g_entry_list); i++)
+#ifdef CONFIG_SMP
+      for (i = 0; i < nitems(g_entry_list); i++)
+        {
+          item = &g_entry_list[i];
+          if (item->flags & PERFORMANCE_IPC)
+            {
+              performance_run(item, count, detail, true, format, hist,
+                              &first);
+            }
+        }
+#endif
+    }
+
+  if (format == PERFORMANCE_FORMAT_JSON)
     {
-      item = &g_entry_list[i];
-      performance_run(item, count, detail);
+      printf("\n]\n");
     }
 
   return EXIT_SUCCESS;
@@ -26,6 +26,9 @@
 
 #include <nuttx/config.h>
 #include <nuttx/irq.h>
+#include <pthread.h>
+#include <sched.h>
+#include <semaphore.h>
 #include <stdio.h>
 #include <stdint.h>
 #include <stdlib.h>
@@ -40,6 +43,12 @@
 
 #define RAMSPEED_PREFIX "RAM Speed: "
 
+/* Default distance between the slots of the pointer chase, one cache line
+ * on most targets.
+ */
+
+#define RAMSPEED_CHASE_STRIDE 64
+
 #if defined(UINTPTR_MAX) && UINTPTR_MAX > 0xFFFFFFFF
 #  define MEM_UNIT         uint64_t
 #  define ALIGN_MASK       0x7
@@ -81,21 +90,56 @@
  * Private Types
  ****************************************************************************/
 
+enum ramspeed_kernel_e
+{
+  RAMSPEED_KERNEL_NONE = 0,  /* Run the memcpy()/memset() tests */
+  RAMSPEED_KERNEL_READ,      /* Read one word every stride */
+  RAMSPEED_KERNEL_WRITE,     /* Write one word every stride */
+  RAMSPEED_KERNEL_COPY,      /* Copy one word every stride */
+  RAMSPEED_KERNEL_CHASE      /* Follow a random cycle of pointers */
+};
+
 struct ramspeed_s
 {
   FAR void *dest;
   FAR const void *src;
   size_t size;
+  size_t stride;
   uint8_t value;
+  uint8_t kernel;
   uint32_t repeat_num;
+  uint32_t nthreads;
   bool irq_disable;
   bool allocate_rw_address;
 };
 
+/* One bandwidth worker, working on its own slice of the buffers */
+
+struct ramspeed_worker_s
+{
+  pthread_t tid;
+  FAR const struct ramspeed_s *info;
+  FAR sem_t *start;
+  FAR uint8_t *dest;
+  FAR const uint8_t *src;
+  size_t size;
+  uint64_t bytes;
+  uint32_t cost_time;
+  uint32_t index;
+  int cpu;
+  bool cancel;
+  MEM_UNIT sink;
+};
+
 /****************************************************************************
  * Private Data
  ****************************************************************************/
 
+static FAR const char * const g_kernel_name[] =
+{
+  "", "read", "write", "copy", "chase"
+};
+
 /****************************************************************************
  * Private Functions
  ****************************************************************************/
@@ -107,7 +151,8 @@ struct ramspeed_s
 static void show_usage(FAR const char *progname, int exitcode)
 {
   printf("\nUsage: %s -a -r <hex-address> -w <hex-address> -s <decimal-size>"
-         " -v <hex-value>[0x00] -n <decimal-repeat number>[100] -i\n",
+         " -v <hex-value>[0x00] -n <decimal-repeat number>[100] -i"
+         " -k <kernel> -t <threads>[1] -S <stride>\n",
          progname);
   printf("\nWhere:\n");
   printf("  -a allocate RW buffers on heap. Overwrites -r and -w option.\n");
@@ -122,6 +167,14 @@ static void show_usage(FAR const char *progname, int exitcode)
   printf("  -i turn off interrupts while testing"
          " [default value: false].\n");
   #endif
+  printf("  -k <kernel> measure the bandwidth of one kernel instead of\n"
+         "     memcpy()/memset(): read, write, copy or chase.\n"
+         "     chase follows a random cycle of pointers.\n");
+  printf("  -t <threads> number of concurrent workers, each working on\n"
+         "     its own slice of the buffers [default value: 1].\n");
+  printf("  -S <stride> distance between accesses in bytes"
+         " [default value: %zu, %d for chase].\n",
+         sizeof(MEM_UNIT), RAMSPEED_CHASE_STRIDE);
   exit(exitcode);
 }
 
@@ -136,6 +189,7 @@ static void parse_commandline(int argc, FAR char **argv,
 
   memset(info, 0, sizeof(struct ramspeed_s));
   info->repeat_num = 100;
+  info->nthreads = 1;
 
   if (argc < 4)
     {
@@ -143,7 +197,7 @@ static void parse_commandline(int argc, FAR char **argv,
       show_usage(argv[0], EXIT_FAILURE);
     }
 
-  while ((ch = getopt(argc, argv, "r:w:s:v:n:ia")) != ERROR)
+  while ((ch = getopt(argc, argv, "r:w:s:v:n:iak:t:S:")) != ERROR)
     {
       switch (ch)
         {
@@ -195,6 +249,44 @@ static void parse_commandline(int argc, FAR char **argv,
             info->irq_disable = true;
             break;
           #endif
+          case 'k':
+            for (info->kernel = RAMSPEED_KERNEL_READ;
+                 info->kernel <= RAMSPEED_KERNEL_CHASE;
+                 info->kernel++)
+              {
+                if (strcmp(optarg, g_kernel_name[info->kernel]) == 0)
+                  {
+                    break;
+                  }
+              }
+
+            if (info->kernel > RAMSPEED_KERNEL_CHASE)
+              {
+                printf(RAMSPEED_PREFIX "Unknown kernel: %s\n", optarg);
+                show_usage(argv[0], EXIT_FAILURE);
+              }
+
+            break;
+          case 't':
+            OPTARG_TO_VALUE(info->nthreads, uint32_t, 10);
+            if (info->nthreads == 0)
+              {
+                printf(RAMSPEED_PREFIX "<threads> must > 0\n");
+                exit(EXIT_FAILURE);
+              }
+
+            break;
+          case 'S':
+            OPTARG_TO_VALUE(info->stride, size_t, 10);
+            if (info->stride == 0 ||
+                (info->stride % sizeof(MEM_UNIT)) != 0)
+              {
+                printf(RAMSPEED_PREFIX "<stride> must be a multiple"
+                       " of %zu\n", sizeof(MEM_UNIT));
+                exit(EXIT_FAILURE);
+              }
+
+            break;
           case '?':
             printf(RAMSPEED_PREFIX "Unknown option: %c\n", (char)optopt);
             show_usage(argv[0], EXIT_FAILURE);
@@ -202,6 +294,33 @@ static void parse_commandline(int argc, FAR char **argv,
         }
     }
 
+  if (info->kernel == RAMSPEED_KERNEL_NONE && info->nthreads > 1)
+    {
+      printf(RAMSPEED_PREFIX "<threads> requires a kernel\n");
+      goto out;
+    }
+
+  if (info->irq_disable && info->nthreads > 1)
+    {
+      /* The workers can't run while one of them holds the interrupts */
+
+      printf(RAMSPEED_PREFIX "-i can't be used with several threads\n");
+      goto out;
+    }
+
+  if (info->stride == 0)
+    {
+      info->stride = info->kernel == RAMSPEED_KERNEL_CHASE ?
+                     RAMSPEED_CHASE_STRIDE : sizeof(MEM_UNIT);
+    }
+
+  if (info->kernel == RAMSPEED_KERNEL_COPY && !info->allocate_rw_address &&
+      info->src == NULL)
+    {
+      printf(RAMSPEED_PREFIX "The copy kernel requires a read address\n");
+      goto out;
+    }
+
   if (!info->allocate_rw_address && info->dest == NULL)
     {
       /* We allow only set write address to test memset only.
@@ -247,6 +366,13 @@ static void parse_commandline(int argc, FAR char **argv,
   printf(RAMSPEED_PREFIX "Interrupts disabled: %s\n",
          info->irq_disable ? "true" : "false");
 
+  if (info->kernel != RAMSPEED_KERNEL_NONE)
+    {
+      printf(RAMSPEED_PREFIX "Kernel: %s\n", g_kernel_name[info->kernel]);
+      printf(RAMSPEED_PREFIX "Threads: %" PRIu32 "\n", info->nthreads);
+      printf(RAMSPEED_PREFIX "Stride: %zu bytes\n", info->stride);
+    }
+
   return;
 
 out:
@@ -564,6 +690,387 @@ static void memset_speed_test(FAR void *dest, uint8_t value,
     }
 }
 
+/****************************************************************************
+ * Name: kernel_read
+ ****************************************************************************/
+
+static void kernel_read(FAR struct ramspeed_worker_s *worker)
+{
+  FAR const volatile MEM_UNIT *s =
+    (FAR const volatile MEM_UNIT *)worker->src;
+  size_t step = worker->info->stride / sizeof(MEM_UNIT);
+  size_t nelem = worker->size / worker->info->stride;
+  MEM_UNIT sum = 0;
+  uint32_t cnt;
+  size_t i;
+
+  for (cnt = 0; cnt < worker->info->repeat_num; cnt++)
+    {
+      for (i = 0; i < nelem; i++)
+        {
+          sum += s[i * step];
+        }
+    }
+
+  worker->sink = sum;
+  worker->bytes = (uint64_t)nelem * sizeof(MEM_UNIT) *
+                  worker->info->repeat_num;
+}
+
+/****************************************************************************
+ * Name: kernel_write
+ ****************************************************************************/
+
+static void kernel_write(FAR struct ramspeed_worker_s *worker)
+{
+  FAR volatile MEM_UNIT *d = (FAR volatile MEM_UNIT *)worker->dest;
+  size_t step = worker->info->stride / sizeof(MEM_UNIT);
+  size_t nelem = worker->size / worker->info->stride;
+  MEM_UNIT v;
+  uint32_t cnt;
+  size_t i;
+
+  memset(&v, worker->info->value, sizeof(v));
+
+  for (cnt = 0; cnt < worker->info->repeat_num; cnt++)
+    {
+      for (i = 0; i < nelem; i++)
+        {
+          d[i * step] = v;
+        }
+    }
+
+  worker->bytes = (uint64_t)nelem * sizeof(MEM_UNIT) *
+                  worker->info->repeat_num;
+}
+
+/****************************************************************************
+ * Name: kernel_copy
+ ****************************************************************************/
+
+static void kernel_copy(FAR struct ramspeed_worker_s *worker)
+{
+  FAR volatile MEM_UNIT *d = (FAR volatile MEM_UNIT *)worker->dest;
+  FAR const volatile MEM_UNIT *s =
+    (FAR const volatile MEM_UNIT *)worker->src;
+  size_t step = worker->info->stride / sizeof(MEM_UNIT);
+  size_t nelem = worker->size / worker->info->stride;
+  uint32_t cnt;
+  size_t i;
+
+  for (cnt = 0; cnt < worker->info->repeat_num; cnt++)
+    {
+      /* A sequential copy is what memcpy() is optimized for */
+
+      if (step == 1)
+        {
+          memcpy(worker->dest, worker->src, nelem * sizeof(MEM_UNIT));
+          continue;
+        }
+
+      for (i = 0; i < nelem; i++)
+        {
+          d[i * step] = s[i * step];
+        }
+    }
+
+  worker->bytes = (uint64_t)nelem * sizeof(MEM_UNIT) *
+                  worker->info->repeat_num;
+}
+
+/****************************************************************************
+ * Name: kernel_chase_prepare
+ *
+ * Description:
+ *   Link the slots of the worker's slice into a single random cycle, so
+ *   that every load depends on the previous one and the prefetcher can't
+ *   guess the next address.  Sattolo's algorithm shuffles the slot indices
+ *   in place into a cyclic permutation, which is then turned into
+ *   pointers.
+ *
+ ****************************************************************************/
+
+static void kernel_chase_prepare(FAR struct ramspeed_worker_s *worker)
+{
+  size_t stride = worker->info->stride;
+  size_t nslots = worker->size / stride;
+  uint32_t seed = 2463534242u + worker->index;
+  uintptr_t tmp;
+  size_t i;
+  size_t j;
+
+#define CHASE_SLOT(n) (*(FAR uintptr_t *)(worker->dest + (n) * stride))
+
+  for (i = 0; i < nslots; i++)
+    {
+      CHASE_SLOT(i) = i;
+    }
+
+  for (i = nslots - 1; i > 0; i--)
+    {
+      /* xorshift32 */
+
+      seed ^= seed << 13;
+      seed ^= seed >> 17;
+      seed ^= seed << 5;
+
+      j = seed % i;
+      tmp = CHASE_SLOT(i);
+      CHASE_SLOT(i) = CHASE_SLOT(j);
+      CHASE_SLOT(j) = tmp;
+    }
+
+  for (i = 0; i < nslots; i++)
+    {
+      CHASE_SLOT(i) = (uintptr_t)(worker->dest + CHASE_SLOT(i) * stride);
+    }
+
+#undef CHASE_SLOT
+}
+
+/****************************************************************************
+ * Name: kernel_chase
+ ****************************************************************************/
+
+static void kernel_chase(FAR struct ramspeed_worker_s *worker)
+{
+  uint64_t nsteps = (uint64_t)(worker->size / worker->info->stride) *
+                    worker->info->repeat_num;
+  FAR void *p = worker->dest;
+  uint64_t i;
+
+  for (i = 0; i < nsteps; i++)
+    {
+      p = *(FAR void * volatile *)p;
+    }
+
+  worker->sink = (MEM_UNIT)(uintptr_t)p;
+  worker->bytes = nsteps * sizeof(uintptr_t);
+}
+
+/****************************************************************************
+ * Name: print_bandwidth
+ ****************************************************************************/
+
+static void print_bandwidth(FAR const char *name, uint64_t bytes,
+                            uint32_t cost_time)
+{
+  double rate;
+
+  if (cost_time == 0)
+    {
+      printf(RAMSPEED_PREFIX
+             "Time-consuming is too short,"
+             " please increase the <repeat number>\n");
+      return;
+    }
+
+  rate = (double)bytes / 1024 / 1024 / 1024 / (cost_time / 1000000.0);
+  printf(RAMSPEED_PREFIX "%s Rate = %.3f GB/s\t[cost: %.3f ms]\n",
+         name, rate, cost_time / 1000.0f);
+}
+
+/****************************************************************************
+ * Name: bandwidth_worker
+ ****************************************************************************/
+
+static FAR void *bandwidth_worker(FAR void *arg)
+{
+  FAR struct ramspeed_worker_s *worker = arg;
+  irqstate_t flags = 0;
+  uint32_t start_time;
+
+  /* Wait until all the workers exist, so that they compete for the memory
+   * for the whole measurement.
+   */
+
+  sem_wait(worker->start);
+
+  if (worker->cancel)
+    {
+      return NULL;
+    }
+
+  if (worker->info->irq_disable)
+    {
+      DISABLE_IRQ(flags);
+    }
+
+  start_time = get_timestamp();
+
+  switch (worker->info->kernel)
+    {
+      case RAMSPEED_KERNEL_READ:
+        kernel_read(worker);
+        break;
+      case RAMSPEED_KERNEL_WRITE:
+        kernel_write(worker);
+        break;
+      case RAMSPEED_KERNEL_COPY:
+        kernel_copy(worker);
+        break;
+      case RAMSPEED_KERNEL_CHASE:
+        kernel_chase(worker);
+        break;
+    }
+
+  worker->cost_time = get_time_elaps(start_time);
+
+  if (worker->info->irq_disable)
+    {
+      ENABLE_IRQ(flags);
+    }
+
+  return NULL;
+}
+
+/****************************************************************************
+ * Name: bandwidth_test
+ ****************************************************************************/
+
+static void bandwidth_test(FAR const struct ramspeed_s *info)
+{
+  FAR struct ramspeed_worker_s *workers;
+  FAR struct ramspeed_worker_s *worker;
+  FAR const uint8_t *src;
+  struct sched_param param;
+  pthread_attr_t attr;
+  sem_t start;
+#ifdef CONFIG_SMP
+  cpu_set_t cpuset;
+#endif
+  uint32_t start_time;
+  uint32_t cost_time;
+  uint64_t bytes = 0;
+  double latency = 0;
+  size_t slice;
+  uint32_t started;
+  uint32_t i;
+  char name[32];
+  int ret;
+
+  /* Every worker gets its own slice of the buffers.  The read kernel uses
+   * the write buffer when there is no read address.
+   */
+
+  slice = (info->size / info->nthreads) & ~(size_t)ALIGN_MASK;
+  if (slice < info->stride ||
+      (info->kernel == RAMSPEED_KERNEL_CHASE && slice < 2 * info->stride))
+    {
+      printf(RAMSPEED_PREFIX "<size> too small for %" PRIu32
+             " threads with a %zu bytes stride\n",
+             info->nthreads, info->stride);
+      return;
+    }
+
+  src = info->src != NULL ? info->src : info->dest;
+
+  workers = calloc(info->nthreads, sizeof(struct ramspeed_worker_s));
+  if (workers == NULL)
+    {
+      printf(RAMSPEED_PREFIX "Workers Alloc Memory Failed!\n");
+      return;
+    }
+
+  sem_init(&start, 0, 0);
+
+  sched_getparam(0, &param);
+  pthread_attr_init(&attr);
+  pthread_attr_setschedparam(&attr, &param);
+
+  printf("______%s bandwidth______\n", g_kernel_name[info->kernel]);
+
+  for (started = 0; started < info->nthreads; started++)
+    {
+      worker          = &workers[started];
+      worker->info    = info;
+      worker->start   = &start;
+      worker->dest    = (FAR uint8_t *)info->dest + started * slice;
+      worker->src     = src + started * slice;
+      worker->size    = slice;
+      worker->index   = started;
+      worker->cpu     = -1;
+
+      if (info->kernel == RAMSPEED_KERNEL_CHASE)
+        {
+          kernel_chase_prepare(worker);
+        }
+
+#ifdef CONFIG_SMP
+      worker->cpu = started % CONFIG_SMP_NCPUS;
+      CPU_ZERO(&cpuset);
+      CPU_SET(worker->cpu, &cpuset);
+      pthread_attr_setaffinity_np(&attr, sizeof(cpu_set_t), &cpuset);
+#endif
+
+      ret = pthread_create(&worker->tid, &attr, bandwidth_worker, worker);
+      if (ret != 0)
+        {
+          printf(RAMSPEED_PREFIX "Failed to create worker %" PRIu32
+                 ": %d\n", started, ret);
+          break;
+        }
+    }
+
+  pthread_attr_destroy(&attr);
+
+  /* Release the workers.  If some could not be created, tell the others
+   * to quit without measuring.
+   */
+
+  start_time = get_timestamp();
+
+  for (i = 0; i < started; i++)
+    {
+      workers[i].cancel = started < info->nthreads;
+
+      sem_post(&start);
+    }
+
+  for (i = 0; i < started; i++)
+    {
+      pthread_join(workers[i].tid, NULL);
+    }
+
+  cost_time = get_time_elaps(start_time);
+
+  if (started == info->nthreads)
+    {
+      for (i = 0; i < started; i++)
+        {
+          worker = &workers[i];
+          if (worker->cpu >= 0)
+            {
+              snprintf(name, sizeof(name), "thread %" PRIu32
+                       " (CPU %d):\t", i, worker->cpu);
+            }
+          else
+            {
+              snprintf(name, sizeof(name), "thread %" PRIu32 ":\t", i);
+            }
+
+          print_bandwidth(name, worker->bytes, worker->cost_time);
+          bytes += worker->bytes;
+
+          /* Every step of the chase loads one pointer */
+
+          latency += (double)worker->cost_time * 1000 /
+                     (worker->bytes / sizeof(uintptr_t));
+        }
+
+      print_bandwidth("aggregate:\t", bytes, cost_time);
+
+      if (info->kernel == RAMSPEED_KERNEL_CHASE)
+        {
+          printf(RAMSPEED_PREFIX "Average latency = %.3f ns\n",
+                 latency / started);
+        }
+    }
+
+  sem_destroy(&start);
+  free(workers);
+}
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -578,17 +1085,24 @@ int main(int argc, FAR char *argv[])
 
   parse_commandline(argc, argv, &ramspeed);
 
-  if (ramspeed.src != NULL)
+  if (ramspeed.kernel != RAMSPEED_KERNEL_NONE)
     {
-      memcpy_speed_test(ramspeed.dest, ramspeed.src,
+      bandwidth_test(&ramspeed);
+    }
+  else
+    {
+      if (ramspeed.src != NULL)
+        {
+          memcpy_speed_test(ramspeed.dest, ramspeed.src,
+                            ramspeed.size, ramspeed.repeat_num,
+                            ramspeed.irq_disable);
+        }
+
+      memset_speed_test(ramspeed.dest, ramspeed.value,
                         ramspeed.size, ramspeed.repeat_num,
                         ramspeed.irq_disable);
     }
 
-  memset_speed_test(ramspeed.dest, ramspeed.value,
-                    ramspeed.size, ramspeed.repeat_num,
-                    ramspeed.irq_disable);
-
   /* Check if alloc from heap? */
 
   if (ramspeed.allocate_rw_address)
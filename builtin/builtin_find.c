@@ -0,0 +1,154 @@
+/****************************************************************************
+ * apps/builtin/builtin_find.c
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <errno.h>
+#include <string.h>
+
+#include "builtin/builtin.h"
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define BUILTIN_UNKNOWN  -1  /* Table not checked yet */
+#define BUILTIN_UNSORTED -2  /* Table not sorted, search linearly */
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+/* Number of entries in the builtin table if it is sorted by name */
+
+static int g_builtin_nsorted = BUILTIN_UNKNOWN;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: builtin_checksorted
+ *
+ * Description:
+ *   Count the builtin table entries and check that the names are strictly
+ *   ascending, as generated by the build.  The result does not change, so
+ *   it is safe to compute it concurrently.
+ *
+ ****************************************************************************/
+
+static int builtin_checksorted(void)
+{
+  FAR const struct builtin_s *prev = NULL;
+  FAR const struct builtin_s *builtin;
+  int i;
+
+  for (i = 0; (builtin = builtin_for_index(i)) != NULL; i++)
+    {
+      if (builtin->name == NULL)
+        {
+          break;
+        }
+
+      if (prev != NULL && strcmp(prev->name, builtin->name) >= 0)
+        {
+          return BUILTIN_UNSORTED;
+        }
+
+      prev = builtin;
+    }
+
+  return i;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: builtin_find
+ *
+ * Description:
+ *   Find a builtin application by name.  This is a binary search version
+ *   of builtin_isavail(), which relies on the builtin table being sorted
+ *   by name.  It falls back to builtin_isavail() if the table turns out
+ *   not to be sorted.
+ *
+ * Input Parameter:
+ *   appname - Name of the builtin application.
+ *
+ * Returned Value:
+ *   The index of the application in the builtin table, or a negated errno
+ *   value (-ENOENT) if there is no such application.
+ *
+ ****************************************************************************/
+
+int builtin_find(FAR const char *appname)
+{
+  FAR const struct builtin_s *builtin;
+  int nsorted;
+  int lo;
+  int hi;
+  int mid;
+  int cmp;
+
+  nsorted = g_builtin_nsorted;
+  if (nsorted == BUILTIN_UNKNOWN)
+    {
+      nsorted           = builtin_checksorted();
+      g_builtin_nsorted = nsorted;
+    }
+
+  if (nsorted == BUILTIN_UNSORTED)
+    {
+      return builtin_isavail(appname);
+    }
+
+  lo = 0;
+  hi = nsorted - 1;
+
+  while (lo <= hi)
+    {
+      mid     = (lo + hi) / 2;
+      builtin = builtin_for_index(mid);
+
+      cmp = strcmp(appname, builtin->name);
+      if (cmp == 0)
+        {
+          return mid;
+        }
+      else if (cmp < 0)
+        {
+          hi = mid - 1;
+        }
+      else
+        {
+          lo = mid + 1;
+        }
+    }
+
+  return -ENOENT;
+}
@@ -619,6 +619,9 @@ int main(int argc, FAR char *argv[])
   nxs_cfg.rxbuf_len     = CONFIG_EXAMPLES_NXSCOPE_RXBUF_LEN;
 #ifdef CONFIG_LOGGING_NXSCOPE_CRICHANNELS
   nxs_cfg.cribuf_len    = CONFIG_EXAMPLES_NXSCOPE_CRIBUF_LEN;
+#endif
+#ifdef CONFIG_LOGGING_NXSCOPE_CHANRINGS
+  nxs_cfg.ringbuf_len   = CONFIG_EXAMPLES_NXSCOPE_RINGBUF_LEN;
 #endif
   nxs_cfg.rx_padding    = CONFIG_EXAMPLES_NXSCOPE_RX_PADDING;
 
@@ -0,0 +1,279 @@
+/****************************************************************************
+ * apps/graphics/nxwidgets/src/cglyphcache.cxx
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "graphics/nxwidgets/cglyphcache.hxx"
+
+/****************************************************************************
+ * Pre-Processor Definitions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Method Implementations
+ ****************************************************************************/
+
+using namespace NXWidgets;
+
+/**
+ * Constructor.
+ *
+ * @param budget Memory budget in bytes.  Zero disables the cache.
+ */
+
+CGlyphCache::CGlyphCache(size_t budget)
+{
+  for (int i = 0; i < NXWIDGETS_GLYPHCACHE_NBUCKETS; i++)
+    {
+      m_buckets[i] = (struct SGlyph *)0;
+    }
+
+  m_head   = (struct SGlyph *)0;
+  m_tail   = (struct SGlyph *)0;
+  m_budget = budget;
+  m_used   = 0;
+  m_hits   = 0;
+  m_misses = 0;
+}
+
+/**
+ * Destructor.
+ */
+
+CGlyphCache::~CGlyphCache(void)
+{
+  flush();
+}
+
+/**
+ * Get the hash bucket of a glyph.
+ */
+
+unsigned int CGlyphCache::hash(enum nx_fontid_e fontId, nxgl_mxpixel_t color,
+                               nxgl_mxpixel_t background,
+                               nxwidget_char_t letter)
+{
+  // Most lookups differ only in the character, so that goes in the low bits
+
+  uint32_t key = (uint32_t)letter ^ ((uint32_t)fontId << 8) ^
+                 ((uint32_t)color * 31) ^ ((uint32_t)background * 131);
+
+  key ^= key >> 16;
+  key ^= key >> 8;
+  return key & (NXWIDGETS_GLYPHCACHE_NBUCKETS - 1);
+}
+
+/**
+ * Remove a glyph from the LRU list.
+ */
+
+void CGlyphCache::unlink(struct SGlyph *glyph)
+{
+  if (glyph->prev)
+    {
+      glyph->prev->next = glyph->next;
+    }
+  else
+    {
+      m_head = glyph->next;
+    }
+
+  if (glyph->next)
+    {
+      glyph->next->prev = glyph->prev;
+    }
+  else
+    {
+      m_tail = glyph->prev;
+    }
+}
+
+/**
+ * Insert a glyph at the head of the LRU list.
+ */
+
+void CGlyphCache::pushHead(struct SGlyph *glyph)
+{
+  glyph->prev = (struct SGlyph *)0;
+  glyph->next = m_head;
+
+  if (m_head)
+    {
+      m_head->prev = glyph;
+    }
+  else
+    {
+      m_tail = glyph;
+    }
+
+  m_head = glyph;
+}
+
+/**
+ * Remove a glyph from the cache and free it.
+ */
+
+void CGlyphCache::evict(struct SGlyph *glyph)
+{
+  // Remove the glyph from its hash bucket
+
+  struct SGlyph **link = &m_buckets[hash(glyph->fontId, glyph->color,
+                                         glyph->background, glyph->letter)];
+  while (*link != glyph)
+    {
+      link = &(*link)->hnext;
+    }
+
+  *link = glyph->hnext;
+
+  // And from the LRU list
+
+  unlink(glyph);
+
+  m_used -= glyph->size;
+  delete[] (uint8_t *)glyph;
+}
+
+/**
+ * Look up a rendered glyph.  A glyph that is found becomes the most
+ * recently used one.
+ *
+ * @param fontId The font ID.
+ * @param color The font color.
+ * @param background The background color.
+ * @param letter The character.
+ * @param width Receives the width of the glyph in pixels.
+ * @return The glyph bitmap, or NULL if the glyph is not cached.
+ */
+
+FAR const uint8_t *CGlyphCache::find(enum nx_fontid_e fontId,
+                                     nxgl_mxpixel_t color,
+                                     nxgl_mxpixel_t background,
+                                     nxwidget_char_t letter,
+                                     nxgl_coord_t &width)
+{
+  if (m_budget == 0)
+    {
+      return (FAR const uint8_t *)0;
+    }
+
+  struct SGlyph *glyph = m_buckets[hash(fontId, color, background, letter)];
+  for (; glyph; glyph = glyph->hnext)
+    {
+      if (glyph->letter == letter && glyph->fontId == fontId &&
+          glyph->color == color && glyph->background == background)
+        {
+          if (glyph != m_head)
+            {
+              unlink(glyph);
+              pushHead(glyph);
+            }
+
+          m_hits++;
+          width = glyph->width;
+          return (FAR const uint8_t *)(glyph + 1);
+        }
+    }
+
+  m_misses++;
+  return (FAR const uint8_t *)0;
+}
+
+/**
+ * Allocate a new glyph in the cache, evicting the least recently used
+ * glyphs as needed.  The caller renders the glyph into the returned
+ * memory.  The glyph must not already be in the cache.
+ *
+ * @param fontId The font ID.
+ * @param color The font color.
+ * @param background The background color.
+ * @param letter The character.
+ * @param width The width of the glyph in pixels.
+ * @param height The height of the glyph in rows.
+ * @param stride The length of one row of the bitmap in bytes.
+ * @return The glyph bitmap memory, or NULL if the glyph doesn't fit
+ *   in the budget or can't be allocated.
+ */
+
+FAR uint8_t *CGlyphCache::add(enum nx_fontid_e fontId, nxgl_mxpixel_t color,
+                              nxgl_mxpixel_t background,
+                              nxwidget_char_t letter, nxgl_coord_t width,
+                              nxgl_coord_t height, size_t stride)
+{
+  // The bitmap follows the glyph header.  The header size is a multiple of
+  // the pointer alignment, so the bitmap is suitably aligned for pixels.
+
+  size_t size = sizeof(struct SGlyph) + stride * height;
+  if (size > m_budget)
+    {
+      return (FAR uint8_t *)0;
+    }
+
+  while (m_used + size > m_budget)
+    {
+      evict(m_tail);
+    }
+
+  FAR uint8_t *mem = new uint8_t[size];
+  if (!mem)
+    {
+      return (FAR uint8_t *)0;
+    }
+
+  struct SGlyph *glyph = (struct SGlyph *)mem;
+  glyph->size       = size;
+  glyph->fontId     = fontId;
+  glyph->color      = color;
+  glyph->background = background;
+  glyph->letter     = letter;
+  glyph->width      = width;
+  glyph->height     = height;
+
+  unsigned int ndx  = hash(fontId, color, background, letter);
+  glyph->hnext      = m_buckets[ndx];
+  m_buckets[ndx]    = glyph;
+
+  pushHead(glyph);
+  m_used += size;
+
+  return (FAR uint8_t *)(glyph + 1);
+}
+
+/**
+ * Free all cached glyphs.  The hit and miss counters are kept.
+ */
+
+void CGlyphCache::flush(void)
+{
+  while (m_tail)
+    {
+      evict(m_tail);
+    }
+}
@@ -100,13 +100,17 @@ using namespace NXWidgets;
 #ifdef CONFIG_NX_WRITEONLY
 CGraphicsPort::CGraphicsPort(INxWindow *pNxWnd, nxgl_mxpixel_t backColor)
 {
-  m_pNxWnd    = pNxWnd;
-  m_backColor = backColor;
+  m_pNxWnd          = pNxWnd;
+  m_backColor       = backColor;
+  m_glyphBuffer     = (FAR uint8_t *)0;
+  m_glyphBufferSize = 0;
 }
 #else
 CGraphicsPort::CGraphicsPort(INxWindow *pNxWnd)
 {
-  m_pNxWnd = pNxWnd;
+  m_pNxWnd          = pNxWnd;
+  m_glyphBuffer     = (FAR uint8_t *)0;
+  m_glyphBufferSize = 0;
 }
 #endif
 
@@ -119,6 +123,8 @@ CGraphicsPort::~CGraphicsPort(void)
   // m_pNxWnd is not deleted.  This is an abstract base class and
   // the caller of the CGraphicsPort instance is responsible for
   // the window destruction.
+
+  delete[] m_glyphBuffer;
 };
 
 /**
@@ -677,6 +683,27 @@ void CGraphicsPort::drawText(struct nxgl_point_s *pos, CRect *bound,
   font->setColor(savedColor);
 }
 
+/**
+ * Get scratch memory large enough to render one glyph.  The memory is
+ * kept between calls.
+ *
+ * @param size The required size in bytes.
+ * @return The scratch memory, or NULL if it cannot be allocated.
+ */
+
+FAR uint8_t *CGraphicsPort::getGlyphBuffer(size_t size)
+{
+  if (size > m_glyphBufferSize)
+    {
+      delete[] m_glyphBuffer;
+
+      m_glyphBuffer     = new uint8_t[size];
+      m_glyphBufferSize = m_glyphBuffer ? size : 0;
+    }
+
+  return m_glyphBuffer;
+}
+
 /**
  * The underlying implementation for drawText functions
  * @param pos The window-relative x/y coordinate of the string.
@@ -720,13 +747,16 @@ void CGraphicsPort::_drawText(struct nxgl_point_s *pos, CRect *bound,
     }
 #endif
 
-  // Allocate a bit of memory to hold the largest rendered font
+  // Glyphs rendered on a solid background only depend on the font, the
+  // colors and the character, so they can be taken from the glyph cache.
+  // Transparent glyphs are blended with the display contents and must be
+  // rendered every time.
 
-  unsigned int bmWidth   = ((unsigned int)font->getMaxWidth() * CONFIG_NXWIDGETS_BPP + 7) >> 3;
-  unsigned int bmHeight  = (unsigned int)font->getHeight();
+  bool useCache = !transparent && m_glyphCache.isEnabled();
 
-  unsigned int glyphSize =  bmWidth * bmHeight;
-  FAR uint8_t  *glyph    =  new uint8_t[glyphSize];
+  enum nx_fontid_e fontId    = font->getFontId();
+  nxgl_mxpixel_t   fontColor = font->getColor();
+  unsigned int     bmHeight  = (unsigned int)font->getHeight();
 
   // Get the bounding rectangle in NX form
 
@@ -738,7 +768,7 @@ void CGraphicsPort::_drawText(struct nxgl_point_s *pos, CRect *bound,
   struct SBitmap bitmap;
   bitmap.bpp    = CONFIG_NXWIDGETS_BPP;
   bitmap.fmt    = CONFIG_NXWIDGETS_FMT;
-  bitmap.data   = (FAR const nxgl_mxpixel_t*)glyph;
+  bitmap.height = bmHeight;
 
   // Loop for each letter in the sub-string
 
@@ -748,23 +778,38 @@ void CGraphicsPort::_drawText(struct nxgl_point_s *pos, CRect *bound,
 
       const nxwidget_char_t letter = string.getCharAt(i);
 
-      // Get the font metrics for this letter
+      // Try the glyph cache first.  A hit also provides the glyph width.
 
-      struct nx_fontmetric_s metrics;
-      font->getCharMetrics(letter, &metrics);
+      FAR const uint8_t *data = (FAR const uint8_t *)0;
+      nxgl_coord_t fontWidth  = 0;
+      bool hasHeight          = true;
 
-      // Get the width of the font (in pixels)
+      if (useCache)
+        {
+          data = m_glyphCache.find(fontId, fontColor, background, letter,
+                                   fontWidth);
+        }
 
-      nxgl_coord_t fontWidth  = (nxgl_coord_t)(metrics.width + metrics.xoffset);
+      if (!data)
+        {
+          // Get the font metrics for this letter
+
+          struct nx_fontmetric_s metrics;
+          font->getCharMetrics(letter, &metrics);
+
+          // Get the width of the font (in pixels)
+
+          fontWidth = (nxgl_coord_t)(metrics.width + metrics.xoffset);
+          hasHeight = metrics.height > 0;
+        }
 
       // Does the letter have height?  Spaces have width, but no height
 
-      if (metrics.height > 0 || !transparent)
+      if (hasHeight || !transparent)
         {
           // Set the current, effective size of the bitmap
 
           bitmap.width  = fontWidth;
-          bitmap.height = bmHeight;
           bitmap.stride = (fontWidth * bitmap.bpp + 7) >> 3;
 
           // Describe the destination of the font as a bounding box
@@ -785,35 +830,62 @@ void CGraphicsPort::_drawText(struct nxgl_point_s *pos, CRect *bound,
 
           if (!nxgl_nullrect(&intersection))
             {
-              // If we have been given a background color, use it to fill the array.
-              // Otherwise initialize the bitmap memory by reading from the display.
-              // The font renderer always renders the fonts on a transparent background.
-
-              if (!transparent)
+              if (!data)
                 {
-                  // Set the glyph memory to the background color
+                  // Render into a new cache entry if possible, otherwise
+                  // into the scratch memory.
 
-                  nxwidget_pixel_t *bmPtr   = (nxwidget_pixel_t *)bitmap.data;
-                  unsigned int      npixels = fontWidth * bmHeight;
-                  for (unsigned int j = 0; j < npixels; j++)
+                  FAR uint8_t *glyph = (FAR uint8_t *)0;
+                  if (useCache)
                     {
-                      *bmPtr++ = background;
+                      glyph = m_glyphCache.add(fontId, fontColor, background,
+                                               letter, fontWidth, bmHeight,
+                                               bitmap.stride);
                     }
-                }
-              else
-                {
-                  // Read the current contents of the destination into the glyph memory
 
-                  m_pNxWnd->getRectangle(&dest, &bitmap);
-                }
+                  if (!glyph)
+                    {
+                      glyph = getGlyphBuffer(bitmap.stride * bmHeight);
+                      if (!glyph)
+                        {
+                          return;
+                        }
+                    }
 
-              // Render the font into the initialized bitmap
+                  bitmap.data = (FAR const nxgl_mxpixel_t *)glyph;
 
-              font->drawChar(&bitmap, letter);
+                  // If we have been given a background color, use it to fill the array.
+                  // Otherwise initialize the bitmap memory by reading from the display.
+                  // The font renderer always renders the fonts on a transparent background.
+
+                  if (!transparent)
+                    {
+                      // Set the glyph memory to the background color
+
+                      nxwidget_pixel_t *bmPtr   = (nxwidget_pixel_t *)glyph;
+                      unsigned int      npixels = (bitmap.stride * bmHeight) /
+                                                  sizeof(nxwidget_pixel_t);
+                      for (unsigned int j = 0; j < npixels; j++)
+                        {
+                          *bmPtr++ = background;
+                        }
+                    }
+                  else
+                    {
+                      // Read the current contents of the destination into the glyph memory
+
+                      m_pNxWnd->getRectangle(&dest, &bitmap);
+                    }
+
+                  // Render the font into the initialized bitmap
+
+                  font->drawChar(&bitmap, letter);
+                  data = glyph;
+                }
 
               // Then put the font on the display
 
-              if (!m_pNxWnd->bitmap(&intersection, (FAR const void *)bitmap.data,
+              if (!m_pNxWnd->bitmap(&intersection, (FAR const void *)data,
                                    pos, bitmap.stride))
                 {
                   ginfo("nx_bitmapwindow failed: %d\n", errno);
@@ -825,8 +897,6 @@ void CGraphicsPort::_drawText(struct nxgl_point_s *pos, CRect *bound,
 
       pos->x += fontWidth;
     }
-
-  delete[] glyph;
 }
 
 /**
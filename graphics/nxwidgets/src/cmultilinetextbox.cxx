@@ -1265,8 +1265,11 @@ void CMultiLineTextBox::drawRow(CGraphicsPort *port, int row)
       textColor = getEnabledTextColor();
     }
 
-  // And draw the text using the selected color
+  // And draw the text using the selected color on the background color
+  // that drawBorder() filled the widget with, so that the glyphs can come
+  // from the glyph cache.
 
   port->drawText(&pos, &rect, m_text->getFont(), *m_text,
-                 m_text->getLineStartIndex(row), rowLength, textColor);
+                 m_text->getLineStartIndex(row), rowLength, textColor,
+                 getBackgroundColor());
 }
@@ -360,10 +360,13 @@ void CTextBox::drawContents(CGraphicsPort *port)
   pos.x = rect.getX() + m_align.x;
   pos.y = rect.getY() + m_align.y;
 
-  // And draw the text
+  // And draw the text.  The background was just filled, so drawing the
+  // glyphs on the background color gives the same result and lets them
+  // come from the glyph cache.
 
   CNxFont *font = getFont();
-  port->drawText(&pos, &rect, font, m_text, 0, m_text.getLength(), textColor);
+  port->drawText(&pos, &rect, font, m_text, 0, m_text.getLength(),
+                 textColor, backColor);
 
   // Draw cursor
 
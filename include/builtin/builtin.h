@@ -81,6 +81,25 @@ extern "C"
 int exec_builtin(FAR const char *appname, FAR char * const *argv,
                  FAR const struct nsh_param_s *param);
 
+/****************************************************************************
+ * Name: builtin_find
+ *
+ * Description:
+ *   Find a builtin application by name.  Same as builtin_isavail(), but
+ *   uses a binary search over the builtin table, which the build generates
+ *   sorted by name.
+ *
+ * Input Parameter:
+ *   appname - Name of the builtin application.
+ *
+ * Returned Value:
+ *   The index of the application in the builtin table, or a negated errno
+ *   value (-ENOENT) if there is no such application.
+ *
+ ****************************************************************************/
+
+int builtin_find(FAR const char *appname);
+
 #undef EXTERN
 #if defined(__cplusplus)
 }
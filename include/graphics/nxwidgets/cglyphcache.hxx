@@ -0,0 +1,261 @@
+/****************************************************************************
+ * apps/include/graphics/nxwidgets/cglyphcache.hxx
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+#ifndef __APPS_INCLUDE_GRAPHICS_NXWIDGETS_CGLYPHCACHE_HXX
+#define __APPS_INCLUDE_GRAPHICS_NXWIDGETS_CGLYPHCACHE_HXX
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include <nuttx/nx/nxglib.h>
+#include <nuttx/nx/nxfonts.h>
+
+#include "graphics/nxwidgets/nxconfig.hxx"
+
+/****************************************************************************
+ * Pre-Processor Definitions
+ ****************************************************************************/
+
+/**
+ * Number of hash buckets.  Must be a power of two.
+ */
+
+#define NXWIDGETS_GLYPHCACHE_NBUCKETS 32
+
+/****************************************************************************
+ * Implementation Classes
+ ****************************************************************************/
+
+#if defined(__cplusplus)
+
+namespace NXWidgets
+{
+  /**
+   * Cache of rendered glyph bitmaps.  Glyphs are keyed by font ID, font
+   * color, background color and character, and the least recently used
+   * glyphs are evicted once the memory budget would be exceeded.
+   *
+   * Only glyphs rendered on a solid background can be cached.  Glyphs
+   * drawn transparently are blended with the current display contents and
+   * must be rendered every time.
+   */
+
+  class CGlyphCache
+  {
+  private:
+    /**
+     * One cached glyph.  The bitmap data follows the structure in the
+     * same allocation.
+     */
+
+    struct SGlyph
+    {
+      struct SGlyph     *hnext;      /**< Next glyph in the hash bucket */
+      struct SGlyph     *prev;       /**< More recently used glyph */
+      struct SGlyph     *next;       /**< Less recently used glyph */
+      size_t             size;       /**< Size of the allocation */
+      enum nx_fontid_e   fontId;     /**< Font ID */
+      nxgl_mxpixel_t     color;      /**< Font color */
+      nxgl_mxpixel_t     background; /**< Background color */
+      nxwidget_char_t    letter;     /**< Character */
+      nxgl_coord_t       width;      /**< Width of the glyph in pixels */
+      nxgl_coord_t       height;     /**< Height of the glyph in rows */
+    };
+
+    /** Hash table of cached glyphs */
+    struct SGlyph *m_buckets[NXWIDGETS_GLYPHCACHE_NBUCKETS];
+
+    struct SGlyph *m_head;       /**< Most recently used glyph */
+    struct SGlyph *m_tail;       /**< Least recently used glyph */
+    size_t         m_budget;     /**< Memory budget in bytes */
+    size_t         m_used;       /**< Memory in use in bytes */
+    uint32_t       m_hits;       /**< Number of lookups that hit */
+    uint32_t       m_misses;     /**< Number of lookups that missed */
+
+    /**
+     * Get the hash bucket of a glyph.
+     */
+
+    static unsigned int hash(enum nx_fontid_e fontId, nxgl_mxpixel_t color,
+                             nxgl_mxpixel_t background,
+                             nxwidget_char_t letter);
+
+    /**
+     * Remove a glyph from the LRU list.
+     */
+
+    void unlink(struct SGlyph *glyph);
+
+    /**
+     * Insert a glyph at the head of the LRU list.
+     */
+
+    void pushHead(struct SGlyph *glyph);
+
+    /**
+     * Remove a glyph from the cache and free it.
+     */
+
+    void evict(struct SGlyph *glyph);
+
+    /**
+     * Copy constructor is private to prevent usage.
+     */
+
+    inline CGlyphCache(const CGlyphCache &cache) { }
+
+  public:
+
+    /**
+     * Constructor.
+     *
+     * @param budget Memory budget in bytes.  Zero disables the cache.
+     */
+
+    CGlyphCache(size_t budget = CONFIG_NXWIDGETS_GLYPHCACHE_SIZE);
+
+    /**
+     * Destructor.
+     */
+
+    ~CGlyphCache(void);
+
+    /**
+     * Look up a rendered glyph.  A glyph that is found becomes the most
+     * recently used one.
+     *
+     * @param fontId The font ID.
+     * @param color The font color.
+     * @param background The background color.
+     * @param letter The character.
+     * @param width Receives the width of the glyph in pixels.
+     * @return The glyph bitmap, or NULL if the glyph is not cached.
+     */
+
+    FAR const uint8_t *find(enum nx_fontid_e fontId, nxgl_mxpixel_t color,
+                            nxgl_mxpixel_t background,
+                            nxwidget_char_t letter, nxgl_coord_t &width);
+
+    /**
+     * Allocate a new glyph in the cache, evicting the least recently used
+     * glyphs as needed.  The caller renders the glyph into the returned
+     * memory.  The glyph must not already be in the cache.
+     *
+     * @param fontId The font ID.
+     * @param color The font color.
+     * @param background The background color.
+     * @param letter The character.
+     * @param width The width of the glyph in pixels.
+     * @param height The height of the glyph in rows.
+     * @param stride The length of one row of the bitmap in bytes.
+     * @return The glyph bitmap memory, or NULL if the glyph doesn't fit
+     *   in the budget or can't be allocated.
+     */
+
+    FAR uint8_t *add(enum nx_fontid_e fontId, nxgl_mxpixel_t color,
+                     nxgl_mxpixel_t background, nxwidget_char_t letter,
+                     nxgl_coord_t width, nxgl_coord_t height,
+                     size_t stride);
+
+    /**
+     * Free all cached glyphs.  The hit and miss counters are kept.
+     */
+
+    void flush(void);
+
+    /**
+     * Check if the cache is enabled.
+     *
+     * @return True if the cache has a non-zero budget.
+     */
+
+    inline bool isEnabled(void) const
+    {
+      return m_budget > 0;
+    }
+
+    /**
+     * Get the memory budget.
+     *
+     * @return The memory budget in bytes.
+     */
+
+    inline size_t getBudget(void) const
+    {
+      return m_budget;
+    }
+
+    /**
+     * Get the memory in use.
+     *
+     * @return The memory used by cached glyphs in bytes.
+     */
+
+    inline size_t getUsed(void) const
+    {
+      return m_used;
+    }
+
+    /**
+     * Get the number of lookups that found a cached glyph.
+     *
+     * @return The number of cache hits.
+     */
+
+    inline uint32_t getHits(void) const
+    {
+      return m_hits;
+    }
+
+    /**
+     * Get the number of lookups that did not find a cached glyph.
+     *
+     * @return The number of cache misses.
+     */
+
+    inline uint32_t getMisses(void) const
+    {
+      return m_misses;
+    }
+
+    /**
+     * Reset the hit and miss counters.
+     */
+
+    inline void resetStatistics(void)
+    {
+      m_hits   = 0;
+      m_misses = 0;
+    }
+  };
+}
+
+#endif // __cplusplus
+
+#endif // __APPS_INCLUDE_GRAPHICS_NXWIDGETS_CGLYPHCACHE_HXX
@@ -70,6 +70,7 @@
 
 #include "graphics/nxwidgets/nxconfig.hxx"
 #include "graphics/nxwidgets/inxwindow.hxx"
+#include "graphics/nxwidgets/cglyphcache.hxx"
 
 /****************************************************************************
  * Pre-Processor Definitions
@@ -99,6 +100,19 @@ namespace NXWidgets
 #ifdef CONFIG_NX_WRITEONLY
     nxgl_mxpixel_t m_backColor;  /**< The background color to use */
 #endif
+    CGlyphCache    m_glyphCache; /**< Cache of rendered glyphs. */
+    FAR uint8_t   *m_glyphBuffer; /**< Scratch memory for uncached glyphs. */
+    size_t         m_glyphBufferSize; /**< Size of the scratch memory. */
+
+    /**
+     * Get scratch memory large enough to render one glyph.  The memory is
+     * kept between calls.
+     *
+     * @param size The required size in bytes.
+     * @return The scratch memory, or NULL if it cannot be allocated.
+     */
+
+    FAR uint8_t *getGlyphBuffer(size_t size);
 
     /**
      * The underlying implementation for drawText functions
@@ -139,6 +153,18 @@ namespace NXWidgets
 
     virtual ~CGraphicsPort();
 
+    /**
+     * Get the cache of rendered glyphs used by the text drawing methods.
+     * Only text drawn with a background color is cached.
+     *
+     * @return The glyph cache.
+     */
+
+    inline CGlyphCache *getGlyphCache(void)
+    {
+      return &m_glyphCache;
+    }
+
     /**
      * Return the absolute x coordinate of the upper left hand corner of the
      * underlying window.
@@ -114,6 +114,12 @@
  * CONFIG_NXWIDGETS_CURSORCONTROL_SIZE - Size of incoming cursor control
  *   buffer, i.e., the maximum number of cursor controls that can between
  *   entered by NX polling cycles without losing data.  Default: 4
+ *
+ * Text rendering
+ *
+ * CONFIG_NXWIDGETS_GLYPHCACHE_SIZE - Memory budget (in bytes) of the cache
+ *   of rendered glyphs kept by each graphics port.  Zero disables the
+ *   cache.  Default: 4096
  */
 
 /* Prerequisites ************************************************************/
@@ -419,6 +425,15 @@
 #  define CONFIG_NXWIDGETS_CURSORCONTROL_SIZE 4
 #endif
 
+/**
+ * Memory budget (in bytes) of the rendered glyph cache of each graphics
+ * port.  Zero disables the cache.
+ */
+
+#ifndef CONFIG_NXWIDGETS_GLYPHCACHE_SIZE
+#  define CONFIG_NXWIDGETS_GLYPHCACHE_SIZE 4096
+#endif
+
 /****************************************************************************
  * Public Types
  ****************************************************************************/
@@ -33,6 +33,10 @@
 #include <pthread.h>
 #include <stdint.h>
 
+#if CONFIG_LOGGING_NXSCOPE_STREAMBUFS > 1
+#  include <nuttx/atomic.h>
+#endif
+
 #include <logging/nxscope/nxscope_chan.h>
 #include <logging/nxscope/nxscope_intf.h>
 #include <logging/nxscope/nxscope_proto.h>
@@ -41,6 +45,8 @@
  * Pre-processor Definitions
  ****************************************************************************/
 
+#define NXSCOPE_STREAMBUFS    CONFIG_LOGGING_NXSCOPE_STREAMBUFS
+
 #define NXSCOPE_ENABLE_LEN    (sizeof(struct nxscope_enable_data_s))
 #define NXSCOPE_DIV_LEN       (sizeof(struct nxscope_div_data_s))
 #define NXSCOPE_START_LEN     (sizeof(struct nxscope_start_data_s))
@@ -248,6 +254,12 @@ struct nxscope_stream_s
   struct nxscope_sample_s samples[1];        /* stream samples */
 };
 
+#ifdef CONFIG_LOGGING_NXSCOPE_CHANRINGS
+/* Nxscope per-channel sample ring (see nxscope_ring.c) */
+
+struct nxscope_ring_s;
+#endif
+
 /* Nxscope callbacks */
 
 struct nxscope_callbacks_s
@@ -322,6 +334,17 @@ struct nxscope_cfg_s
   size_t cribuf_len;
 #endif
 
+#ifdef CONFIG_LOGGING_NXSCOPE_CHANRINGS
+  /* Per-channel sample ring len.
+   *
+   * Each channel gets a ring of this size. The ring is split into slots
+   * that hold one sample, so the ring must be at least as large as the
+   * largest sample (1 + type_size * vdim + meta_len).
+   */
+
+  size_t ringbuf_len;
+#endif
+
   /* RX padding.
    *
    * This option will be provided for client in common info data
@@ -372,6 +395,28 @@ struct nxscope_s
   size_t                       stream_i;
   bool                         stream_retry;
 
+  /* Per-channel overflow counters, chmax elements */
+
+  FAR uint32_t                *ovfcntr;
+
+#if CONFIG_LOGGING_NXSCOPE_STREAMBUFS > 1
+  /* Stream frames pool.
+   *
+   * streambuf always points to the buffer being filled, sealed frames
+   * wait in the pool until they are sent.
+   */
+
+  FAR uint8_t                 *streampool;
+  size_t                       streampool_len[NXSCOPE_STREAMBUFS];
+  uint8_t                      streampool_wr;
+  uint8_t                      streampool_rd;
+  atomic_t                     streampool_sealed;
+
+  /* Exclusive access to the interfaces */
+
+  pthread_mutex_t              txlock;
+#endif
+
 #ifdef CONFIG_LOGGING_NXSCOPE_CRICHANNELS
   /* Critical buffer data */
 
@@ -379,6 +424,14 @@ struct nxscope_s
   size_t                       cribuf_len;
 #endif
 
+#ifdef CONFIG_LOGGING_NXSCOPE_CHANRINGS
+  /* Per-channel sample rings, chmax elements */
+
+  FAR struct nxscope_ring_s   *rings;
+  size_t                       ringbuf_len;
+  uint8_t                      ring_next;
+#endif
+
   /* RX data buffer */
 
   FAR uint8_t                 *rxbuf;
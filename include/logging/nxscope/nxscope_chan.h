@@ -168,6 +168,23 @@ int nxscope_chan_div(FAR struct nxscope_s *s, uint8_t chan, uint8_t div);
 
 int nxscope_chan_all_en(FAR struct nxscope_s *s, bool en);
 
+/****************************************************************************
+ * Name: nxscope_chan_ovf
+ *
+ * Description:
+ *   Get the number of samples lost on a given channel because there was
+ *   no space for them in the stream buffer
+ *
+ * Input Parameters:
+ *   s   - a pointer to a nxscope instance
+ *   ch  - a channel id
+ *   ovf - a pointer to the returned overflow counter
+ *
+ ****************************************************************************/
+
+int nxscope_chan_ovf(FAR struct nxscope_s *s, uint8_t ch,
+                     FAR uint32_t *ovf);
+
 /****************************************************************************
  * Name: nxscope_put_vXXXX_m
  *
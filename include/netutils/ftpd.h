@@ -56,6 +56,8 @@
  *     transfers.  Default: 512 bytes.
  *   CONFIG_FTPD_WORKERSTACKSIZE - The stacksize to allocate for each
  *     FTP daemon worker thread.  Default:  2048 bytes.
+ *   CONFIG_FTPD_XFRBUFFERSIZE - The size of the aligned buffer for binary
+ *     uploads, zero to use the data buffer.  Default: 4096 bytes.
  */
 
 #ifdef CONFIG_DISABLE_PTHREAD
@@ -82,6 +84,10 @@
 #  define CONFIG_FTPD_WORKERSTACKSIZE 2048
 #endif
 
+#ifndef CONFIG_FTPD_XFRBUFFERSIZE
+#  define CONFIG_FTPD_XFRBUFFERSIZE 4096
+#endif
+
 /* Interface definitions ****************************************************/
 
 #define FTPD_ACCOUNTFLAG_NONE    (0)
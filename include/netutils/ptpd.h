@@ -83,14 +83,14 @@ struct ptpd_status_s
   int64_t last_delta_ns;     /* Latest measured clock error */
   int64_t last_adjtime_ns;   /* Previously applied adjtime() offset */
 
-  /* Averaged clock drift estimate (parts per billion).
+  /* Clock drift estimate of the servo (parts per billion).
    * Positive means remote clock runs faster than local clock before
    * adjustment.
    */
 
   long drift_ppb;
 
-  /* Averaged path delay */
+  /* Filtered path delay */
 
   long path_delay_ns;
 
@@ -47,6 +47,16 @@
  * Public Type Declarations
  ****************************************************************************/
 
+/* Frame conversion statistics of the current or last stream */
+
+struct nxcamera_stats_s
+{
+  uint32_t              frames;                      /* Number of frames shown */
+  uint32_t              min_us;                      /* Shortest conversion time */
+  uint32_t              max_us;                      /* Longest conversion time */
+  uint64_t              total_us;                    /* Total conversion time */
+};
+
 /* This structure describes the internal state of the nxcamera */
 
 struct nxcamera_s
@@ -72,6 +82,9 @@ struct nxcamera_s
   size_t                nbuffers;                    /* Number of buffers */
   FAR size_t            *buf_sizes;                  /* Buffer lengths */
   FAR uint8_t           **bufs;                      /* Buffer pointers */
+  FAR uint8_t           *convbuf;                    /* Intermediate frame for
+                                                      * two-pass conversion */
+  struct nxcamera_stats_s stats;                     /* Conversion statistics */
 };
 
 struct video_msg_s
@@ -249,6 +262,24 @@ int nxcamera_setfb(FAR struct nxcamera_s *pcam, FAR const char *device);
 int nxcamera_setfile(FAR struct nxcamera_s *pcam, FAR const char *pfile,
                      bool isimage);
 
+/****************************************************************************
+ * Name: nxcamera_getstats
+ *
+ *   Gets the frame conversion statistics of the current stream, or of the
+ *   last one if no stream is running.
+ *
+ * Input Parameters:
+ *   pcam   - Pointer to the nxcamera context
+ *   stats  - Location to return the statistics
+ *
+ * Returned Value:
+ *   OK
+ *
+ ****************************************************************************/
+
+int nxcamera_getstats(FAR struct nxcamera_s *pcam,
+                      FAR struct nxcamera_stats_s *stats);
+
 #undef EXTERN
 #ifdef __cplusplus
 }
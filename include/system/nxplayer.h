@@ -56,6 +56,20 @@ struct nxplayer_tone_s
   uint32_t pitch_freq;   /* Pitch frequency */
 };
 
+#ifdef CONFIG_NXPLAYER_PREFETCH
+/* Read-ahead statistics of the last or current playback */
+
+struct nxplayer_stats_s
+{
+  uint32_t underruns;    /* Buffers the device had to wait for */
+  uint32_t lowwater;     /* Fewest chunks buffered while playing */
+  uint32_t nchunks;      /* Number of chunks in the read-ahead buffer */
+  uint32_t maxread_us;   /* Longest time to read one chunk */
+};
+
+struct nxplayer_prefetch_s;
+#endif
+
 /* This structure describes the internal state of the NxPlayer */
 
 struct nxplayer_s
@@ -92,6 +106,10 @@ struct nxplayer_s
 
   FAR const struct nxplayer_dec_ops_s *ops;
   struct nxplayer_tone_s tone;
+#ifdef CONFIG_NXPLAYER_PREFETCH
+  FAR struct nxplayer_prefetch_s *prefetch;   /* Reader thread state */
+  struct nxplayer_stats_s stats;              /* Read-ahead statistics */
+#endif
 };
 
 typedef int (*nxplayer_func)(FAR struct nxplayer_s *pplayer, char *pargs);
@@ -528,6 +546,26 @@ int nxplayer_settreble(FAR struct nxplayer_s *pplayer, uint8_t treble);
 int nxplayer_systemreset(FAR struct nxplayer_s *pplayer);
 #endif
 
+/****************************************************************************
+ * Name: nxplayer_getstats
+ *
+ *   Returns the read-ahead statistics of the current playback, or of the
+ *   last one if the player is idle.
+ *
+ * Input Parameters:
+ *   pplayer   - Pointer to the context to initialize
+ *   stats     - Pointer to the structure that receives the statistics
+ *
+ * Returned Value:
+ *   OK if the statistics were returned.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NXPLAYER_PREFETCH
+int nxplayer_getstats(FAR struct nxplayer_s *pplayer,
+                      FAR struct nxplayer_stats_s *stats);
+#endif
+
 /****************************************************************************
  * Name: nxplayer_parse_mp3
  *
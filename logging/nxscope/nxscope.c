@@ -97,7 +97,9 @@ static int nxscope_frame_send(FAR struct nxscope_s *s, uint8_t id,
 
   /* Send frame */
 
+  nxscope_txlock(s);
   ret = INTF_SEND(s, s->intf_cmd, s->txbuf, tx_i);
+  nxscope_txunlock(s);
   if (ret < 0)
     {
       _err("ERROR: INTF_SEND failed %d\n", ret);
@@ -499,6 +501,116 @@ static bool nxscope_stream_empty(FAR struct nxscope_s *s)
     }
 }
 
+#if CONFIG_LOGGING_NXSCOPE_STREAMBUFS > 1
+/****************************************************************************
+ * Name: nxscope_stream_seal
+ *
+ * Description:
+ *   Finalize the current stream frame and switch to the next free buffer
+ *   from the pool. If there is no free buffer, the current frame is kept
+ *   open and producers continue to fill it.
+ *
+ * NOTE: This function assumes that we have exclusive access to the nxscope
+ *       instance
+ *
+ ****************************************************************************/
+
+static int nxscope_stream_seal(FAR struct nxscope_s *s)
+{
+  uint8_t wr  = 0;
+  int     ret = OK;
+
+  DEBUGASSERT(s);
+
+  /* Do nothing if no data */
+
+  if (nxscope_stream_empty(s))
+    {
+      goto errout;
+    }
+
+  /* One buffer is always owned by producers */
+
+  if (atomic_read_acquire(&s->streampool_sealed) >=
+      CONFIG_LOGGING_NXSCOPE_STREAMBUFS - 1)
+    {
+      goto errout;
+    }
+
+  wr = s->streampool_wr;
+
+  ret = PROTO_FRAME_FINAL(s, s->proto_stream, NXSCOPE_HDRID_STREAM,
+                          s->streambuf, &s->stream_i);
+  if (ret < 0)
+    {
+      _err("ERROR: PROTO_FRAME_FINAL failed %d\n", ret);
+      goto errout;
+    }
+
+  s->streampool_len[wr] = s->stream_i;
+
+  /* Pass frame to the sender */
+
+  atomic_fetch_add(&s->streampool_sealed, 1);
+
+  /* Switch to the next buffer */
+
+  wr = (wr + 1) % CONFIG_LOGGING_NXSCOPE_STREAMBUFS;
+
+  s->streampool_wr = wr;
+  s->streambuf     = &s->streampool[wr * s->streambuf_len];
+
+  nxscope_stream_reset(s);
+
+errout:
+  return ret;
+}
+
+/****************************************************************************
+ * Name: nxscope_stream_flush
+ *
+ * Description:
+ *   Send all sealed stream frames directly from the pool buffers.
+ *   A frame that fails to send is kept and retried on the next call.
+ *
+ * NOTE: This function must be called without the nxscope lock held
+ *
+ ****************************************************************************/
+
+static int nxscope_stream_flush(FAR struct nxscope_s *s)
+{
+  FAR uint8_t *buff = NULL;
+  uint8_t      rd   = 0;
+  int          ret  = OK;
+
+  DEBUGASSERT(s);
+
+  nxscope_txlock(s);
+
+  while (atomic_read_acquire(&s->streampool_sealed) > 0)
+    {
+      rd   = s->streampool_rd;
+      buff = &s->streampool[rd * s->streambuf_len];
+
+      ret = INTF_SEND(s, s->intf_stream, buff, s->streampool_len[rd]);
+      if (ret < 0)
+        {
+          _err("ERROR: INTF_SEND failed %d\n", ret);
+          break;
+        }
+
+      /* Return buffer to the pool */
+
+      s->streampool_rd = (rd + 1) % CONFIG_LOGGING_NXSCOPE_STREAMBUFS;
+      atomic_fetch_sub(&s->streampool_sealed, 1);
+    }
+
+  nxscope_txunlock(s);
+
+  return ret;
+}
+#endif
+
 #ifdef CONFIG_LOGGING_NXSCOPE_ACKFRAMES
 /****************************************************************************
  * Name: nxscope_ack
@@ -770,7 +882,15 @@ int nxscope_init(FAR struct nxscope_s *s, FAR struct nxscope_cfg_s *cfg)
 
   DEBUGASSERT(cfg->streambuf_len > 0);
 
+#if CONFIG_LOGGING_NXSCOPE_STREAMBUFS > 1
+  /* All stream frame buffers in one block, start with the first one */
+
+  s->streampool = zalloc(cfg->streambuf_len *
+                         CONFIG_LOGGING_NXSCOPE_STREAMBUFS);
+  s->streambuf  = s->streampool;
+#else
   s->streambuf = zalloc(cfg->streambuf_len);
+#endif
   if (s->streambuf == NULL)
     {
       ret = -errno;
@@ -794,6 +914,27 @@ int nxscope_init(FAR struct nxscope_s *s, FAR struct nxscope_cfg_s *cfg)
       goto errout;
     }
 
+  /* Allocate memory for overflow counters */
+
+  s->ovfcntr = zalloc(cfg->channels * sizeof(uint32_t));
+  if (s->ovfcntr == NULL)
+    {
+      ret = -errno;
+      _err("ERROR: ovfcntr zalloc failed %d\n", ret);
+      goto errout;
+    }
+
+#ifdef CONFIG_LOGGING_NXSCOPE_CHANRINGS
+  /* Allocate memory for channel rings */
+
+  ret = nxscope_ring_init(s, cfg->channels, cfg->ringbuf_len);
+  if (ret < 0)
+    {
+      _err("ERROR: nxscope_ring_init failed %d\n", ret);
+      goto errout;
+    }
+#endif
+
 #ifdef CONFIG_LOGGING_NXSCOPE_DIVIDER
   /* Allocate memory for divider counters */
 
@@ -855,6 +996,16 @@ int nxscope_init(FAR struct nxscope_s *s, FAR struct nxscope_cfg_s *cfg)
       goto errout;
     }
 
+#if CONFIG_LOGGING_NXSCOPE_STREAMBUFS > 1
+  ret = pthread_mutex_init(&s->txlock, NULL);
+  if (ret != 0)
+    {
+      _err("ERROR: pthread_mutex_init failed %d\n", errno);
+      pthread_mutex_destroy(&s->lock);
+      goto errout;
+    }
+#endif
+
   /* Reset stream buffer */
 
   nxscope_stream_reset(s);
@@ -884,16 +1035,32 @@ int nxscope_init(FAR struct nxscope_s *s, FAR struct nxscope_cfg_s *cfg)
 
 errout:
 
+#if CONFIG_LOGGING_NXSCOPE_STREAMBUFS > 1
+  if (s->streampool != NULL)
+    {
+      free(s->streampool);
+    }
+#else
   if (s->streambuf != NULL)
     {
       free(s->streambuf);
     }
+#endif
 
   if (s->chinfo != NULL)
     {
       free(s->chinfo);
     }
 
+  if (s->ovfcntr != NULL)
+    {
+      free(s->ovfcntr);
+    }
+
+#ifdef CONFIG_LOGGING_NXSCOPE_CHANRINGS
+  nxscope_ring_deinit(s);
+#endif
+
 #ifdef CONFIG_LOGGING_NXSCOPE_DIVIDER
   if (s->cntr != NULL)
     {
@@ -939,19 +1106,38 @@ void nxscope_deinit(FAR struct nxscope_s *s)
   /* Free mutex */
 
   pthread_mutex_destroy(&s->lock);
+#if CONFIG_LOGGING_NXSCOPE_STREAMBUFS > 1
+  pthread_mutex_destroy(&s->txlock);
+#endif
 
   /* Free allocated memory */
 
+#if CONFIG_LOGGING_NXSCOPE_STREAMBUFS > 1
+  if (s->streampool != NULL)
+    {
+      free(s->streampool);
+    }
+#else
   if (s->streambuf != NULL)
     {
       free(s->streambuf);
     }
+#endif
 
   if (s->chinfo != NULL)
     {
       free(s->chinfo);
     }
 
+  if (s->ovfcntr != NULL)
+    {
+      free(s->ovfcntr);
+    }
+
+#ifdef CONFIG_LOGGING_NXSCOPE_CHANRINGS
+  nxscope_ring_deinit(s);
+#endif
+
 #ifdef CONFIG_LOGGING_NXSCOPE_DIVIDER
   if (s->cntr != NULL)
     {
@@ -1037,6 +1223,25 @@ int nxscope_stream(FAR struct nxscope_s *s)
       goto errout;
     }
 
+#ifdef CONFIG_LOGGING_NXSCOPE_CHANRINGS
+  /* Collect samples from channel rings */
+
+  nxscope_ring_drain(s);
+#endif
+
+#if CONFIG_LOGGING_NXSCOPE_STREAMBUFS > 1
+  /* Seal the current frame and send frames without the lock held */
+
+  ret = nxscope_stream_seal(s);
+  nxscope_unlock(s);
+
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  return nxscope_stream_flush(s);
+#else
   /* Do nothing if no data */
 
   if (nxscope_stream_empty(s))
@@ -1056,6 +1261,7 @@ int nxscope_stream(FAR struct nxscope_s *s)
   /* Reset stream buffer */
 
   nxscope_stream_reset(s);
+#endif
 
 errout:
   nxscope_unlock(s);
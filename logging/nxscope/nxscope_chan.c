@@ -109,10 +109,12 @@ static void nxscope_stream_overflow(FAR struct nxscope_s *s)
 static int nxscope_ch_validate(FAR struct nxscope_s *s, uint8_t ch,
                                uint8_t type, uint8_t d, uint8_t mlen)
 {
+#ifdef CONFIG_LOGGING_NXSCOPE_CRICHANNELS
   union nxscope_chinfo_type_u utype;
-  size_t                      next_i    = 0;
-  int                         ret       = OK;
-  size_t                      type_size = 0;
+#endif
+  size_t                      next_i      = 0;
+  int                         ret         = OK;
+  size_t                      sample_size = 0;
 
   DEBUGASSERT(s);
 
@@ -184,28 +186,19 @@ static int nxscope_ch_validate(FAR struct nxscope_s *s, uint8_t ch,
     }
 #endif
 
-  /* Get utype */
-
-  utype.u8 = type;
-
   /* Check buffer size */
 
-#ifdef CONFIG_LOGGING_NXSCOPE_USERTYPES
-  if (type >= NXSCOPE_TYPE_USER)
-    {
-      type_size = 1;
-    }
-  else
-#endif
-    {
-      type_size = g_type_size[utype.s.dtype];
-    }
+  sample_size = nxscope_sample_size(type, d, mlen);
 
 #ifdef CONFIG_LOGGING_NXSCOPE_CRICHANNELS
+  /* Get utype */
+
+  utype.u8 = type;
+
   if (utype.s.cri)
     {
 #  ifdef CONFIG_DEBUG_FEATURES
-      next_i = (s->proto_stream->hdrlen + 1 + type_size * d + mlen +
+      next_i = (s->proto_stream->hdrlen + sample_size +
                 s->proto_stream->footlen);
 
       /* Verify the size of the critical channels buffer  */
@@ -228,12 +221,21 @@ static int nxscope_ch_validate(FAR struct nxscope_s *s, uint8_t ch,
     }
 #endif
 
-  next_i = (s->stream_i + 1 + type_size * d + mlen +
-            s->proto_stream->footlen);
+#ifdef CONFIG_LOGGING_NXSCOPE_CHANRINGS
+  /* Samples go to the channel ring, free space is checked there */
+
+  if (!s->chinfo[ch].type.s.cri)
+    {
+      goto errout;
+    }
+#endif
+
+  next_i = s->stream_i + sample_size + s->proto_stream->footlen;
 
   if (next_i > s->streambuf_len)
     {
       _err("ERROR: no space for data %zu\n", s->stream_i);
+      s->ovfcntr[ch] += 1;
       nxscope_stream_overflow(s);
       ret = -ENOBUFS;
       goto errout;
@@ -408,37 +410,6 @@ static int nxscope_put_meta(FAR uint8_t *buff, FAR uint8_t *meta,
   return mlen;
 }
 
-/****************************************************************************
- * Name: nxscope_put_sample
- *
- * NOTE: This function assumes that we have exclusive access to the nxscope
- *       stream buffer
- *
- ****************************************************************************/
-
-static void nxscope_put_sample(FAR uint8_t *buff, FAR size_t *buff_i,
-                               uint8_t type, uint8_t ch, FAR void *val,
-                               uint8_t d, FAR uint8_t *meta, uint8_t mlen)
-{
-  size_t i = 0;
-
-  /* Channel ID */
-
-  buff[(*buff_i)++] = ch;
-
-  /* Vector sample data - always little-endian */
-
-  i = nxscope_put_vector(&buff[*buff_i], type, val, d);
-  *buff_i += i;
-
-  /* Meta data.
-   * REVISIT: what about endianness ?
-   */
-
-  i = nxscope_put_meta(&buff[*buff_i], meta, mlen);
-  *buff_i += i;
-}
-
 /****************************************************************************
  * Name: nxscope_put_common_m
  ****************************************************************************/
@@ -457,6 +428,30 @@ static int nxscope_put_common_m(FAR struct nxscope_s *s, uint8_t type,
 
   DEBUGASSERT(s);
 
+#ifdef CONFIG_LOGGING_NXSCOPE_CHANRINGS
+  /* The channel type is needed before nxscope_ch_validate() runs, so the
+   * channel index must be checked here.
+   */
+
+  if (ch >= s->cmninfo.chmax)
+    {
+      return -EINVAL;
+    }
+
+  /* Non-critical channels are buffered in lock-free channel rings */
+
+  if (!s->chinfo[ch].type.s.cri)
+    {
+      ret = nxscope_ch_validate(s, ch, type, d, mlen);
+      if (ret == OK)
+        {
+          ret = nxscope_ring_put(s, type, ch, val, d, meta, mlen);
+        }
+
+      goto errout_nolock;
+    }
+#endif
+
 #ifndef CONFIG_LOGGING_NXSCOPE_DISABLE_PUTLOCK
   nxscope_lock(s);
 #endif
@@ -512,6 +507,9 @@ errout:
   nxscope_unlock(s);
 #endif
 
+#ifdef CONFIG_LOGGING_NXSCOPE_CHANRINGS
+errout_nolock:
+#endif
   return ret;
 }
 
@@ -519,6 +517,86 @@ errout:
  * Public Functions
  ****************************************************************************/
 
+/****************************************************************************
+ * Name: nxscope_sample_size
+ *
+ * Description:
+ *   Return the encoded size of a sample for a given channel type
+ *
+ * Input Parameters:
+ *   type - a channel data type
+ *   d    - a dimmention of sample data vector
+ *   mlen - a length of metadata
+ *
+ ****************************************************************************/
+
+size_t nxscope_sample_size(uint8_t type, uint8_t d, uint8_t mlen)
+{
+  union nxscope_chinfo_type_u utype;
+  size_t                      type_size = 0;
+
+  utype.u8 = type;
+
+#ifdef CONFIG_LOGGING_NXSCOPE_USERTYPES
+  if (type >= NXSCOPE_TYPE_USER)
+    {
+      type_size = 1;
+    }
+  else
+#endif
+    {
+      type_size = g_type_size[utype.s.dtype];
+    }
+
+  /* Channel ID + vector data + metadata */
+
+  return 1 + type_size * d + mlen;
+}
+
+/****************************************************************************
+ * Name: nxscope_put_sample
+ *
+ * Description:
+ *   Encode a sample (channel id, vector data, metadata) into a buffer
+ *
+ *   NOTE: This function assumes that we have exclusive access to the
+ *         buffer
+ *
+ * Input Parameters:
+ *   buff   - a pointer to a buffer
+ *   buff_i - a pointer to a buffer cursor
+ *   type   - a channel data type
+ *   ch     - a channel id
+ *   val    - a pointer to a sample data vector
+ *   d      - a dimmention of sample data vector
+ *   meta   - a pointer to metadata
+ *   mlen   - a length of metadata
+ *
+ ****************************************************************************/
+
+void nxscope_put_sample(FAR uint8_t *buff, FAR size_t *buff_i,
+                        uint8_t type, uint8_t ch, FAR void *val,
+                        uint8_t d, FAR uint8_t *meta, uint8_t mlen)
+{
+  size_t i = 0;
+
+  /* Channel ID */
+
+  buff[(*buff_i)++] = ch;
+
+  /* Vector sample data - always little-endian */
+
+  i = nxscope_put_vector(&buff[*buff_i], type, val, d);
+  *buff_i += i;
+
+  /* Meta data.
+   * REVISIT: what about endianness ?
+   */
+
+  i = nxscope_put_meta(&buff[*buff_i], meta, mlen);
+  *buff_i += i;
+}
+
 /****************************************************************************
  * Name: nxscope_chan_init
  *
@@ -572,6 +650,20 @@ int nxscope_chan_init(FAR struct nxscope_s *s, uint8_t ch, FAR char *name,
   s->chinfo[ch].mlen    = mlen;
   s->chinfo[ch].name    = name;
 
+#ifdef CONFIG_LOGGING_NXSCOPE_CHANRINGS
+  /* Configure channel ring slots */
+
+  if (!NXSCOPE_IS_CRICHAN(type))
+    {
+      ret = nxscope_ring_setup(s, ch, nxscope_sample_size(type, vdim,
+                                                          mlen));
+      if (ret < 0)
+        {
+          memset(&s->chinfo[ch], 0, sizeof(struct nxscope_chinfo_s));
+        }
+    }
+#endif
+
   nxscope_unlock(s);
 
 errout:
@@ -694,6 +786,54 @@ int nxscope_chan_all_en(FAR struct nxscope_s *s, bool en)
   return ret;
 }
 
+/****************************************************************************
+ * Name: nxscope_chan_ovf
+ *
+ * Description:
+ *   Get the number of samples lost on a given channel because there was
+ *   no space for them in the stream buffer
+ *
+ * Input Parameters:
+ *   s   - a pointer to a nxscope instance
+ *   ch  - a channel id
+ *   ovf - a pointer to the returned overflow counter
+ *
+ ****************************************************************************/
+
+int nxscope_chan_ovf(FAR struct nxscope_s *s, uint8_t ch,
+                     FAR uint32_t *ovf)
+{
+  int ret = OK;
+
+  DEBUGASSERT(s);
+  DEBUGASSERT(ovf);
+
+  nxscope_lock(s);
+
+  if (ch >= s->cmninfo.chmax)
+    {
+      _err("ERROR: invalid channel %d\n", ch);
+      ret = -EINVAL;
+      goto errout;
+    }
+
+  *ovf = s->ovfcntr[ch];
+
+#ifdef CONFIG_LOGGING_NXSCOPE_CHANRINGS
+  /* Samples dropped on a full channel ring */
+
+  if (s->rings != NULL)
+    {
+      *ovf += (uint32_t)atomic_read(&s->rings[ch].drops);
+    }
+#endif
+
+errout:
+  nxscope_unlock(s);
+
+  return ret;
+}
+
 /****************************************************************************
  * Name: nxscope_put_vXXXX_m
  *
@@ -76,7 +76,9 @@ int nxscope_stream_send(FAR struct nxscope_s *s, FAR uint8_t *buff,
 
   /* Send stream data */
 
+  nxscope_txlock(s);
   ret = INTF_SEND(s, s->intf_stream, buff, *buff_i);
+  nxscope_txunlock(s);
   if (ret < 0)
     {
       _err("ERROR: INTF_SEND failed %d\n", ret);
@@ -29,6 +29,10 @@
 
 #include <nuttx/config.h>
 
+#ifdef CONFIG_LOGGING_NXSCOPE_CHANRINGS
+#  include <nuttx/atomic.h>
+#endif
+
 #include <logging/nxscope/nxscope.h>
 
 /****************************************************************************
@@ -51,6 +55,42 @@
 #define INTF_RECV(s, intf, buff, i)             \
   (s)->intf_stream->ops->recv(intf, buff, i)
 
+/* Interfaces are accessed without the nxscope lock held when the stream
+ * frames pool is used, so they need their own lock.
+ */
+
+#if CONFIG_LOGGING_NXSCOPE_STREAMBUFS > 1
+#  define nxscope_txlock(s)   pthread_mutex_lock(&(s)->txlock)
+#  define nxscope_txunlock(s) pthread_mutex_unlock(&(s)->txlock)
+#else
+#  define nxscope_txlock(s)
+#  define nxscope_txunlock(s)
+#endif
+
+/****************************************************************************
+ * Public Types
+ ****************************************************************************/
+
+#ifdef CONFIG_LOGGING_NXSCOPE_CHANRINGS
+/* Single-producer/single-consumer sample ring.
+ *
+ * The ring buffer is divided into slots of a fixed size, each slot holds
+ * exactly one encoded sample for the channel. head is written only by
+ * the producer, tail only by the consumer (nxscope_stream()).
+ */
+
+struct nxscope_ring_s
+{
+  FAR uint8_t *buf;             /* Ring memory */
+  size_t       slot_size;       /* Size of one sample slot */
+  uint32_t     nslots;          /* Number of slots in the ring */
+  atomic_t     head;            /* Producer slot counter */
+  atomic_t     tail;            /* Consumer slot counter */
+  atomic_t     drops;           /* Samples dropped on full ring */
+  uint32_t     drops_seen;      /* Drops already reported by consumer */
+};
+#endif
+
 /****************************************************************************
  * Public Function Puttypes
  ****************************************************************************/
@@ -71,4 +111,88 @@
 int nxscope_stream_send(FAR struct nxscope_s *s, FAR uint8_t *buff,
                         FAR size_t *buff_i);
 
+#ifdef CONFIG_LOGGING_NXSCOPE_CHANRINGS
+/****************************************************************************
+ * Name: nxscope_ring_init
+ *
+ * Description:
+ *   Allocate per-channel sample rings
+ *
+ ****************************************************************************/
+
+int nxscope_ring_init(FAR struct nxscope_s *s, uint8_t channels,
+                      size_t len);
+
+/****************************************************************************
+ * Name: nxscope_ring_deinit
+ *
+ * Description:
+ *   Free per-channel sample rings
+ *
+ ****************************************************************************/
+
+void nxscope_ring_deinit(FAR struct nxscope_s *s);
+
+/****************************************************************************
+ * Name: nxscope_ring_setup
+ *
+ * Description:
+ *   Configure the ring slots for a given channel.
+ *
+ *   NOTE: This function assumes that we have exclusive access to the
+ *         nxscope instance and the channel producer is not active.
+ *
+ ****************************************************************************/
+
+int nxscope_ring_setup(FAR struct nxscope_s *s, uint8_t ch,
+                       size_t sample_size);
+
+/****************************************************************************
+ * Name: nxscope_ring_put
+ *
+ * Description:
+ *   Put a sample on the channel ring. Lock-free, producer side.
+ *
+ ****************************************************************************/
+
+int nxscope_ring_put(FAR struct nxscope_s *s, uint8_t type, uint8_t ch,
+                     FAR void *val, uint8_t d, FAR uint8_t *meta,
+                     uint8_t mlen);
+
+/****************************************************************************
+ * Name: nxscope_ring_drain
+ *
+ * Description:
+ *   Move samples from the channel rings to the stream buffer.
+ *
+ *   NOTE: This function assumes that we have exclusive access to the
+ *         nxscope instance
+ *
+ ****************************************************************************/
+
+void nxscope_ring_drain(FAR struct nxscope_s *s);
+#endif
+
+/****************************************************************************
+ * Name: nxscope_put_sample
+ *
+ * Description:
+ *   Encode a sample (channel id, vector data, metadata) into a buffer
+ *
+ ****************************************************************************/
+
+void nxscope_put_sample(FAR uint8_t *buff, FAR size_t *buff_i,
+                        uint8_t type, uint8_t ch, FAR void *val,
+                        uint8_t d, FAR uint8_t *meta, uint8_t mlen);
+
+/****************************************************************************
+ * Name: nxscope_sample_size
+ *
+ * Description:
+ *   Return the encoded size of a sample for a given channel type
+ *
+ ****************************************************************************/
+
+size_t nxscope_sample_size(uint8_t type, uint8_t d, uint8_t mlen);
+
 #endif  /* __APPS_LOGGING_NXSCOPE_NXSCOPE_INTERNALS_H */
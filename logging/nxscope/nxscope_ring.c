@@ -0,0 +1,332 @@
+/****************************************************************************
+ * apps/logging/nxscope/nxscope_ring.c
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <assert.h>
+#include <nuttx/debug.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <logging/nxscope/nxscope.h>
+
+#include "nxscope_internals.h"
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: nxscope_ring_next
+ ****************************************************************************/
+
+static inline uint32_t nxscope_ring_next(FAR struct nxscope_ring_s *r,
+                                         uint32_t i)
+{
+  i += 1;
+  return (i >= r->nslots) ? 0 : i;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: nxscope_ring_init
+ *
+ * Description:
+ *   Allocate per-channel sample rings
+ *
+ * Input Parameters:
+ *   s        - a pointer to a nxscope instance
+ *   channels - number of channels
+ *   len      - ring length for each channel
+ *
+ ****************************************************************************/
+
+int nxscope_ring_init(FAR struct nxscope_s *s, uint8_t channels,
+                      size_t len)
+{
+  FAR uint8_t *buf = NULL;
+  int          ret = OK;
+  int          i   = 0;
+
+  DEBUGASSERT(s);
+  DEBUGASSERT(len > 0);
+
+  s->rings = zalloc(channels * sizeof(struct nxscope_ring_s));
+  if (s->rings == NULL)
+    {
+      ret = -errno;
+      _err("ERROR: rings zalloc failed %d\n", ret);
+      goto errout;
+    }
+
+  /* One allocation for all channel rings */
+
+  buf = zalloc(channels * len);
+  if (buf == NULL)
+    {
+      ret = -errno;
+      _err("ERROR: ringbuf zalloc failed %d\n", ret);
+      free(s->rings);
+      s->rings = NULL;
+      goto errout;
+    }
+
+  for (i = 0; i < channels; i++)
+    {
+      s->rings[i].buf = &buf[i * len];
+    }
+
+  s->ringbuf_len = len;
+
+errout:
+  return ret;
+}
+
+/****************************************************************************
+ * Name: nxscope_ring_deinit
+ *
+ * Description:
+ *   Free per-channel sample rings
+ *
+ * Input Parameters:
+ *   s - a pointer to a nxscope instance
+ *
+ ****************************************************************************/
+
+void nxscope_ring_deinit(FAR struct nxscope_s *s)
+{
+  DEBUGASSERT(s);
+
+  if (s->rings != NULL)
+    {
+      /* Ring memory is allocated as one block starting at the first ring */
+
+      free(s->rings[0].buf);
+      free(s->rings);
+      s->rings = NULL;
+    }
+}
+
+/****************************************************************************
+ * Name: nxscope_ring_setup
+ *
+ * Description:
+ *   Configure the ring slots for a given channel.
+ *
+ *   NOTE: This function assumes that we have exclusive access to the
+ *         nxscope instance and the channel producer is not active.
+ *
+ * Input Parameters:
+ *   s           - a pointer to a nxscope instance
+ *   ch          - a channel id
+ *   sample_size - size of one encoded sample for this channel
+ *
+ ****************************************************************************/
+
+int nxscope_ring_setup(FAR struct nxscope_s *s, uint8_t ch,
+                       size_t sample_size)
+{
+  FAR struct nxscope_ring_s *r = NULL;
+
+  DEBUGASSERT(s);
+  DEBUGASSERT(s->rings);
+
+  r = &s->rings[ch];
+
+  /* One slot is always left empty to tell a full ring from an empty one */
+
+  if (sample_size * 2 > s->ringbuf_len)
+    {
+      _err("ERROR: no space in ring for ch=%d %zu\n", ch, sample_size);
+      r->nslots = 0;
+      return -ENOBUFS;
+    }
+
+  r->slot_size  = sample_size;
+  r->nslots     = s->ringbuf_len / sample_size;
+  r->drops_seen = 0;
+
+  atomic_set(&r->head, 0);
+  atomic_set(&r->tail, 0);
+  atomic_set(&r->drops, 0);
+
+  return OK;
+}
+
+/****************************************************************************
+ * Name: nxscope_ring_put
+ *
+ * Description:
+ *   Put a sample on the channel ring. This is the producer side and it
+ *   never blocks: if the ring is full the sample is dropped and counted.
+ *
+ * Input Parameters:
+ *   s    - a pointer to a nxscope instance
+ *   type - a channel data type
+ *   ch   - a channel id
+ *   val  - a pointer to a sample data vector
+ *   d    - a dimmention of sample data vector
+ *   meta - a pointer to metadata
+ *   mlen - a length of metadata
+ *
+ ****************************************************************************/
+
+int nxscope_ring_put(FAR struct nxscope_s *s, uint8_t type, uint8_t ch,
+                     FAR void *val, uint8_t d, FAR uint8_t *meta,
+                     uint8_t mlen)
+{
+  FAR struct nxscope_ring_s *r    = NULL;
+  uint32_t                   head = 0;
+  uint32_t                   next = 0;
+  size_t                     i    = 0;
+
+  DEBUGASSERT(s);
+
+  r = &s->rings[ch];
+
+  if (r->nslots == 0)
+    {
+      return -EINVAL;
+    }
+
+  head = (uint32_t)atomic_read(&r->head);
+  next = nxscope_ring_next(r, head);
+
+  /* Drop sample if ring is full */
+
+  if (next == (uint32_t)atomic_read_acquire(&r->tail))
+    {
+      atomic_fetch_add(&r->drops, 1);
+      return -ENOBUFS;
+    }
+
+  /* Encode sample directly in the slot */
+
+  nxscope_put_sample(&r->buf[head * r->slot_size], &i, type, ch, val, d,
+                     meta, mlen);
+  DEBUGASSERT(i == r->slot_size);
+
+  /* Publish sample to the consumer */
+
+  atomic_set_release(&r->head, next);
+
+  return OK;
+}
+
+/****************************************************************************
+ * Name: nxscope_ring_drain
+ *
+ * Description:
+ *   Move samples from the channel rings to the stream buffer.
+ *   Samples are interleaved one per channel in round-robin order, so a
+ *   busy channel can't starve the others. Samples that don't fit in the
+ *   stream buffer stay in the rings for the next frame.
+ *
+ *   NOTE: This function assumes that we have exclusive access to the
+ *         nxscope instance
+ *
+ * Input Parameters:
+ *   s - a pointer to a nxscope instance
+ *
+ ****************************************************************************/
+
+void nxscope_ring_drain(FAR struct nxscope_s *s)
+{
+  FAR struct nxscope_ring_s *r        = NULL;
+  uint32_t                   tail     = 0;
+  uint32_t                   drops    = 0;
+  uint8_t                    chmax    = 0;
+  uint8_t                    ch       = 0;
+  int                        i        = 0;
+  bool                       progress = false;
+  bool                       full     = false;
+
+  DEBUGASSERT(s);
+
+  chmax = s->cmninfo.chmax;
+
+  /* Report samples dropped by producers */
+
+  for (i = 0; i < chmax; i++)
+    {
+      r     = &s->rings[i];
+      drops = (uint32_t)atomic_read(&r->drops);
+
+      if (drops != r->drops_seen)
+        {
+          s->streambuf[s->proto_stream->hdrlen] |=
+            NXSCOPE_STREAM_FLAGS_OVERFLOW;
+          r->drops_seen = drops;
+        }
+    }
+
+  do
+    {
+      progress = false;
+
+      for (i = 0; i < chmax; i++)
+        {
+          ch = (s->ring_next + i) % chmax;
+          r  = &s->rings[ch];
+
+          if (r->nslots == 0)
+            {
+              continue;
+            }
+
+          tail = (uint32_t)atomic_read(&r->tail);
+          if (tail == (uint32_t)atomic_read_acquire(&r->head))
+            {
+              continue;
+            }
+
+          if (s->stream_i + r->slot_size + s->proto_stream->footlen >
+              s->streambuf_len)
+            {
+              full = true;
+              break;
+            }
+
+          memcpy(&s->streambuf[s->stream_i],
+                 &r->buf[tail * r->slot_size], r->slot_size);
+          s->stream_i += r->slot_size;
+
+          /* Release slot to the producer */
+
+          atomic_set_release(&r->tail, nxscope_ring_next(r, tail));
+          progress = true;
+        }
+    }
+  while (progress && !full);
+
+  /* Start with the next channel in the next frame */
+
+  s->ring_next = (s->ring_next + 1) % chmax;
+}
@@ -49,7 +49,11 @@
 #include <sys/ioctl.h>
 #include <sys/wait.h>
 
+#include <fcntl.h>
+#include <stdio.h>
+
 #include <inttypes.h>
+#include <limits.h>
 #include <sched.h>
 #include <stdint.h>
 #include <stdbool.h>
@@ -171,6 +175,18 @@
 #  define CONFIG_NETUTILS_DHCPD_DECLINETIME (60*60) /* 1 hour */
 #endif
 
+/* Leases are linked by their index in the lease table */
+
+#define DHCPD_NOLEASE             0xffff
+
+/* Number of buckets of the hash table of the leases by MAC address */
+
+#define DHCPD_MACHASH_SIZE        (CONFIG_NETUTILS_DHCPD_MAXLEASES / 2 + 1)
+
+/* The journal is compacted when it holds this many records */
+
+#define DHCPD_JOURNAL_MAXRECORDS  (2 * CONFIG_NETUTILS_DHCPD_MAXLEASES + 16)
+
 #undef HAVE_ROUTERIP
 #if defined(CONFIG_NETUTILS_DHCPD_ROUTERIP) && CONFIG_NETUTILS_DHCPD_ROUTERIP
 #  define HAVE_ROUTERIP 1
@@ -191,6 +207,12 @@
 #  define HAVE_LEASE_TIME 1
 #endif
 
+/* The journal records the expiry of the leases */
+
+#if defined(CONFIG_NETUTILS_DHCPD_JOURNAL) && !defined(HAVE_LEASE_TIME)
+#  error "CONFIG_NETUTILS_DHCPD_JOURNAL requires POSIX timers"
+#endif
+
 #define g_state  (*g_dhcpd_daemon.ds_data)
 
 /****************************************************************************
@@ -200,17 +222,40 @@
 /* This structure describes one element in the lease table. There is one
  * slot in the lease table for each assign-able IP address (hence, the IP
  * address itself does not have to be in the table.
+ *
+ * Leases with a MAC address are in a hash table by MAC address and the
+ * free leases are in a FIFO list, so that lookups and allocations do not
+ * scan the table.
  */
 
 struct lease_s
 {
   uint8_t  mac[DHCP_HLEN_ETHERNET]; /* MAC address (network order) -- could be larger! */
   bool     allocated;               /* true: IP address is allocated */
+  bool     hashed;                  /* true: In the MAC hash table */
+  bool     free;                    /* true: In the free list */
+  uint16_t hnext;                   /* Next lease in the MAC hash bucket */
+  uint16_t fprev;                   /* Previous lease in the free list */
+  uint16_t fnext;                   /* Next lease in the free list */
 #ifdef HAVE_LEASE_TIME
   time_t   expiry;                  /* Lease expiration time (seconds past Epoch) */
 #endif
 };
 
+/* One record of the lease journal.  The lease of ipaddr is set, or freed
+ * if expiry is zero.
+ */
+
+#ifdef CONFIG_NETUTILS_DHCPD_JOURNAL
+struct dhcpd_record_s
+{
+  int64_t  expiry;                  /* Lease expiration time (Epoch s) */
+  uint32_t ipaddr;                  /* IP address (host order) */
+  uint8_t  mac[DHCP_HLEN_ETHERNET]; /* MAC address (network order) */
+  uint8_t  reserved[2];
+};
+#endif
+
 struct dhcpmsg_s
 {
   uint8_t  op;
@@ -268,6 +313,14 @@ struct dhcpd_state_s
   /* Leases */
 
   struct lease_s   ds_leases[CONFIG_NETUTILS_DHCPD_MAXLEASES];
+  uint16_t         ds_machash[DHCPD_MACHASH_SIZE]; /* Leases by MAC */
+  uint16_t         ds_freehead;     /* Oldest free lease */
+  uint16_t         ds_freetail;     /* Newest free lease */
+
+#ifdef CONFIG_NETUTILS_DHCPD_JOURNAL
+  int              ds_journalfd;    /* Lease journal, opened for append */
+  int              ds_nrecords;     /* Number of records in the journal */
+#endif
 };
 
 /* This type describes the state of the DHCPD client daemon.  Only one
@@ -386,6 +439,180 @@ static time_t dhcpd_time(void)
 #  define dhcpd_time() (0)
 #endif
 
+/****************************************************************************
+ * Name: dhcpd_leaseindex
+ ****************************************************************************/
+
+static inline uint16_t dhcpd_leaseindex(FAR struct lease_s *lease)
+{
+  return (uint16_t)(lease - g_state.ds_leases);
+}
+
+/****************************************************************************
+ * Name: dhcpd_machash
+ ****************************************************************************/
+
+static unsigned int dhcpd_machash(FAR const uint8_t *mac)
+{
+  uint32_t hash = 2166136261u;
+  int i;
+
+  /* FNV-1a.  The last bytes of MAC addresses vary the most, and all of
+   * them go through the multiplication.
+   */
+
+  for (i = 0; i < DHCP_HLEN_ETHERNET; i++)
+    {
+      hash = (hash ^ mac[i]) * 16777619u;
+    }
+
+  return hash % DHCPD_MACHASH_SIZE;
+}
+
+/****************************************************************************
+ * Name: dhcpd_hashadd
+ ****************************************************************************/
+
+static void dhcpd_hashadd(FAR struct lease_s *lease)
+{
+  unsigned int bucket = dhcpd_machash(lease->mac);
+
+  lease->hnext = g_state.ds_machash[bucket];
+  g_state.ds_machash[bucket] = dhcpd_leaseindex(lease);
+  lease->hashed = true;
+}
+
+/****************************************************************************
+ * Name: dhcpd_hashremove
+ ****************************************************************************/
+
+static void dhcpd_hashremove(FAR struct lease_s *lease)
+{
+  FAR uint16_t *link = &g_state.ds_machash[dhcpd_machash(lease->mac)];
+  uint16_t ndx = dhcpd_leaseindex(lease);
+
+  while (*link != ndx)
+    {
+      link = &g_state.ds_leases[*link].hnext;
+    }
+
+  *link = lease->hnext;
+  lease->hnext = DHCPD_NOLEASE;
+  lease->hashed = false;
+}
+
+/****************************************************************************
+ * Name: dhcpd_freeadd
+ *
+ * Description:
+ *   Append a lease to the free list.  Addresses are handed out again in
+ *   the order they were freed, so the address most recently used by a
+ *   client that went away is the last one reused.
+ *
+ ****************************************************************************/
+
+static void dhcpd_freeadd(FAR struct lease_s *lease)
+{
+  uint16_t ndx = dhcpd_leaseindex(lease);
+
+  lease->fprev = g_state.ds_freetail;
+  lease->fnext = DHCPD_NOLEASE;
+  if (g_state.ds_freetail != DHCPD_NOLEASE)
+    {
+      g_state.ds_leases[g_state.ds_freetail].fnext = ndx;
+    }
+  else
+    {
+      g_state.ds_freehead = ndx;
+    }
+
+  g_state.ds_freetail = ndx;
+  lease->free = true;
+}
+
+/****************************************************************************
+ * Name: dhcpd_freeremove
+ ****************************************************************************/
+
+static void dhcpd_freeremove(FAR struct lease_s *lease)
+{
+  if (lease->fprev != DHCPD_NOLEASE)
+    {
+      g_state.ds_leases[lease->fprev].fnext = lease->fnext;
+    }
+  else
+    {
+      g_state.ds_freehead = lease->fnext;
+    }
+
+  if (lease->fnext != DHCPD_NOLEASE)
+    {
+      g_state.ds_leases[lease->fnext].fprev = lease->fprev;
+    }
+  else
+    {
+      g_state.ds_freetail = lease->fprev;
+    }
+
+  lease->free = false;
+}
+
+/****************************************************************************
+ * Name: dhcpd_leasefree
+ *
+ * Description:
+ *   Forget the client and the expiry of a lease and make its address
+ *   available again.
+ *
+ ****************************************************************************/
+
+static void dhcpd_leasefree(FAR struct lease_s *lease)
+{
+  in_addr_t ipaddr = dhcpd_leaseindex(lease) + g_dhcpd_config.ds_startip;
+
+  if (lease->hashed)
+    {
+      dhcpd_hashremove(lease);
+    }
+
+  memset(lease->mac, 0, DHCP_HLEN_ETHERNET);
+  lease->allocated = false;
+#ifdef HAVE_LEASE_TIME
+  lease->expiry = 0;
+#endif
+
+  /* Addresses ending in 0 or 255 are never allocated */
+
+  if (!lease->free && (ipaddr & 0xff) != 0 && (ipaddr & 0xff) != 0xff)
+    {
+      dhcpd_freeadd(lease);
+    }
+}
+
+/****************************************************************************
+ * Name: dhcpd_leaseinit
+ ****************************************************************************/
+
+static void dhcpd_leaseinit(void)
+{
+  int i;
+
+  for (i = 0; i < DHCPD_MACHASH_SIZE; i++)
+    {
+      g_state.ds_machash[i] = DHCPD_NOLEASE;
+    }
+
+  g_state.ds_freehead = DHCPD_NOLEASE;
+  g_state.ds_freetail = DHCPD_NOLEASE;
+
+  for (i = 0; i < CONFIG_NETUTILS_DHCPD_MAXLEASES &&
+              g_dhcpd_config.ds_startip + i <= g_dhcpd_config.ds_endip; i++)
+    {
+      g_state.ds_leases[i].hnext = DHCPD_NOLEASE;
+      dhcpd_leasefree(&g_state.ds_leases[i]);
+    }
+}
+
 /****************************************************************************
  * Name: dhcpd_leaseexpired
  ****************************************************************************/
@@ -399,7 +626,7 @@ static inline bool dhcpd_leaseexpired(struct lease_s *lease)
     }
   else
     {
-      memset(lease, 0, sizeof(struct lease_s));
+      dhcpd_leasefree(lease);
       return true;
     }
 }
@@ -407,6 +634,27 @@ static inline bool dhcpd_leaseexpired(struct lease_s *lease)
 #  define dhcpd_leaseexpired(lease) (false)
 #endif
 
+/****************************************************************************
+ * Name: dhcpd_findbymac
+ ****************************************************************************/
+
+static FAR struct lease_s *dhcpd_findbymac(FAR const uint8_t *mac)
+{
+  uint16_t ndx = g_state.ds_machash[dhcpd_machash(mac)];
+
+  while (ndx != DHCPD_NOLEASE)
+    {
+      if (memcmp(g_state.ds_leases[ndx].mac, mac, DHCP_HLEN_ETHERNET) == 0)
+        {
+          return &(g_state.ds_leases[ndx]);
+        }
+
+      ndx = g_state.ds_leases[ndx].hnext;
+    }
+
+  return NULL;
+}
+
 /****************************************************************************
  * Name: dhcpd_setlease
  ****************************************************************************/
@@ -420,6 +668,7 @@ struct lease_s *dhcpd_setlease(const uint8_t *mac,
 
   int ndx = ipaddr - g_dhcpd_config.ds_startip;
   struct lease_s *ret = NULL;
+  struct lease_s *old;
 
   ninfo("ipaddr: %08" PRIx32 " ipaddr: %08" PRIx32 " ndx: %d MAX: %d\n",
         (uint32_t)ipaddr, (uint32_t)g_dhcpd_config.ds_startip, ndx,
@@ -430,8 +679,33 @@ struct lease_s *dhcpd_setlease(const uint8_t *mac,
   if (ndx >= 0 && ndx < CONFIG_NETUTILS_DHCPD_MAXLEASES)
     {
        ret = &g_state.ds_leases[ndx];
+
+       /* A client holds a single lease */
+
+       old = dhcpd_findbymac(mac);
+       if (old != NULL && old != ret)
+         {
+           dhcpd_leasefree(old);
+         }
+
+       if (ret->hashed &&
+           memcmp(ret->mac, mac, DHCP_HLEN_ETHERNET) != 0)
+         {
+           dhcpd_hashremove(ret);
+         }
+
+       if (ret->free)
+         {
+           dhcpd_freeremove(ret);
+         }
+
        memcpy(ret->mac, mac, DHCP_HLEN_ETHERNET);
        ret->allocated = true;
+       if (!ret->hashed)
+         {
+           dhcpd_hashadd(ret);
+         }
+
 #ifdef HAVE_LEASE_TIME
        ret->expiry = dhcpd_time() + expiry;
 #endif
@@ -452,25 +726,6 @@ static inline in_addr_t dhcp_leaseipaddr(FAR struct lease_s *lease)
          g_dhcpd_config.ds_startip;
 }
 
-/****************************************************************************
- * Name: dhcpd_findbymac
- ****************************************************************************/
-
-static FAR struct lease_s *dhcpd_findbymac(FAR const uint8_t *mac)
-{
-  int i;
-
-  for (i = 0; i < CONFIG_NETUTILS_DHCPD_MAXLEASES; i++)
-    {
-      if (memcmp(g_state.ds_leases[i].mac, mac, DHCP_HLEN_ETHERNET) == 0)
-        {
-          return &(g_state.ds_leases[i]);
-        }
-    }
-
-  return NULL;
-}
-
 /****************************************************************************
  * Name: dhcpd_findbyipaddr
  ****************************************************************************/
@@ -497,43 +752,231 @@ static FAR struct lease_s *dhcpd_findbyipaddr(in_addr_t ipaddr)
 
 static in_addr_t dhcpd_allocipaddr(void)
 {
-  struct lease_s *lease = NULL;
-  in_addr_t ipaddr, startaddr;
+  struct lease_s *lease;
+#ifdef HAVE_LEASE_TIME
+  int i;
 
-  ipaddr = startaddr = g_dhcpd_config.ds_startip;
-  for (; ipaddr <= g_dhcpd_config.ds_endip; ipaddr++)
-    {
-      /* Skip over address ending in 0 or 255 */
+  /* Expired leases are only freed when they are looked at.  Once the free
+   * list is exhausted, sweep the table for them.
+   */
 
-      if ((ipaddr & 0xff) == 0 || (ipaddr & 0xff) == 0xff)
+  if (g_state.ds_freehead == DHCPD_NOLEASE)
+    {
+      for (i = 0; i < CONFIG_NETUTILS_DHCPD_MAXLEASES; i++)
         {
-          continue;
+          if (g_state.ds_leases[i].allocated)
+            {
+              dhcpd_leaseexpired(&g_state.ds_leases[i]);
+            }
         }
+    }
+#endif
 
-      /* Is there already a lease on this address?  If so, has it expired? */
+  if (g_state.ds_freehead == DHCPD_NOLEASE)
+    {
+      return 0;
+    }
 
-      lease = dhcpd_findbyipaddr(ipaddr);
-      if ((!lease || dhcpd_leaseexpired(lease)))
-        {
 #ifdef CONFIG_CPP_HAVE_WARNING
 #  warning "FIXME: Should check if anything responds to an ARP request or ping"
 #  warning "       to verify that there is no other user of this IP address"
 #endif
-          memset(g_state.ds_leases[ipaddr - startaddr].mac,
-          0, DHCP_HLEN_ETHERNET);
-          g_state.ds_leases[ipaddr - startaddr].allocated = true;
+
+  lease = &g_state.ds_leases[g_state.ds_freehead];
+  dhcpd_freeremove(lease);
+  lease->allocated = true;
 #ifdef HAVE_LEASE_TIME
-          g_state.ds_leases[ipaddr - startaddr].expiry =
-            dhcpd_time() + CONFIG_NETUTILS_DHCPD_OFFERTIME;
+  lease->expiry = dhcpd_time() + CONFIG_NETUTILS_DHCPD_OFFERTIME;
 #endif
-          /* Return the address in host order */
 
-          return ipaddr;
+  /* Return the address in host order */
+
+  return dhcp_leaseipaddr(lease);
+}
+
+/****************************************************************************
+ * Name: dhcpd_journal_write
+ ****************************************************************************/
+
+#ifdef CONFIG_NETUTILS_DHCPD_JOURNAL
+static int dhcpd_journal_write(int fd, in_addr_t ipaddr,
+                               FAR const uint8_t *mac, time_t expiry)
+{
+  struct dhcpd_record_s record;
+
+  memset(&record, 0, sizeof(record));
+  record.expiry = expiry;
+  record.ipaddr = ipaddr;
+  memcpy(record.mac, mac, DHCP_HLEN_ETHERNET);
+
+  if (write(fd, &record, sizeof(record)) != sizeof(record))
+    {
+      nerr("ERROR: Failed to write lease journal: %d\n", errno);
+      return ERROR;
+    }
+
+  return OK;
+}
+
+/****************************************************************************
+ * Name: dhcpd_journal_compact
+ *
+ * Description:
+ *   Replace the journal with one record per active lease, then reopen it
+ *   for appending.
+ *
+ ****************************************************************************/
+
+static void dhcpd_journal_compact(void)
+{
+  FAR const char *path = CONFIG_NETUTILS_DHCPD_JOURNAL_PATH;
+  char tmppath[PATH_MAX];
+  FAR struct lease_s *lease;
+  time_t now = dhcpd_time();
+  int nrecords = 0;
+  int fd;
+  int i;
+
+  snprintf(tmppath, sizeof(tmppath), "%s.tmp", path);
+  fd = open(tmppath, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0)
+    {
+      nerr("ERROR: Failed to create %s: %d\n", tmppath, errno);
+      goto reopen;
+    }
+
+  for (i = 0; i < CONFIG_NETUTILS_DHCPD_MAXLEASES; i++)
+    {
+      lease = &g_state.ds_leases[i];
+      if (lease->hashed && lease->expiry > now)
+        {
+          if (dhcpd_journal_write(fd, dhcp_leaseipaddr(lease), lease->mac,
+                                  lease->expiry) < 0)
+            {
+              close(fd);
+              unlink(tmppath);
+              goto reopen;
+            }
+
+          nrecords++;
+        }
+    }
+
+  fsync(fd);
+  close(fd);
+
+  if (rename(tmppath, path) < 0)
+    {
+      nerr("ERROR: Failed to rename %s: %d\n", tmppath, errno);
+      unlink(tmppath);
+      goto reopen;
+    }
+
+  g_state.ds_nrecords = nrecords;
+
+reopen:
+  if (g_state.ds_journalfd >= 0)
+    {
+      close(g_state.ds_journalfd);
+    }
+
+  g_state.ds_journalfd = open(path, O_WRONLY | O_CREAT | O_APPEND, 0644);
+  if (g_state.ds_journalfd < 0)
+    {
+      nerr("ERROR: Failed to open %s: %d\n", path, errno);
+    }
+}
+
+/****************************************************************************
+ * Name: dhcpd_journal_log
+ *
+ * Description:
+ *   Record a change of a lease.  An expiry of zero frees the lease.
+ *
+ ****************************************************************************/
+
+static void dhcpd_journal_log(in_addr_t ipaddr, FAR const uint8_t *mac,
+                              time_t expiry)
+{
+  if (g_state.ds_journalfd < 0)
+    {
+      return;
+    }
+
+  if (dhcpd_journal_write(g_state.ds_journalfd, ipaddr, mac, expiry) == OK)
+    {
+      fsync(g_state.ds_journalfd);
+    }
+
+  if (++g_state.ds_nrecords >= DHCPD_JOURNAL_MAXRECORDS)
+    {
+      dhcpd_journal_compact();
+    }
+}
+
+/****************************************************************************
+ * Name: dhcpd_journal_load
+ *
+ * Description:
+ *   Restore the leases recorded in the journal.  A record truncated by a
+ *   power loss ends the replay.
+ *
+ ****************************************************************************/
+
+static void dhcpd_journal_load(void)
+{
+  struct dhcpd_record_s record;
+  FAR struct lease_s *lease;
+  time_t now = dhcpd_time();
+  int fd;
+
+  fd = open(CONFIG_NETUTILS_DHCPD_JOURNAL_PATH, O_RDONLY);
+  if (fd >= 0)
+    {
+      while (read(fd, &record, sizeof(record)) == sizeof(record))
+        {
+          if (record.ipaddr < g_dhcpd_config.ds_startip ||
+              record.ipaddr > g_dhcpd_config.ds_endip)
+            {
+              continue;
+            }
+
+          if (record.expiry > now)
+            {
+              /* Without a battery backed clock, the time may have gone
+               * backwards since the lease was recorded.
+               */
+
+              if (record.expiry - now > CONFIG_NETUTILS_DHCPD_MAXLEASETIME)
+                {
+                  record.expiry = now + CONFIG_NETUTILS_DHCPD_MAXLEASETIME;
+                }
+
+              lease = dhcpd_setlease(record.mac, record.ipaddr, 0);
+              if (lease != NULL)
+                {
+                  lease->expiry = record.expiry;
+                }
+            }
+          else
+            {
+              lease = dhcpd_findbymac(record.mac);
+              if (lease != NULL &&
+                  dhcp_leaseipaddr(lease) == record.ipaddr)
+                {
+                  dhcpd_leasefree(lease);
+                }
+            }
         }
+
+      close(fd);
     }
 
-  return 0;
+  dhcpd_journal_compact();
 }
+#else
+#  define dhcpd_journal_log(ipaddr, mac, expiry)
+#endif
 
 /****************************************************************************
  * Name: dhcpd_parseoptions
@@ -1149,7 +1592,12 @@ int dhcpd_sendack(int sockfd, in_addr_t ipaddr)
       return ERROR;
     }
 
-  dhcpd_setlease(g_state.ds_inpacket.chaddr, ipaddr, leasetime);
+  if (dhcpd_setlease(g_state.ds_inpacket.chaddr, ipaddr, leasetime))
+    {
+      dhcpd_journal_log(ipaddr, g_state.ds_inpacket.chaddr,
+                        dhcpd_time() + leasetime);
+    }
+
   return OK;
 }
 
@@ -1408,10 +1856,13 @@ static inline int dhcpd_decline(void)
        * address for a period of time.
        */
 
+      dhcpd_hashremove(lease);
       memset(lease->mac, 0, DHCP_HLEN_ETHERNET);
 #ifdef HAVE_LEASE_TIME
       lease->expiry = dhcpd_time() + CONFIG_NETUTILS_DHCPD_DECLINETIME;
 #endif
+      dhcpd_journal_log(dhcp_leaseipaddr(lease),
+                        g_state.ds_inpacket.chaddr, 0);
     }
 
   return OK;
@@ -1428,7 +1879,9 @@ static inline int dhcpd_release(void)
     {
       /* Release the IP address now */
 
-      memset(lease, 0, sizeof(struct lease_s));
+      dhcpd_leasefree(lease);
+      dhcpd_journal_log(dhcp_leaseipaddr(lease),
+                        g_state.ds_inpacket.chaddr, 0);
     }
 
   return OK;
@@ -1599,6 +2052,14 @@ int dhcpd_run(FAR const char *interface)
     }
 
   memset(g_dhcpd_daemon.ds_data, 0, sizeof(struct dhcpd_state_s));
+  dhcpd_leaseinit();
+
+#ifdef CONFIG_NETUTILS_DHCPD_JOURNAL
+  /* Restore the leases granted before the last shutdown */
+
+  g_state.ds_journalfd = -1;
+  dhcpd_journal_load();
+#endif
 
   /* Update the pid if running in daemon mode */
 
@@ -1698,6 +2159,13 @@ int dhcpd_run(FAR const char *interface)
         }
     }
 
+#ifdef CONFIG_NETUTILS_DHCPD_JOURNAL
+  if (g_state.ds_journalfd >= 0)
+    {
+      close(g_state.ds_journalfd);
+    }
+#endif
+
   free(g_dhcpd_daemon.ds_data);
   g_dhcpd_daemon.ds_data = NULL;
   g_dhcpd_daemon.ds_pid   = -1;
@@ -44,10 +44,16 @@
 
 #include <sys/socket.h>
 #include <sys/stat.h>
+#ifdef CONFIG_FTPD_SENDFILE
+#  include <sys/sendfile.h>
+#endif
 
+#include <inttypes.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <syslog.h>
+#include <time.h>
 #include <pthread.h>
 #include <unistd.h>
 #include <dirent.h>
@@ -135,6 +141,15 @@ static int ftpd_getpath(FAR struct ftpd_session_s *session,
 static int ftpd_changedir(FAR struct ftpd_session_s *session,
                           FAR const char *rempath);
 static off_t ftpd_offsatoi(FAR const char *filename, off_t offset);
+#ifdef CONFIG_FTPD_SENDFILE
+static off_t ftpd_sendbinary(FAR struct ftpd_session_s *session);
+#endif
+#if CONFIG_FTPD_XFRBUFFERSIZE > 0
+static off_t ftpd_recvbinary(FAR struct ftpd_session_s *session);
+#endif
+static void ftpd_xfrstats(FAR struct ftpd_session_s *session, int cmdtype,
+                          off_t nbytes, FAR const struct timespec *start);
+static off_t ftpd_xfrcopy(FAR struct ftpd_session_s *session, int cmdtype);
 static int ftpd_stream(FAR struct ftpd_session_s *session, int cmdtype);
 static uint8_t ftpd_listoption(FAR char **param);
 static int ftpd_listbuffer(FAR struct ftpd_session_s *session,
@@ -1779,159 +1794,208 @@ static off_t ftpd_offsatoi(FAR const char *filename, off_t offset)
 }
 
 /****************************************************************************
- * Name: ftpd_stream
+ * Name: ftpd_sendbinary
+ *
+ * Description:
+ *   Send the file from its current position to the data connection with
+ *   sendfile(), which does not copy the data through a user buffer.
+ *   Returns the number of bytes sent or a negated errno value.
+ *
  ****************************************************************************/
 
-static int ftpd_stream(FAR struct ftpd_session_s *session, int cmdtype)
+#ifdef CONFIG_FTPD_SENDFILE
+static off_t ftpd_sendbinary(FAR struct ftpd_session_s *session)
 {
-  FAR char *abspath;
-  FAR char *path;
-  bool isnew;
-  int oflags;
-  FAR char *buffer;
-  size_t buflen;
-  size_t wantsize;
-  ssize_t rdbytes;
-  ssize_t wrbytes;
-  int errval = 0;
+  off_t total = 0;
+  ssize_t nsent;
   int ret;
 
-  ret = ftpd_getpath(session, session->param, &abspath, NULL);
-  if (ret < 0)
-    {
-      ftpd_response(session->cmd.sd, session->txtimeout,
-                    g_respfmt1, 550, ' ', "Stream error !");
-      goto errout;
-    }
-
-  path = abspath;
+  /* Send until the end of the file, which may grow while it is sent */
 
-  ret = ftpd_dataopen(session);
-  if (ret < 0)
+  for (; ; )
     {
-      goto errout_with_path;
-    }
+      if (session->txtimeout >= 0)
+        {
+          ret = ftpd_txpoll(session->data.sd, session->txtimeout);
+          if (ret < 0)
+            {
+              nerr("ERROR: ftpd_txpoll failed: %d\n", ret);
+              goto errout;
+            }
+        }
 
-  switch (cmdtype)
-    {
-      case 0: /* retr */
-        oflags = O_RDONLY;
-        break;
+      nsent = sendfile(session->data.sd, session->fd, NULL,
+                       FTPD_SENDFILE_CHUNK);
+      if (nsent < 0)
+        {
+          ret = -errno;
+          if (ret == -EAGAIN || ret == -EINTR)
+            {
+              continue;
+            }
 
-      case 1: /* stor */
-        oflags = O_CREAT | O_WRONLY;
-         break;
+          nerr("ERROR: sendfile() failed: %d\n", ret);
+          goto errout;
+        }
 
-      case 2: /* appe */
-        oflags = O_CREAT | O_WRONLY | O_APPEND;
-        break;
+      if (nsent == 0)
+        {
+          return total;
+        }
 
-      default:
-        oflags = O_RDONLY;
-        break;
+      total += nsent;
     }
 
-#if defined(O_LARGEFILE)
-  oflags |= O_LARGEFILE;
+errout:
+  ftpd_response(session->cmd.sd, session->txtimeout,
+                g_respfmt1, 550, ' ', "Data send error !");
+  return ret;
+}
 #endif
 
-  /* Are we creating the file? */
-
-  if ((oflags & O_CREAT) != 0)
-    {
-      int mode = S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP | S_IROTH;
-
-      if (session->restartpos <= 0)
-        {
-          oflags |= O_TRUNC;
-        }
-
-      isnew = true;
-      session->fd = open(path, oflags | O_EXCL, mode);
-      if (session->fd < 0)
-        {
-          isnew = false;
-          session->fd = open(path, oflags, mode);
-        }
-    }
-  else
-    {
-      /* No.. we are opening an existing file */
+/****************************************************************************
+ * Name: ftpd_recvbinary
+ *
+ * Description:
+ *   Receive a binary upload into the transfer buffer, which is larger than
+ *   the data buffer and aligned, and write it to the file one full buffer
+ *   at a time.  Returns the number of bytes received or a negated errno
+ *   value.
+ *
+ ****************************************************************************/
 
-      isnew = false;
-      session->fd = open(path, oflags);
-    }
+#if CONFIG_FTPD_XFRBUFFERSIZE > 0
+static off_t ftpd_recvbinary(FAR struct ftpd_session_s *session)
+{
+  FAR char *buffer;
+  off_t total = 0;
+  size_t buflen;
+  ssize_t nbytes;
+  bool eof = false;
+  int ret;
 
-  if (session->fd < 0)
+  if (session->xfrbuffer == NULL &&
+      posix_memalign((FAR void **)&session->xfrbuffer,
+                     FTPD_XFRBUFFER_ALIGN,
+                     CONFIG_FTPD_XFRBUFFERSIZE) != 0)
     {
-      ret = -errno;
-      ftpd_response(session->cmd.sd, session->txtimeout,
-                    g_respfmt1, 550, ' ', "Can not open file !");
-      goto errout_with_data;
+      session->xfrbuffer = NULL;
+      ret = -ENOMEM;
+      goto errout_with_read;
     }
 
-  /* Restart position */
-
-  if (session->restartpos > 0)
+  while (!eof)
     {
-      off_t seekoffs = (off_t)-1;
-      off_t seekpos;
-
-      /* Get the seek position */
+      /* Fill the buffer unless the upload ends */
 
-      if (session->type == FTPD_SESSIONTYPE_A)
+      for (buflen = 0; buflen < CONFIG_FTPD_XFRBUFFERSIZE; buflen += nbytes)
         {
-          seekpos = ftpd_offsatoi(path, session->restartpos);
-          if (seekpos < 0)
+          nbytes = ftpd_recv(session->data.sd, session->xfrbuffer + buflen,
+                             CONFIG_FTPD_XFRBUFFERSIZE - buflen,
+                             session->rxtimeout);
+          if (nbytes < 0)
             {
-              nerr("ERROR: ftpd_offsatoi failed: %jd\n", (intmax_t)seekpos);
-              errval = -seekpos;
+              ret = nbytes;
+              goto errout_with_read;
             }
-        }
-      else
-        {
-          seekpos = session->restartpos;
-          if (seekpos < 0)
+
+          if (nbytes == 0)
             {
-              nerr("ERROR: Bad restartpos: %jd\n", (intmax_t)seekpos);
-              errval = EINVAL;
+              eof = true;
+              break;
             }
         }
 
-      /* Seek to the request position */
+      /* Then write it to the file */
 
-      if (seekpos >= 0)
+      for (buffer = session->xfrbuffer; buflen > 0; buflen -= nbytes)
         {
-          seekoffs = lseek(session->fd, seekpos, SEEK_SET);
-          if (seekoffs < 0)
+          nbytes = write(session->fd, buffer, buflen);
+          if (nbytes < 0)
             {
-              errval = errno;
-              nerr("ERROR: lseek failed: %d\n", errval);
+              ret = -errno;
+              nerr("ERROR: write() failed: %d\n", ret);
+              goto errout_with_write;
             }
-        }
-
-      /* Report errors.  If an error occurred, seekoffs will be negative and
-       * errval will hold the (positive) error code.
-       */
 
-      if (seekoffs < 0)
-        {
-          ftpd_response(session->cmd.sd, session->txtimeout,
-                        g_respfmt1, 550, ' ', "Can not seek file !");
-          ret = -errval;
-          goto errout_with_session;
+          buffer += nbytes;
+          total  += nbytes;
         }
     }
 
-  /* Send success message */
+  return total;
 
-  ret = ftpd_response(session->cmd.sd, session->txtimeout,
-                      g_respfmt1, 150, ' ', "Opening data connection");
-  if (ret < 0)
+errout_with_read:
+  nerr("ERROR: Read failed: %d\n", ret);
+  ftpd_response(session->cmd.sd, session->txtimeout,
+                g_respfmt1, 550, ' ', "Data read error !");
+  return ret;
+
+errout_with_write:
+  ftpd_response(session->cmd.sd, session->txtimeout,
+                g_respfmt1, 550, ' ', "Data send error !");
+  return ret;
+}
+#endif
+
+/****************************************************************************
+ * Name: ftpd_xfrstats
+ *
+ * Description:
+ *   Account a completed transfer and log its throughput.
+ *
+ ****************************************************************************/
+
+static void ftpd_xfrstats(FAR struct ftpd_session_s *session, int cmdtype,
+                          off_t nbytes, FAR const struct timespec *start)
+{
+#ifdef CONFIG_FTPD_XFRSTATS
+  struct timespec now;
+  uint32_t msec;
+#endif
+
+  session->nxfers++;
+  if (cmdtype == 0)
     {
-      nerr("ERROR: ftpd_response failed: %d\n", ret);
-      goto errout_with_session;
+      session->txbytes += nbytes;
     }
+  else
+    {
+      session->rxbytes += nbytes;
+    }
+
+#ifdef CONFIG_FTPD_XFRSTATS
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  msec = (now.tv_sec - start->tv_sec) * 1000 +
+         (now.tv_nsec - start->tv_nsec) / 1000000;
+
+  syslog(LOG_INFO, "ftpd: %s %s: %" PRIu64 " bytes in %" PRIu32
+         " ms, %" PRIu64 " KB/s\n",
+         cmdtype == 0 ? "RETR" : cmdtype == 1 ? "STOR" : "APPE",
+         session->param, (uint64_t)nbytes, msec,
+         (uint64_t)nbytes * 1000 / 1024 / (msec > 0 ? msec : 1));
+#endif
+}
+
+/****************************************************************************
+ * Name: ftpd_xfrcopy
+ *
+ * Description:
+ *   Copy between the file and the data connection through the data buffer,
+ *   converting line endings in ASCII mode.  Returns the number of bytes
+ *   read from the source or a negated errno value.
+ *
+ ****************************************************************************/
+
+static off_t ftpd_xfrcopy(FAR struct ftpd_session_s *session, int cmdtype)
+{
+  FAR char *buffer;
+  size_t buflen;
+  size_t wantsize;
+  ssize_t rdbytes;
+  ssize_t wrbytes;
+  off_t total = 0;
+  int errval = 0;
 
   for (; ; )
     {
@@ -1982,8 +2046,7 @@ static int ftpd_stream(FAR struct ftpd_session_s *session, int cmdtype)
                rdbytes, errval);
           ftpd_response(session->cmd.sd, session->txtimeout,
                         g_respfmt1, 550, ' ', "Data read error !");
-          ret = -errval;
-          break;
+          return -errval;
         }
 
       /* A value of rdbytes == 0 means that we have read the entire source
@@ -1994,13 +2057,7 @@ static int ftpd_stream(FAR struct ftpd_session_s *session, int cmdtype)
         {
           /* End-of-file */
 
-          ftpd_response(session->cmd.sd, session->txtimeout,
-                        g_respfmt1, 226, ' ', "Transfer complete");
-
-          /* Return success */
-
-          ret = 0;
-          break;
+          return total;
         }
 
       /* Write to the destination (file or TCP connection) */
@@ -2080,11 +2137,201 @@ static int ftpd_stream(FAR struct ftpd_session_s *session, int cmdtype)
                wrbytes, errval);
           ftpd_response(session->cmd.sd, session->txtimeout,
                         g_respfmt1, 550, ' ', "Data send error !");
+          return errval > 0 ? -errval : -EIO;
+        }
+
+      total += rdbytes;
+    }
+}
+
+/****************************************************************************
+ * Name: ftpd_stream
+ ****************************************************************************/
+
+static int ftpd_stream(FAR struct ftpd_session_s *session, int cmdtype)
+{
+  FAR char *abspath;
+  FAR char *path;
+  bool isnew;
+  int oflags;
+  struct timespec start;
+  off_t total;
+  int errval = 0;
+  int ret;
+
+  ret = ftpd_getpath(session, session->param, &abspath, NULL);
+  if (ret < 0)
+    {
+      ftpd_response(session->cmd.sd, session->txtimeout,
+                    g_respfmt1, 550, ' ', "Stream error !");
+      goto errout;
+    }
+
+  path = abspath;
+
+  ret = ftpd_dataopen(session);
+  if (ret < 0)
+    {
+      goto errout_with_path;
+    }
+
+  switch (cmdtype)
+    {
+      case 0: /* retr */
+        oflags = O_RDONLY;
+        break;
+
+      case 1: /* stor */
+        oflags = O_CREAT | O_WRONLY;
+         break;
+
+      case 2: /* appe */
+        oflags = O_CREAT | O_WRONLY | O_APPEND;
+        break;
+
+      default:
+        oflags = O_RDONLY;
+        break;
+    }
+
+#if defined(O_LARGEFILE)
+  oflags |= O_LARGEFILE;
+#endif
+
+  /* Are we creating the file? */
+
+  if ((oflags & O_CREAT) != 0)
+    {
+      int mode = S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP | S_IROTH;
+
+      /* STOR replaces the file unless it resumes an upload */
+
+      if (cmdtype == 1 && session->restartpos <= 0)
+        {
+          oflags |= O_TRUNC;
+        }
+
+      isnew = true;
+      session->fd = open(path, oflags | O_EXCL, mode);
+      if (session->fd < 0)
+        {
+          isnew = false;
+          session->fd = open(path, oflags, mode);
+        }
+    }
+  else
+    {
+      /* No.. we are opening an existing file */
+
+      isnew = false;
+      session->fd = open(path, oflags);
+    }
+
+  if (session->fd < 0)
+    {
+      ret = -errno;
+      ftpd_response(session->cmd.sd, session->txtimeout,
+                    g_respfmt1, 550, ' ', "Can not open file !");
+      goto errout_with_data;
+    }
+
+  /* Restart position */
+
+  if (session->restartpos > 0)
+    {
+      off_t seekoffs = (off_t)-1;
+      off_t seekpos;
+
+      /* Get the seek position */
+
+      if (session->type == FTPD_SESSIONTYPE_A)
+        {
+          seekpos = ftpd_offsatoi(path, session->restartpos);
+          if (seekpos < 0)
+            {
+              nerr("ERROR: ftpd_offsatoi failed: %jd\n", (intmax_t)seekpos);
+              errval = -seekpos;
+            }
+        }
+      else
+        {
+          seekpos = session->restartpos;
+          if (seekpos < 0)
+            {
+              nerr("ERROR: Bad restartpos: %jd\n", (intmax_t)seekpos);
+              errval = EINVAL;
+            }
+        }
+
+      /* Seek to the request position */
+
+      if (seekpos >= 0)
+        {
+          seekoffs = lseek(session->fd, seekpos, SEEK_SET);
+          if (seekoffs < 0)
+            {
+              errval = errno;
+              nerr("ERROR: lseek failed: %d\n", errval);
+            }
+        }
+
+      /* Report errors.  If an error occurred, seekoffs will be negative and
+       * errval will hold the (positive) error code.
+       */
+
+      if (seekoffs < 0)
+        {
+          ftpd_response(session->cmd.sd, session->txtimeout,
+                        g_respfmt1, 550, ' ', "Can not seek file !");
           ret = -errval;
-          break;
+          goto errout_with_session;
         }
     }
 
+  /* Send success message */
+
+  ret = ftpd_response(session->cmd.sd, session->txtimeout,
+                      g_respfmt1, 150, ' ', "Opening data connection");
+  if (ret < 0)
+    {
+      nerr("ERROR: ftpd_response failed: %d\n", ret);
+      goto errout_with_session;
+    }
+
+  clock_gettime(CLOCK_MONOTONIC, &start);
+
+  /* Binary transfers bypass the data buffer */
+
+#ifdef CONFIG_FTPD_SENDFILE
+  if (cmdtype == 0 && session->type != FTPD_SESSIONTYPE_A)
+    {
+      total = ftpd_sendbinary(session);
+    }
+  else
+#endif
+#if CONFIG_FTPD_XFRBUFFERSIZE > 0
+  if (cmdtype != 0 && session->type != FTPD_SESSIONTYPE_A)
+    {
+      total = ftpd_recvbinary(session);
+    }
+  else
+#endif
+    {
+      total = ftpd_xfrcopy(session, cmdtype);
+    }
+
+  if (total < 0)
+    {
+      ret = (int)total;
+    }
+  else
+    {
+      ftpd_response(session->cmd.sd, session->txtimeout,
+                    g_respfmt1, 226, ' ', "Transfer complete");
+      ftpd_xfrstats(session, cmdtype, total, &start);
+      ret = 0;
+    }
+
 errout_with_session:;
     close(session->fd);
     session->fd = -1;
@@ -2101,6 +2348,10 @@ errout_with_path:
     free(abspath);
 
 errout:
+    /* The restart position only applies to one transfer */
+
+    session->restartpos = 0;
+    session->flags &= ~FTPD_SESSIONFLAG_RESTARTPOS;
     return ret;
 }
 
@@ -3768,11 +4019,21 @@ static int ftpd_command_appe(FAR struct ftpd_session_s *session)
 
 static int ftpd_command_rest(FAR struct ftpd_session_s *session)
 {
-  session->restartpos = (off_t)atoll(session->param);
+  FAR char *endptr;
+  long long pos;
+
+  pos = strtoll(session->param, &endptr, 10);
+  if (endptr == session->param || *endptr != '\0' || pos < 0)
+    {
+      return ftpd_response(session->cmd.sd, session->txtimeout,
+                           g_respfmt1, 501, ' ', "Invalid restart position");
+    }
+
+  session->restartpos = (off_t)pos;
   session->flags |= FTPD_SESSIONFLAG_RESTARTPOS;
 
   return ftpd_response(session->cmd.sd, session->txtimeout,
-                       g_respfmt1, 320, ' ', "Restart position ready");
+                       "%03u%cRestarting at %lld\r\n", 350, ' ', pos);
 }
 
 /****************************************************************************
@@ -4098,6 +4359,11 @@ static void ftpd_freesession(FAR struct ftpd_session_s *session)
       free(session->data.buffer);
     }
 
+  if (session->xfrbuffer != NULL)
+    {
+      free(session->xfrbuffer);
+    }
+
   ftpd_dataclose(session);
 
   if (session->cmd.buffer != NULL)
@@ -4269,6 +4535,15 @@ static FAR void *ftpd_worker(FAR void *arg)
         }
     }
 
+#ifdef CONFIG_FTPD_XFRSTATS
+  if (session->nxfers > 0)
+    {
+      syslog(LOG_INFO, "ftpd: session closed: %" PRIu32 " transfers, "
+             "%" PRIu64 " bytes sent, %" PRIu64 " bytes received\n",
+             session->nxfers, session->txbytes, session->rxbytes);
+    }
+#endif
+
   ftpd_freesession(session);
   return NULL;
 }
@@ -4437,6 +4712,7 @@ int ftpd_session(FTPD_SESSION handle, int timeout)
   session->data.buflen  = CONFIG_FTPD_DATABUFFERSIZE;
   session->data.buffer  = NULL;
   session->restartpos   = 0;
+  session->xfrbuffer    = NULL;
   session->fd           = -1;
   session->user         = NULL;
   session->type         = FTPD_SESSIONTYPE_NONE;
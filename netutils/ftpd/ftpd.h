@@ -52,6 +52,9 @@
 
 #define FTPD_CMDFLAG_LOGIN          (1 << 0)  /* Command requires login */
 
+#define FTPD_SENDFILE_CHUNK         32768     /* Max. bytes per sendfile() */
+#define FTPD_XFRBUFFER_ALIGN        64        /* Upload buffer alignment */
+
 /****************************************************************************
  * Public Types
  ****************************************************************************/
@@ -137,6 +140,13 @@ struct ftpd_session_s
 
   struct ftpd_stream_s       data;
   off_t                      restartpos;
+  FAR char                  *xfrbuffer; /* Buffer of binary uploads */
+
+  /* Transfer statistics */
+
+  uint32_t                   nxfers;  /* Number of completed transfers */
+  uint64_t                   txbytes; /* Bytes sent to the client */
+  uint64_t                   rxbytes; /* Bytes received from the client */
 
   /* File */
 
@@ -26,12 +26,16 @@
 
 #include <arpa/inet.h>
 #include <assert.h>
+#include <errno.h>
+#include <inttypes.h>
 #include <net/if.h>
 #include <netinet/in.h>
 #include <netpacket/rpmsg.h>
 #include <pthread.h>
 #include <sched.h>
+#include <semaphore.h>
 #include <stdbool.h>
+#include <sys/param.h>
 #include <sys/prctl.h>
 #include <sys/socket.h>
 #include <sys/time.h>
@@ -47,6 +51,9 @@
 #define IPERF_TRAFFIC_TASK_NAME      "iperf_traffic"
 #define IPERF_TRAFFIC_TASK_PRIORITY  100
 #define IPERF_TRAFFIC_TASK_STACK     4096
+#define IPERF_STREAM_TASK_NAME       "iperf_stream"
+#define IPERF_STREAM_TASK_PRIORITY   100
+#define IPERF_STREAM_TASK_STACK      4096
 #define IPERF_REPORT_TASK_NAME       "iperf_report"
 #define IPERF_REPORT_TASK_PRIORITY   101
 #define IPERF_REPORT_TASK_STACK      4096
@@ -63,15 +70,38 @@
  * Private Types
  ****************************************************************************/
 
+struct iperf_ctrl_t;
+
+/* One direction of one connection.  In bidirectional mode, a send and a
+ * receive stream share the socket.
+ */
+
+struct iperf_stream_t
+{
+  FAR struct iperf_ctrl_t *ctrl;
+  pthread_t thread;
+  bool running;
+  int id;
+  int sockfd;
+  bool closefd;     /* This stream owns the socket */
+  bool tx;
+  uintmax_t total_len;
+  uintmax_t last_len;
+  uint32_t buffer_len;
+  FAR uint8_t *buffer;
+};
+
 struct iperf_ctrl_t
 {
   FAR struct iperf_ctrl_t *flink;
   struct iperf_cfg_t cfg;
   bool finish;
-  uintmax_t total_len;
-  uint32_t buffer_len;
-  FAR uint8_t *buffer;
-  uint32_t sockfd;
+  bool quiet;       /* No reports, for the loopback server */
+  FAR sem_t *ready; /* Posted once a server accepts connections */
+  pthread_t report;
+  bool reporting;
+  int nstreams;
+  FAR struct iperf_stream_t *streams;
 };
 
 struct iperf_udp_pkt_t
@@ -113,7 +143,8 @@ static int iperf_run_udp_server(FAR struct iperf_ctrl_t *ctrl);
 static int iperf_run_udp_client(FAR struct iperf_ctrl_t *ctrl);
 static int iperf_run_tcp_client(FAR struct iperf_ctrl_t *ctrl);
 static void iperf_task_traffic(FAR void *arg);
-static uint32_t iperf_get_buffer_len(FAR struct iperf_ctrl_t *ctrl);
+static uint32_t iperf_get_buffer_len(FAR struct iperf_ctrl_t *ctrl,
+                                     bool tx);
 
 /****************************************************************************
  * Private Functions
@@ -277,6 +308,81 @@ static double ts_diff(const struct timespec *a, const struct timespec *b)
   return ts_sec(a) - ts_sec(b);
 }
 
+/****************************************************************************
+ * Name: iperf_report_line
+ *
+ * Description:
+ *   Print one line of a report
+ *
+ ****************************************************************************/
+
+static void iperf_report_line(FAR const char *label,
+                              FAR const struct timespec *from,
+                              FAR const struct timespec *to,
+                              FAR const struct timespec *start,
+                              uintmax_t len)
+{
+  printf("%s%7.2lf-%7.2lf sec %10ju Bytes %7.2f Mbits/sec\n",
+         label, ts_diff(from, start), ts_diff(to, start), len,
+         ((len * 8) / 1000000.0) / ts_diff(to, from));
+}
+
+/****************************************************************************
+ * Name: iperf_report_streams
+ *
+ * Description:
+ *   Report the data moved between two points in time.  A single stream
+ *   is reported as such, otherwise each stream is reported followed by
+ *   the sum of each direction.
+ *
+ ****************************************************************************/
+
+static void iperf_report_streams(FAR struct iperf_ctrl_t *ctrl,
+                                 FAR const struct timespec *from,
+                                 FAR const struct timespec *to,
+                                 FAR const struct timespec *start,
+                                 bool final)
+{
+  FAR struct iperf_stream_t *stream;
+  uintmax_t sum[2];
+  bool dir[2];
+  char label[16];
+  uintmax_t len;
+  uintmax_t now;
+  int i;
+
+  sum[0] = sum[1] = 0;
+  dir[0] = dir[1] = false;
+
+  for (i = 0; i < ctrl->nstreams; i++)
+    {
+      stream = &ctrl->streams[i];
+      now = stream->total_len;
+      len = final ? now : now - stream->last_len;
+      stream->last_len = now;
+
+      sum[stream->tx] += len;
+      dir[stream->tx] = true;
+
+      if (ctrl->nstreams > 1)
+        {
+          snprintf(label, sizeof(label), "[%3d] %s ", stream->id,
+                   stream->tx ? "TX" : "RX");
+          iperf_report_line(label, from, to, start, len);
+        }
+    }
+
+  for (i = 1; i >= 0; i--)
+    {
+      if (dir[i])
+        {
+          snprintf(label, sizeof(label), "[SUM] %s ", i ? "TX" : "RX");
+          iperf_report_line(ctrl->nstreams > 1 ? label : "",
+                            from, to, start, sum[i]);
+        }
+    }
+}
+
 /****************************************************************************
  * Name: iperf_report_task
  *
@@ -292,12 +398,10 @@ static void iperf_report_task(FAR void *arg)
   uint32_t time = ctrl->cfg.time;
   struct timespec now;
   struct timespec start;
-  uintmax_t now_len;
   int ret;
 
   prctl(PR_SET_NAME, IPERF_REPORT_TASK_NAME);
 
-  now_len = ctrl->total_len;
   ret = clock_gettime(CLOCK_MONOTONIC, &now);
   if (ret != 0)
     {
@@ -309,13 +413,10 @@ static void iperf_report_task(FAR void *arg)
   printf("\n%19s %16s %18s\n", "Interval", "Transfer", "Bandwidth\n");
   while (!ctrl->finish)
     {
-      uintmax_t last_len;
       struct timespec last;
 
       sleep(interval);
-      last_len = now_len;
       last = now;
-      now_len = ctrl->total_len;
       ret = clock_gettime(CLOCK_MONOTONIC, &now);
       if (ret != 0)
         {
@@ -323,13 +424,7 @@ static void iperf_report_task(FAR void *arg)
           exit(EXIT_FAILURE);
         }
 
-      printf("%7.2lf-%7.2lf sec %10ju Bytes %7.2f Mbits/sec\n",
-             ts_diff(&last, &start),
-             ts_diff(&now, &start),
-             now_len -last_len,
-             (((now_len - last_len) * 8) / 1000000.0) /
-             ts_diff(&now, &last)
-             );
+      iperf_report_streams(ctrl, &last, &now, &start, false);
       if (time != 0 && ts_diff(&now, &start) >= time)
         {
           break;
@@ -338,13 +433,7 @@ static void iperf_report_task(FAR void *arg)
 
   if (ts_diff(&now, &start) > 0)
     {
-      printf("%7.2lf-%7.2lf sec %10ju Bytes %7.2f Mbits/sec\n",
-             ts_diff(&start, &start),
-             ts_diff(&now, &start),
-             now_len,
-             ((now_len * 8) / 1000000.0) /
-             ts_diff(&now, &start)
-             );
+      iperf_report_streams(ctrl, &start, &now, &start, true);
     }
 
   ctrl->finish = true;
@@ -364,15 +453,19 @@ static int iperf_start_report(FAR struct iperf_ctrl_t *ctrl)
 {
   struct sched_param param;
   pthread_attr_t attr;
-  pthread_t thread;
   int ret;
 
+  if (ctrl->quiet || ctrl->reporting)
+    {
+      return 0;
+    }
+
   pthread_attr_init(&attr);
   param.sched_priority = IPERF_REPORT_TASK_PRIORITY;
   pthread_attr_setschedparam(&attr, &param);
   pthread_attr_setstacksize(&attr, IPERF_REPORT_TASK_STACK);
 
-  ret = pthread_create(&thread, &attr, (FAR void *)iperf_report_task,
+  ret = pthread_create(&ctrl->report, &attr, (FAR void *)iperf_report_task,
                        ctrl);
   if (ret != 0)
     {
@@ -381,11 +474,324 @@ static int iperf_start_report(FAR struct iperf_ctrl_t *ctrl)
       return -1;
     }
 
-  pthread_detach(thread);
+  /* The report task is joined by iperf_start(), since it reads the
+   * streams until it exits.
+   */
+
+  ctrl->reporting = true;
+
+  return 0;
+}
+
+/****************************************************************************
+ * Name: iperf_server_ready
+ *
+ * Description:
+ *   Tell a waiting loopback client that the server accepts connections
+ *
+ ****************************************************************************/
+
+static void iperf_server_ready(FAR struct iperf_ctrl_t *ctrl)
+{
+  if (ctrl->ready != NULL)
+    {
+      sem_post(ctrl->ready);
+      ctrl->ready = NULL;
+    }
+}
+
+/****************************************************************************
+ * Name: iperf_add_stream
+ *
+ * Description:
+ *   Add a stream on a connected socket.  The first stream added on a
+ *   socket closes it.
+ *
+ ****************************************************************************/
+
+static int iperf_add_stream(FAR struct iperf_ctrl_t *ctrl, int id,
+                            int sockfd, bool closefd, bool tx)
+{
+  FAR struct iperf_stream_t *stream = &ctrl->streams[ctrl->nstreams];
+
+  memset(stream, 0, sizeof(*stream));
+  stream->ctrl = ctrl;
+  stream->id = id;
+  stream->sockfd = sockfd;
+  stream->closefd = closefd;
+  stream->tx = tx;
+  stream->buffer_len = iperf_get_buffer_len(ctrl, tx);
+  stream->buffer = (FAR uint8_t *)malloc(stream->buffer_len);
+  if (stream->buffer == NULL)
+    {
+      printf("create buffer: not enough memory\n");
+      return -1;
+    }
+
+  memset(stream->buffer, 0, stream->buffer_len);
 
+  ctrl->nstreams++;
   return 0;
 }
 
+/****************************************************************************
+ * Name: iperf_add_connection
+ *
+ * Description:
+ *   Add the streams of a connected socket.  In bidirectional mode both
+ *   ends send and receive, otherwise the client sends unless the test is
+ *   reversed.  On failure, the socket is closed.
+ *
+ ****************************************************************************/
+
+static int iperf_add_connection(FAR struct iperf_ctrl_t *ctrl, int id,
+                                int sockfd)
+{
+  bool tx = ((ctrl->cfg.flag & IPERF_FLAG_CLIENT) != 0) ^
+            ((ctrl->cfg.flag & IPERF_FLAG_REVERSE) != 0);
+
+  bool bidir = (ctrl->cfg.flag & IPERF_FLAG_BIDIR) != 0;
+  struct timeval t;
+
+  if (bidir || !tx)
+    {
+      t.tv_sec = IPERF_SOCKET_RX_TIMEOUT;
+      t.tv_usec = 0;
+      setsockopt(sockfd, SOL_SOCKET, SO_RCVTIMEO, &t, sizeof(t));
+    }
+
+  if (iperf_add_stream(ctrl, id, sockfd, true, bidir || tx) < 0)
+    {
+      close(sockfd);
+      return -1;
+    }
+
+  if (bidir)
+    {
+      /* The socket is closed with the send stream if this fails */
+
+      return iperf_add_stream(ctrl, id, sockfd, false, false);
+    }
+
+  return 0;
+}
+
+/****************************************************************************
+ * Name: iperf_stream_cpu
+ *
+ * Description:
+ *   Return the CPU a stream is pinned to, or -1.  The streams are spread
+ *   round-robin over the CPUs in the affinity mask.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_SMP
+static int iperf_stream_cpu(FAR struct iperf_ctrl_t *ctrl, int index)
+{
+  uint32_t mask = ctrl->cfg.affinity;
+  int ncpus = 0;
+  int cpu;
+
+  if (CONFIG_SMP_NCPUS < 32)
+    {
+      mask &= (1u << CONFIG_SMP_NCPUS) - 1;
+    }
+
+  for (cpu = 0; cpu < 32; cpu++)
+    {
+      ncpus += (mask >> cpu) & 1;
+    }
+
+  if (ncpus == 0)
+    {
+      return -1;
+    }
+
+  index %= ncpus;
+  for (cpu = 0; ; cpu++)
+    {
+      if (((mask >> cpu) & 1) && index-- == 0)
+        {
+          return cpu;
+        }
+    }
+}
+#endif
+
+/****************************************************************************
+ * Name: iperf_run_streams
+ *
+ * Description:
+ *   Run all streams in their own threads and wait for them to finish.
+ *
+ ****************************************************************************/
+
+static int iperf_run_streams(FAR struct iperf_ctrl_t *ctrl,
+                             CODE void (*task)(FAR void *arg))
+{
+  FAR struct iperf_stream_t *stream;
+  struct sched_param param;
+  pthread_attr_t attr;
+#ifdef CONFIG_SMP
+  cpu_set_t cpuset;
+  int cpu;
+#endif
+  int ret = 0;
+  int i;
+
+  for (i = 0; i < ctrl->nstreams; i++)
+    {
+      stream = &ctrl->streams[i];
+
+      pthread_attr_init(&attr);
+      param.sched_priority = IPERF_STREAM_TASK_PRIORITY;
+      pthread_attr_setschedparam(&attr, &param);
+      pthread_attr_setstacksize(&attr, IPERF_STREAM_TASK_STACK);
+
+#ifdef CONFIG_SMP
+      cpu = iperf_stream_cpu(ctrl, i);
+      if (cpu >= 0)
+        {
+          CPU_ZERO(&cpuset);
+          CPU_SET(cpu, &cpuset);
+          pthread_attr_setaffinity_np(&attr, sizeof(cpu_set_t), &cpuset);
+        }
+#endif
+
+      ret = pthread_create(&stream->thread, &attr, (FAR void *)task,
+                           stream);
+      pthread_attr_destroy(&attr);
+      if (ret != 0)
+        {
+          printf("iperf_thread: pthread_create failed: %d, %s\n",
+                 ret, IPERF_STREAM_TASK_NAME);
+          ctrl->finish = true;
+          ret = -1;
+          break;
+        }
+
+      stream->running = true;
+    }
+
+  for (i = 0; i < ctrl->nstreams; i++)
+    {
+      stream = &ctrl->streams[i];
+      if (stream->running)
+        {
+          pthread_join(stream->thread, NULL);
+          stream->running = false;
+        }
+    }
+
+  return ret;
+}
+
+/****************************************************************************
+ * Name: iperf_close_streams
+ *
+ * Description:
+ *   Close the sockets and free the buffers of all streams.  The byte
+ *   counts are kept for the final report.
+ *
+ ****************************************************************************/
+
+static void iperf_close_streams(FAR struct iperf_ctrl_t *ctrl)
+{
+  FAR struct iperf_stream_t *stream;
+  int i;
+
+  for (i = 0; i < ctrl->nstreams; i++)
+    {
+      stream = &ctrl->streams[i];
+      if (stream->closefd)
+        {
+          close(stream->sockfd);
+          stream->closefd = false;
+        }
+
+      free(stream->buffer);
+      stream->buffer = NULL;
+    }
+}
+
+/****************************************************************************
+ * Name: iperf_end_stream
+ *
+ * Description:
+ *   Called when a stream stops.  Any stream stopping ends the test, and
+ *   shutting down the socket wakes a receiver sharing it.
+ *
+ ****************************************************************************/
+
+static void iperf_end_stream(FAR struct iperf_stream_t *stream)
+{
+  stream->ctrl->finish = true;
+  if (stream->ctrl->cfg.flag & IPERF_FLAG_TCP)
+    {
+      shutdown(stream->sockfd, SHUT_RDWR);
+    }
+}
+
+/****************************************************************************
+ * Name: iperf_tcp_stream
+ *
+ * Description:
+ *   Move data over one tcp stream
+ *
+ ****************************************************************************/
+
+static void iperf_tcp_stream(FAR void *arg)
+{
+  FAR struct iperf_stream_t *stream = arg;
+  FAR struct iperf_ctrl_t *ctrl = stream->ctrl;
+  ssize_t actual;
+
+  prctl(PR_SET_NAME, IPERF_STREAM_TASK_NAME);
+
+  while (!ctrl->finish)
+    {
+      if (stream->tx)
+        {
+          actual = send(stream->sockfd, stream->buffer,
+                        stream->buffer_len, MSG_NOSIGNAL);
+        }
+      else
+        {
+          actual = recv(stream->sockfd, stream->buffer,
+                        stream->buffer_len, 0);
+        }
+
+      if ((actual == 0 && !stream->tx) ||
+          (actual < 0 && (errno == EPIPE || errno == ECONNRESET)))
+        {
+          if (!ctrl->finish && !ctrl->quiet)
+            {
+              printf("[%3d] closed by the peer\n", stream->id);
+            }
+
+          break;
+        }
+      else if (actual <= 0)
+        {
+          if (!ctrl->finish && !ctrl->quiet)
+            {
+              iperf_show_socket_error_reason(stream->tx ?
+                                             "tcp send" : "tcp recv",
+                                             stream->sockfd);
+            }
+
+          break;
+        }
+      else
+        {
+          stream->total_len += actual;
+        }
+    }
+
+  iperf_end_stream(stream);
+  pthread_exit(NULL);
+}
+
 /****************************************************************************
  * Name: iperf_run_server
  *
@@ -488,13 +894,12 @@ static int iperf_tcp_server(FAR struct iperf_ctrl_t *ctrl,
                             FAR struct sockaddr *addr, socklen_t addrlen,
                             FAR struct sockaddr *remote_addr)
 {
-  int actual_recv = 0;
-  int want_recv = 0;
-  FAR uint8_t *buffer;
+  socklen_t remote_len;
   int listen_socket;
-  struct timeval t;
   int sockfd;
-  int opt;
+  int opt = 1;
+  int ret = 0;
+  int i;
 
   listen_socket = socket(addr->sa_family, SOCK_STREAM, IPPROTO_TCP);
   if (listen_socket < 0)
@@ -511,70 +916,66 @@ static int iperf_tcp_server(FAR struct iperf_ctrl_t *ctrl,
       return -1;
     }
 
-  if (listen(listen_socket, 5) < 0)
+  if (listen(listen_socket, MAX(5, ctrl->cfg.nstreams)) < 0)
     {
       iperf_show_socket_error_reason("tcp server listen", listen_socket);
       close(listen_socket);
       return -1;
     }
 
-  buffer = ctrl->buffer;
-  want_recv = ctrl->buffer_len;
-  while (!ctrl->finish)
+  iperf_server_ready(ctrl);
+
+  /* Wait for all parallel connections before starting the test.
+   * Note: unlike the original iperf, this implementation exits after
+   * finishing a single test.
+   */
+
+  for (i = 0; i < ctrl->cfg.nstreams && !ctrl->finish; i++)
     {
       /* TODO need to change to non-block mode */
 
-      sockfd = accept4(listen_socket, remote_addr, &addrlen, SOCK_CLOEXEC);
+      remote_len = addrlen;
+      sockfd = accept4(listen_socket, remote_addr, &remote_len,
+                       SOCK_CLOEXEC);
       if (sockfd < 0)
         {
           iperf_show_socket_error_reason("tcp server listen", listen_socket);
-          close(listen_socket);
-          return -1;
+          ret = -1;
+          goto out;
         }
-      else
+
+      if (ctrl->finish)
         {
-          iperf_print_addr("accept", remote_addr);
-          iperf_start_report(ctrl);
+          /* Woken up by iperf_start_loopback() */
 
-          t.tv_sec = IPERF_SOCKET_RX_TIMEOUT;
-          t.tv_usec = 0;
-          setsockopt(sockfd, SOL_SOCKET, SO_RCVTIMEO, &t, sizeof(t));
+          close(sockfd);
+          goto out;
         }
 
-      while (!ctrl->finish)
+      if (!ctrl->quiet)
         {
-          actual_recv = recv(sockfd, buffer, want_recv, 0);
-          if (actual_recv == 0)
-            {
-              iperf_print_addr("closed by the peer", remote_addr);
-
-              /* Note: unlike the original iperf, this implementation
-               * exits after finishing a single connection.
-               */
+          iperf_print_addr("accept", remote_addr);
+        }
 
-              ctrl->finish = true;
-              break;
-            }
-          else if (actual_recv < 0)
-            {
-              iperf_show_socket_error_reason("tcp server recv",
-                                             listen_socket);
-              ctrl->finish = true;
-              break;
-            }
-          else
-            {
-              ctrl->total_len += actual_recv;
-            }
+      if (iperf_add_connection(ctrl, i + 1, sockfd) < 0)
+        {
+          ret = -1;
+          goto out;
         }
+    }
 
-      close(sockfd);
+  if (!ctrl->finish)
+    {
+      iperf_start_report(ctrl);
+      ret = iperf_run_streams(ctrl, iperf_tcp_stream);
     }
 
+out:
   ctrl->finish = true;
+  iperf_close_streams(ctrl);
   close(listen_socket);
 
-  return 0;
+  return ret;
 }
 
 /****************************************************************************
@@ -590,11 +991,68 @@ static int iperf_run_tcp_server(FAR struct iperf_ctrl_t *ctrl)
   return iperf_run_server(ctrl, iperf_tcp_server);
 }
 
+/****************************************************************************
+ * Name: iperf_udp_rx_stream
+ *
+ * Description:
+ *   Receive data on the udp server socket.  The report starts with the
+ *   first datagram.
+ *
+ ****************************************************************************/
+
+static void iperf_udp_rx_stream(FAR void *arg)
+{
+  FAR struct iperf_stream_t *stream = arg;
+  FAR struct iperf_ctrl_t *ctrl = stream->ctrl;
+  struct sockaddr_storage remote_addr;
+  bool udp_recv_start = true;
+  socklen_t addrlen;
+  int actual_recv;
+
+  prctl(PR_SET_NAME, IPERF_STREAM_TASK_NAME);
+
+  while (!ctrl->finish)
+    {
+      addrlen = sizeof(remote_addr);
+      actual_recv = recvfrom(stream->sockfd, stream->buffer,
+                             stream->buffer_len, 0,
+                             (FAR struct sockaddr *)&remote_addr, &addrlen);
+      if (actual_recv < 0)
+        {
+          if (!ctrl->finish)
+            {
+              iperf_show_socket_error_reason("udp server recv",
+                                             stream->sockfd);
+            }
+        }
+      else
+        {
+          if (udp_recv_start == true)
+            {
+              if (!ctrl->quiet)
+                {
+                  iperf_print_addr("accept",
+                                   (FAR struct sockaddr *)&remote_addr);
+                }
+
+              iperf_start_report(ctrl);
+              udp_recv_start = false;
+            }
+
+          stream->total_len += actual_recv;
+        }
+    }
+
+  iperf_end_stream(stream);
+  pthread_exit(NULL);
+}
+
 /****************************************************************************
  * Name: iperf_udp_server
  *
  * Description:
- *   The main udp server logic
+ *   The main udp server logic.  Datagrams of all parallel client streams
+ *   arrive on the one server socket.
  *
  ****************************************************************************/
 
@@ -602,13 +1060,10 @@ static int iperf_udp_server(FAR struct iperf_ctrl_t *ctrl,
                             FAR struct sockaddr *addr, socklen_t addrlen,
                             FAR struct sockaddr *remote_addr)
 {
-  int actual_recv = 0;
   struct timeval t;
-  int want_recv = 0;
-  FAR uint8_t *buffer;
   int sockfd;
-  int opt;
-  bool udp_recv_start = true;
+  int opt = 1;
+  int ret;
 
   sockfd = socket(addr->sa_family, SOCK_DGRAM, IPPROTO_UDP);
   if (sockfd < 0)
@@ -622,42 +1077,29 @@ static int iperf_udp_server(FAR struct iperf_ctrl_t *ctrl,
   if (bind(sockfd, addr, addrlen) != 0)
     {
       iperf_show_socket_error_reason("udp server bind", sockfd);
+      close(sockfd);
       return -1;
     }
 
-  buffer = ctrl->buffer;
-  want_recv = ctrl->buffer_len;
-  printf("want recv=%d\n", want_recv);
-
   t.tv_sec = IPERF_SOCKET_RX_TIMEOUT;
   t.tv_usec = 0;
   setsockopt(sockfd, SOL_SOCKET, SO_RCVTIMEO, &t, sizeof(t));
 
-  while (!ctrl->finish)
+  if (iperf_add_stream(ctrl, 1, sockfd, true, false) < 0)
     {
-      actual_recv = recvfrom(sockfd, buffer, want_recv, 0,
-                             remote_addr, &addrlen);
-      if (actual_recv < 0)
-        {
-          iperf_show_socket_error_reason("udp server recv", sockfd);
-        }
-      else
-        {
-          if (udp_recv_start == true)
-            {
-              iperf_print_addr("accept", remote_addr);
-              iperf_start_report(ctrl);
-              udp_recv_start = false;
-            }
-
-          ctrl->total_len += actual_recv;
-        }
+      close(sockfd);
+      return -1;
     }
 
+  printf("want recv=%" PRIu32 "\n", ctrl->streams[0].buffer_len);
+
+  iperf_server_ready(ctrl);
+  ret = iperf_run_streams(ctrl, iperf_udp_rx_stream);
+
   ctrl->finish = true;
-  close(sockfd);
+  iperf_close_streams(ctrl);
 
-  return 0;
+  return ret;
 }
 
 /****************************************************************************
@@ -674,40 +1116,31 @@ static int iperf_run_udp_server(FAR struct iperf_ctrl_t *ctrl)
 }
 
 /****************************************************************************
- * Name: iperf_udp_client
+ * Name: iperf_udp_tx_stream
  *
  * Description:
- *   The main udp client logic
+ *   Send datagrams on one connected udp client socket
  *
  ****************************************************************************/
 
-static int iperf_udp_client(FAR struct iperf_ctrl_t *ctrl,
-                            FAR struct sockaddr *addr, socklen_t addrlen)
+static void iperf_udp_tx_stream(FAR void *arg)
 {
+  FAR struct iperf_stream_t *stream = arg;
+  FAR struct iperf_ctrl_t *ctrl = stream->ctrl;
   FAR struct iperf_udp_pkt_t *udp;
   int actual_send = 0;
   bool retry = false;
   uint32_t delay = 1;
   int want_send = 0;
   uint8_t *buffer;
-  int sockfd;
-  int opt;
   int err;
   int id;
 
-  sockfd = socket(addr->sa_family, SOCK_DGRAM, IPPROTO_UDP);
-  if (sockfd < 0)
-    {
-      iperf_show_socket_error_reason("udp client create", sockfd);
-      return -1;
-    }
-
-  setsockopt(sockfd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+  prctl(PR_SET_NAME, IPERF_STREAM_TASK_NAME);
 
-  iperf_start_report(ctrl);
-  buffer = ctrl->buffer;
+  buffer = stream->buffer;
   udp = (FAR struct iperf_udp_pkt_t *)buffer;
-  want_send = ctrl->buffer_len;
+  want_send = stream->buffer_len;
   id = 0;
 
   while (!ctrl->finish)
@@ -720,11 +1153,11 @@ static int iperf_udp_client(FAR struct iperf_ctrl_t *ctrl,
         }
 
       retry = false;
-      actual_send = sendto(sockfd, buffer, want_send, 0, addr, addrlen);
+      actual_send = send(stream->sockfd, buffer, want_send, 0);
 
       if (actual_send != want_send)
         {
-          err = iperf_get_socket_error_code(sockfd);
+          err = iperf_get_socket_error_code(stream->sockfd);
           if (err == ENOMEM)
             {
               usleep(delay * 10000);
@@ -744,14 +1177,67 @@ static int iperf_udp_client(FAR struct iperf_ctrl_t *ctrl,
         }
       else
         {
-          ctrl->total_len += actual_send;
+          stream->total_len += actual_send;
+        }
+    }
+
+  iperf_end_stream(stream);
+  pthread_exit(NULL);
+}
+
+/****************************************************************************
+ * Name: iperf_udp_client
+ *
+ * Description:
+ *   The main udp client logic
+ *
+ ****************************************************************************/
+
+static int iperf_udp_client(FAR struct iperf_ctrl_t *ctrl,
+                            FAR struct sockaddr *addr, socklen_t addrlen)
+{
+  int sockfd;
+  int opt = 1;
+  int ret = -1;
+  int i;
+
+  for (i = 0; i < ctrl->cfg.nstreams; i++)
+    {
+      sockfd = socket(addr->sa_family, SOCK_DGRAM, IPPROTO_UDP);
+      if (sockfd < 0)
+        {
+          iperf_show_socket_error_reason("udp client create", sockfd);
+          goto out;
+        }
+
+      setsockopt(sockfd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+
+      /* Each stream sends from its own port, so connect the socket
+       * rather than passing the address with every datagram.
+       */
+
+      if (connect(sockfd, addr, addrlen) < 0)
+        {
+          iperf_show_socket_error_reason("udp client connect", sockfd);
+          close(sockfd);
+          goto out;
+        }
+
+      if (iperf_add_stream(ctrl, i + 1, sockfd, true, true) < 0)
+        {
+          close(sockfd);
+          goto out;
         }
     }
 
+  iperf_start_report(ctrl);
+  ret = iperf_run_streams(ctrl, iperf_udp_tx_stream);
+
+out:
   ctrl->finish = true;
-  close(sockfd);
+  iperf_close_streams(ctrl);
 
-  return 0;
+  return ret;
 }
 
 /****************************************************************************
@@ -778,46 +1264,40 @@ static int iperf_run_udp_client(FAR struct iperf_ctrl_t *ctrl)
 static int iperf_tcp_client(FAR struct iperf_ctrl_t *ctrl,
                             FAR struct sockaddr *addr, socklen_t addrlen)
 {
-  FAR uint8_t *buffer;
-  int actual_send = 0;
-  int want_send = 0;
   int sockfd;
+  int ret = -1;
+  int i;
 
-  sockfd = socket(addr->sa_family, SOCK_STREAM, IPPROTO_TCP);
-  if (sockfd < 0)
-    {
-      iperf_show_socket_error_reason("tcp client create", sockfd);
-      return -1;
-    }
-
-  if (connect(sockfd, addr, addrlen) < 0)
+  for (i = 0; i < ctrl->cfg.nstreams; i++)
     {
-      iperf_show_socket_error_reason("tcp client connect", sockfd);
-      return -1;
-    }
-
-  iperf_start_report(ctrl);
-  buffer = ctrl->buffer;
-  want_send = ctrl->buffer_len;
+      sockfd = socket(addr->sa_family, SOCK_STREAM, IPPROTO_TCP);
+      if (sockfd < 0)
+        {
+          iperf_show_socket_error_reason("tcp client create", sockfd);
+          goto out;
+        }
 
-  while (!ctrl->finish)
-    {
-      actual_send = send(sockfd, buffer, want_send, 0);
-      if (actual_send <= 0)
+      if (connect(sockfd, addr, addrlen) < 0)
         {
-          iperf_show_socket_error_reason("tcp client send", sockfd);
-          break;
+          iperf_show_socket_error_reason("tcp client connect", sockfd);
+          close(sockfd);
+          goto out;
         }
-      else
+
+      if (iperf_add_connection(ctrl, i + 1, sockfd) < 0)
         {
-          ctrl->total_len += actual_send;
+          goto out;
         }
     }
 
+  iperf_start_report(ctrl);
+  ret = iperf_run_streams(ctrl, iperf_tcp_stream);
+
+out:
   ctrl->finish = true;
-  close(sockfd);
+  iperf_close_streams(ctrl);
 
-  return 0;
+  return ret;
 }
 
 /****************************************************************************
@@ -870,102 +1350,252 @@ static void iperf_task_traffic(FAR void *arg)
       assert(false);
     }
 
-  if (ctrl->buffer)
+  /* Don't leave a loopback client waiting for a server that failed */
+
+  iperf_server_ready(ctrl);
+
+  if (!ctrl->quiet)
     {
-      free(ctrl->buffer);
-      ctrl->buffer = NULL;
+      printf("iperf exit\n");
     }
 
-  printf("iperf exit\n");
-
   pthread_exit(NULL);
 }
 
-static uint32_t iperf_get_buffer_len(FAR struct iperf_ctrl_t *ctrl)
+static uint32_t iperf_get_buffer_len(FAR struct iperf_ctrl_t *ctrl,
+                                     bool tx)
 {
-  if (iperf_is_udp_client(ctrl))
-    {
-      return IPERF_UDP_TX_LEN;
-    }
-  else if (iperf_is_udp_server(ctrl))
+  if (ctrl->cfg.flag & IPERF_FLAG_UDP)
     {
-      return IPERF_UDP_RX_LEN;
-    }
-  else if (iperf_is_tcp_client(ctrl))
-    {
-      return IPERF_TCP_TX_LEN;
+      return tx ? IPERF_UDP_TX_LEN : IPERF_UDP_RX_LEN;
     }
   else
     {
-      return IPERF_TCP_RX_LEN;
+      return tx ? IPERF_TCP_TX_LEN : IPERF_TCP_RX_LEN;
     }
-
-  return 0;
 }
 
 /****************************************************************************
- * Public Functions
- ****************************************************************************/
-
-/****************************************************************************
- * Name: iperf_start
+ * Name: iperf_create_traffic
  *
  * Description:
- *   Start iperf task.
+ *   Prepare a test and start its traffic task.  If ready is given, the
+ *   test is a quiet server that posts ready once it accepts connections.
  *
  ****************************************************************************/
 
-int iperf_start(FAR struct iperf_cfg_t *cfg)
+static int iperf_create_traffic(FAR struct iperf_ctrl_t *ctrl,
+                                FAR const struct iperf_cfg_t *cfg,
+                                FAR sem_t *ready, FAR pthread_t *thread)
 {
-  struct iperf_ctrl_t ctrl;
   struct sched_param param;
   pthread_attr_t attr;
-  pthread_t thread;
-  FAR void *retval;
   int ret;
 
-  if (!cfg)
+  memset(ctrl, 0, sizeof(*ctrl));
+  memcpy(&ctrl->cfg, cfg, sizeof(*cfg));
+  ctrl->finish = false;
+
+  /* Only a loopback server waits for a client, and it doesn't report */
+
+  ctrl->ready = ready;
+  ctrl->quiet = ready != NULL;
+
+  if (ctrl->cfg.nstreams == 0)
     {
-      return -1;
+      ctrl->cfg.nstreams = 1;
     }
 
-  memset(&ctrl, 0, sizeof(ctrl));
-  memcpy(&ctrl.cfg, cfg, sizeof(*cfg));
-  ctrl.finish = false;
-  ctrl.buffer_len = iperf_get_buffer_len(&ctrl);
-  ctrl.buffer = (FAR uint8_t *)malloc(ctrl.buffer_len);
-  if (ctrl.buffer == NULL)
+  /* A bidirectional connection has a send and a receive stream */
+
+  ctrl->streams = (FAR struct iperf_stream_t *)
+    malloc(2 * ctrl->cfg.nstreams * sizeof(struct iperf_stream_t));
+  if (ctrl->streams == NULL)
     {
-      printf("create buffer: not enough memory\n");
+      printf("create streams: not enough memory\n");
       return -1;
     }
 
-  memset(ctrl.buffer, 0, ctrl.buffer_len);
   pthread_attr_init(&attr);
   param.sched_priority = IPERF_TRAFFIC_TASK_PRIORITY;
   pthread_attr_setschedparam(&attr, &param);
   pthread_attr_setstacksize(&attr, IPERF_TRAFFIC_TASK_STACK);
-  ret = pthread_create(&thread, &attr, (FAR void *)iperf_task_traffic,
-                       &ctrl);
+  ret = pthread_create(thread, &attr, (FAR void *)iperf_task_traffic,
+                       ctrl);
 
   if (ret != 0)
     {
       printf("iperf_task_traffic: create task failed: %d\n", ret);
-      free(ctrl.buffer);
-      ctrl.buffer = NULL;
+      free(ctrl->streams);
+      ctrl->streams = NULL;
       return -1;
     }
 
   pthread_mutex_lock(&g_iperf_ctrl_mutex);
-  sq_addlast((FAR sq_entry_t *)&ctrl, &g_iperf_ctrl_list);
+  sq_addlast((FAR sq_entry_t *)ctrl, &g_iperf_ctrl_list);
   pthread_mutex_unlock(&g_iperf_ctrl_mutex);
 
+  return 0;
+}
+
+/****************************************************************************
+ * Name: iperf_join_traffic
+ *
+ * Description:
+ *   Wait for a test to finish and release it.
+ *
+ ****************************************************************************/
+
+static void iperf_join_traffic(FAR struct iperf_ctrl_t *ctrl,
+                               pthread_t thread)
+{
+  FAR void *retval;
+
   pthread_join(thread, &retval);
 
   pthread_mutex_lock(&g_iperf_ctrl_mutex);
-  sq_rem((FAR sq_entry_t *)&ctrl, &g_iperf_ctrl_list);
+  sq_rem((FAR sq_entry_t *)ctrl, &g_iperf_ctrl_list);
   pthread_mutex_unlock(&g_iperf_ctrl_mutex);
 
+  if (ctrl->reporting)
+    {
+      pthread_join(ctrl->report, &retval);
+    }
+
+  free(ctrl->streams);
+  ctrl->streams = NULL;
+}
+
+/****************************************************************************
+ * Name: iperf_wakeup
+ *
+ * Description:
+ *   Wake up a loopback server blocked in accept() or recvfrom()
+ *
+ ****************************************************************************/
+
+static int iperf_wakeup(FAR struct iperf_ctrl_t *ctrl,
+                        FAR struct sockaddr *addr, socklen_t addrlen)
+{
+  char dummy = 0;
+  int sockfd;
+
+  if (ctrl->cfg.flag & IPERF_FLAG_UDP)
+    {
+      sockfd = socket(addr->sa_family, SOCK_DGRAM, IPPROTO_UDP);
+    }
+  else
+    {
+      sockfd = socket(addr->sa_family, SOCK_STREAM, IPPROTO_TCP);
+    }
+
+  if (sockfd < 0)
+    {
+      return -1;
+    }
+
+  if (connect(sockfd, addr, addrlen) == 0 &&
+      (ctrl->cfg.flag & IPERF_FLAG_UDP))
+    {
+      send(sockfd, &dummy, sizeof(dummy), 0);
+    }
+
+  close(sockfd);
+
+  return 0;
+}
+
+/****************************************************************************
+ * Name: iperf_start_loopback
+ *
+ * Description:
+ *   Run the server and the client of a test in this process.  Only the
+ *   client reports; with --bidir or -R it reports both directions.
+ *
+ ****************************************************************************/
+
+static int iperf_start_loopback(FAR struct iperf_cfg_t *cfg)
+{
+  struct iperf_ctrl_t server;
+  struct iperf_ctrl_t client;
+  struct iperf_cfg_t scfg;
+  pthread_t sthread;
+  pthread_t cthread;
+  sem_t ready;
+  int ret;
+
+  memcpy(&scfg, cfg, sizeof(scfg));
+  scfg.flag = (cfg->flag & ~IPERF_FLAG_CLIENT) | IPERF_FLAG_SERVER;
+  scfg.time = 0;
+
+  sem_init(&ready, 0, 0);
+
+  ret = iperf_create_traffic(&server, &scfg, &ready, &sthread);
+  if (ret < 0)
+    {
+      sem_destroy(&ready);
+      return ret;
+    }
+
+  sem_wait(&ready);
+
+  cfg->flag = (cfg->flag & ~IPERF_FLAG_SERVER) | IPERF_FLAG_CLIENT;
+  ret = iperf_create_traffic(&client, cfg, NULL, &cthread);
+  if (ret == 0)
+    {
+      iperf_join_traffic(&client, cthread);
+    }
+
+  /* The tcp server ends when the client closes its connections, but it
+   * may still wait in accept() if the client failed to connect.  A udp
+   * server never learns that the client is done.
+   */
+
+  server.finish = true;
+  iperf_run_client(&server, iperf_wakeup);
+
+  iperf_join_traffic(&server, sthread);
+  sem_destroy(&ready);
+
+  return ret;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: iperf_start
+ *
+ * Description:
+ *   Start iperf task.
+ *
+ ****************************************************************************/
+
+int iperf_start(FAR struct iperf_cfg_t *cfg)
+{
+  struct iperf_ctrl_t ctrl;
+  pthread_t thread;
+  int ret;
+
+  if (!cfg)
+    {
+      return -1;
+    }
+
+  if (cfg->flag & IPERF_FLAG_LOOPBACK)
+    {
+      return iperf_start_loopback(cfg);
+    }
+
+  ret = iperf_create_traffic(&ctrl, cfg, NULL, &thread);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  iperf_join_traffic(&ctrl, thread);
+
   return 0;
 }
 
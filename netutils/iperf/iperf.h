@@ -46,12 +46,17 @@ extern "C"
  * Pre-processor Definitions
  ****************************************************************************/
 
-#define IPERF_FLAG_CLIENT (1 << 0)
-#define IPERF_FLAG_SERVER (1 << 1)
-#define IPERF_FLAG_TCP    (1 << 2)
-#define IPERF_FLAG_UDP    (1 << 3)
-#define IPERF_FLAG_LOCAL  (1 << 4)
-#define IPERF_FLAG_RPMSG  (1 << 5)
+#define IPERF_FLAG_CLIENT   (1 << 0)
+#define IPERF_FLAG_SERVER   (1 << 1)
+#define IPERF_FLAG_TCP      (1 << 2)
+#define IPERF_FLAG_UDP      (1 << 3)
+#define IPERF_FLAG_LOCAL    (1 << 4)
+#define IPERF_FLAG_RPMSG    (1 << 5)
+#define IPERF_FLAG_REVERSE  (1 << 6)  /* Server sends, client receives */
+#define IPERF_FLAG_BIDIR    (1 << 7)  /* Both ends send and receive */
+#define IPERF_FLAG_LOOPBACK (1 << 8)  /* Server and client in one process */
+
+#define IPERF_MAX_STREAMS   16
 
 /****************************************************************************
  * Public Types
@@ -68,6 +73,8 @@ struct iperf_cfg_t
   uint32_t time;
   FAR const char *host; /* host name (dip) or rpmsg cpu */
   FAR const char *path; /* local path or rpmsg name */
+  uint16_t nstreams;    /* number of parallel connections */
+  uint32_t affinity;    /* mask of CPUs to run the streams on, 0 = any */
 };
 
 /****************************************************************************
@@ -64,6 +64,11 @@ struct wifi_iperf_t
   FAR struct arg_int *port;
   FAR struct arg_int *interval;
   FAR struct arg_int *time;
+  FAR struct arg_int *parallel;
+  FAR struct arg_lit *reverse;
+  FAR struct arg_lit *bidir;
+  FAR struct arg_lit *loopback;
+  FAR struct arg_int *affinity;
   FAR struct arg_lit *abort;
   FAR struct arg_end *end;
 };
@@ -83,8 +88,9 @@ struct wifi_iperf_t
 static void iperf_showusage(FAR const char *progname,
                             FAR struct wifi_iperf_t *args, int exitcode)
 {
-  printf("USAGE: %s [-sua] [-c <ip|cpu>] [-p <port>] [-i <interval>] "
-         "[-t <time>] [--local <path>] [--rpmsg <name>]\n", progname);
+  printf("USAGE: %s [-suaR] [-c <ip|cpu>] [-p <port>] [-i <interval>] "
+         "[-t <time>] [-P <n>] [-A <cpumask>] [--bidir] [--loopback] "
+         "[--local <path>] [--rpmsg <name>]\n", progname);
   printf("iperf command:\n");
   arg_print_glossary(stdout, (FAR void **)args, NULL);
 
@@ -106,7 +112,8 @@ static void iperf_printcfg(FAR struct iperf_cfg_t *cfg)
          cfg->flag & IPERF_FLAG_LOCAL ? "local-":
            cfg->flag & IPERF_FLAG_RPMSG ? "rpmsg-":"",
          cfg->flag & IPERF_FLAG_TCP ? "tcp":"udp",
-         cfg->flag & IPERF_FLAG_SERVER ? "server":"client");
+         cfg->flag & IPERF_FLAG_LOOPBACK ? "loopback":
+           cfg->flag & IPERF_FLAG_SERVER ? "server":"client");
 
   if (cfg->flag & IPERF_FLAG_LOCAL)
     {
@@ -126,8 +133,25 @@ static void iperf_printcfg(FAR struct iperf_cfg_t *cfg)
              (cfg->dip >> 16) & 0xff, (cfg->dip >> 24) & 0xff, cfg->dport);
     }
 
-  printf("interval=%" PRId32 ", time=%" PRId32 "\n",
+  printf("interval=%" PRId32 ", time=%" PRId32,
          cfg->interval, cfg->time);
+
+  if (cfg->nstreams > 1)
+    {
+      printf(", parallel=%d", cfg->nstreams);
+    }
+
+  if (cfg->flag & (IPERF_FLAG_REVERSE | IPERF_FLAG_BIDIR))
+    {
+      printf(", %s", cfg->flag & IPERF_FLAG_BIDIR ? "bidir" : "reverse");
+    }
+
+  if (cfg->affinity != 0)
+    {
+      printf(", cpus=0x%" PRIx32, cfg->affinity);
+    }
+
+  printf("\n");
 }
 
 /****************************************************************************
@@ -161,6 +185,16 @@ int main(int argc, FAR char *argv[])
                             "seconds between periodic bandwidth reports");
   iperf_args.time = arg_int0("t", "time", "<time>",
                         "time in seconds to transmit for (default 10 secs)");
+  iperf_args.parallel = arg_int0("P", "parallel", "<n>",
+                            "number of parallel connections (default 1)");
+  iperf_args.reverse = arg_lit0("R", "reverse",
+                                "server sends, client receives");
+  iperf_args.bidir = arg_lit0(NULL, "bidir",
+                              "both ends send and receive");
+  iperf_args.loopback = arg_lit0(NULL, "loopback",
+                                 "run server and client in this process");
+  iperf_args.affinity = arg_int0("A", "affinity", "<cpumask>",
+                                 "CPUs to spread the streams over");
   iperf_args.abort = arg_lit0("a", "abort", "abort running iperf");
   iperf_args.end = arg_end(1);
 
@@ -182,14 +216,31 @@ int main(int argc, FAR char *argv[])
       iperf_showusage(argv[0], &iperf_args, 0);
     }
 
-  if (((iperf_args.ip->count == 0) && (iperf_args.server->count == 0)) ||
-         ((iperf_args.ip->count != 0) && (iperf_args.server->count != 0)))
+  if (iperf_args.loopback->count != 0)
+    {
+      if (iperf_args.server->count != 0)
+        {
+          printf("ERROR: loopback mode runs both server and client\n");
+          iperf_showusage(argv[0], &iperf_args, 0);
+        }
+
+      cfg.host  = iperf_args.ip->count ? iperf_args.ip->sval[0] : "";
+      cfg.flag |= IPERF_FLAG_LOOPBACK;
+    }
+  else if (((iperf_args.ip->count == 0) &&
+            (iperf_args.server->count == 0)) ||
+           ((iperf_args.ip->count != 0) &&
+            (iperf_args.server->count != 0)))
     {
       printf("ERROR: should specific client/server mode\n");
       iperf_showusage(argv[0], &iperf_args, 0);
     }
 
-  if (iperf_args.ip->count == 0)
+  if (cfg.flag & IPERF_FLAG_LOOPBACK)
+    {
+      /* The role is chosen per task by iperf_start() */
+    }
+  else if (iperf_args.ip->count == 0)
     {
       cfg.host  = "";
       cfg.flag |= IPERF_FLAG_SERVER;
@@ -230,7 +281,12 @@ int main(int argc, FAR char *argv[])
   else
     {
 #ifdef CONFIG_NET_IPv4
-      if (iperf_args.bind->count > 0)
+      if (cfg.flag & IPERF_FLAG_LOOPBACK)
+        {
+          addr.s_addr = htonl(INADDR_LOOPBACK);
+          cfg.dip = addr.s_addr;
+        }
+      else if (iperf_args.bind->count > 0)
         {
           addr.s_addr = inet_addr(iperf_args.bind->sval[0]);
           if (addr.s_addr == INADDR_NONE)
@@ -267,6 +323,48 @@ int main(int argc, FAR char *argv[])
       cfg.flag |= IPERF_FLAG_UDP;
     }
 
+  if (iperf_args.reverse->count != 0)
+    {
+      cfg.flag |= IPERF_FLAG_REVERSE;
+    }
+
+  if (iperf_args.bidir->count != 0)
+    {
+      cfg.flag |= IPERF_FLAG_BIDIR;
+    }
+
+  if ((cfg.flag & (IPERF_FLAG_REVERSE | IPERF_FLAG_BIDIR)) &&
+      (cfg.flag & IPERF_FLAG_UDP))
+    {
+      /* A udp server doesn't know where to send before it receives */
+
+      printf("ERROR: reverse and bidir modes need TCP\n");
+      goto out;
+    }
+
+  cfg.nstreams = 1;
+  if (iperf_args.parallel->count != 0)
+    {
+      if (iperf_args.parallel->ival[0] < 1 ||
+          iperf_args.parallel->ival[0] > IPERF_MAX_STREAMS)
+        {
+          printf("ERROR: parallel streams should be 1-%d\n",
+                 IPERF_MAX_STREAMS);
+          goto out;
+        }
+
+      cfg.nstreams = iperf_args.parallel->ival[0];
+    }
+
+  if (iperf_args.affinity->count != 0)
+    {
+#ifdef CONFIG_SMP
+      cfg.affinity = iperf_args.affinity->ival[0];
+#else
+      printf("WARNING: CPU affinity needs SMP, ignored\n");
+#endif
+    }
+
   if (iperf_args.port->count == 0)
     {
       cfg.sport = IPERF_DEFAULT_PORT;
@@ -274,7 +372,12 @@ int main(int argc, FAR char *argv[])
     }
   else
     {
-      if (cfg.flag & IPERF_FLAG_SERVER)
+      if (cfg.flag & IPERF_FLAG_LOOPBACK)
+        {
+          cfg.sport = iperf_args.port->ival[0];
+          cfg.dport = iperf_args.port->ival[0];
+        }
+      else if (cfg.flag & IPERF_FLAG_SERVER)
         {
           cfg.sport = iperf_args.port->ival[0];
           cfg.dport = IPERF_DEFAULT_PORT;
@@ -29,8 +29,10 @@
 #include <sys/types.h>
 #include <sys/socket.h>
 
+#include <stdbool.h>
 #include <stdint.h>
 #include <stdio.h>
+#include <string.h>
 #include <unistd.h>
 #include <pthread.h>
 #include <errno.h>
@@ -41,124 +43,336 @@
 #include "netutils/netlib.h"
 
 /****************************************************************************
- * Public Functions
+ * Pre-processor Definitions
  ****************************************************************************/
 
+#ifndef CONFIG_NETUTILS_NETLIB_SERVER_WORKERS
+#  define CONFIG_NETUTILS_NETLIB_SERVER_WORKERS 0
+#endif
+
+#ifndef CONFIG_NETUTILS_NETLIB_SERVER_QUEUE
+#  define CONFIG_NETUTILS_NETLIB_SERVER_QUEUE 4
+#endif
+
 /****************************************************************************
- * Public Functions
+ * Private Types
  ****************************************************************************/
 
+#if CONFIG_NETUTILS_NETLIB_SERVER_WORKERS > 0
+/* Worker pool state.  Accepted sockets are passed to the pre-spawned
+ * workers through a bounded queue.  When the queue is full, the server
+ * stops accepting so that further connections wait in the listen backlog.
+ */
+
+struct netlib_pool_s
+{
+  pthread_mutex_t        lock;
+  pthread_cond_t         notempty;
+  pthread_cond_t         notfull;
+  pthread_startroutine_t handler;
+  bool                   stop;
+  int                    head;
+  int                    count;
+  int                    queue[CONFIG_NETUTILS_NETLIB_SERVER_QUEUE];
+};
+#endif
+
 /****************************************************************************
- * Name: netlib_server
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: netlib_accept
  *
  * Description:
- *   Implement basic server logic
- *
- * Parameters:
- *   portno    The port to listen on (in network byte order)
- *   handler   The entrypoint of the task to spawn when a new connection is
- *             accepted.
- *   stacksize The stack size needed by the spawned task
+ *   Accept the next connection and configure it.
  *
  * Return:
- *   Does not return unless an error occurs.
+ *   The accepted socket or a negated errno value on failure.
  *
  ****************************************************************************/
 
-void netlib_server(uint16_t portno,
-                   pthread_startroutine_t handler, int stacksize)
+static int netlib_accept(int listensd)
 {
   struct sockaddr_in myaddr;
 #ifdef CONFIG_NET_SOLINGER
   struct linger ling;
+  int ret;
 #endif
-  pthread_t child;
-  pthread_attr_t attr;
   socklen_t addrlen;
-  int listensd;
   int acceptsd;
+
+  addrlen = sizeof(struct sockaddr_in);
+  acceptsd = accept4(listensd, (struct sockaddr *)&myaddr, &addrlen,
+                     SOCK_CLOEXEC);
+  if (acceptsd < 0)
+    {
+      nerr("ERROR: accept failure: %d\n", errno);
+      return -errno;
+    }
+
+  ninfo("Connection accepted sd=%d\n", acceptsd);
+
+  /* Configure to "linger" until all data is sent when the socket is
+   * closed.
+   */
+
+#ifdef CONFIG_NET_SOLINGER
+  ling.l_onoff  = 1;
+  ling.l_linger = 30;     /* timeout is seconds */
+
+  ret = setsockopt(acceptsd, SOL_SOCKET,
+                   SO_LINGER, &ling, sizeof(struct linger));
+  if (ret < 0)
+    {
+      ret = -errno;
+      close(acceptsd);
+      nerr("ERROR: setsockopt SO_LINGER failure: %d\n", ret);
+      return ret;
+    }
+#endif
+
+  return acceptsd;
+}
+
+#if CONFIG_NETUTILS_NETLIB_SERVER_WORKERS == 0
+/****************************************************************************
+ * Name: netlib_spawn
+ *
+ * Description:
+ *   Create a thread to handle the connection.  The socket descriptor is
+ *   provided in as the single argument to the new thread.
+ *
+ ****************************************************************************/
+
+static int netlib_spawn(int acceptsd, pthread_startroutine_t handler,
+                        int stacksize)
+{
+  pthread_attr_t attr;
+  pthread_t child;
   int ret;
 
-  /* Create a new TCP socket to use to listen for connections */
+  pthread_attr_init(&attr);
+  pthread_attr_setstacksize(&attr, stacksize);
 
-  listensd = netlib_listenon(portno);
-  if (listensd < 0)
+  ret = pthread_create(&child, &attr,
+                       handler, (pthread_addr_t)((uintptr_t)acceptsd));
+  if (ret != 0)
     {
-      return;
+      /* Close the connection */
+
+      close(acceptsd);
+      nerr("ERROR: pthread_create failed\n");
+
+      /* EAGAIN means that we lacked resources to create a new thread.
+       * This is a temporary condition, so we close this peer, but keep
+       * serving for other connections.
+       */
+
+      return -ret;
     }
 
-  /* Begin serving connections */
+  /* We don't care when/how the child thread exits so detach from it now
+   * in order to avoid memory leaks.
+   */
+
+  pthread_detach(child);
+  return OK;
+}
+#else
+/****************************************************************************
+ * Name: netlib_worker
+ *
+ * Description:
+ *   Worker pool thread: handle queued connections one at a time until the
+ *   pool is stopped and the queue is drained.
+ *
+ ****************************************************************************/
+
+static pthread_addr_t netlib_worker(pthread_addr_t arg)
+{
+  FAR struct netlib_pool_s *pool = arg;
+  int acceptsd;
 
   for (; ; )
     {
-      /* Accept the next connection */
+      pthread_mutex_lock(&pool->lock);
+      while (pool->count == 0 && !pool->stop)
+        {
+          pthread_cond_wait(&pool->notempty, &pool->lock);
+        }
 
-      addrlen = sizeof(struct sockaddr_in);
-      acceptsd = accept4(listensd, (struct sockaddr *)&myaddr, &addrlen,
-                         SOCK_CLOEXEC);
-      if (acceptsd < 0)
+      if (pool->count == 0)
         {
-          nerr("ERROR: accept failure: %d\n", errno);
+          pthread_mutex_unlock(&pool->lock);
           break;
         }
 
-      ninfo("Connection accepted -- spawning sd=%d\n", acceptsd);
+      acceptsd   = pool->queue[pool->head];
+      pool->head = (pool->head + 1) % CONFIG_NETUTILS_NETLIB_SERVER_QUEUE;
+      pool->count--;
 
-      /* Configure to "linger" until all data is sent when the socket is
-       * closed.
-       */
+      pthread_cond_signal(&pool->notfull);
+      pthread_mutex_unlock(&pool->lock);
 
-#ifdef CONFIG_NET_SOLINGER
-      ling.l_onoff  = 1;
-      ling.l_linger = 30;     /* timeout is seconds */
+      ninfo("Serving sd=%d\n", acceptsd);
+      pool->handler((pthread_addr_t)((uintptr_t)acceptsd));
+    }
+
+  return NULL;
+}
+
+/****************************************************************************
+ * Name: netlib_pool_serve
+ *
+ * Description:
+ *   Serve connections with a pool of pre-spawned worker threads.
+ *
+ ****************************************************************************/
 
-      ret = setsockopt(acceptsd, SOL_SOCKET,
-                       SO_LINGER, &ling, sizeof(struct linger));
-      if (ret < 0)
+static void netlib_pool_serve(int listensd, pthread_startroutine_t handler,
+                              int stacksize)
+{
+  pthread_t workers[CONFIG_NETUTILS_NETLIB_SERVER_WORKERS];
+  struct netlib_pool_s pool;
+  pthread_attr_t attr;
+  int nworkers;
+  int acceptsd;
+  int ret;
+
+  memset(&pool, 0, sizeof(pool));
+  pthread_mutex_init(&pool.lock, NULL);
+  pthread_cond_init(&pool.notempty, NULL);
+  pthread_cond_init(&pool.notfull, NULL);
+  pool.handler = handler;
+
+  pthread_attr_init(&attr);
+  pthread_attr_setstacksize(&attr, stacksize);
+
+  for (nworkers = 0; nworkers < CONFIG_NETUTILS_NETLIB_SERVER_WORKERS;
+       nworkers++)
+    {
+      ret = pthread_create(&workers[nworkers], &attr, netlib_worker, &pool);
+      if (ret != 0)
         {
-          close(acceptsd);
-          nerr("ERROR: setsockopt SO_LINGER failure: %d\n", errno);
+          nerr("ERROR: pthread_create failed: %d\n", ret);
           break;
         }
-#endif
+    }
 
-      /* Create a thread to handle the connection.  The socket descriptor is
-       * provided in as the single argument to the new thread.
-       */
+  /* Serve with as many workers as could be created */
 
-      pthread_attr_init(&attr);
-      pthread_attr_setstacksize(&attr, stacksize);
+  while (nworkers > 0)
+    {
+      /* Don't accept more connections than can be queued */
 
-      ret = pthread_create(&child, &attr,
-                           handler, (pthread_addr_t)((uintptr_t)acceptsd));
-      if (ret != 0)
+      pthread_mutex_lock(&pool.lock);
+      while (pool.count == CONFIG_NETUTILS_NETLIB_SERVER_QUEUE)
         {
-          /* Close the connection */
+          pthread_cond_wait(&pool.notfull, &pool.lock);
+        }
 
-          close(acceptsd);
-          nerr("ERROR: pthread_create failed\n");
+      pthread_mutex_unlock(&pool.lock);
 
-          if (ret == EAGAIN)
-            {
-              /* Lacked resources to create a new thread. This is a temporary
-               * condition, so we close this peer, but keep serving for
-               * other connections.
-               */
+      acceptsd = netlib_accept(listensd);
+      if (acceptsd < 0)
+        {
+          break;
+        }
 
-              continue;
-            }
+      pthread_mutex_lock(&pool.lock);
+      pool.queue[(pool.head + pool.count) %
+                 CONFIG_NETUTILS_NETLIB_SERVER_QUEUE] = acceptsd;
+      pool.count++;
+      pthread_cond_signal(&pool.notempty);
+      pthread_mutex_unlock(&pool.lock);
+    }
 
-          /* Something is very wrong... Break out and stop serving */
+  /* Let the workers finish the queued connections and exit */
+
+  pthread_mutex_lock(&pool.lock);
+  pool.stop = true;
+  pthread_cond_broadcast(&pool.notempty);
+  pthread_mutex_unlock(&pool.lock);
+
+  while (nworkers > 0)
+    {
+      pthread_join(workers[--nworkers], NULL);
+    }
+
+  pthread_attr_destroy(&attr);
+  pthread_cond_destroy(&pool.notfull);
+  pthread_cond_destroy(&pool.notempty);
+  pthread_mutex_destroy(&pool.lock);
+}
+#endif
 
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: netlib_server
+ *
+ * Description:
+ *   Implement basic server logic.  By default a new thread is spawned for
+ *   each accepted connection.  If CONFIG_NETUTILS_NETLIB_SERVER_WORKERS is
+ *   non-zero, connections are handed to a fixed pool of worker threads
+ *   instead.  The handler must then return rather than call
+ *   pthread_exit(), and must close the socket before it returns.
+ *
+ * Parameters:
+ *   portno    The port to listen on (in network byte order)
+ *   handler   The entrypoint of the task to spawn when a new connection is
+ *             accepted.
+ *   stacksize The stack size needed by the spawned task
+ *
+ * Return:
+ *   Does not return unless an error occurs.
+ *
+ ****************************************************************************/
+
+void netlib_server(uint16_t portno,
+                   pthread_startroutine_t handler, int stacksize)
+{
+  int listensd;
+#if CONFIG_NETUTILS_NETLIB_SERVER_WORKERS == 0
+  int acceptsd;
+  int ret;
+#endif
+
+  /* Create a new TCP socket to use to listen for connections */
+
+  listensd = netlib_listenon(portno);
+  if (listensd < 0)
+    {
+      return;
+    }
+
+  /* Begin serving connections */
+
+#if CONFIG_NETUTILS_NETLIB_SERVER_WORKERS > 0
+  netlib_pool_serve(listensd, handler, stacksize);
+#else
+  for (; ; )
+    {
+      /* Accept the next connection */
+
+      acceptsd = netlib_accept(listensd);
+      if (acceptsd < 0)
+        {
           break;
         }
 
-      /* We don't care when/how the child thread exits so detach from it now
-       * in order to avoid memory leaks.
-       */
+      ret = netlib_spawn(acceptsd, handler, stacksize);
+      if (ret < 0 && ret != -EAGAIN)
+        {
+          /* Something is very wrong... Break out and stop serving */
 
-      pthread_detach(child);
+          break;
+        }
     }
+#endif
 
   /* Close the listener socket */
 
@@ -58,8 +58,19 @@
 #include <netutils/ptpd.h>
 
 #include "netutils/netlib.h"
+#include "ptpd_servo.h"
 #include "ptpv2.h"
 
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#ifdef CONFIG_NETUTILS_PTPD_PATH_DELAY_MIN
+#  define PTP_PATH_DELAY_USE_MIN true
+#else
+#  define PTP_PATH_DELAY_USE_MIN false
+#endif
+
 /****************************************************************************
  * Private Types
  ****************************************************************************/
@@ -108,13 +119,12 @@ struct ptp_state_s
   uint16_t sync_seq;
   uint16_t delay_req_seq;
 
-  /* Previous measurement and estimated clock drift rate */
+  /* Previous measurement and clock servo */
 
   struct timespec last_delta_timestamp;
   int64_t last_delta_ns;
   int64_t last_adjtime_ns;
-  long drift_avg_total_ms;
-  long drift_ppb;
+  struct ptp_servo_s servo;
 
   /* Identity of currently selected clock source,
    * from the latest announcement message.
@@ -142,7 +152,7 @@ struct ptp_state_s
 
   bool can_send_delayreq;
   struct timespec delayreq_time;
-  int path_delay_avgcount;
+  struct ptp_delayfilter_s path_delay_filter;
   long path_delay_ns;
   long delayreq_interval;
 
@@ -171,6 +181,21 @@ struct ptp_state_s
   FAR const struct ptpd_config_s *config;
 };
 
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static const struct ptp_servo_config_s g_ptp_servo_config =
+{
+  CONFIG_NETUTILS_PTPD_SERVO_KP,
+  CONFIG_NETUTILS_PTPD_SERVO_KI,
+  CONFIG_NETUTILS_PTPD_SETTIME_THRESHOLD_MS * (int64_t)NSEC_PER_MSEC,
+  CONFIG_CLOCK_ADJTIME_SLEWLIMIT_PPM * 1000,
+  CONFIG_NETUTILS_PTPD_OUTLIER_THRESHOLD,
+  CONFIG_NETUTILS_PTPD_OUTLIER_MAXCOUNT,
+  CONFIG_NETUTILS_PTPD_TIMEOUT_MS
+};
+
 /****************************************************************************
  * Private Functions
  ****************************************************************************/
@@ -998,7 +1023,7 @@ static int ptp_process_announce(FAR struct ptp_state_s *state,
 {
   clock_gettime(CLOCK_MONOTONIC, &state->last_received_announce);
 
-  if (state->conifg->bmca && is_better_clock(msg, &state->n_identity))
+  if (state->config->bmca && is_better_clock(msg, &state->own_identity))
     {
       if (!state->selected_source_valid ||
           is_better_clock(msg, &state->selected_source))
@@ -1007,7 +1032,9 @@ static int ptp_process_announce(FAR struct ptp_state_s *state,
 
           state->selected_source = *msg;
           state->last_received_sync = state->last_received_announce;
-          state->path_delay_avgcount = 0;
+          ptp_delayfilter_init(&state->path_delay_filter,
+                               CONFIG_NETUTILS_PTPD_PATH_DELAY_WINDOW,
+                               PTP_PATH_DELAY_USE_MIN);
           state->path_delay_ns = 0;
           state->delayreq_time.tv_sec = 0;
         }
@@ -1024,11 +1051,14 @@ static int ptp_update_local_clock(FAR struct ptp_state_s *state,
                                   FAR struct timespec *remote_timestamp,
                                   FAR struct timespec *local_timestamp)
 {
-  int ret;
+  enum ptp_servo_state_e servo_state;
+  int ret = OK;
   int64_t delta_ns;
   int64_t absdelta_ns;
-  const int64_t adj_limit_ns = CONFIG_NETUTILS_PTPD_SETTIME_THRESHOLD_MS
-                               * (int64_t)NSEC_PER_MSEC;
+  int64_t local_ns;
+  int64_t adjustment_ns;
+  long ppb;
+  int period_ms;
 
   ptpinfo("Local time: %jd.%09ld, remote time %jd.%09ld\n",
           (intmax_t)local_timestamp->tv_sec,
@@ -1039,8 +1069,26 @@ static int ptp_update_local_clock(FAR struct ptp_state_s *state,
   delta_ns = timespec_delta_ns(remote_timestamp, local_timestamp);
   delta_ns += state->path_delay_ns;
   absdelta_ns = (delta_ns < 0) ? -delta_ns : delta_ns;
+  local_ns = (int64_t)local_timestamp->tv_sec * NSEC_PER_SEC
+             + local_timestamp->tv_nsec;
 
-  if (absdelta_ns > adj_limit_ns)
+  /* The latest measurement is also needed for path delay calculation,
+   * so keep it even if the servo decides to ignore it.
+   */
+
+  state->last_delta_ns = delta_ns;
+
+  servo_state = ptp_servo_sample(&state->servo, delta_ns, local_ns, &ppb);
+  if (servo_state == PTP_SERVO_OUTLIER)
+    {
+      /* The previous rate is still applied below: a one-shot adjtime()
+       * slew would otherwise leave the clock uncorrected until the next
+       * accepted sample.
+       */
+
+      ptpwarn("Ignoring outlier delta: %+lld ns\n", (long long)delta_ns);
+    }
+  else if (servo_state == PTP_SERVO_JUMP)
     {
       /* Large difference, move by jumping.
        * Account for delay since packet was received.
@@ -1052,13 +1100,8 @@ static int ptp_update_local_clock(FAR struct ptp_state_s *state,
       clock_timespec_add(&new_time, remote_timestamp, &new_time);
       ret = ptp_settime(state, &new_time);
 
-      /* Reinitialize drift adjustment parameters */
-
       state->last_delta_timestamp = new_time;
       state->last_delta_ns = 0;
-      state->last_adjtime_ns = 0;
-      state->drift_avg_total_ms = 0;
-      state->drift_ppb = 0;
 
       if (ret == OK)
         {
@@ -1072,123 +1115,43 @@ static int ptp_update_local_clock(FAR struct ptp_state_s *state,
     }
   else
     {
-      /* Track drift rate based on two consecutive measurements and
-       * the adjustment that was made previously.
-       */
-
-      int64_t drift_ppb;
-      struct timespec interval;
-      int interval_ms;
-      int max_avg_period_ms;
-      int64_t adjustment_ns;
-
-      clock_timespec_subtract(local_timestamp,
-                              &state->last_delta_timestamp,
-                              &interval);
-      interval_ms = timespec_to_ms(&interval);
-
-      if (interval_ms > 0 && interval_ms < CONFIG_NETUTILS_PTPD_TIMEOUT_MS)
-        {
-          drift_ppb = (delta_ns - state->last_delta_ns) * MSEC_PER_SEC
-                      / interval_ms;
-        }
-      else
-        {
-          ptpwarn("Measurement interval out of range: %d ms\n", interval_ms);
-          drift_ppb = 0;
-          interval_ms = 1;
-        }
-
-      /* Account for the adjustment previously made */
-
-      drift_ppb += state->last_adjtime_ns * MSEC_PER_SEC
-                  / CONFIG_CLOCK_ADJTIME_PERIOD_MS;
-
-      if (drift_ppb > CONFIG_CLOCK_ADJTIME_SLEWLIMIT_PPM * 1000 ||
-          drift_ppb < -CONFIG_CLOCK_ADJTIME_SLEWLIMIT_PPM * 1000)
-        {
-          ptpwarn("Drift estimate out of range: %lld\n",
-                  (long long)drift_ppb);
-          drift_ppb = state->drift_ppb;
-        }
-
-      /* Take direct average of drift estimate for first measurements,
-       * after that update the exponential sliding average.
-       * Measurements are weighted according to the interval, because
-       * drift estimate is more accurate over longer timespan.
-       */
-
-      state->drift_avg_total_ms += interval_ms;
-      max_avg_period_ms = CONFIG_NETUTILS_PTPD_DRIFT_AVERAGE_S
-                          * MSEC_PER_SEC;
-      if (state->drift_avg_total_ms > max_avg_period_ms)
-        {
-          state->drift_avg_total_ms = max_avg_period_ms;
-        }
-
-      state->drift_ppb += (drift_ppb - state->drift_ppb) * interval_ms
-                        / state->drift_avg_total_ms;
-
-      /* Compute the value we need to give to adjtime() to match the
-       * drift rate.
-       */
-
-      adjustment_ns = state->drift_ppb * CONFIG_CLOCK_ADJTIME_PERIOD_MS
-                      / MSEC_PER_SEC;
-
-      /* Drift estimation ensures local clock runs at same rate as remote.
-       *
-       * Adding the current clock offset to adjustment brings the clocks
-       * to match. To avoid individual outliers from causing jitter, we
-       * take the larger signed value of two previous deltas. This is based
-       * on the logic that packets can get delayed in transit, but do not
-       * travel backwards in time.
-       *
-       * Clock offset is applied over ADJTIME_PERIOD. If there is significant
-       * noise in measurements, increasing ADJTIME_PERIOD will reduce its
-       * effect on the local clock run rate.
-       */
-
-      if (state->last_delta_ns > delta_ns)
-        {
-          adjustment_ns += state->last_delta_ns;
-        }
-      else
-        {
-          adjustment_ns += delta_ns;
-        }
+      state->last_delta_timestamp = *local_timestamp;
+    }
 
-      /* Apply adjustment and store information for next time */
+  /* Rate adjustment from the servo.  A PTP hardware clock takes it as a
+   * frequency setting.  adjtime() on the system clock instead slews by a
+   * fixed amount over CLOCK_ADJTIME_PERIOD, and a new call replaces what
+   * is left of the previous one, so convert the rate to the amount
+   * needed until the next sync (or over one period, if that is longer).
+   */
 
-      state->last_delta_ns = delta_ns;
-      state->last_delta_timestamp = *local_timestamp;
-      state->last_adjtime_ns = adjustment_ns;
+  period_ms = state->servo.interval_ms;
+  if (period_ms < CONFIG_CLOCK_ADJTIME_PERIOD_MS)
+    {
+      period_ms = CONFIG_CLOCK_ADJTIME_PERIOD_MS;
+    }
 
-      ptpinfo("Delta: %+lld ns, adjustment %+lld ns, drift rate %+lld ppb\n",
-              (long long)delta_ns,
-              (long long)state->last_adjtime_ns,
-              (long long)state->drift_ppb);
+  adjustment_ns = (int64_t)ppb * period_ms / MSEC_PER_SEC;
+  state->last_adjtime_ns = adjustment_ns;
 
-      if (absdelta_ns > CONFIG_NETUTILS_PTPD_ADJTIME_THRESHOLD_NS)
-        {
-          ret = ptp_adjtime(state, delta_ns, drift_ppb);
-        }
-      else
-        {
-          ret = ptp_adjtime(state, adjustment_ns, state->drift_ppb);
-        }
+  ptpinfo("Delta: %+lld ns, adjustment %+ld ppb, drift rate %+ld ppb\n",
+          (long long)delta_ns, ppb, state->servo.drift_ppb);
 
-      if (ret != OK)
+  if (ptp_adjtime(state, adjustment_ns, ppb) != OK)
+    {
+      ptperr("ptp_adjtime() failed: %d\n", errno);
+      if (ret == OK)
         {
-          ptperr("ptp_adjtime() failed: %d\n", errno);
+          ret = ERROR;
         }
+    }
 
-      /* Check if clock is stable enough for sending delay requests */
+  /* Check if clock is stable enough for sending delay requests */
 
-      if (absdelta_ns < CONFIG_NETUTILS_PTPD_MAX_PATH_DELAY_NS)
-        {
-          state->can_send_delayreq = true;
-        }
+  if (servo_state == PTP_SERVO_LOCKED &&
+      absdelta_ns < CONFIG_NETUTILS_PTPD_MAX_PATH_DELAY_NS)
+    {
+      state->can_send_delayreq = true;
     }
 
   return ret;
@@ -1381,16 +1344,10 @@ static int ptp_process_delay_resp(FAR struct ptp_state_s *state,
 
   if (path_delay >= 0 && path_delay < CONFIG_NETUTILS_PTPD_MAX_PATH_DELAY_NS)
     {
-      if (state->path_delay_avgcount <
-          CONFIG_NETUTILS_PTPD_DELAYREQ_AVGCOUNT)
-        {
-          state->path_delay_avgcount++;
-        }
+      state->path_delay_ns = ptp_delayfilter_add(&state->path_delay_filter,
+                                                 path_delay);
 
-      state->path_delay_ns += (path_delay - state->path_delay_ns)
-                              / state->path_delay_avgcount;
-
-      ptpinfo("Path delay: %ld ns (avg: %ld ns)\n",
+      ptpinfo("Path delay: %ld ns (filtered: %ld ns)\n",
         (long)path_delay, (long)state->path_delay_ns);
     }
   else
@@ -1565,7 +1522,7 @@ static void ptp_process_statusreq(FAR struct ptp_state_s *state)
   status->last_clock_update = state->last_delta_timestamp;
   status->last_delta_ns     = state->last_delta_ns;
   status->last_adjtime_ns   = state->last_adjtime_ns;
-  status->drift_ppb         = state->drift_ppb;
+  status->drift_ppb         = state->servo.drift_ppb;
   status->path_delay_ns     = state->path_delay_ns;
 
   /* Copy timestamps */
@@ -1628,6 +1585,11 @@ int ptpd_start(FAR const struct ptpd_config_s *config)
     }
 
   state->config = config;
+  ptp_servo_init(&state->servo, &g_ptp_servo_config);
+  ptp_delayfilter_init(&state->path_delay_filter,
+                       CONFIG_NETUTILS_PTPD_PATH_DELAY_WINDOW,
+                       PTP_PATH_DELAY_USE_MIN);
+
   if (ptp_initialize_state(state) != OK)
     {
       ptperr("Failed to initialize PTP state, exiting\n");
@@ -0,0 +1,333 @@
+/****************************************************************************
+ * apps/netutils/ptpd/ptpd_servo.c
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "ptpd_servo.h"
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define SERVO_NSEC_PER_MSEC  1000000
+
+/* Lower bound for the jitter estimate, so that a very clean signal does
+ * not make the outlier gate reject ordinary timestamping noise.
+ */
+
+#define SERVO_MIN_JITTER_NS  20
+
+/* Number of samples averaged into the jitter estimate.  Outliers are
+ * only rejected once this many samples have been seen since locking.
+ */
+
+#define SERVO_JITTER_SAMPLES 16
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+static int64_t servo_abs(int64_t value)
+{
+  return (value < 0) ? -value : value;
+}
+
+static long servo_clamp(int64_t value, long limit)
+{
+  if (value > limit)
+    {
+      return limit;
+    }
+  else if (value < -limit)
+    {
+      return -limit;
+    }
+
+  return (long)value;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: ptp_servo_init
+ ****************************************************************************/
+
+void ptp_servo_init(FAR struct ptp_servo_s *servo,
+                    FAR const struct ptp_servo_config_s *config)
+{
+  memset(servo, 0, sizeof(*servo));
+  servo->config = *config;
+}
+
+/****************************************************************************
+ * Name: ptp_servo_reset
+ ****************************************************************************/
+
+void ptp_servo_reset(FAR struct ptp_servo_s *servo)
+{
+  servo->count    = 0;
+  servo->outliers = 0;
+  servo->ppb      = servo->drift_ppb;
+}
+
+/****************************************************************************
+ * Name: ptp_servo_sample
+ ****************************************************************************/
+
+enum ptp_servo_state_e ptp_servo_sample(FAR struct ptp_servo_s *servo,
+                                        int64_t offset_ns,
+                                        int64_t local_ns,
+                                        FAR long *ppb)
+{
+  FAR const struct ptp_servo_config_s *cfg = &servo->config;
+  int64_t absoffset_ns = servo_abs(offset_ns);
+  int64_t residual_ns = 0;
+  int64_t interval_ns;
+  int64_t sample_ns;
+  int64_t jitter_ns;
+  int interval_ms = 1;
+
+  /* Until the servo is locked, hold the current drift estimate */
+
+  *ppb = servo->drift_ppb;
+
+  if (servo->count > 0)
+    {
+      interval_ns = local_ns - servo->last_local_ns;
+      if (interval_ns <= 0 ||
+          interval_ns > (int64_t)cfg->max_interval_ms * SERVO_NSEC_PER_MSEC)
+        {
+          /* Lost track of the remote clock, start over */
+
+          servo->count = 0;
+        }
+      else if (interval_ns >= SERVO_NSEC_PER_MSEC)
+        {
+          interval_ms = interval_ns / SERVO_NSEC_PER_MSEC;
+        }
+
+      /* The gains work on the time since the last accepted sample, but
+       * the caller sizes its adjustment by the sync interval, which must
+       * not grow when samples are rejected.
+       */
+
+      sample_ns = local_ns - servo->last_sample_ns;
+      if (sample_ns >= SERVO_NSEC_PER_MSEC && sample_ns <= interval_ns)
+        {
+          servo->interval_ms = sample_ns / SERVO_NSEC_PER_MSEC;
+        }
+    }
+
+  servo->last_sample_ns = local_ns;
+
+  /* Once locked, the offset is expected to be what is left of the
+   * previous one after the proportional correction.  The difference is
+   * measurement noise, averaged into the jitter estimate.
+   */
+
+  if (servo->count >= 2)
+    {
+      residual_ns = offset_ns - servo->last_offset_ns +
+                    (int64_t)(servo->ppb - servo->drift_ppb) *
+                    interval_ms / 1000;
+      residual_ns = servo_abs(residual_ns);
+    }
+
+  /* Packets that were queued somewhere on the way show up as spikes far
+   * outside the jitter.  Drop those, unless there are so many in a row
+   * that the clock has really moved.
+   */
+
+  if (servo->count >= 2 + SERVO_JITTER_SAMPLES &&
+      cfg->outlier_threshold > 0)
+    {
+      jitter_ns = servo->jitter_ns;
+      if (jitter_ns < SERVO_MIN_JITTER_NS)
+        {
+          jitter_ns = SERVO_MIN_JITTER_NS;
+        }
+
+      if (residual_ns > jitter_ns * cfg->outlier_threshold)
+        {
+          /* Keep applying the previous rate */
+
+          if (servo->outliers < cfg->outlier_maxcount)
+            {
+              servo->outliers++;
+              *ppb = servo->ppb;
+              return PTP_SERVO_OUTLIER;
+            }
+
+          /* Accept it and open the gate to the new offset level */
+
+          servo->jitter_ns = residual_ns;
+        }
+    }
+
+  servo->outliers = 0;
+
+  if (absoffset_ns > cfg->step_threshold_ns)
+    {
+      ptp_servo_reset(servo);
+      return PTP_SERVO_JUMP;
+    }
+
+  switch (servo->count)
+    {
+      case 0:
+
+        /* First sample, wait for another one to estimate the drift */
+
+        servo->count = 1;
+        servo->last_offset_ns = offset_ns;
+        servo->last_local_ns = local_ns;
+        return PTP_SERVO_UNLOCKED;
+
+      case 1:
+
+        /* Initialize the integral term from the change of the offset over
+         * the interval, on top of the rate correction already applied.
+         */
+
+        servo->drift_ppb =
+          servo_clamp(servo->drift_ppb +
+                      (offset_ns - servo->last_offset_ns) * 1000 /
+                      interval_ms,
+                      cfg->max_ppb);
+        servo->jitter_ns = 0;
+        servo->count = 2;
+        break;
+
+      default:
+        servo->drift_ppb =
+          servo_clamp(servo->drift_ppb +
+                      offset_ns * cfg->ki / interval_ms,
+                      cfg->max_ppb);
+
+        /* Plain average over the first samples, then a sliding one */
+
+        if (servo->count < 2 + SERVO_JITTER_SAMPLES)
+          {
+            servo->count++;
+          }
+
+        servo->jitter_ns += (residual_ns - servo->jitter_ns) /
+                            (servo->count - 2);
+        break;
+    }
+
+  servo->ppb = servo_clamp(servo->drift_ppb +
+                           offset_ns * cfg->kp / interval_ms,
+                           cfg->max_ppb);
+  servo->last_offset_ns = offset_ns;
+  servo->last_local_ns = local_ns;
+
+  *ppb = servo->ppb;
+  return PTP_SERVO_LOCKED;
+}
+
+/****************************************************************************
+ * Name: ptp_delayfilter_init
+ ****************************************************************************/
+
+void ptp_delayfilter_init(FAR struct ptp_delayfilter_s *filter,
+                          int length, bool use_min)
+{
+  memset(filter, 0, sizeof(*filter));
+
+  if (length < 1)
+    {
+      length = 1;
+    }
+  else if (length > PTP_DELAYFILTER_MAXLEN)
+    {
+      length = PTP_DELAYFILTER_MAXLEN;
+    }
+
+  filter->length  = length;
+  filter->use_min = use_min;
+}
+
+/****************************************************************************
+ * Name: ptp_delayfilter_add
+ ****************************************************************************/
+
+int64_t ptp_delayfilter_add(FAR struct ptp_delayfilter_s *filter,
+                            int64_t delay_ns)
+{
+  int64_t sorted[PTP_DELAYFILTER_MAXLEN];
+  int64_t value;
+  int i;
+  int j;
+
+  filter->samples[filter->head] = delay_ns;
+  filter->head = (filter->head + 1) % filter->length;
+  if (filter->count < filter->length)
+    {
+      filter->count++;
+    }
+
+  /* The minimum suits links where packets only ever get delayed, the
+   * median also tolerates occasional too short measurements.
+   */
+
+  if (filter->use_min)
+    {
+      value = filter->samples[0];
+      for (i = 1; i < filter->count; i++)
+        {
+          if (filter->samples[i] < value)
+            {
+              value = filter->samples[i];
+            }
+        }
+
+      return value;
+    }
+
+  for (i = 0; i < filter->count; i++)
+    {
+      value = filter->samples[i];
+      for (j = i; j > 0 && sorted[j - 1] > value; j--)
+        {
+          sorted[j] = sorted[j - 1];
+        }
+
+      sorted[j] = value;
+    }
+
+  i = filter->count / 2;
+  if (filter->count & 1)
+    {
+      return sorted[i];
+    }
+
+  return (sorted[i - 1] + sorted[i]) / 2;
+}
@@ -0,0 +1,180 @@
+/****************************************************************************
+ * apps/netutils/ptpd/ptpd_servo.h
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+#ifndef __APPS_NETUTILS_PTPD_PTPD_SERVO_H
+#define __APPS_NETUTILS_PTPD_PTPD_SERVO_H
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+/* The servo and the path delay filter have no OS dependencies so that the
+ * same code can be built into the host simulator (see ptpd_sim.c).
+ */
+
+#ifdef NETUTILS_PTPD_HOST
+#  define FAR
+#else
+#  include <nuttx/compiler.h>
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Maximum number of samples in the path delay filter window */
+
+#define PTP_DELAYFILTER_MAXLEN 64
+
+/****************************************************************************
+ * Public Types
+ ****************************************************************************/
+
+/* Result of feeding one offset measurement to the servo */
+
+enum ptp_servo_state_e
+{
+  PTP_SERVO_UNLOCKED = 0, /* Collecting initial samples, hold frequency */
+  PTP_SERVO_JUMP,         /* Offset too large, step the clock */
+  PTP_SERVO_LOCKED,       /* Apply the returned frequency adjustment */
+  PTP_SERVO_OUTLIER       /* Sample rejected, keep previous adjustment */
+};
+
+/* Servo tuning parameters.
+ *
+ * The gains are in 1/1000 units and are normalized to the measurement
+ * interval: kp = 1000 would remove the whole offset within one interval.
+ */
+
+struct ptp_servo_config_s
+{
+  int kp;                    /* Proportional gain (1/1000) */
+  int ki;                    /* Integral gain (1/1000) */
+  int64_t step_threshold_ns; /* Offsets above this step the clock */
+  long max_ppb;              /* Frequency adjustment limit */
+  int outlier_threshold;     /* Reject offsets above N * jitter, 0 = off */
+  int outlier_maxcount;      /* Accept after this many rejects in a row */
+  int max_interval_ms;       /* Sample interval considered a restart */
+};
+
+/* PI servo state */
+
+struct ptp_servo_s
+{
+  struct ptp_servo_config_s config;
+  int count;                 /* Samples since last reset */
+  int outliers;              /* Consecutive rejected samples */
+  int interval_ms;           /* Interval between the last two samples */
+  int64_t last_offset_ns;    /* Offset of the previous accepted sample */
+  int64_t last_local_ns;     /* Local time of that sample */
+  int64_t last_sample_ns;    /* Local time of the previous sample */
+  int64_t jitter_ns;         /* Mean deviation from expected offset */
+  long drift_ppb;            /* Integral term, estimated clock drift */
+  long ppb;                  /* Last frequency adjustment */
+};
+
+/* Path delay filter over a sliding window of measurements */
+
+struct ptp_delayfilter_s
+{
+  bool use_min;              /* Minimum instead of median of the window */
+  int length;                /* Window length */
+  int count;                 /* Valid samples in window */
+  int head;                  /* Next slot to overwrite */
+  int64_t samples[PTP_DELAYFILTER_MAXLEN];
+};
+
+/****************************************************************************
+ * Public Function Prototypes
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: ptp_servo_init
+ *
+ * Description:
+ *   Initialize the servo with the given tuning parameters.
+ *
+ ****************************************************************************/
+
+void ptp_servo_init(FAR struct ptp_servo_s *servo,
+                    FAR const struct ptp_servo_config_s *config);
+
+/****************************************************************************
+ * Name: ptp_servo_reset
+ *
+ * Description:
+ *   Forget the sample history, e.g. after the clock has been stepped.
+ *   The drift estimate is kept, as the oscillator rate did not change.
+ *
+ ****************************************************************************/
+
+void ptp_servo_reset(FAR struct ptp_servo_s *servo);
+
+/****************************************************************************
+ * Name: ptp_servo_sample
+ *
+ * Description:
+ *   Feed one clock offset measurement to the servo.
+ *
+ * Input Parameters:
+ *   servo     - Servo state
+ *   offset_ns - Remote minus local time, positive when local is behind
+ *   local_ns  - Local timestamp of the measurement
+ *   ppb       - Returns the frequency adjustment to apply, positive
+ *               meaning the local clock must run faster
+ *
+ * Returned Value:
+ *   The action the caller should take, see enum ptp_servo_state_e.
+ *
+ ****************************************************************************/
+
+enum ptp_servo_state_e ptp_servo_sample(FAR struct ptp_servo_s *servo,
+                                        int64_t offset_ns,
+                                        int64_t local_ns,
+                                        FAR long *ppb);
+
+/****************************************************************************
+ * Name: ptp_delayfilter_init
+ *
+ * Description:
+ *   Initialize an empty path delay filter.
+ *
+ ****************************************************************************/
+
+void ptp_delayfilter_init(FAR struct ptp_delayfilter_s *filter,
+                          int length, bool use_min);
+
+/****************************************************************************
+ * Name: ptp_delayfilter_add
+ *
+ * Description:
+ *   Add a path delay measurement and return the filtered path delay.
+ *
+ ****************************************************************************/
+
+int64_t ptp_delayfilter_add(FAR struct ptp_delayfilter_s *filter,
+                            int64_t delay_ns);
+
+#endif /* __APPS_NETUTILS_PTPD_PTPD_SERVO_H */
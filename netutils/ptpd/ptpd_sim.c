@@ -0,0 +1,848 @@
+/****************************************************************************
+ * apps/netutils/ptpd/ptpd_sim.c
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/* Host simulator for the PTP client clock servo.
+ *
+ * Each input line holds the timestamps of one sync exchange, either as
+ * integer nanoseconds or as seconds.nanoseconds:
+ *
+ *   t1 t2 [t3 t4]
+ *
+ *   t1 - Sync origin timestamp from the server (remote clock)
+ *   t2 - Sync reception time (local clock)
+ *   t3 - Delay request transmission time (local clock), optional
+ *   t4 - Delay request reception time from the server, optional
+ *
+ * The local timestamps must come from the free running oscillator, i.e.
+ * be recorded with the clock undisciplined.  The simulator applies the
+ * corrections requested by the servo to them, as a PTP hardware clock
+ * would, and reports how the resulting offset behaves.  With -A they are
+ * applied like adjtime() on the system clock instead: each one is a
+ * one-shot slew over CLOCK_ADJTIME_PERIOD that stops once done.  Lines
+ * starting with '#' are ignored.
+ *
+ * Without an input file, a sequence is generated from a clock model with
+ * constant drift, random timestamping noise and occasional delayed
+ * packets.  With -w the generated sequence is printed in the input format
+ * instead, so that it can be edited and replayed.
+ */
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include "config.h"
+
+#include <ctype.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "ptpd_servo.h"
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#ifndef CONFIG_NETUTILS_PTPD_SERVO_KP
+#  define CONFIG_NETUTILS_PTPD_SERVO_KP 700
+#endif
+
+#ifndef CONFIG_NETUTILS_PTPD_SERVO_KI
+#  define CONFIG_NETUTILS_PTPD_SERVO_KI 300
+#endif
+
+#ifndef CONFIG_NETUTILS_PTPD_SETTIME_THRESHOLD_MS
+#  define CONFIG_NETUTILS_PTPD_SETTIME_THRESHOLD_MS 1000
+#endif
+
+#ifndef CONFIG_CLOCK_ADJTIME_PERIOD_MS
+#  define CONFIG_CLOCK_ADJTIME_PERIOD_MS 970
+#endif
+
+#ifndef CONFIG_CLOCK_ADJTIME_SLEWLIMIT_PPM
+#  define CONFIG_CLOCK_ADJTIME_SLEWLIMIT_PPM 500
+#endif
+
+#ifndef CONFIG_NETUTILS_PTPD_OUTLIER_THRESHOLD
+#  define CONFIG_NETUTILS_PTPD_OUTLIER_THRESHOLD 5
+#endif
+
+#ifndef CONFIG_NETUTILS_PTPD_OUTLIER_MAXCOUNT
+#  define CONFIG_NETUTILS_PTPD_OUTLIER_MAXCOUNT 5
+#endif
+
+#ifndef CONFIG_NETUTILS_PTPD_TIMEOUT_MS
+#  define CONFIG_NETUTILS_PTPD_TIMEOUT_MS 60000
+#endif
+
+#ifndef CONFIG_NETUTILS_PTPD_MAX_PATH_DELAY_NS
+#  define CONFIG_NETUTILS_PTPD_MAX_PATH_DELAY_NS 100000
+#endif
+
+#ifndef CONFIG_NETUTILS_PTPD_PATH_DELAY_WINDOW
+#  define CONFIG_NETUTILS_PTPD_PATH_DELAY_WINDOW 16
+#endif
+
+#ifdef CONFIG_NETUTILS_PTPD_PATH_DELAY_MIN
+#  define SIM_PATH_DELAY_USE_MIN true
+#else
+#  define SIM_PATH_DELAY_USE_MIN false
+#endif
+
+#define SIM_NSEC_PER_SEC  1000000000ll
+#define SIM_NSEC_PER_MSEC 1000000ll
+
+/* Remote time of the first generated sync */
+
+#define SIM_START_NS      (1000 * SIM_NSEC_PER_SEC)
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* One sync exchange, see the format description above */
+
+struct sim_sample_s
+{
+  int64_t t1;
+  int64_t t2;
+  int64_t t3;
+  int64_t t4;
+  bool has_delay;
+};
+
+/* Parameters of the generated clock model */
+
+struct sim_model_s
+{
+  int count;              /* Number of sync exchanges */
+  int interval_ms;        /* Sync interval */
+  int delayreq_every;     /* Delay request every N syncs, 0 = never */
+  int64_t offset_ns;      /* Initial local clock offset */
+  int64_t path_delay_ns;  /* One way path delay */
+  long drift_ppb;         /* Local oscillator frequency error */
+  long noise_ns;          /* Timestamp noise standard deviation */
+  int outlier_pct;        /* Percentage of delayed packets */
+  long outlier_ns;        /* Maximum extra delay of those packets */
+};
+
+/* Simulated local clock and collected statistics */
+
+struct sim_state_s
+{
+  struct ptp_servo_s servo;
+  struct ptp_delayfilter_s filter;
+  bool verbose;
+  int64_t threshold_ns;   /* Offset limit for convergence */
+
+  /* Correction applied to the raw local timestamps */
+
+  bool clock_valid;
+  int adjtime_ms;         /* Slew period of adjtime(), 0 = frequency */
+  int64_t raw_ns;         /* Raw local time of last update */
+  int64_t phase_ns;       /* Accumulated correction at raw_ns */
+  long ppb;               /* Current frequency adjustment or slew rate */
+  int64_t path_delay_ns;
+
+  /* Statistics */
+
+  int samples;
+  int jumps;
+  int outliers;
+  int64_t first_t2;
+  int offsets_count;
+  int offsets_alloc;
+  FAR int64_t *offsets;   /* Offsets of accepted samples */
+  FAR int64_t *times;     /* Raw local time of those samples */
+};
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+static void sim_usage(FAR const char *progname, int exitcode)
+{
+  fprintf(stderr, "Usage: %s [options] [file|-]\n", progname);
+  fprintf(stderr, "Servo options:\n");
+  fprintf(stderr, "  -p <kp>    Proportional gain, 1/1000 (%d)\n",
+          CONFIG_NETUTILS_PTPD_SERVO_KP);
+  fprintf(stderr, "  -i <ki>    Integral gain, 1/1000 (%d)\n",
+          CONFIG_NETUTILS_PTPD_SERVO_KI);
+  fprintf(stderr, "  -r <n>     Outlier threshold, 0 = off (%d)\n",
+          CONFIG_NETUTILS_PTPD_OUTLIER_THRESHOLD);
+  fprintf(stderr, "  -m <n>     Maximum consecutive outliers (%d)\n",
+          CONFIG_NETUTILS_PTPD_OUTLIER_MAXCOUNT);
+  fprintf(stderr, "  -W <n>     Path delay filter window (%d)\n",
+          CONFIG_NETUTILS_PTPD_PATH_DELAY_WINDOW);
+  fprintf(stderr, "  -M         Minimum instead of median path delay\n");
+  fprintf(stderr, "  -t <ns>    Convergence threshold (1000)\n");
+  fprintf(stderr, "  -A         Apply corrections with adjtime() "
+                  "(%d ms)\n", CONFIG_CLOCK_ADJTIME_PERIOD_MS);
+  fprintf(stderr, "  -v         Print every sample\n");
+  fprintf(stderr, "Generator options, when no file is given:\n");
+  fprintf(stderr, "  -n <n>     Number of syncs (600)\n");
+  fprintf(stderr, "  -I <ms>    Sync interval (1000)\n");
+  fprintf(stderr, "  -o <ns>    Initial offset (100000)\n");
+  fprintf(stderr, "  -d <ppb>   Oscillator drift (20000)\n");
+  fprintf(stderr, "  -D <ns>    Path delay (5000)\n");
+  fprintf(stderr, "  -j <ns>    Timestamp noise deviation (100)\n");
+  fprintf(stderr, "  -P <pct>   Delayed packet percentage (5)\n");
+  fprintf(stderr, "  -X <ns>    Maximum extra delay (50000)\n");
+  fprintf(stderr, "  -R <n>     Delay request every n syncs (4)\n");
+  fprintf(stderr, "  -s <seed>  Random seed (1)\n");
+  fprintf(stderr, "  -w         Write the sequence instead\n");
+  exit(exitcode);
+}
+
+/* Parse "123456789" (ns) or "12.345678901" (s) */
+
+static int sim_parsetime(FAR const char *str, FAR char **endptr,
+                         FAR int64_t *ns)
+{
+  FAR const char *ptr = str;
+  bool negative = false;
+  int64_t sec;
+  int64_t frac = 0;
+  int digits = 0;
+
+  while (isspace((unsigned char)*ptr))
+    {
+      ptr++;
+    }
+
+  if (*ptr == '-')
+    {
+      negative = true;
+      ptr++;
+    }
+
+  if (!isdigit((unsigned char)*ptr))
+    {
+      return -EINVAL;
+    }
+
+  sec = strtoll(ptr, endptr, 10);
+  ptr = *endptr;
+
+  if (*ptr != '.')
+    {
+      *ns = negative ? -sec : sec;
+      return 0;
+    }
+
+  for (ptr++; isdigit((unsigned char)*ptr); ptr++)
+    {
+      if (digits < 9)
+        {
+          frac = frac * 10 + (*ptr - '0');
+          digits++;
+        }
+    }
+
+  for (; digits < 9; digits++)
+    {
+      frac *= 10;
+    }
+
+  *endptr = (FAR char *)ptr;
+  *ns = sec * SIM_NSEC_PER_SEC + frac;
+  if (negative)
+    {
+      *ns = -*ns;
+    }
+
+  return 0;
+}
+
+static int sim_parseline(FAR const char *line,
+                         FAR struct sim_sample_s *sample)
+{
+  FAR char *ptr = (FAR char *)line;
+  int64_t values[4];
+  int count;
+
+  while (isspace((unsigned char)*ptr))
+    {
+      ptr++;
+    }
+
+  if (*ptr == '\0' || *ptr == '#')
+    {
+      return 0;
+    }
+
+  for (count = 0; count < 4; count++)
+    {
+      if (sim_parsetime(ptr, &ptr, &values[count]) < 0)
+        {
+          break;
+        }
+    }
+
+  while (isspace((unsigned char)*ptr))
+    {
+      ptr++;
+    }
+
+  if ((count != 2 && count != 4) || (*ptr != '\0' && *ptr != '#'))
+    {
+      return -EINVAL;
+    }
+
+  sample->t1 = values[0];
+  sample->t2 = values[1];
+  sample->has_delay = (count == 4);
+  if (sample->has_delay)
+    {
+      sample->t3 = values[2];
+      sample->t4 = values[3];
+    }
+
+  return 1;
+}
+
+/* Map a raw local timestamp to the disciplined local clock */
+
+static int64_t sim_localtime(FAR struct sim_state_s *sim, int64_t raw_ns)
+{
+  int64_t elapsed_ns;
+
+  if (!sim->clock_valid)
+    {
+      return raw_ns;
+    }
+
+  /* An adjtime() slew stops at the end of its period */
+
+  elapsed_ns = raw_ns - sim->raw_ns;
+  if (sim->adjtime_ms > 0 &&
+      elapsed_ns > sim->adjtime_ms * SIM_NSEC_PER_MSEC)
+    {
+      elapsed_ns = sim->adjtime_ms * SIM_NSEC_PER_MSEC;
+    }
+
+  return raw_ns + sim->phase_ns + elapsed_ns * sim->ppb / SIM_NSEC_PER_SEC;
+}
+
+/* Change the correction from raw_ns onwards.  What is left of a previous
+ * adjtime() slew is dropped, as a new call replaces it.
+ */
+
+static void sim_setclock(FAR struct sim_state_s *sim, int64_t raw_ns,
+                         int64_t step_ns, long ppb)
+{
+  int period_ms;
+
+  sim->phase_ns = sim_localtime(sim, raw_ns) - raw_ns + step_ns;
+  sim->raw_ns = raw_ns;
+  sim->ppb = ppb;
+  sim->clock_valid = true;
+
+  /* ptp_update_local_clock() asks adjtime() for the amount needed until
+   * the next sync, which is then slewed over one adjtime period.
+   */
+
+  if (sim->adjtime_ms > 0)
+    {
+      period_ms = sim->servo.interval_ms;
+      if (period_ms < sim->adjtime_ms)
+        {
+          period_ms = sim->adjtime_ms;
+        }
+
+      sim->ppb = (int64_t)ppb * period_ms / sim->adjtime_ms;
+    }
+}
+
+static void sim_record(FAR struct sim_state_s *sim, int64_t offset_ns,
+                       int64_t t2)
+{
+  FAR int64_t *ptr;
+  int newsize;
+
+  if (sim->offsets_count == sim->offsets_alloc)
+    {
+      newsize = sim->offsets_alloc ? sim->offsets_alloc * 2 : 1024;
+      ptr = realloc(sim->offsets, newsize * sizeof(int64_t));
+      if (ptr == NULL)
+        {
+          fprintf(stderr, "ERROR: Out of memory\n");
+          exit(EXIT_FAILURE);
+        }
+
+      sim->offsets = ptr;
+      ptr = realloc(sim->times, newsize * sizeof(int64_t));
+      if (ptr == NULL)
+        {
+          fprintf(stderr, "ERROR: Out of memory\n");
+          exit(EXIT_FAILURE);
+        }
+
+      sim->times = ptr;
+      sim->offsets_alloc = newsize;
+    }
+
+  sim->offsets[sim->offsets_count] = offset_ns;
+  sim->times[sim->offsets_count] = t2;
+  sim->offsets_count++;
+}
+
+/* Run one sync exchange through the path delay filter and the servo,
+ * in the same way as ptp_update_local_clock() and
+ * ptp_process_delay_resp().
+ */
+
+static void sim_process(FAR struct sim_state_s *sim,
+                        FAR const struct sim_sample_s *sample)
+{
+  enum ptp_servo_state_e state;
+  FAR const char *name;
+  int64_t local_t2;
+  int64_t offset_ns;
+  int64_t delay_ns;
+  long ppb;
+
+  if (sim->samples++ == 0)
+    {
+      sim->first_t2 = sample->t2;
+    }
+
+  local_t2 = sim_localtime(sim, sample->t2);
+  offset_ns = sample->t1 - local_t2 + sim->path_delay_ns;
+
+  state = ptp_servo_sample(&sim->servo, offset_ns, local_t2, &ppb);
+  switch (state)
+    {
+      case PTP_SERVO_JUMP:
+        name = "jump";
+        sim->jumps++;
+        sim_setclock(sim, sample->t2, offset_ns, ppb);
+        break;
+
+      case PTP_SERVO_OUTLIER:
+        name = "outlier";
+        sim->outliers++;
+        sim_setclock(sim, sample->t2, 0, ppb);
+        break;
+
+      case PTP_SERVO_LOCKED:
+        name = "locked";
+        sim_setclock(sim, sample->t2, 0, ppb);
+        sim_record(sim, offset_ns, sample->t2);
+        break;
+
+      default:
+        name = "unlocked";
+        sim_setclock(sim, sample->t2, 0, ppb);
+        break;
+    }
+
+  if (sim->verbose)
+    {
+      printf("%6d %+12" PRId64 " ns %+9ld ppb drift %+9ld ppb %s\n",
+             sim->samples, offset_ns, ppb, sim->servo.drift_ppb, name);
+    }
+
+  if (!sample->has_delay || state != PTP_SERVO_LOCKED)
+    {
+      return;
+    }
+
+  /* Path delay from the sync and delay request directions */
+
+  delay_ns = ((local_t2 - sample->t1) +
+              (sample->t4 - sim_localtime(sim, sample->t3))) / 2;
+  if (delay_ns >= 0 && delay_ns < CONFIG_NETUTILS_PTPD_MAX_PATH_DELAY_NS)
+    {
+      sim->path_delay_ns = ptp_delayfilter_add(&sim->filter, delay_ns);
+    }
+}
+
+/* Gaussian random number with zero mean and the given deviation */
+
+static double sim_gauss(double deviation)
+{
+  double u1 = (random() + 1.0) / ((double)RAND_MAX + 2.0);
+  double u2 = (random() + 1.0) / ((double)RAND_MAX + 2.0);
+
+  return deviation * sqrt(-2.0 * log(u1)) * cos(2.0 * M_PI * u2);
+}
+
+static int64_t sim_delay(FAR const struct sim_model_s *model)
+{
+  int64_t delay = model->path_delay_ns +
+                  (int64_t)sim_gauss(model->noise_ns);
+
+  if (model->outlier_pct > 0 && model->outlier_ns > 0 &&
+      random() % 100 < model->outlier_pct)
+    {
+      delay += random() % model->outlier_ns;
+    }
+
+  return delay;
+}
+
+/* Generate one sync exchange of the clock model.  Remote time is the
+ * reference, the raw local clock is off by offset_ns and runs drift_ppb
+ * too fast.
+ */
+
+static int64_t sim_rawtime(FAR const struct sim_model_s *model,
+                           int64_t remote)
+{
+  return remote - model->offset_ns +
+         (remote - SIM_START_NS) * model->drift_ppb / SIM_NSEC_PER_SEC;
+}
+
+static void sim_generate(FAR const struct sim_model_s *model, int index,
+                         FAR struct sim_sample_s *sample)
+{
+  int64_t remote;
+
+  remote = SIM_START_NS +
+           (int64_t)index * model->interval_ms * SIM_NSEC_PER_MSEC;
+
+  sample->t1 = remote;
+  sample->t2 = sim_rawtime(model, remote + sim_delay(model));
+
+  sample->has_delay = model->delayreq_every > 0 &&
+                      index % model->delayreq_every == 0;
+  if (sample->has_delay)
+    {
+      remote += model->interval_ms * SIM_NSEC_PER_MSEC / 4;
+      sample->t3 = sim_rawtime(model, remote);
+      sample->t4 = remote + sim_delay(model);
+    }
+}
+
+static int sim_compare(FAR const void *a, FAR const void *b)
+{
+  int64_t va = *(FAR const int64_t *)a;
+  int64_t vb = *(FAR const int64_t *)b;
+
+  return (va > vb) - (va < vb);
+}
+
+static void sim_report(FAR struct sim_state_s *sim)
+{
+  FAR int64_t *sorted;
+  int64_t absoffset;
+  double mean;
+  double rms;
+  int start;
+  int count;
+  int i;
+
+  /* Converged once the offset stays below the threshold until the end */
+
+  start = sim->offsets_count;
+  while (start > 0)
+    {
+      absoffset = sim->offsets[start - 1];
+      absoffset = absoffset < 0 ? -absoffset : absoffset;
+      if (absoffset > sim->threshold_ns)
+        {
+          break;
+        }
+
+      start--;
+    }
+
+  printf("Samples:         %d\n", sim->samples);
+  printf("Clock steps:     %d\n", sim->jumps);
+  printf("Outliers:        %d\n", sim->outliers);
+  printf("Drift estimate:  %+ld ppb\n", sim->servo.drift_ppb);
+  printf("Path delay:      %" PRId64 " ns\n", sim->path_delay_ns);
+
+  count = sim->offsets_count - start;
+  if (count == 0)
+    {
+      printf("Not converged to within %" PRId64 " ns\n", sim->threshold_ns);
+      return;
+    }
+
+  printf("Converged:       %.3f s (%" PRId64 " ns threshold)\n",
+         (double)(sim->times[start] - sim->first_t2) / SIM_NSEC_PER_SEC,
+         sim->threshold_ns);
+
+  /* Steady state statistics over the converged part */
+
+  sorted = malloc(count * sizeof(int64_t));
+  if (sorted == NULL)
+    {
+      fprintf(stderr, "ERROR: Out of memory\n");
+      exit(EXIT_FAILURE);
+    }
+
+  mean = 0;
+  rms = 0;
+  for (i = 0; i < count; i++)
+    {
+      sorted[i] = sim->offsets[start + i];
+      mean += sorted[i];
+      rms += (double)sorted[i] * sorted[i];
+      if (sorted[i] < 0)
+        {
+          sorted[i] = -sorted[i];
+        }
+    }
+
+  qsort(sorted, count, sizeof(int64_t), sim_compare);
+
+  printf("Steady state:    %d samples\n", count);
+  printf("  mean offset:   %+.1f ns\n", mean / count);
+  printf("  rms offset:    %.1f ns\n", sqrt(rms / count));
+  printf("  95%% |offset|:  %" PRId64 " ns\n", sorted[count * 95 / 100]);
+  printf("  max |offset|:  %" PRId64 " ns\n", sorted[count - 1]);
+
+  free(sorted);
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * main
+ ****************************************************************************/
+
+int main(int argc, FAR char *argv[])
+{
+  struct ptp_servo_config_s config;
+  struct sim_model_s model;
+  struct sim_state_s sim;
+  struct sim_sample_s sample;
+  FAR FILE *input = NULL;
+  char line[256];
+  bool use_min = SIM_PATH_DELAY_USE_MIN;
+  bool writeout = false;
+  int window = CONFIG_NETUTILS_PTPD_PATH_DELAY_WINDOW;
+  int lineno = 0;
+  int option;
+  int ret;
+  int i;
+
+  memset(&config, 0, sizeof(config));
+  config.kp = CONFIG_NETUTILS_PTPD_SERVO_KP;
+  config.ki = CONFIG_NETUTILS_PTPD_SERVO_KI;
+  config.step_threshold_ns = CONFIG_NETUTILS_PTPD_SETTIME_THRESHOLD_MS *
+                             SIM_NSEC_PER_MSEC;
+  config.max_ppb = CONFIG_CLOCK_ADJTIME_SLEWLIMIT_PPM * 1000l;
+  config.outlier_threshold = CONFIG_NETUTILS_PTPD_OUTLIER_THRESHOLD;
+  config.outlier_maxcount = CONFIG_NETUTILS_PTPD_OUTLIER_MAXCOUNT;
+  config.max_interval_ms = CONFIG_NETUTILS_PTPD_TIMEOUT_MS;
+
+  model.count = 600;
+  model.interval_ms = 1000;
+  model.delayreq_every = 4;
+  model.offset_ns = 100000;
+  model.path_delay_ns = 5000;
+  model.drift_ppb = 20000;
+  model.noise_ns = 100;
+  model.outlier_pct = 5;
+  model.outlier_ns = 50000;
+
+  memset(&sim, 0, sizeof(sim));
+  sim.threshold_ns = 1000;
+  srandom(1);
+
+  while ((option = getopt(argc, argv,
+                          "p:i:r:m:W:MAt:vn:I:o:d:D:j:P:X:R:s:wh")) != -1)
+    {
+      switch (option)
+        {
+          case 'p':
+            config.kp = atoi(optarg);
+            break;
+
+          case 'i':
+            config.ki = atoi(optarg);
+            break;
+
+          case 'r':
+            config.outlier_threshold = atoi(optarg);
+            break;
+
+          case 'm':
+            config.outlier_maxcount = atoi(optarg);
+            break;
+
+          case 'W':
+            window = atoi(optarg);
+            break;
+
+          case 'M':
+            use_min = true;
+            break;
+
+          case 'A':
+            sim.adjtime_ms = CONFIG_CLOCK_ADJTIME_PERIOD_MS;
+            break;
+
+          case 't':
+            sim.threshold_ns = atoll(optarg);
+            break;
+
+          case 'v':
+            sim.verbose = true;
+            break;
+
+          case 'n':
+            model.count = atoi(optarg);
+            break;
+
+          case 'I':
+            model.interval_ms = atoi(optarg);
+            break;
+
+          case 'o':
+            model.offset_ns = atoll(optarg);
+            break;
+
+          case 'd':
+            model.drift_ppb = atol(optarg);
+            break;
+
+          case 'D':
+            model.path_delay_ns = atoll(optarg);
+            break;
+
+          case 'j':
+            model.noise_ns = atol(optarg);
+            break;
+
+          case 'P':
+            model.outlier_pct = atoi(optarg);
+            break;
+
+          case 'X':
+            model.outlier_ns = atol(optarg);
+            break;
+
+          case 'R':
+            model.delayreq_every = atoi(optarg);
+            break;
+
+          case 's':
+            srandom(atoi(optarg));
+            break;
+
+          case 'w':
+            writeout = true;
+            break;
+
+          case 'h':
+            sim_usage(argv[0], EXIT_SUCCESS);
+            break;
+
+          default:
+            sim_usage(argv[0], EXIT_FAILURE);
+        }
+    }
+
+  if (optind + 1 < argc || model.interval_ms <= 0)
+    {
+      sim_usage(argv[0], EXIT_FAILURE);
+    }
+
+  if (optind < argc)
+    {
+      if (strcmp(argv[optind], "-") == 0)
+        {
+          input = stdin;
+        }
+      else
+        {
+          input = fopen(argv[optind], "r");
+          if (input == NULL)
+            {
+              fprintf(stderr, "ERROR: Cannot open %s: %d\n",
+                      argv[optind], errno);
+              return EXIT_FAILURE;
+            }
+        }
+    }
+
+  ptp_servo_init(&sim.servo, &config);
+  ptp_delayfilter_init(&sim.filter, window, use_min);
+
+  if (input == NULL)
+    {
+      for (i = 0; i < model.count; i++)
+        {
+          sim_generate(&model, i, &sample);
+          if (!writeout)
+            {
+              sim_process(&sim, &sample);
+            }
+          else if (sample.has_delay)
+            {
+              printf("%" PRId64 " %" PRId64 " %" PRId64 " %" PRId64 "\n",
+                     sample.t1, sample.t2, sample.t3, sample.t4);
+            }
+          else
+            {
+              printf("%" PRId64 " %" PRId64 "\n", sample.t1, sample.t2);
+            }
+        }
+
+      if (writeout)
+        {
+          return EXIT_SUCCESS;
+        }
+    }
+  else
+    {
+      while (fgets(line, sizeof(line), input) != NULL)
+        {
+          lineno++;
+          ret = sim_parseline(line, &sample);
+          if (ret < 0)
+            {
+              fprintf(stderr, "ERROR: Invalid input on line %d\n", lineno);
+              return EXIT_FAILURE;
+            }
+          else if (ret > 0)
+            {
+              sim_process(&sim, &sample);
+            }
+        }
+
+      if (input != stdin)
+        {
+          fclose(input);
+        }
+    }
+
+  sim_report(&sim);
+
+  free(sim.offsets);
+  free(sim.times);
+  return EXIT_SUCCESS;
+}
@@ -38,6 +38,7 @@
 
 #include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
 #include <sys/param.h>
 #include <nuttx/debug.h>
 #include <poll.h>
@@ -64,6 +65,10 @@
 #  define fwinfo   _none
 #endif
 
+/* The fd to poll index map grows in steps of this many descriptors */
+
+#define FDWATCH_NDXINCR 16
+
 /****************************************************************************
  * Private Data
  ****************************************************************************/
@@ -93,22 +98,27 @@ static void fdwatch_dump(const char *msg, FAR struct fdwatch_s *fw)
   fwinfo("nactive: %d next: %d\n", fw->nactive, fw->next);
   for (i = 0; i < fw->nactive; i++)
     {
-      fwinfo("%2d. %d active\n", i, fw->ready[i]);
+      fwinfo("%2d. fd %d active\n", i, fw->ready[i]);
     }
 }
 #else
 #  define fdwatch_dump(m,f)
 #endif
 
+/* Get the poll index associated with the fd.  The map is only a hint: it
+ * may be stale for fds that are no longer watched, so the hit is verified
+ * against the poll table.  That also makes the lookup O(1) without having
+ * to clear the map on delete.
+ */
+
 static int fdwatch_pollndx(FAR struct fdwatch_s *fw, int fd)
 {
   int pollndx;
 
-  /* Get the index associated with the fd */
-
-  for (pollndx = 0; pollndx < fw->nwatched; pollndx++)
+  if (fd >= 0 && fd < fw->nfdndx)
     {
-      if (fw->pollfds[pollndx].fd == fd)
+      pollndx = fw->fdndx[fd];
+      if (pollndx < fw->nwatched && fw->pollfds[pollndx].fd == fd)
         {
           fwinfo("pollndx: %d\n", pollndx);
           return pollndx;
@@ -119,6 +129,32 @@ static int fdwatch_pollndx(FAR struct fdwatch_s *fw, int fd)
   return -1;
 }
 
+/* Make sure that the fd to poll index map can hold fd */
+
+static int fdwatch_growndx(FAR struct fdwatch_s *fw, int fd)
+{
+  FAR uint8_t *fdndx;
+  int nfdndx;
+
+  if (fd < fw->nfdndx)
+    {
+      return OK;
+    }
+
+  nfdndx = (fd / FDWATCH_NDXINCR + 1) * FDWATCH_NDXINCR;
+  fdndx  = RENEW(fw->fdndx, uint8_t, fw->nfdndx, nfdndx);
+  if (!fdndx)
+    {
+      fwerr("ERROR: Failed to grow fd map to %d\n", nfdndx);
+      return -1;
+    }
+
+  memset(&fdndx[fw->nfdndx], 0, nfdndx - fw->nfdndx);
+  fw->fdndx  = fdndx;
+  fw->nfdndx = nfdndx;
+  return OK;
+}
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -154,7 +190,7 @@ struct fdwatch_s *fdwatch_initialize(int nfds)
       goto errout_with_allocations;
     }
 
-  fw->ready = (uint8_t *)httpd_malloc(sizeof(uint8_t) * nfds);
+  fw->ready = (int *)httpd_malloc(sizeof(int) * nfds);
   if (!fw->ready)
     {
       goto errout_with_allocations;
@@ -190,6 +226,11 @@ void fdwatch_uninitialize(struct fdwatch_s *fw)
           httpd_free(fw->ready);
         }
 
+      if (fw->fdndx)
+        {
+          httpd_free(fw->fdndx);
+        }
+
       httpd_free(fw);
     }
 }
@@ -207,11 +248,20 @@ void fdwatch_add_fd(struct fdwatch_s *fw, int fd, void *client_data)
       return;
     }
 
-  /* Save the new fd at the end of the list */
+  if (fdwatch_growndx(fw, fd) < 0)
+    {
+      return;
+    }
 
-  fw->pollfds[fw->nwatched].fd     = fd;
-  fw->pollfds[fw->nwatched].events = POLLIN;
-  fw->client[fw->nwatched]         = client_data;
+  /* Save the new fd at the end of the list.  It has no activity until the
+   * next poll.
+   */
+
+  fw->pollfds[fw->nwatched].fd      = fd;
+  fw->pollfds[fw->nwatched].events  = POLLIN;
+  fw->pollfds[fw->nwatched].revents = 0;
+  fw->client[fw->nwatched]          = client_data;
+  fw->fdndx[fd]                     = fw->nwatched;
 
   /* Increment the count of watched descriptors */
 
@@ -245,6 +295,7 @@ void fdwatch_del_fd(struct fdwatch_s *fw, int fd)
         {
           fw->pollfds[pollndx] = fw->pollfds[fw->nwatched];
           fw->client[pollndx]  = fw->client[fw->nwatched];
+          fw->fdndx[fw->pollfds[pollndx].fd] = pollndx;
         }
     }
 
@@ -330,17 +381,29 @@ int fdwatch_check_fd(struct fdwatch_s *fw, int fd)
   return 0;
 }
 
+/* Get the client data for the next descriptor with activity.  Only the
+ * ready list is walked, so the cost depends on the number of active
+ * descriptors rather than on the number of watched ones.  Descriptors that
+ * were deleted since the poll are skipped.
+ */
+
 void *fdwatch_get_next_client_data(struct fdwatch_s *fw)
 {
+  int pollndx;
+
   fdwatch_dump("Before getting client data:", fw);
-  if (fw->next >= fw->nwatched)
+  while (fw->next < fw->nactive)
     {
-      fwinfo("All client data returned: %d\n", fw->next);
-      return (void *)(uintptr_t)-1;
+      pollndx = fdwatch_pollndx(fw, fw->ready[fw->next++]);
+      if (pollndx >= 0)
+        {
+          fwinfo("client_data[%d]: %p\n", pollndx, fw->client[pollndx]);
+          return fw->client[pollndx];
+        }
     }
 
-  fwinfo("client_data[%d]: %p\n", fw->next, fw->client[fw->next]);
-  return fw->client[fw->next++];
+  fwinfo("All client data returned: %d\n", fw->next);
+  return (void *)(uintptr_t)-1;
 }
 
 #endif /* CONFIG_THTTPD */
@@ -60,11 +60,13 @@ struct fdwatch_s
 {
   struct pollfd *pollfds;          /* Poll data (allocated) */
   void         **client;           /* Client data (allocated) */
-  uint8_t       *ready;            /* The list of fds with activity (allocated) */
+  int           *ready;            /* List of active fds (allocated) */
+  uint8_t       *fdndx;            /* fd to poll index map (allocated) */
+  int            nfdndx;           /* The number of entries in fdndx */
   uint8_t        nfds;             /* The configured maximum number of fds */
   uint8_t        nwatched;         /* The number of fds currently watched */
   uint8_t        nactive;          /* The number of fds with activity */
-  uint8_t        next;             /* The index to the next client data */
+  uint8_t        next;             /* The index to the next ready fd */
 };
 
 /****************************************************************************
@@ -98,8 +100,8 @@ extern int fdwatch(struct fdwatch_s *fw, long timeout_msecs);
 
 extern int fdwatch_check_fd(struct fdwatch_s *fw, int fd);
 
-/* Get the client data for the next returned event.  Returns -1 when there
- * are no more events.
+/* Get the client data for the next descriptor with activity.  Returns -1
+ * when there are no more events.
  */
 
 extern void *fdwatch_get_next_client_data(struct fdwatch_s *fw);
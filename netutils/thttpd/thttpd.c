@@ -41,6 +41,7 @@
 #include <sys/stat.h>
 #include <sys/time.h>
 
+#include <inttypes.h>
 #include <stdbool.h>
 #include <stdint.h>
 #include <stdio.h>
@@ -50,6 +51,8 @@
 #include <fcntl.h>
 #include <signal.h>
 #include <errno.h>
+#include <syslog.h>
+#include <time.h>
 #include <nuttx/debug.h>
 
 #include <arpa/inet.h>
@@ -101,6 +104,18 @@ struct connect_s
   bool eof;                    /* Set true when length==0 read from file */
 };
 
+#ifdef CONFIG_THTTPD_BENCHMARK
+struct bench_s
+{
+  uint32_t turns;              /* Loop turns with active connections */
+  uint32_t maxwatched;         /* Maximum number of watched fds */
+  uint32_t maxus;              /* Maximum dispatch time (usec) */
+  uint64_t watched;            /* Sum of watched fds over all turns */
+  uint64_t active;             /* Sum of active fds over all turns */
+  uint64_t us;                 /* Sum of dispatch time (usec) */
+};
+#endif
+
 /****************************************************************************
  * Private Data
  ****************************************************************************/
@@ -109,6 +124,9 @@ static httpd_server *hs;
 static struct connect_s *free_connections;
 static struct connect_s *connects;
 static struct fdwatch_s *fw;
+#ifdef CONFIG_THTTPD_BENCHMARK
+static struct bench_s bench;
+#endif
 
 /****************************************************************************
  * Public Data
@@ -130,6 +148,9 @@ static void idle(clientdata client_data, struct timeval *nowp);
 static void linger_clear_connection(clientdata client_data,
                                     struct timeval *nowp);
 static void occasional(clientdata client_data, struct timeval *nowp);
+#ifdef CONFIG_THTTPD_BENCHMARK
+static void bench_report(clientdata client_data, struct timeval *nowp);
+#endif
 
 /****************************************************************************
  * Private Functions
@@ -643,6 +664,52 @@ static void occasional(clientdata client_data, struct timeval *nowp)
   tmr_cleanup();
 }
 
+#ifdef CONFIG_THTTPD_BENCHMARK
+static uint32_t bench_usec(FAR const struct timespec *start)
+{
+  struct timespec now;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (now.tv_sec - start->tv_sec) * 1000000 +
+         (now.tv_nsec - start->tv_nsec) / 1000;
+}
+
+static void bench_update(FAR const struct timespec *start)
+{
+  uint32_t us = bench_usec(start);
+
+  bench.turns++;
+  bench.watched += fw->nwatched;
+  bench.active  += fw->nactive;
+  bench.us      += us;
+
+  if (fw->nwatched > bench.maxwatched)
+    {
+      bench.maxwatched = fw->nwatched;
+    }
+
+  if (us > bench.maxus)
+    {
+      bench.maxus = us;
+    }
+}
+
+static void bench_report(clientdata client_data, struct timeval *nowp)
+{
+  if (bench.turns > 0)
+    {
+      syslog(LOG_INFO, "thttpd: %" PRIu32 " turns, watched avg %" PRIu64
+             " max %" PRIu32 ", active avg %" PRIu64 ", dispatch avg %"
+             PRIu64 " us max %" PRIu32 " us\n",
+             bench.turns, bench.watched / bench.turns, bench.maxwatched,
+             bench.active / bench.turns, bench.us / bench.turns,
+             bench.maxus);
+    }
+
+  memset(&bench, 0, sizeof(bench));
+}
+#endif
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -671,6 +738,9 @@ int thttpd_main(int argc, char **argv)
   FAR httpd_conn *hc;
   httpd_sockaddr sa;
   struct timeval tv;
+#ifdef CONFIG_THTTPD_BENCHMARK
+  struct timespec start;
+#endif
 #ifdef CONFIG_THTTPD_DIR
   int ret;
 #endif
@@ -740,6 +810,17 @@ int thttpd_main(int argc, char **argv)
       exit(1);
     }
 
+#ifdef CONFIG_THTTPD_BENCHMARK
+  /* Set up the benchmark report timer */
+
+  if (tmr_create(NULL, bench_report, junkclientdata,
+                 CONFIG_THTTPD_BENCHMARK_SEC * 1000L, 1) == NULL)
+    {
+      nerr("ERROR: tmr_create(bench_report) failed\n");
+      exit(1);
+    }
+#endif
+
   /* Initialize our connections table */
 
   connects = NEW(struct connect_s, AVAILABLE_FDS);
@@ -816,6 +897,10 @@ int thttpd_main(int argc, char **argv)
 
       /* Find the connections that need servicing */
 
+#ifdef CONFIG_THTTPD_BENCHMARK
+      clock_gettime(CLOCK_MONOTONIC, &start);
+#endif
+
       while ((conn = (struct connect_s *)fdwatch_get_next_client_data(fw))
              != (struct connect_s *)-1)
         {
@@ -865,6 +950,10 @@ int thttpd_main(int argc, char **argv)
             }
         }
 
+#ifdef CONFIG_THTTPD_BENCHMARK
+      bench_update(&start);
+#endif
+
       tmr_run(&tv);
     }
 
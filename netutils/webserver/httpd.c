@@ -44,6 +44,7 @@
 #include <sys/socket.h>
 #include <sys/time.h>
 #include <sys/param.h>
+#include <stdbool.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -174,6 +175,107 @@ static int httpd_openindex(struct httpd_state *pstate)
   return ret;
 }
 
+#ifdef CONFIG_NETUTILS_HTTPD_GZIP
+/* Check whether an Accept-Encoding list allows gzip.  A q-value of zero
+ * explicitly refuses the coding.
+ */
+
+static bool httpd_acceptgzip(FAR const char *value)
+{
+  FAR const char *ptr = value;
+  FAR const char *end;
+  size_t len;
+
+  while (*ptr != '\0')
+    {
+      ptr += strspn(ptr, " \t,");
+      end  = ptr + strcspn(ptr, ",");
+      len  = strcspn(ptr, " \t;,");
+
+      if ((len == 4 && strncasecmp(ptr, "gzip", 4) == 0) ||
+          (len == 6 && strncasecmp(ptr, "x-gzip", 6) == 0))
+        {
+          for (ptr += len; ptr < end; ptr++)
+            {
+              if (*ptr != ';')
+                {
+                  continue;
+                }
+
+              ptr += 1 + strspn(ptr + 1, " \t");
+              if ((*ptr != 'q' && *ptr != 'Q') || ptr[1] != '=' ||
+                  ptr[2] != '0')
+                {
+                  continue;
+                }
+
+              /* "0", "0." or "0.000" */
+
+              ptr += 3;
+              if (*ptr == '.')
+                {
+                  ptr += 1 + strspn(ptr + 1, "0");
+                }
+
+              return *ptr >= '1' && *ptr <= '9';
+            }
+
+          return true;
+        }
+
+      ptr = end;
+    }
+
+  return false;
+}
+
+static int httpd_opengzip(struct httpd_state *pstate)
+{
+  char name[HTTPD_MAX_FILENAME + sizeof(".gz")];
+#ifndef CONFIG_NETUTILS_HTTPD_SCRIPT_DISABLE
+  const char *ptr;
+#endif
+  size_t z;
+
+  pstate->ht_gzip = false;
+
+  z = strlen(pstate->ht_filename);
+  if (!pstate->ht_acceptgzip || z == 0 ||
+      pstate->ht_filename[z - 1] == '/')
+    {
+      return ERROR;
+    }
+
+#ifndef CONFIG_NETUTILS_HTTPD_SCRIPT_DISABLE
+  /* Scripts are processed on the fly, they can't be precompressed */
+
+  ptr = strchr(pstate->ht_filename, ISO_PERIOD);
+  if (ptr != NULL && strncmp(ptr, ".shtml", strlen(".shtml")) == 0)
+    {
+      return ERROR;
+    }
+#endif
+
+  /* The ROM file system lookup matches prefixes by default, which would
+   * find <name> itself.  The .gz name must match exactly.
+   */
+
+  snprintf(name, sizeof(name), "%s.gz", pstate->ht_filename);
+#if defined(CONFIG_NETUTILS_HTTPD_CLASSIC)
+  if (httpd_fs_openexact(name, &pstate->ht_file) != OK)
+#else
+  if (httpd_open(name, &pstate->ht_file) != OK)
+#endif
+    {
+      return ERROR;
+    }
+
+  ninfo("[%d] sending '%s'\n", pstate->ht_sockfd, name);
+  pstate->ht_gzip = true;
+  return OK;
+}
+#endif
+
 static int httpd_close(struct httpd_fs_file *file)
 {
 #if defined(CONFIG_NETUTILS_HTTPD_CLASSIC)
@@ -445,7 +547,12 @@ static int httpd_sendfile(struct httpd_state *pstate)
     }
 #endif
 
+#ifdef CONFIG_NETUTILS_HTTPD_GZIP
+  if (httpd_opengzip(pstate) != OK &&
+      httpd_openindex(pstate) != OK)
+#else
   if (httpd_openindex(pstate) != OK)
+#endif
     {
       nwarn("WARNING: [%d] '%s' not found\n",
            pstate->ht_sockfd, pstate->ht_filename);
@@ -510,6 +617,11 @@ static inline int httpd_parse(struct httpd_state *pstate)
   state = STATE_METHOD;
   o = pstate->ht_buffer;
 
+#ifdef CONFIG_NETUTILS_HTTPD_GZIP
+  pstate->ht_acceptgzip = false;
+  pstate->ht_gzip       = false;
+#endif
+
   do
     {
       char *start;
@@ -641,6 +753,13 @@ static inline int httpd_parse(struct httpd_state *pstate)
               {
                 pstate->ht_keepalive = true;
               }
+#endif
+#ifdef CONFIG_NETUTILS_HTTPD_GZIP
+            else if (0 == strcasecmp(start, "Accept-Encoding") &&
+                     httpd_acceptgzip(v))
+              {
+                pstate->ht_acceptgzip = true;
+              }
 #endif
             break;
 
@@ -1042,6 +1161,9 @@ int httpd_send_headers(struct httpd_state *pstate, int status, int len)
                     "Connection: %s\r\n"
                     "Content-type: %s\r\n"
                     "%s"
+#ifdef CONFIG_NETUTILS_HTTPD_GZIP
+                    "%s"
+#endif
                     "\r\n",
                     status,
                     status >= 400 ? "Error" : "OK",
@@ -1052,6 +1174,11 @@ int httpd_send_headers(struct httpd_state *pstate, int status, int len)
 #endif
                     mime,
                     contentlen
+#ifdef CONFIG_NETUTILS_HTTPD_GZIP
+                    , pstate->ht_gzip ?
+                    "Content-Encoding: gzip\r\nVary: Accept-Encoding\r\n" :
+                    ""
+#endif
                     );
 
   return send_chunk(pstate, header, hdrlen);
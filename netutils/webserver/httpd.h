@@ -72,6 +72,7 @@ int  httpd_mmap_close(struct httpd_fs_file *file);
 #else
 
 int  httpd_fs_open(const char *name, struct httpd_fs_file *file);
+int  httpd_fs_openexact(const char *name, struct httpd_fs_file *file);
 void httpd_fs_init(void);
 
 #endif
@@ -39,8 +39,10 @@
  * Included Header Files
  ****************************************************************************/
 
+#include <stdbool.h>
 #include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "netutils/httpd.h"
 
@@ -50,6 +52,11 @@
  * Pre-processor Definitions
  ****************************************************************************/
 
+/* FNV-1a hash parameters */
+
+#define HTTPD_FS_FNV_OFFSET 2166136261u
+#define HTTPD_FS_FNV_PRIME  16777619u
+
 /****************************************************************************
  * Private Data
  ****************************************************************************/
@@ -58,6 +65,16 @@
 static uint16_t *count;
 #endif
 
+/* Hash index over g_httpdfs_root, built by httpd_fs_init().  g_files holds
+ * the files in list order and the open addressed hash table holds file
+ * numbers + 1 (0 marks an empty slot).  The table is sized to at least
+ * twice the number of files to keep the probe sequences short.
+ */
+
+static FAR const struct httpd_fsdata_file **g_files;
+static FAR uint16_t *g_hash;
+static uint32_t g_hashmask;
+
 /****************************************************************************
  * Private Functions
  ****************************************************************************/
@@ -83,36 +100,179 @@ static uint8_t httpd_fs_strcmp(const char *str1, const char *str2)
     }
 }
 
-/****************************************************************************
- * Public Functions
- ****************************************************************************/
+static uint32_t httpd_fs_hash(const char *name, size_t len)
+{
+  uint32_t hash = HTTPD_FS_FNV_OFFSET;
 
-int httpd_fs_open(const char *name, struct httpd_fs_file *file)
+  while (len-- > 0)
+    {
+      hash ^= (uint8_t)*name++;
+      hash *= HTTPD_FS_FNV_PRIME;
+    }
+
+  return hash;
+}
+
+/* Names may be terminated by CR or LF when they come from a script */
+
+static bool httpd_fs_nameeq(const char *name, size_t len,
+                            const char *fname)
 {
-#ifdef CONFIG_NETUTILS_HTTPDFSSTATS
-  uint16_t i = 0;
-#endif
-  struct httpd_fsdata_file_noconst *f;
+  return strncmp(fname, name, len) == 0 && fname[len] == '\0';
+}
 
-  for (f = (struct httpd_fsdata_file_noconst *)g_httpdfs_root;
-       f != NULL;
-       f = (struct httpd_fsdata_file_noconst *)f->next)
+static int httpd_fs_lookup(const char *name)
+{
+  uint32_t slot;
+  uint16_t ndx;
+  size_t len;
+
+  len = strcspn(name, "\r\n");
+
+  for (slot = httpd_fs_hash(name, len) & g_hashmask;
+       (ndx = g_hash[slot]) != 0;
+       slot = (slot + 1) & g_hashmask)
     {
-      if (httpd_fs_strcmp(name, f->name) == 0)
+      if (httpd_fs_nameeq(name, len,
+                          (const char *)g_files[ndx - 1]->name))
         {
-          file->data = f->data;
-          file->len  = f->len;
-#ifdef CONFIG_NETUTILS_HTTPDFSSTATS
-          ++count[i];
-#endif
-          return OK;
+          return ndx - 1;
         }
+    }
+
+  return ERROR;
+}
+
+static const struct httpd_fsdata_file *httpd_fs_find(const char *name,
+                                                     bool exact, int *ndx)
+{
+  const struct httpd_fsdata_file *f;
+  size_t len;
+  int i;
+
+  /* Look up the exact name in the hash index */
+
+  if (g_hash != NULL)
+    {
+      i = httpd_fs_lookup(name);
+      if (i >= 0)
+        {
+          *ndx = i;
+          return g_files[i];
+        }
+
+      if (exact)
+        {
+          return NULL;
+        }
+    }
+
+  /* Otherwise walk the list.  Unless an exact match is required, the
+   * prefix match also accepts names with trailing data (e.g. a query
+   * string), but then "/style.css.gz" would match "/style.css" too.
+   */
+
+  len = strcspn(name, "\r\n");
+
+  for (f = g_httpdfs_root, i = 0; f != NULL; f = f->next, i++)
+    {
+      if (exact ? httpd_fs_nameeq(name, len, (const char *)f->name) :
+          httpd_fs_strcmp(name, (const char *)f->name) == 0)
+        {
+          *ndx = i;
+          return f;
+        }
+    }
+
+  return NULL;
+}
+
+static int httpd_fs_openfile(const char *name, bool exact,
+                             struct httpd_fs_file *file)
+{
+  const struct httpd_fsdata_file *f;
+  int i;
+
+  f = httpd_fs_find(name, exact, &i);
+  if (f == NULL)
+    {
+      return ERROR;
+    }
+
+  file->data = (FAR char *)f->data;
+  file->len  = f->len;
 #ifdef CONFIG_NETUTILS_HTTPDFSSTATS
-      ++i;
+  ++count[i];
 #endif
+  return OK;
+}
+
+static void httpd_fs_index(void)
+{
+  const struct httpd_fsdata_file *f;
+  uint32_t size;
+  uint32_t slot;
+  int i;
+
+  if (g_hash != NULL || g_httpd_numfiles <= 0)
+    {
+      return;
     }
 
-  return ERROR;
+  size = 2;
+  while (size < 2 * (uint32_t)g_httpd_numfiles)
+    {
+      size <<= 1;
+    }
+
+  g_files = malloc(g_httpd_numfiles * sizeof(*g_files));
+  g_hash  = calloc(size, sizeof(*g_hash));
+  if (g_files == NULL || g_hash == NULL)
+    {
+      /* Lookups fall back to the list */
+
+      free(g_files);
+      free(g_hash);
+      g_files = NULL;
+      g_hash  = NULL;
+      return;
+    }
+
+  g_hashmask = size - 1;
+
+  for (f = g_httpdfs_root, i = 0; f != NULL && i < g_httpd_numfiles;
+       f = f->next, i++)
+    {
+      g_files[i] = f;
+
+      /* Keep the first of duplicate names, like the list walk does */
+
+      if (httpd_fs_lookup((const char *)f->name) < 0)
+        {
+          slot = httpd_fs_hash((const char *)f->name,
+                               strlen((const char *)f->name)) & g_hashmask;
+          while (g_hash[slot] != 0)
+            {
+              slot = (slot + 1) & g_hashmask;
+            }
+
+          g_hash[slot] = i + 1;
+        }
+    }
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+int httpd_fs_open(const char *name, struct httpd_fs_file *file)
+{
+  return httpd_fs_openfile(name, false, file);
+}
+
+int httpd_fs_openexact(const char *name, struct httpd_fs_file *file)
+{
+  return httpd_fs_openfile(name, true, file);
 }
 
 void httpd_fs_init(void)
@@ -127,24 +287,18 @@ void httpd_fs_init(void)
       count[i] = 0;
     }
 #endif
+
+  httpd_fs_index();
 }
 
 #ifdef CONFIG_NETUTILS_HTTPDFSSTATS
 uint16_t httpd_fs_count(char *name)
 {
-  struct httpd_fsdata_file_noconst *f;
-  uint16_t i;
+  int i;
 
-  i = 0;
-  for (f = (struct httpd_fsdata_file_noconst *)g_httpdfs_root;
-      f != NULL;
-      f = (struct httpd_fsdata_file_noconst *)f->next)
+  if (httpd_fs_find(name, false, &i) != NULL)
     {
-      if (httpd_fs_strcmp(name, f->name) == 0)
-        {
-          return count[i];
-        }
-      ++i;
+      return count[i];
     }
 
   return 0;
@@ -501,6 +501,7 @@
 /* Suppress unused file utilities */
 
 #define NSH_HAVE_CATFILE          1
+#define NSH_HAVE_SENDFD           1
 #define NSH_HAVE_WRITEFILE        1
 #define NSH_HAVE_READFILE         1
 #define NSH_HAVE_FOREACH_DIRENTRY 1
@@ -529,6 +530,12 @@
 #  undef NSH_HAVE_CATFILE
 #endif
 
+/* nsh_sendfd used by nsh_catfile, cat and cp */
+
+#if !defined(NSH_HAVE_CATFILE) && defined(CONFIG_NSH_DISABLE_CP)
+#  undef NSH_HAVE_SENDFD
+#endif
+
 /* nsh_readfile used by ps command */
 
 #if defined(CONFIG_NSH_DISABLE_PS)
@@ -1325,6 +1332,31 @@ int nsh_catfile(FAR struct nsh_vtbl_s *vtbl, FAR const char *cmd,
                 FAR const char *filepath);
 #endif
 
+/****************************************************************************
+ * Name: nsh_sendfd
+ *
+ * Description:
+ *   Copy everything from one file descriptor to another, or to the current
+ *   NSH terminal.  Regular files are sent with sendfile(), so the data
+ *   doesn't pass through a user buffer.  Other files, or if sendfile() is
+ *   not supported, are copied through a buffer.
+ *
+ * Input Paratemets:
+ *   vtbl     - The console vtable
+ *   cmd      - NSH command name to use in error reporting
+ *   outfd    - The output file descriptor, or -1 for the NSH terminal
+ *   infd     - The input file descriptor
+ *
+ * Returned Value:
+ *   The number of bytes copied on success; -1 (ERROR) on failure.
+ *
+ ****************************************************************************/
+
+#ifdef NSH_HAVE_SENDFD
+ssize_t nsh_sendfd(FAR struct nsh_vtbl_s *vtbl, FAR const char *cmd,
+                   int outfd, int infd);
+#endif
+
 /****************************************************************************
  * Name: nsh_readfile
  *
@@ -34,6 +34,10 @@
 #  include <nuttx/lib/builtin.h>
 #endif
 
+#ifdef CONFIG_NSH_BUILTIN_AS_COMMAND
+#  include "builtin/builtin.h"
+#endif
+
 #if defined(CONFIG_SYSTEM_READLINE) && defined(CONFIG_READLINE_HAVE_EXTMATCH)
 #  include "system/readline.h"
 #endif
@@ -105,21 +109,26 @@ static int  cmd_unrecognized(FAR struct nsh_vtbl_s *vtbl, int argc,
  * Private Data
  ****************************************************************************/
 
+/* The command table is looked up by binary search, so the entries must be
+ * kept in strcmp() order of the command name.  Entries that share a
+ * conditional are split up so that each can be put in its place.
+ */
+
 static const struct cmdmap_s g_cmdmap[] =
 {
 #if !defined(CONFIG_NSH_DISABLESCRIPT) && !defined(CONFIG_NSH_DISABLE_SOURCE)
   CMD_MAP(".",        cmd_source,   2, 2, "<script-path>"),
 #endif
 
+#ifndef CONFIG_NSH_DISABLE_HELP
+  CMD_MAP("?",        cmd_help,     1, 1, NULL),
+#endif
+
 #if !defined(CONFIG_NSH_DISABLESCRIPT) && !defined(CONFIG_NSH_DISABLE_TEST)
   CMD_MAP("[",        cmd_lbracket,
           4, CONFIG_NSH_MAXARGUMENTS, "<expression> ]"),
 #endif
 
-#ifndef CONFIG_NSH_DISABLE_HELP
-  CMD_MAP("?",        cmd_help,     1, 1, NULL),
-#endif
-
 #if defined(CONFIG_NET) && defined(CONFIG_NET_ROUTE) && !defined(CONFIG_NSH_DISABLE_ADDROUTE)
   CMD_MAP("addroute", cmd_addroute, 3, 4, "<target> [<netmask>] <router>"),
 #endif
@@ -127,8 +136,6 @@ static const struct cmdmap_s g_cmdmap[] =
 #ifdef CONFIG_NSH_ALIAS
   CMD_MAP("alias",    cmd_alias,    1, CONFIG_NSH_MAXARGUMENTS,
     "[name[=value] ... ]"),
-  CMD_MAP("unalias",  cmd_unalias,  1, CONFIG_NSH_MAXARGUMENTS,
-    "[-a] name [name ... ]"),
 #endif
 
 #if defined(CONFIG_NET) && defined(CONFIG_NET_ARP) && !defined(CONFIG_NSH_DISABLE_ARP)
@@ -161,18 +168,13 @@ static const struct cmdmap_s g_cmdmap[] =
 
 #ifndef CONFIG_NSH_DISABLE_CAT
   CMD_MAP("cat",      cmd_cat,      1, CONFIG_NSH_MAXARGUMENTS,
-    "[<path> [<path> [<path> ...]]]"),
+    "[-t] [<path> [<path> [<path> ...]]]"),
 #endif
 
 #ifndef CONFIG_NSH_DISABLE_CD
   CMD_MAP("cd",       cmd_cd,       1, 2, "[<dir-path>|-|~|..]"),
 #endif
 
-#if defined(CONFIG_FS_CHROOT) && !defined(CONFIG_NSH_DISABLE_CHROOT)
-  CMD_MAP("chroot",   cmd_chroot,   2, CONFIG_NSH_MAXARGUMENTS,
-    "<newroot> [<command> [args...]]"),
-#endif
-
 #if defined(CONFIG_FS_PERMISSION) && !defined(CONFIG_NSH_DISABLE_CHMOD)
   CMD_MAP("chmod",    cmd_chmod,    3, 3, "<octal-mode> <path>"),
 #endif
@@ -181,16 +183,18 @@ static const struct cmdmap_s g_cmdmap[] =
   CMD_MAP("chown",    cmd_chown,    3, 3, "[<uid>][:<gid>] <path>"),
 #endif
 
-#ifndef CONFIG_NSH_DISABLE_CP
-  CMD_MAP("cp",       cmd_cp,       3, 4, "[-r] <source-path> <dest-path>"),
+#if defined(CONFIG_FS_CHROOT) && !defined(CONFIG_NSH_DISABLE_CHROOT)
+  CMD_MAP("chroot",   cmd_chroot,   2, CONFIG_NSH_MAXARGUMENTS,
+    "<newroot> [<command> [args...]]"),
 #endif
 
 #ifndef CONFIG_NSH_DISABLE_CMP
   CMD_MAP("cmp",      cmd_cmp,      3, 3, "<path1> <path2>"),
 #endif
 
-#ifndef CONFIG_NSH_DISABLE_DIRNAME
-  CMD_MAP("dirname",  cmd_dirname,  2, 2, "<path>"),
+#ifndef CONFIG_NSH_DISABLE_CP
+  CMD_MAP("cp",       cmd_cp,       3, 5,
+    "[-r] [-t] <source-path> <dest-path>"),
 #endif
 
 #ifndef CONFIG_NSH_DISABLE_DATE
@@ -212,10 +216,19 @@ static const struct cmdmap_s g_cmdmap[] =
 #endif
 #endif
 
+#ifndef CONFIG_NSH_DISABLE_DIRNAME
+  CMD_MAP("dirname",  cmd_dirname,  2, 2, "<path>"),
+#endif
+
 #if defined(CONFIG_SYSLOG_DEVPATH) && !defined(CONFIG_NSH_DISABLE_DMESG)
   CMD_MAP("dmesg",    cmd_dmesg,    1, 2, "[-c,--clear |-C,--read-clear]"),
 #endif
 
+#ifndef CONFIG_NSH_DISABLE_DU
+  CMD_MAP("du",       cmd_du,       1, 7,
+    "[-h] [-s] [-a] [-d N] <path>..."),
+#endif
+
 #ifndef CONFIG_NSH_DISABLE_ECHO
 #  ifndef CONFIG_DISABLE_ENVIRON
   CMD_MAP("echo",     cmd_echo,     1, CONFIG_NSH_MAXARGUMENTS,
@@ -238,15 +251,15 @@ static const struct cmdmap_s g_cmdmap[] =
   CMD_MAP("exit",     cmd_exit,     1, 1, NULL),
 #endif
 
+#ifndef CONFIG_NSH_DISABLE_EXPORT
+  CMD_MAP("export",   cmd_export,   2, 3, "[<name> [<value>]]"),
+#endif
+
 #ifndef CONFIG_NSH_DISABLE_EXPR
   CMD_MAP("expr",     cmd_expr,     4, 4,
     "<operand1> <operator> <operand2>"),
 #endif
 
-#ifndef CONFIG_NSH_DISABLE_EXPORT
-  CMD_MAP("export",   cmd_export,   2, 3, "[<name> [<value>]]"),
-#endif
-
 #ifndef CONFIG_NSH_DISABLESCRIPT
   CMD_MAP("false",    cmd_false,    1, 1, NULL),
 #endif
@@ -261,17 +274,6 @@ static const struct cmdmap_s g_cmdmap[] =
   CMD_MAP("free",     cmd_free,     1, 1, NULL),
 #endif
 
-#if defined(CONFIG_SCHED_USER_IDENTITY) && !defined(CONFIG_NSH_DISABLE_ID)
-  CMD_MAP("id",       cmd_id,       1, 1, NULL),
-#endif
-
-#ifdef CONFIG_DEBUG_MM
-#  ifndef CONFIG_NSH_DISABLE_MEMDUMP
-  CMD_MAP("memdump",  cmd_memdump,
-          1, 4, "[pid/used/free/on/off]" " <minseq> <maxseq>"),
-#  endif
-#endif
-
 #ifdef CONFIG_NET_UDP
 #  ifndef CONFIG_NSH_DISABLE_GET
   CMD_MAP("get",      cmd_get,      4, 7,
@@ -296,45 +298,41 @@ static const struct cmdmap_s g_cmdmap[] =
 #endif
 #endif
 
-#ifdef CONFIG_NET
-#  ifndef CONFIG_NSH_DISABLE_IFCONFIG
+#if defined(CONFIG_SCHED_USER_IDENTITY) && !defined(CONFIG_NSH_DISABLE_ID)
+  CMD_MAP("id",       cmd_id,       1, 1, NULL),
+#endif
+
+#if defined(CONFIG_NET) && !defined(CONFIG_NSH_DISABLE_IFCONFIG)
   CMD_MAP("ifconfig", cmd_ifconfig, 1, 12,
     "[interface [mtu <len>]|[address_family] [[add|del] <ip-address>|dhcp]]"
     "[dr|gw|gateway <dr-address>] [netmask <net-mask>|prefixlen <len>] "
     "[dns <dns-address>] [hw <hw-mac>] [up|down]"),
-#  endif
-#  if defined(CONFIG_NET_VLAN) && !defined(CONFIG_NSH_DISABLE_VCONFIG)
-  CMD_MAP("vconfig", cmd_vconfig, 3, 5,
-    "[add iface-name vlan-id [pcp]]|[rem vlan-name]"),
-#  endif
-#  ifndef CONFIG_NSH_DISABLE_IFUPDOWN
+#endif
+
+#if defined(CONFIG_NET) && !defined(CONFIG_NSH_DISABLE_IFUPDOWN)
   CMD_MAP("ifdown",   cmd_ifdown,   2, 2, "<interface>"),
   CMD_MAP("ifup",     cmd_ifup,     2, 2, "<interface>"),
-#  endif
 #endif
 
 #if defined(CONFIG_MODULE) && !defined(CONFIG_NSH_DISABLE_MODCMDS)
   CMD_MAP("insmod",   cmd_insmod,   3, 3, "<file-path> <module-name>"),
 #endif
 
+#if defined(CONFIG_BOARDCTL_IRQ_AFFINITY) && !defined(CONFIG_NSH_DISABLE_IRQ_AFFINITY)
+  CMD_MAP("irqaff", cmd_irq_affinity, 3, 3,
+    "irqaff [IRQ Number] [Core Mask]"),
+#endif
+
 #ifdef HAVE_IRQINFO
   CMD_MAP("irqinfo",  cmd_irqinfo,  1, 1, NULL),
 #endif
 
-#ifndef CONFIG_DISABLE_MOUNTPOINT
-#  if defined(CONFIG_DEV_LOOP) && !defined(CONFIG_NSH_DISABLE_LOSETUP)
-  CMD_MAP("losetup",  cmd_losetup,  3, 6,
-    "[-d <dev-path>] | [[-o <offset>] [-r] [-b <sect-size>] "
-    "<dev-path> <file-path>]"),
-#  endif
+#if !defined(CONFIG_DISABLE_ALL_SIGNALS) && !defined(CONFIG_NSH_DISABLE_KILL)
+  CMD_MAP("kill",     cmd_kill,     2, 3, "[-<signal>] <pid>"),
 #endif
 
-#ifndef CONFIG_DISABLE_MOUNTPOINT
-#  if defined(CONFIG_SMART_DEV_LOOP) && !defined(CONFIG_NSH_DISABLE_LOSMART)
-  CMD_MAP("losmart",  cmd_losmart,  2, 11,
-    "[-d <dev-path>] | [[-m <minor>] [-o <offset>] [-e <erase-size>] "
-    "[-s <sect-size>] [-r] <file-path>]"),
-#  endif
+#if !defined(CONFIG_NSH_DISABLE_LN) && defined(CONFIG_PSEUDOFS_SOFTLINKS)
+  CMD_MAP("ln",       cmd_ln,       3, 4, "[-s] <target> <link>"),
 #endif
 
 #ifndef CONFIG_DISABLE_MOUNTPOINT
@@ -351,17 +349,24 @@ static const struct cmdmap_s g_cmdmap[] =
 #  endif
 #endif
 
-#if !defined(CONFIG_NSH_DISABLE_LN) && defined(CONFIG_PSEUDOFS_SOFTLINKS)
-  CMD_MAP("ln",       cmd_ln,       3, 4, "[-s] <target> <link>"),
+#ifndef CONFIG_DISABLE_MOUNTPOINT
+#  if defined(CONFIG_DEV_LOOP) && !defined(CONFIG_NSH_DISABLE_LOSETUP)
+  CMD_MAP("losetup",  cmd_losetup,  3, 6,
+    "[-d <dev-path>] | [[-o <offset>] [-r] [-b <sect-size>] "
+    "<dev-path> <file-path>]"),
+#  endif
 #endif
 
-#ifndef CONFIG_NSH_DISABLE_LS
-  CMD_MAP("ls",       cmd_ls,       1, 5, "[-lRsh] <dir-path>"),
+#ifndef CONFIG_DISABLE_MOUNTPOINT
+#  if defined(CONFIG_SMART_DEV_LOOP) && !defined(CONFIG_NSH_DISABLE_LOSMART)
+  CMD_MAP("losmart",  cmd_losmart,  2, 11,
+    "[-d <dev-path>] | [[-m <minor>] [-o <offset>] [-e <erase-size>] "
+    "[-s <sect-size>] [-r] <file-path>]"),
+#  endif
 #endif
 
-#ifndef CONFIG_NSH_DISABLE_DU
-  CMD_MAP("du",       cmd_du,       1, 7,
-    "[-h] [-s] [-a] [-d N] <path>..."),
+#ifndef CONFIG_NSH_DISABLE_LS
+  CMD_MAP("ls",       cmd_ls,       1, 5, "[-lRsh] <dir-path>"),
 #endif
 
 #if defined(CONFIG_MODULE) && !defined(CONFIG_NSH_DISABLE_MODCMDS)
@@ -382,6 +387,18 @@ static const struct cmdmap_s g_cmdmap[] =
 #  endif
 #endif
 
+#ifdef CONFIG_DEBUG_MM
+#  ifndef CONFIG_NSH_DISABLE_MEMDUMP
+  CMD_MAP("memdump",  cmd_memdump,
+          1, 4, "[pid/used/free/on/off]" " <minseq> <maxseq>"),
+#  endif
+#endif
+
+#ifndef CONFIG_NSH_DISABLE_MH
+  CMD_MAP("mh",       cmd_mh,       2, 3,
+    "<hex-address>[=<hex-value>] [<hex-byte-count>]"),
+#endif
+
 #ifdef NSH_HAVE_DIROPTS
 #  ifndef CONFIG_NSH_DISABLE_MKDIR
   CMD_MAP("mkdir",    cmd_mkdir,    2, 3, "[-p] <path>"),
@@ -420,11 +437,6 @@ static const struct cmdmap_s g_cmdmap[] =
 #  endif
 #endif
 
-#ifndef CONFIG_NSH_DISABLE_MH
-  CMD_MAP("mh",       cmd_mh,       2, 3,
-    "<hex-address>[=<hex-value>] [<hex-byte-count>]"),
-#endif
-
 #if !defined(CONFIG_DISABLE_MOUNTPOINT)
 #  ifndef CONFIG_NSH_DISABLE_MOUNT
 #    if defined(NSH_HAVE_CATFILE) && defined(HAVE_MOUNT_LIST)
@@ -472,6 +484,11 @@ static const struct cmdmap_s g_cmdmap[] =
   CMD_MAP("pidof",   cmd_pidof, 2, 2, "<name>"),
 #endif
 
+#if !defined(CONFIG_DISABLE_ALL_SIGNALS) && defined(CONFIG_FS_PROCFS) && \
+    !defined(CONFIG_NSH_DISABLE_PKILL)
+  CMD_MAP("pkill",     cmd_pkill,     2, 3, "[-<signal>] <name>"),
+#endif
+
 #if defined(CONFIG_PM) && !defined(CONFIG_NSH_DISABLE_PMCONFIG)
   CMD_MAP("pmconfig", cmd_pmconfig, 1, 4,
     "[stay|relax] [normal|idle|standby|sleep] [domain]"),
@@ -479,7 +496,6 @@ static const struct cmdmap_s g_cmdmap[] =
 
 #if defined(CONFIG_BOARDCTL_POWEROFF) && !defined(CONFIG_NSH_DISABLE_POWEROFF)
   CMD_MAP("poweroff", cmd_poweroff, 1, 2, NULL),
-  CMD_MAP("quit", cmd_poweroff, 1, 2, NULL),
 #endif
 
 #ifndef CONFIG_NSH_DISABLE_PRINTF
@@ -508,6 +524,10 @@ static const struct cmdmap_s g_cmdmap[] =
   CMD_MAP("pwd",      cmd_pwd,      1, 1, NULL),
 #endif
 
+#if defined(CONFIG_BOARDCTL_POWEROFF) && !defined(CONFIG_NSH_DISABLE_POWEROFF)
+  CMD_MAP("quit", cmd_poweroff, 1, 2, NULL),
+#endif
+
 #if !defined(CONFIG_NSH_DISABLE_READLINK) && defined(CONFIG_PSEUDOFS_SOFTLINKS)
   CMD_MAP("readlink", cmd_readlink, 2, 2, "<link>"),
 #endif
@@ -520,11 +540,6 @@ static const struct cmdmap_s g_cmdmap[] =
   CMD_MAP("resetcause", cmd_reset_cause, 1, 1, NULL),
 #endif
 
-#if defined(CONFIG_BOARDCTL_IRQ_AFFINITY) && !defined(CONFIG_NSH_DISABLE_IRQ_AFFINITY)
-  CMD_MAP("irqaff", cmd_irq_affinity, 3, 3,
-    "irqaff [IRQ Number] [Core Mask]"),
-#endif
-
 #ifdef NSH_HAVE_DIROPTS
 #  ifndef CONFIG_NSH_DISABLE_RM
   CMD_MAP("rm",       cmd_rm,       2, 3, "[-rf] <file-path>"),
@@ -585,10 +600,6 @@ static const struct cmdmap_s g_cmdmap[] =
 #endif
 #endif /* CONFIG_NSH_DISABLE_SET */
 
-#if defined(CONFIG_SCHED_USER_IDENTITY) && !defined(CONFIG_NSH_DISABLE_SU)
-  CMD_MAP("su",       cmd_su,       1, 2, "[<username>]"),
-#endif
-
 #ifndef CONFIG_NSH_DISABLE_SHUTDOWN
 #if defined(CONFIG_BOARDCTL_POWEROFF) && defined(CONFIG_BOARDCTL_RESET)
   CMD_MAP("shutdown", cmd_shutdown, 1, 2, "[--reboot]"),
@@ -599,28 +610,18 @@ static const struct cmdmap_s g_cmdmap[] =
 #endif
 #endif
 
-#ifndef CONFIG_DISABLE_ALL_SIGNALS
-#ifndef CONFIG_NSH_DISABLE_KILL
-  CMD_MAP("kill",     cmd_kill,     2, 3, "[-<signal>] <pid>"),
-#endif
-
-#if defined(CONFIG_FS_PROCFS) && !defined(CONFIG_NSH_DISABLE_PKILL)
-  CMD_MAP("pkill",     cmd_pkill,     2, 3, "[-<signal>] <name>"),
-#endif
-
-#ifndef CONFIG_NSH_DISABLE_SLEEP
+#if !defined(CONFIG_DISABLE_ALL_SIGNALS) && !defined(CONFIG_NSH_DISABLE_SLEEP)
   CMD_MAP("sleep",    cmd_sleep,    2, 2, "<sec>"),
 #endif
 
-#ifndef CONFIG_NSH_DISABLE_USLEEP
-  CMD_MAP("usleep",   cmd_usleep,   2, 2, "<usec>"),
-#endif
-#endif
-
 #if !defined(CONFIG_NSH_DISABLESCRIPT) && !defined(CONFIG_NSH_DISABLE_SOURCE)
   CMD_MAP("source",   cmd_source,   2, 2, "<script-path>"),
 #endif
 
+#if defined(CONFIG_SCHED_USER_IDENTITY) && !defined(CONFIG_NSH_DISABLE_SU)
+  CMD_MAP("su",       cmd_su,       1, 2, "[<username>]"),
+#endif
+
 #if defined(CONFIG_BOARDCTL_SWITCH_BOOT) && !defined(CONFIG_NSH_DISABLE_SWITCHBOOT)
   CMD_MAP("switchboot", cmd_switchboot, 2, 2, "<image path>"),
 #endif
@@ -630,11 +631,6 @@ static const struct cmdmap_s g_cmdmap[] =
           3, CONFIG_NSH_MAXARGUMENTS, "<expression>"),
 #endif
 
-#if !defined(CONFIG_NSH_DISABLE_TOP) && defined(NSH_HAVE_CPULOAD)
-  CMD_MAP("top",       cmd_top,       1, 5,
-          "[ -n <num> ][ -d <delay>] [ -p <pidlist>] [-h]"),
-#endif
-
 #ifndef CONFIG_NSH_DISABLE_TIME
   CMD_MAP("time",     cmd_time,     2, 2, "\"<command>\""),
 #endif
@@ -643,6 +639,11 @@ static const struct cmdmap_s g_cmdmap[] =
   CMD_MAP("timedatectl", cmd_timedatectl, 1, 3, "[set-timezone TZ]"),
 #endif
 
+#if !defined(CONFIG_NSH_DISABLE_TOP) && defined(NSH_HAVE_CPULOAD)
+  CMD_MAP("top",       cmd_top,       1, 5,
+          "[ -n <num> ][ -d <delay>] [ -p <pidlist>] [-h]"),
+#endif
+
 #ifndef CONFIG_NSH_DISABLESCRIPT
   CMD_MAP("true",     cmd_true,     1, 1, NULL),
 #endif
@@ -653,8 +654,15 @@ static const struct cmdmap_s g_cmdmap[] =
 #  endif
 #endif
 
-#if defined(CONFIG_SCHED_USER_IDENTITY) && !defined(CONFIG_NSH_DISABLE_WHOAMI)
-  CMD_MAP("whoami",   cmd_whoami,   1, 1, NULL),
+#if !defined(CONFIG_DISABLE_MOUNTPOINT)
+#  ifndef CONFIG_NSH_DISABLE_UMOUNT
+  CMD_MAP("umount",   cmd_umount,   2, 3, "[-f] <dir-path>"),
+#  endif
+#endif
+
+#ifdef CONFIG_NSH_ALIAS
+  CMD_MAP("unalias",  cmd_unalias,  1, CONFIG_NSH_MAXARGUMENTS,
+    "[-a] name [name ... ]"),
 #endif
 
 #ifndef CONFIG_NSH_DISABLE_UNAME
@@ -665,12 +673,6 @@ static const struct cmdmap_s g_cmdmap[] =
 #  endif
 #endif
 
-#if !defined(CONFIG_DISABLE_MOUNTPOINT)
-#  ifndef CONFIG_NSH_DISABLE_UMOUNT
-  CMD_MAP("umount",   cmd_umount,   2, 3, "[-f] <dir-path>"),
-#  endif
-#endif
-
 #ifndef CONFIG_NSH_DISABLE_UNSET
   CMD_MAP("unset",    cmd_unset,    2, 2, "<name>"),
 #endif
@@ -699,6 +701,23 @@ static const struct cmdmap_s g_cmdmap[] =
 #  endif
 #endif
 
+#if !defined(CONFIG_DISABLE_ALL_SIGNALS) && !defined(CONFIG_NSH_DISABLE_USLEEP)
+  CMD_MAP("usleep",   cmd_usleep,   2, 2, "<usec>"),
+#endif
+
+#if defined(CONFIG_NET) && defined(CONFIG_NET_VLAN) && \
+    !defined(CONFIG_NSH_DISABLE_VCONFIG)
+  CMD_MAP("vconfig", cmd_vconfig, 3, 5,
+    "[add iface-name vlan-id [pcp]]|[rem vlan-name]"),
+#endif
+
+#if !defined(CONFIG_NSH_DISABLE_WAIT) && defined(CONFIG_SCHED_WAITPID) && \
+    !defined(CONFIG_DISABLE_PTHREAD) && defined(CONFIG_FS_PROCFS) && \
+    !defined(CONFIG_FS_PROCFS_EXCLUDE_PROCESS)
+  CMD_MAP("wait",     cmd_wait,     1, CONFIG_NSH_MAXARGUMENTS,
+          "pid1 [pid2 [pid3] ...]"),
+#endif
+
 #ifndef CONFIG_NSH_DISABLE_WATCH
   CMD_MAP("watch",     cmd_watch,
           2, 6, "[-n] interval [-c] count <command>"),
@@ -710,15 +729,14 @@ static const struct cmdmap_s g_cmdmap[] =
 #  endif
 #endif
 
+#if defined(CONFIG_SCHED_USER_IDENTITY) && !defined(CONFIG_NSH_DISABLE_WHOAMI)
+  CMD_MAP("whoami",   cmd_whoami,   1, 1, NULL),
+#endif
+
 #ifndef CONFIG_NSH_DISABLE_XD
   CMD_MAP("xd",       cmd_xd,       3, 3, "<hex-address> <byte-count>"),
 #endif
-#if !defined(CONFIG_NSH_DISABLE_WAIT) && defined(CONFIG_SCHED_WAITPID) && \
-    !defined(CONFIG_DISABLE_PTHREAD) && defined(CONFIG_FS_PROCFS) && \
-    !defined(CONFIG_FS_PROCFS_EXCLUDE_PROCESS)
-  CMD_MAP("wait",     cmd_wait,     1, CONFIG_NSH_MAXARGUMENTS,
-          "pid1 [pid2 [pid3] ...]"),
-#endif
+
   CMD_MAP(NULL,       NULL,         1, 1, NULL)
 };
 
@@ -726,6 +744,53 @@ static const struct cmdmap_s g_cmdmap[] =
  * Private Functions
  ****************************************************************************/
 
+/****************************************************************************
+ * Name: nsh_findcmd
+ *
+ * Description:
+ *   Find a command in the sorted command table.
+ *
+ * Returned Value:
+ *   The command table entry or NULL if the command is not in the table.
+ *
+ ****************************************************************************/
+
+static FAR const struct cmdmap_s *nsh_findcmd(FAR const char *cmd)
+{
+  FAR const struct cmdmap_s *cmdmap;
+  int lo = 0;
+  int hi = (int)NUM_CMDS - 1;
+  int mid;
+  int cmp;
+
+  while (lo <= hi)
+    {
+      mid    = (lo + hi) / 2;
+      cmdmap = &g_cmdmap[mid];
+
+      /* An unsorted table would silently lose commands */
+
+      DEBUGASSERT(mid == 0 || strcmp(g_cmdmap[mid - 1].cmd,
+                                     cmdmap->cmd) < 0);
+
+      cmp = strcmp(cmd, cmdmap->cmd);
+      if (cmp == 0)
+        {
+          return cmdmap;
+        }
+      else if (cmp < 0)
+        {
+          hi = mid - 1;
+        }
+      else
+        {
+          lo = mid + 1;
+        }
+    }
+
+  return NULL;
+}
+
 /****************************************************************************
  * Name: help_cmdlist
  ****************************************************************************/
@@ -880,18 +945,14 @@ static int help_cmd(FAR struct nsh_vtbl_s *vtbl, FAR const char *cmd)
 
   /* Find the command in the command table */
 
-  for (cmdmap = g_cmdmap; cmdmap->cmd; cmdmap++)
+  cmdmap = nsh_findcmd(cmd);
+  if (cmdmap != NULL)
     {
-      /* Is this the one we are looking for? */
-
-      if (strcmp(cmdmap->cmd, cmd) == 0)
-        {
-          /* Yes... show it */
+      /* Yes... show it */
 
-          nsh_output(vtbl, "%s usage:", cmd);
-          help_showcmd(vtbl, cmdmap);
-          return OK;
-        }
+      nsh_output(vtbl, "%s usage:", cmd);
+      help_showcmd(vtbl, cmdmap);
+      return OK;
     }
 
   nsh_error(vtbl, g_fmtcmdnotfound, cmd);
@@ -1277,7 +1338,7 @@ int nsh_command(FAR struct nsh_vtbl_s *vtbl, int argc, FAR char *argv[])
 #ifdef CONFIG_NSH_BUILTIN_AS_COMMAND
   /* Check if the command is available in the builtin list */
 
-  index = builtin_isavail(cmd);
+  index = builtin_find(cmd);
 
   if (index >= 0)
     {
@@ -1293,39 +1354,34 @@ int nsh_command(FAR struct nsh_vtbl_s *vtbl, int argc, FAR char *argv[])
 
   /* See if the command is one that we understand */
 
-  for (cmdmap = g_cmdmap; cmdmap->cmd; cmdmap++)
+  cmdmap = nsh_findcmd(cmd);
+  if (cmdmap != NULL)
     {
-      if (strcmp(cmdmap->cmd, cmd) == 0)
+      /* Check if a valid number of arguments was provided.  We
+       * do this simple, imperfect checking here so that it does
+       * not have to be performed in each command.
+       */
+
+      if (argc < cmdmap->minargs)
         {
-          /* Check if a valid number of arguments was provided.  We
-           * do this simple, imperfect checking here so that it does
-           * not have to be performed in each command.
-           */
+          /* Fewer than the minimum number were provided */
 
-          if (argc < cmdmap->minargs)
-            {
-              /* Fewer than the minimum number were provided */
+          nsh_error(vtbl, g_fmtargrequired, cmd);
+          return ERROR;
+        }
+      else if (argc > cmdmap->maxargs)
+        {
+          /* More than the maximum number were provided */
 
-              nsh_error(vtbl, g_fmtargrequired, cmd);
-              return ERROR;
-            }
-          else if (argc > cmdmap->maxargs)
-            {
-              /* More than the maximum number were provided */
+          nsh_error(vtbl, g_fmttoomanyargs, cmd);
+          return ERROR;
+        }
 
-              nsh_error(vtbl, g_fmttoomanyargs, cmd);
-              return ERROR;
-            }
-          else
-            {
-              /* A valid number of arguments were provided (this does
-               * not mean they are right).
-               */
+      /* A valid number of arguments were provided (this does
+       * not mean they are right).
+       */
 
-              handler = cmdmap->handler;
-              break;
-            }
-        }
+      handler = cmdmap->handler;
     }
 
   ret = handler(vtbl, argc, argv);
@@ -27,6 +27,7 @@
 #include <nuttx/config.h>
 
 #include <sys/ioctl.h>
+#include <sys/sendfile.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -66,6 +67,8 @@ static FAR struct nsh_vtbl_s *nsh_consoleclone(FAR struct nsh_vtbl_s *vtbl);
 static void nsh_consolerelease(FAR struct nsh_vtbl_s *vtbl);
 static ssize_t nsh_consolewrite(FAR struct nsh_vtbl_s *vtbl,
                                 FAR const void *buffer, size_t nbytes);
+static ssize_t nsh_consolesendfile(FAR struct nsh_vtbl_s *vtbl, int infd,
+                                   FAR off_t *offset, size_t count);
 static int nsh_consoleioctl(FAR struct nsh_vtbl_s *vtbl,
                             int cmd, unsigned long arg);
 static int nsh_consoleoutput(FAR struct nsh_vtbl_s *vtbl,
@@ -146,6 +149,24 @@ static ssize_t nsh_consolewrite(FAR struct nsh_vtbl_s *vtbl,
   return write(OUTFD(pstate), buffer, nbytes);
 }
 
+/****************************************************************************
+ * Name: nsh_consolesendfile
+ *
+ * Description:
+ *   Send data from a file directly to the output stream.
+ *
+ *   Same as nsh_consolewrite, errors are only reported to the caller.
+ *
+ ****************************************************************************/
+
+static ssize_t nsh_consolesendfile(FAR struct nsh_vtbl_s *vtbl, int infd,
+                                   FAR off_t *offset, size_t count)
+{
+  FAR struct console_stdio_s *pstate = (FAR struct console_stdio_s *)vtbl;
+
+  return sendfile(OUTFD(pstate), infd, offset, count);
+}
+
 /****************************************************************************
  * Name: nsh_consoleread
  *
@@ -417,6 +438,7 @@ FAR struct console_stdio_s *nsh_newconsole(bool isctty)
       pstate->cn_vtbl.release     = nsh_consolerelease;
       pstate->cn_vtbl.write       = nsh_consolewrite;
       pstate->cn_vtbl.read        = nsh_consoleread;
+      pstate->cn_vtbl.sendfile    = nsh_consolesendfile;
       pstate->cn_vtbl.ioctl       = nsh_consoleioctl;
       pstate->cn_vtbl.output      = nsh_consoleoutput;
 #ifndef CONFIG_NSH_DISABLE_ERROR_PRINT
@@ -47,6 +47,7 @@
 #define nsh_release(v)             (v)->release(v)
 #define nsh_write(v,b,n)           (v)->write(v,b,n)
 #define nsh_read(v,b,n)            (v)->read(v,b,n)
+#define nsh_sendfile(v,i,o,n)      (v)->sendfile(v,i,o,n)
 #define nsh_ioctl(v,c,a)           (v)->ioctl(v,c,a)
 #define nsh_linebuffer(v)          (v)->linebuffer(v)
 #define nsh_redirect(v,fi,fo,fe,s) (v)->redirect(v,fi,fo,fe,s)
@@ -118,6 +119,8 @@ struct nsh_vtbl_s
                    size_t nbytes);
   ssize_t (*read)(FAR struct nsh_vtbl_s *vtbl, FAR void *buffer,
                    size_t nbytes);
+  ssize_t (*sendfile)(FAR struct nsh_vtbl_s *vtbl, int infd,
+                      FAR off_t *offset, size_t count);
   int (*ioctl)(FAR struct nsh_vtbl_s *vtbl, int cmd, unsigned long arg);
 #ifndef CONFIG_NSH_DISABLE_ERROR_PRINT
   int (*error)(FAR struct nsh_vtbl_s *vtbl, FAR const char *fmt, ...)
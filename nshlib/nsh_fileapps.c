@@ -41,6 +41,10 @@
 
 #include <nuttx/lib/builtin.h>
 
+#ifdef CONFIG_BUILTIN
+#  include "builtin/builtin.h"
+#endif
+
 #include "nsh.h"
 #include "nsh_console.h"
 
@@ -216,7 +220,7 @@ int nsh_fileapp(FAR struct nsh_vtbl_s *vtbl, FAR const char *cmd,
   /* Check if a builtin application with this name exists */
 
   appname = basename((FAR char *)cmd);
-  index = builtin_isavail(appname);
+  index = builtin_find(appname);
   if (index >= 0)
     {
       FAR const struct builtin_s *builtin;
@@ -102,18 +102,56 @@
 #define MB                   (1UL << 20)
 #define GB                   (1UL << 30)
 
+#define COPY_RATE_FMT        "%s: %" PRIu64 " bytes in %" PRIu32 " ms" \
+                             " (%" PRIu64 " KB/s)\n"
+
 /****************************************************************************
  * Private Functions
  ****************************************************************************/
 
+/****************************************************************************
+ * Name: copy_rate
+ *
+ * Description:
+ *   Report the throughput of cat or cp.  cat reports to the error stream,
+ *   so the report doesn't mix with the file data.
+ *
+ ****************************************************************************/
+
+#if !defined(CONFIG_NSH_DISABLE_CAT) || !defined(CONFIG_NSH_DISABLE_CP)
+static void copy_rate(FAR struct nsh_vtbl_s *vtbl, FAR const char *cmd,
+                      uint64_t nbytes, FAR const struct timespec *start,
+                      bool toerr)
+{
+  struct timespec now;
+  uint32_t elapsed;
+  uint64_t rate;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  elapsed = (now.tv_sec - start->tv_sec) * 1000 +
+            (now.tv_nsec - start->tv_nsec) / 1000000;
+  rate    = elapsed > 0 ? nbytes * 1000 / KB / elapsed : 0;
+
+  if (toerr)
+    {
+      nsh_error(vtbl, COPY_RATE_FMT, cmd, nbytes, elapsed, rate);
+    }
+  else
+    {
+      nsh_output(vtbl, COPY_RATE_FMT, cmd, nbytes, elapsed, rate);
+    }
+}
+#endif
+
 /****************************************************************************
  * Name: cp_handler
  ****************************************************************************/
 
 #ifndef CONFIG_NSH_DISABLE_CP
 static int cp_handler(FAR struct nsh_vtbl_s *vtbl, FAR const char *srcpath,
-                      FAR const char *destpath)
+                      FAR const char *destpath, FAR uint64_t *nbytes)
 {
+  ssize_t ncopied;
   struct stat buf;
   FAR char *allocpath = NULL;
   int oflags = O_WRONLY | O_CREAT | O_TRUNC;
@@ -171,70 +209,13 @@ static int cp_handler(FAR struct nsh_vtbl_s *vtbl, FAR const char *srcpath,
       goto errout_with_allocpath;
     }
 
-  for (; ; )
+  ncopied = nsh_sendfd(vtbl, "cp", wrfd, rdfd);
+  if (ncopied >= 0)
     {
-      ssize_t nbyteswritten;
-      ssize_t nbytesread;
-      FAR char *iobuffer = vtbl->iobuffer;
-
-      nbytesread = read(rdfd, iobuffer, IOBUFFERSIZE);
-      if (nbytesread == 0)
-        {
-          /* End of file */
-
-          ret = OK;
-          goto errout_with_wrfd;
-        }
-      else if (nbytesread < 0)
-        {
-          /* EINTR is not an error (but will still stop the copy) */
-
-          if (errno == EINTR)
-            {
-              nsh_error(vtbl, g_fmtsignalrecvd, "cp");
-            }
-          else
-            {
-              /* Read error */
-
-              nsh_error(vtbl, g_fmtcmdfailed, "cp", "read",
-                        NSH_ERRNO);
-            }
-
-          goto errout_with_wrfd;
-        }
-
-      do
-        {
-          nbyteswritten = write(wrfd, iobuffer, nbytesread);
-          if (nbyteswritten >= 0)
-            {
-              nbytesread -= nbyteswritten;
-              iobuffer += nbyteswritten;
-            }
-          else
-            {
-              /* EINTR is not an error (but will still stop the copy) */
-
-              if (errno == EINTR)
-                {
-                  nsh_error(vtbl, g_fmtsignalrecvd, "cp");
-                }
-              else
-                {
-                  /* Read error */
-
-                  nsh_error(vtbl, g_fmtcmdfailed, "cp", "write",
-                            NSH_ERRNO);
-                }
-
-              goto errout_with_wrfd;
-            }
-        }
-      while (nbytesread > 0);
+      *nbytes += ncopied;
+      ret = OK;
     }
 
-errout_with_wrfd:
   close(wrfd);
 
 errout_with_allocpath:
@@ -253,7 +234,7 @@ errout_with_rdfd:
 
 #ifndef CONFIG_NSH_DISABLE_CP
 static int cp_recursive(FAR struct nsh_vtbl_s *vtbl, FAR const char *srcpath,
-                        FAR const char *destpath)
+                        FAR const char *destpath, FAR uint64_t *nbytes)
 {
   FAR struct dirent *entry;
   FAR char *allocdestpath;
@@ -310,7 +291,7 @@ static int cp_recursive(FAR struct nsh_vtbl_s *vtbl, FAR const char *srcpath,
             }
 #endif
 
-          ret = cp_recursive(vtbl, allocsrcpath, allocdestpath);
+          ret = cp_recursive(vtbl, allocsrcpath, allocdestpath, nbytes);
           if (ret != OK)
             {
               goto errout_with_allocdestpath;
@@ -318,7 +299,7 @@ static int cp_recursive(FAR struct nsh_vtbl_s *vtbl, FAR const char *srcpath,
         }
       else
         {
-          ret = cp_handler(vtbl, allocsrcpath, allocdestpath);
+          ret = cp_handler(vtbl, allocsrcpath, allocdestpath, nbytes);
           if (ret != OK)
             {
               goto errout_with_allocdestpath;
@@ -842,12 +823,34 @@ int cmd_dirname(FAR struct nsh_vtbl_s *vtbl, int argc, FAR char **argv)
 int cmd_cat(FAR struct nsh_vtbl_s *vtbl, int argc, FAR char **argv)
 {
   FAR char *fullpath;
+  struct timespec start;
+  uint64_t nbytes = 0;
+  ssize_t ncopied;
+  bool rate = false;
+  int option;
+  int fd;
   int i;
   int ret = OK;
 
+  while ((option = getopt(argc, argv, "t")) != ERROR)
+    {
+      switch (option)
+        {
+          case 't':
+            rate = true;
+            break;
+
+          default:
+            nsh_error(vtbl, g_fmtarginvalid, argv[0]);
+            return ERROR;
+        }
+    }
+
+  clock_gettime(CLOCK_MONOTONIC, &start);
+
   /* Loop for each file name on the command line */
 
-  for (i = 1; i < argc && ret == OK; i++)
+  for (i = optind; i < argc && ret == OK; i++)
     {
       /* Get the fullpath to the file */
 
@@ -857,7 +860,7 @@ int cmd_cat(FAR struct nsh_vtbl_s *vtbl, int argc, FAR char **argv)
           nsh_error(vtbl, g_fmtcmdoutofmemory, argv[0]);
           ret = ERROR;
         }
-      else
+      else if (!rate)
         {
           /* Dump the file to the console */
 
@@ -867,9 +870,35 @@ int cmd_cat(FAR struct nsh_vtbl_s *vtbl, int argc, FAR char **argv)
 
           nsh_freefullpath(fullpath);
         }
+      else
+        {
+          /* Same, but count the bytes for the throughput */
+
+          fd = open(fullpath, O_RDONLY | O_CLOEXEC);
+          nsh_freefullpath(fullpath);
+
+          if (fd < 0)
+            {
+              nsh_error(vtbl, g_fmtcmdfailed, argv[0], "open", NSH_ERRNO);
+              ret = ERROR;
+              break;
+            }
+
+          ncopied = nsh_sendfd(vtbl, argv[0], -1, fd);
+          close(fd);
+
+          if (ncopied < 0)
+            {
+              ret = ERROR;
+            }
+          else
+            {
+              nbytes += ncopied;
+            }
+        }
     }
 
-  if (argc == 1)
+  if (optind == argc)
     {
       char *buf = malloc(BUFSIZ);
       if (buf == NULL)
@@ -897,11 +926,17 @@ int cmd_cat(FAR struct nsh_vtbl_s *vtbl, int argc, FAR char **argv)
             }
 
           nsh_write(vtbl, buf, ret);
+          nbytes += ret;
         }
 
       free(buf);
     }
 
+  if (ret == OK && rate)
+    {
+      copy_rate(vtbl, argv[0], nbytes, &start, true);
+    }
+
   return ret;
 }
 #endif
@@ -1085,22 +1120,35 @@ int cmd_cp(FAR struct nsh_vtbl_s *vtbl, int argc, FAR char **argv)
 {
   FAR char *srcpath  = NULL;
   FAR char *destpath = NULL;
+  struct timespec start;
+  uint64_t nbytes = 0;
   bool recursive = false;
+  bool rate = false;
   int ret = ERROR;
   int option;
 
   /* Get the cp flags */
 
-  while ((option = getopt(argc, argv, "r")) != ERROR)
+  while ((option = getopt(argc, argv, "rt")) != ERROR)
     {
       switch (option)
         {
           case 'r':
             recursive = true;
             break;
+
+          case 't':
+            rate = true;
+            break;
         }
     }
 
+  if (optind + 2 != argc)
+    {
+      nsh_error(vtbl, g_fmtargrequired, argv[0]);
+      return ERROR;
+    }
+
   /* Get the full path to the source file */
 
   srcpath = nsh_getfullpath(vtbl, argv[optind]);
@@ -1127,13 +1175,20 @@ int cmd_cp(FAR struct nsh_vtbl_s *vtbl, int argc, FAR char **argv)
 
   /* Now open the destination */
 
+  clock_gettime(CLOCK_MONOTONIC, &start);
+
   if (recursive)
     {
-      ret = cp_recursive(vtbl, srcpath, destpath);
+      ret = cp_recursive(vtbl, srcpath, destpath, &nbytes);
     }
   else
     {
-      ret = cp_handler(vtbl, srcpath, destpath);
+      ret = cp_handler(vtbl, srcpath, destpath, &nbytes);
+    }
+
+  if (ret == OK && rate)
+    {
+      copy_rate(vtbl, argv[0], nbytes, &start, false);
     }
 
 errout_with_destpath:
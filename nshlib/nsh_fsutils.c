@@ -27,6 +27,8 @@
 #include <nuttx/config.h>
 
 #include <sys/types.h>
+#include <sys/sendfile.h>
+#include <sys/stat.h>
 #include <stdint.h>
 #include <stdbool.h>
 #include <stdio.h>
@@ -43,6 +45,20 @@
 #include "nsh.h"
 #include "nsh_console.h"
 
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Maximum size of one sendfile() call.  The copy is only interrupted
+ * between calls, so keep it small enough for Ctrl-C to stay responsive.
+ */
+
+#define NSH_SENDFILE_CHUNK (64 * 1024)
+
+#ifndef CONFIG_NSH_COPYSIZE
+#  define CONFIG_NSH_COPYSIZE IOBUFFERSIZE
+#endif
+
 /****************************************************************************
  * Private Types
  ****************************************************************************/
@@ -143,9 +159,8 @@ static int getpid_callback(FAR struct nsh_vtbl_s *vtbl,
 int nsh_catfile(FAR struct nsh_vtbl_s *vtbl, FAR const char *cmd,
                 FAR const char *filepath)
 {
-  FAR char *buffer;
   int fd;
-  int ret = OK;
+  int ret;
 
   /* Open the file for reading */
 
@@ -166,105 +181,180 @@ int nsh_catfile(FAR struct nsh_vtbl_s *vtbl, FAR const char *cmd,
       return ERROR;
     }
 
-  buffer = (FAR char *)malloc(IOBUFFERSIZE);
+  /* And just dump it byte for byte into stdout */
+
+  ret = nsh_sendfd(vtbl, cmd, -1, fd) < 0 ? ERROR : OK;
+
+  /* NOTE that the following NSH prompt may appear on the same line as file
+   * content.  The IEEE Std requires that "The standard output shall
+   * contain the sequence of bytes read from the input files. Nothing else
+   * shall be written to the standard output." Reference:
+   * https://pubs.opengroup.org/onlinepubs/009695399/utilities/cat.html.
+   */
+
+  /* Close the input file and return the result */
+
+  close(fd);
+  return ret;
+}
+#endif
+
+/****************************************************************************
+ * Name: nsh_sendfd
+ *
+ * Description:
+ *   Copy everything from one file descriptor to another, or to the current
+ *   NSH terminal.
+ *
+ * Input Paratemets:
+ *   vtbl     - session vtbl
+ *   cmd      - NSH command name to use in error reporting
+ *   outfd    - The output file descriptor, or -1 for the NSH terminal
+ *   infd     - The input file descriptor
+ *
+ * Returned Value:
+ *   The number of bytes copied on success; -1 (ERROR) on failure.
+ *
+ ****************************************************************************/
+
+#ifdef NSH_HAVE_SENDFD
+ssize_t nsh_sendfd(FAR struct nsh_vtbl_s *vtbl, FAR const char *cmd,
+                   int outfd, int infd)
+{
+  FAR const char *op = "sendfile";
+  FAR char *buffer;
+  struct stat buf;
+  ssize_t nbytesread;
+  ssize_t total = 0;
+  ssize_t n;
+  size_t bufsize = IOBUFFERSIZE;
+  int errcode;
+
+  /* Regular files are sent without copying through a user buffer.  This
+   * is not used for other files, e.g. procfs or /dev/log, which are
+   * only readable in pieces.
+   */
+
+  if (fstat(infd, &buf) == 0 && S_ISREG(buf.st_mode))
+    {
+      for (; ; )
+        {
+          if (outfd < 0)
+            {
+              n = nsh_sendfile(vtbl, infd, NULL, NSH_SENDFILE_CHUNK);
+            }
+          else
+            {
+              n = sendfile(outfd, infd, NULL, NSH_SENDFILE_CHUNK);
+            }
+
+          if (n > 0)
+            {
+              total += n;
+            }
+          else if (n == 0)
+            {
+              return total;
+            }
+          else
+            {
+              errcode = errno;
+
+              /* Fall back to the buffered copy if sendfile() is not
+               * supported for this pair of files.
+               */
+
+              if (total == 0 && (errcode == ENOSYS || errcode == EINVAL ||
+                                 errcode == ENOTSUP))
+                {
+                  break;
+                }
+
+              goto errout;
+            }
+        }
+
+      bufsize = CONFIG_NSH_COPYSIZE;
+    }
+
+  buffer = (FAR char *)malloc(bufsize);
   if (buffer == NULL)
     {
-      close(fd);
       nsh_error(vtbl, g_fmtcmdfailed, cmd, "malloc", NSH_ERRNO);
       return ERROR;
     }
 
-  /* And just dump it byte for byte into stdout */
-
   for (; ; )
     {
-      int nbytesread = read(fd, buffer, IOBUFFERSIZE);
+      nbytesread = read(infd, buffer, bufsize);
 
       /* Check for read errors */
 
       if (nbytesread < 0)
         {
-          int errval = errno;
+          errcode = errno;
+          op = "read";
+          goto errout_with_buffer;
+        }
 
-          /* EINTR is not an error (but will stop stop the cat) */
+      /* Otherwise, it is the end of file */
 
-          if (errval == EINTR)
+      else if (nbytesread == 0)
+        {
+          break;
+        }
+
+      for (n = 0; n < nbytesread; )
+        {
+          ssize_t nbyteswritten;
+
+          if (outfd < 0)
             {
-              nsh_error(vtbl, g_fmtsignalrecvd, cmd);
+              nbyteswritten = nsh_write(vtbl, buffer + n, nbytesread - n);
             }
           else
             {
-              nsh_error(vtbl, g_fmtcmdfailed, cmd, "read",
-                        NSH_ERRNO_OF(errval));
+              nbyteswritten = write(outfd, buffer + n, nbytesread - n);
             }
 
-          ret = ERROR;
-          break;
-        }
-
-      /* Check for data successfully read */
-
-      else if (nbytesread > 0)
-        {
-          int nbyteswritten = 0;
+          /* Jump straight to cleanup on a write error.  On a broken stdout
+           * (e.g. closed PTY master) we must not keep reading: we would
+           * otherwise drain /dev/log forever when dumping it on dmesg.
+           */
 
-          while (nbyteswritten < nbytesread)
+          if (nbyteswritten < 0)
             {
-              ssize_t n = nsh_write(vtbl, buffer + nbyteswritten,
-                                    nbytesread - nbyteswritten);
-              if (n < 0)
-                {
-                  int errcode = errno;
-
-                  /* EINTR is not an error (but will stop stop the cat) */
-
-                  if (errcode == EINTR)
-                    {
-                      nsh_error(vtbl, g_fmtsignalrecvd, cmd);
-                    }
-                  else
-                    {
-                      nsh_error(vtbl, g_fmtcmdfailed, cmd, "write",
-                                 NSH_ERRNO_OF(errcode));
-                    }
-
-                  /* Jump straight to cleanup.  On a broken stdout (e.g.
-                   * closed PTY master) we must not keep reading: the
-                   * outer loop would otherwise drain /dev/log forever
-                   * when cat is dumping it on dmesg.
-                   */
-
-                  ret = ERROR;
-                  goto errout;
-                }
-              else
-                {
-                  nbyteswritten += n;
-                }
+              errcode = errno;
+              op = "write";
+              goto errout_with_buffer;
             }
-        }
-
-      /* Otherwise, it is the end of file */
 
-      else
-        {
-          break;
+          n += nbyteswritten;
         }
+
+      total += nbytesread;
     }
 
-  /* NOTE that the following NSH prompt may appear on the same line as file
-   * content.  The IEEE Std requires that "The standard output shall
-   * contain the sequence of bytes read from the input files. Nothing else
-   * shall be written to the standard output." Reference:
-   * https://pubs.opengroup.org/onlinepubs/009695399/utilities/cat.html.
-   */
+  free(buffer);
+  return total;
 
-  /* Close the input file and return the result */
+errout_with_buffer:
+  free(buffer);
 
 errout:
-  close(fd);
-  free(buffer);
-  return ret;
+
+  /* EINTR is not an error (but will still stop the copy) */
+
+  if (errcode == EINTR)
+    {
+      nsh_error(vtbl, g_fmtsignalrecvd, cmd);
+    }
+  else
+    {
+      nsh_error(vtbl, g_fmtcmdfailed, cmd, op, NSH_ERRNO_OF(errcode));
+    }
+
+  return ERROR;
 }
 #endif
 
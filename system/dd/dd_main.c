@@ -44,6 +44,8 @@
 #include <string.h>
 #include <errno.h>
 #include <time.h>
+#include <pthread.h>
+#include <semaphore.h>
 
 /****************************************************************************
  * Pre-processor Definitions
@@ -58,6 +60,29 @@
 
 #define DEFAULT_SECTSIZE 512
 
+/* Buffers are aligned for O_DIRECT transfers, which go straight between
+ * the device and the user buffer.
+ */
+
+#define DD_DIRECT_ALIGN  512
+
+#if defined(CONFIG_DISABLE_PTHREAD)
+#  define DD_MAX_NBUFFERS 1
+#  define CONFIG_SYSTEM_DD_NBUFFERS 1
+#else
+#  define DD_MAX_NBUFFERS 64
+#  if !defined(CONFIG_SYSTEM_DD_NBUFFERS)
+#    define CONFIG_SYSTEM_DD_NBUFFERS 2
+#  endif
+#endif
+
+#ifndef O_DIRECT
+#  define O_DIRECT 0
+#endif
+#ifndef O_DSYNC
+#  define O_DSYNC O_SYNC
+#endif
+
 #if !defined(CONFIG_SYSTEM_DD_PROGNAME)
 #define CONFIG_SYSTEM_DD_PROGNAME "dd"
 #endif
@@ -89,11 +114,32 @@ struct dd_s
   uint32_t     nsectors;   /* Number of sectors to transfer */
   uint32_t     skip;       /* The number of sectors skipped on input */
   uint32_t     seek;       /* The number of sectors seeked on output */
+  int          iflags;     /* The open flags on input device */
   int          oflags;     /* The open flags on output device */
   bool         eof;        /* true: The end of the input or output file has been hit */
+  bool         sparse;     /* true: Seek over zero blocks on output */
+  bool         progress;   /* true: Report the throughput while copying */
   size_t       sectsize;   /* Size of one sector */
   size_t       nbytes;     /* Number of valid bytes in the buffer */
   FAR uint8_t *buffer;     /* Buffer of data to write to the output file */
+  off_t        hole;       /* Bytes skipped on output since the last write */
+  uint32_t     sectors;    /* Number of sectors copied */
+  uint64_t     total;      /* Number of bytes copied */
+
+  /* Pipeline of nbuffers sectors between the reader and the writer */
+
+  size_t       nbuffers;   /* Number of sector buffers */
+  FAR size_t  *lengths;    /* Number of valid bytes in each buffer */
+#if DD_MAX_NBUFFERS > 1
+  sem_t        empty;      /* Counts the buffers free for reading */
+  sem_t        full;       /* Counts the buffers ready for writing */
+  volatile bool werror;    /* true: The writer thread failed */
+#endif
+
+#ifdef CONFIG_SYSTEM_DD_STATS
+  struct timespec start;   /* Time the copy started */
+  struct timespec report;  /* Time of the last progress report */
+#endif
 };
 
 /****************************************************************************
@@ -104,18 +150,31 @@ struct dd_s
  * Name: dd_write
  ****************************************************************************/
 
-static int dd_write(FAR struct dd_s *dd)
+static int dd_write(FAR struct dd_s *dd, FAR uint8_t *buffer, size_t len)
 {
-  FAR uint8_t *buffer = dd->buffer;
   size_t written;
   ssize_t nbytes;
 
+  /* Seek over blocks of zeroes if possible.  The hole is closed by
+   * dd_sync() once the copy is complete.
+   */
+
+  if (dd->sparse && buffer[0] == 0 &&
+      memcmp(buffer, buffer + 1, len - 1) == 0 &&
+      lseek(dd->outfd, len, SEEK_CUR) >= 0)
+    {
+      dd->hole = len;
+      return OK;
+    }
+
+  dd->hole = 0;
+
   /* Is the out buffer full (or is this the last one)? */
 
   written = 0;
   do
     {
-      nbytes = write(dd->outfd, buffer, dd->nbytes - written);
+      nbytes = write(dd->outfd, buffer, len - written);
       if (nbytes < 0)
         {
           fprintf(stderr, "%s: failed to write: %s\n", g_dd,
@@ -126,7 +185,35 @@ static int dd_write(FAR struct dd_s *dd)
       written += nbytes;
       buffer  += nbytes;
     }
-  while (written < dd->nbytes);
+  while (written < len);
+
+  return OK;
+}
+
+/****************************************************************************
+ * Name: dd_sync
+ ****************************************************************************/
+
+static int dd_sync(FAR struct dd_s *dd)
+{
+  uint8_t zero = 0;
+
+  /* If the copy ended with a hole, write its last byte so that the output
+   * file gets its full size.
+   */
+
+  if (dd->hole > 0)
+    {
+      if (lseek(dd->outfd, -1, SEEK_CUR) < 0 ||
+          write(dd->outfd, &zero, 1) != 1)
+        {
+          fprintf(stderr, "%s: failed to write: %s\n", g_dd,
+              strerror(errno));
+          return ERROR;
+        }
+
+      dd->hole = 0;
+    }
 
   return OK;
 }
@@ -135,15 +222,15 @@ static int dd_write(FAR struct dd_s *dd)
  * Name: dd_read
  ****************************************************************************/
 
-static int dd_read(FAR struct dd_s *dd)
+static int dd_read(FAR struct dd_s *dd, FAR uint8_t *buffer,
+                   FAR size_t *len)
 {
-  FAR uint8_t *buffer = dd->buffer;
   ssize_t nbytes;
 
-  dd->nbytes = 0;
+  *len = 0;
   do
     {
-      nbytes = read(dd->infd, buffer, dd->sectsize - dd->nbytes);
+      nbytes = read(dd->infd, buffer, dd->sectsize - *len);
       if (nbytes < 0)
         {
           if (errno == EINTR)
@@ -155,15 +242,15 @@ static int dd_read(FAR struct dd_s *dd)
           return ERROR;
         }
 
-      dd->nbytes += nbytes;
-      buffer     += nbytes;
+      *len   += nbytes;
+      buffer += nbytes;
       if (nbytes == 0)
         {
           dd->eof = true;
           break;
         }
     }
-  while (dd->nbytes < dd->sectsize && nbytes != 0);
+  while (*len < dd->sectsize && nbytes != 0);
 
   return OK;
 }
@@ -180,7 +267,7 @@ static inline int dd_infopen(FAR const char *name, FAR struct dd_s *dd)
       return OK;
     }
 
-  dd->infd = open(name, O_RDONLY);
+  dd->infd = open(name, O_RDONLY | dd->iflags);
   if (dd->infd < 0)
     {
       fprintf(stderr, "%s: failed to open '%s': %s\n", g_dd, name,
@@ -214,6 +301,281 @@ static inline int dd_outfopen(FAR const char *name, FAR struct dd_s *dd)
   return OK;
 }
 
+/****************************************************************************
+ * Name: dd_alloc
+ ****************************************************************************/
+
+static FAR void *dd_alloc(FAR struct dd_s *dd, size_t size)
+{
+  FAR void *buffer;
+
+  if (((dd->iflags | dd->oflags) & O_DIRECT) == 0)
+    {
+      return malloc(size);
+    }
+
+  if (posix_memalign(&buffer, DD_DIRECT_ALIGN, size) != 0)
+    {
+      return NULL;
+    }
+
+  return buffer;
+}
+
+/****************************************************************************
+ * Name: dd_progress
+ ****************************************************************************/
+
+#ifdef CONFIG_SYSTEM_DD_STATS
+static void dd_progress(FAR struct dd_s *dd, bool final)
+{
+  struct timespec now;
+  uint64_t elapsed;
+  uint64_t rate;
+
+  /* Report at most once per second, and once more at the end */
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  if (!final && now.tv_sec - dd->report.tv_sec < 1)
+    {
+      return;
+    }
+
+  dd->report = now;
+
+  elapsed  = (now.tv_sec * NSEC_PER_SEC) + now.tv_nsec;
+  elapsed -= (dd->start.tv_sec * NSEC_PER_SEC) + dd->start.tv_nsec;
+  elapsed /= NSEC_PER_USEC; /* usec */
+
+  /* Bytes per usec are MB/s, keep two decimals */
+
+  rate = elapsed > 0 ? dd->total * 100 / elapsed : 0;
+  fprintf(stderr, "\r%" PRIu64 " bytes copied, %u s, %u.%02u MB/s",
+          dd->total, (unsigned int)(elapsed / USEC_PER_SEC),
+          (unsigned int)(rate / 100), (unsigned int)(rate % 100));
+  if (final)
+    {
+      fputc('\n', stderr);
+    }
+}
+#endif
+
+/****************************************************************************
+ * Name: dd_writer
+ *
+ * Description:
+ *   Write the buffers filled by dd_pipeline() until the empty buffer that
+ *   ends the copy.  After an error the buffers are still consumed, so that
+ *   the reader never waits for a free buffer forever.
+ *
+ ****************************************************************************/
+
+#if DD_MAX_NBUFFERS > 1
+static FAR void *dd_writer(FAR void *arg)
+{
+  FAR struct dd_s *dd = arg;
+  size_t tail = 0;
+  size_t len;
+
+  for (; ; )
+    {
+      while (sem_wait(&dd->full) < 0);
+
+      len = dd->lengths[tail];
+      if (len == 0)
+        {
+          break;
+        }
+
+      if (!dd->werror &&
+          dd_write(dd, dd->buffer + tail * dd->sectsize, len) < 0)
+        {
+          dd->werror = true;
+        }
+
+      sem_post(&dd->empty);
+      tail = (tail + 1) % dd->nbuffers;
+    }
+
+  if (!dd->werror && dd_sync(dd) < 0)
+    {
+      dd->werror = true;
+    }
+
+  return NULL;
+}
+
+/****************************************************************************
+ * Name: dd_pipeline
+ *
+ * Description:
+ *   Copy with the reads done by the calling thread and the writes by a
+ *   writer thread, so that the input and the output devices work at the
+ *   same time.  They exchange a ring of nbuffers sectors; an empty buffer
+ *   ends the copy.
+ *
+ ****************************************************************************/
+
+static int dd_pipeline(FAR struct dd_s *dd)
+{
+  pthread_attr_t attr;
+  pthread_t writer;
+  size_t head = 0;
+  size_t len;
+  int ret;
+
+  sem_init(&dd->empty, 0, dd->nbuffers);
+  sem_init(&dd->full, 0, 0);
+  dd->werror = false;
+
+  pthread_attr_init(&attr);
+  pthread_attr_setinheritsched(&attr, PTHREAD_INHERIT_SCHED);
+  ret = pthread_create(&writer, &attr, dd_writer, dd);
+  pthread_attr_destroy(&attr);
+  if (ret != 0)
+    {
+      fprintf(stderr, "%s: failed to create writer: %s\n", g_dd,
+          strerror(ret));
+      ret = ERROR;
+      goto errout_with_sem;
+    }
+
+  for (; ; )
+    {
+      while (sem_wait(&dd->empty) < 0);
+
+      len = 0;
+      if (!dd->werror && !dd->eof && dd->sectors < dd->nsectors)
+        {
+          ret = dd_read(dd, dd->buffer + head * dd->sectsize, &len);
+          if (ret < 0)
+            {
+              len = 0;
+            }
+        }
+
+      dd->lengths[head] = len;
+      sem_post(&dd->full);
+      if (len == 0)
+        {
+          break;
+        }
+
+      dd->sectors++;
+      dd->total += len;
+#ifdef CONFIG_SYSTEM_DD_STATS
+      if (dd->progress)
+        {
+          dd_progress(dd, false);
+        }
+#endif
+
+      head = (head + 1) % dd->nbuffers;
+    }
+
+  pthread_join(writer, NULL);
+  if (dd->werror)
+    {
+      ret = ERROR;
+    }
+
+errout_with_sem:
+  sem_destroy(&dd->full);
+  sem_destroy(&dd->empty);
+  return ret;
+}
+#endif
+
+/****************************************************************************
+ * Name: dd_copy
+ ****************************************************************************/
+
+static int dd_copy(FAR struct dd_s *dd)
+{
+  int ret;
+
+#if DD_MAX_NBUFFERS > 1
+  if (dd->nbuffers > 1)
+    {
+      return dd_pipeline(dd);
+    }
+#endif
+
+  while (!dd->eof && dd->sectors < dd->nsectors)
+    {
+      /* Read one sector from from the input */
+
+      ret = dd_read(dd, dd->buffer, &dd->nbytes);
+      if (ret < 0)
+        {
+          return ret;
+        }
+
+      /* Has the incoming data stream ended? */
+
+      if (dd->nbytes > 0)
+        {
+          /* Write one sector to the output file */
+
+          ret = dd_write(dd, dd->buffer, dd->nbytes);
+          if (ret < 0)
+            {
+              return ret;
+            }
+
+          /* Increment the sector number */
+
+          dd->sectors++;
+          dd->total += dd->nbytes;
+#ifdef CONFIG_SYSTEM_DD_STATS
+          if (dd->progress)
+            {
+              dd_progress(dd, false);
+            }
+#endif
+        }
+    }
+
+  return dd_sync(dd);
+}
+
+/****************************************************************************
+ * Name: dd_parseflags
+ ****************************************************************************/
+
+static int dd_parseflags(FAR const char *cur, FAR int *flags)
+{
+  while (true)
+    {
+      FAR const char *next = strchr(cur, ',');
+      size_t len = next != NULL ? next - cur : strlen(cur);
+      if (len == 6 && !memcmp(cur, "direct", 6))
+        {
+          *flags |= O_DIRECT;
+        }
+      else if (len == 4 && !memcmp(cur, "sync", 4))
+        {
+          *flags |= O_SYNC;
+        }
+      else if (len == 5 && !memcmp(cur, "dsync", 5))
+        {
+          *flags |= O_DSYNC;
+        }
+      else
+        {
+          fprintf(stderr, "%s: unknown flag '%.*s'\n", g_dd, (int)len, cur);
+          return ERROR;
+        }
+
+      if (next == NULL)
+        {
+          return OK;
+        }
+
+      cur = next + 1;
+    }
+}
+
 static int dd_verify(FAR struct dd_s *dd)
 {
   FAR uint8_t *buffer;
@@ -237,7 +599,7 @@ static int dd_verify(FAR struct dd_s *dd)
       return ret;
     }
 
-  buffer = malloc(dd->sectsize);
+  buffer = dd_alloc(dd, dd->sectsize);
   if (buffer == NULL)
     {
       return ERROR;
@@ -245,7 +607,7 @@ static int dd_verify(FAR struct dd_s *dd)
 
   while (!dd->eof && sector < dd->nsectors)
     {
-      ret = dd_read(dd);
+      ret = dd_read(dd, dd->buffer, &dd->nbytes);
       if (ret < 0)
         {
           break;
@@ -296,7 +658,12 @@ static void print_usage(FAR FILE *stream)
   fprintf(stream, "usage:\n");
   fprintf(stream, "  %s [if=<infile>] [of=<outfile>] [bs=<sectsize>] "
          "[count=<sectors>] [skip=<sectors>] [seek=<sectors>] [verify] "
-         "[conv=<nocreat,notrunc>]\n", g_dd);
+         "[conv=<nocreat,notrunc,sparse>] [iflag=<direct,sync,dsync>] "
+         "[oflag=<direct,sync,dsync>] [nbuf=<buffers>] "
+#ifdef CONFIG_SYSTEM_DD_STATS
+         "[status=progress]"
+#endif
+         "\n", g_dd);
 }
 
 /****************************************************************************
@@ -309,12 +676,9 @@ int main(int argc, FAR char **argv)
   FAR char *infile = NULL;
   FAR char *outfile = NULL;
 #ifdef CONFIG_SYSTEM_DD_STATS
-  struct timespec ts0;
   struct timespec ts1;
   uint64_t elapsed;
-  uint64_t total = 0;
 #endif
-  uint32_t sector = 0;
   int ret = ERROR;
   int i;
   bool show_help = false;
@@ -325,6 +689,7 @@ int main(int argc, FAR char **argv)
   dd.sectsize  = DEFAULT_SECTSIZE;  /* Sector size if 'bs=' not provided */
   dd.nsectors  = 0xffffffff;        /* MAX_UINT32 */
   dd.oflags    = O_WRONLY | O_CREAT | O_TRUNC;
+  dd.nbuffers  = CONFIG_SYSTEM_DD_NBUFFERS;
 
   /* Parse command line parameters */
 
@@ -373,6 +738,10 @@ int main(int argc, FAR char **argv)
                 {
                   dd.oflags &= ~(O_CREAT | O_TRUNC);
                 }
+              else if (len == 6 && !memcmp(cur, "sparse", 6))
+                {
+                  dd.sparse = true;
+                }
               else
                 {
                   fprintf(stderr, "%s: unknown conversion '%.*s'\n", g_dd,
@@ -388,6 +757,30 @@ int main(int argc, FAR char **argv)
               cur = next + 1;
             }
         }
+      else if (strncmp(argv[i], "iflag=", 6) == 0)
+        {
+          if (dd_parseflags(&argv[i][6], &dd.iflags) < 0)
+            {
+              goto errout_with_paths;
+            }
+        }
+      else if (strncmp(argv[i], "oflag=", 6) == 0)
+        {
+          if (dd_parseflags(&argv[i][6], &dd.oflags) < 0)
+            {
+              goto errout_with_paths;
+            }
+        }
+      else if (strncmp(argv[i], "nbuf=", 5) == 0)
+        {
+          dd.nbuffers = atoi(&argv[i][5]);
+        }
+#ifdef CONFIG_SYSTEM_DD_STATS
+      else if (strcmp(argv[i], "status=progress") == 0)
+        {
+          dd.progress = true;
+        }
+#endif
       else if (strcmp(argv[i], "--help") == 0)
         {
           show_help = true;
@@ -418,13 +811,21 @@ int main(int argc, FAR char **argv)
       goto errout_with_paths;
     }
 
-  /* Allocate the I/O buffer */
+  if (dd.nbuffers < 1 || dd.nbuffers > DD_MAX_NBUFFERS)
+    {
+      fprintf(stderr, "%s: nbuf must be between 1 and %d\n", g_dd,
+          DD_MAX_NBUFFERS);
+      goto errout_with_paths;
+    }
+
+  /* Allocate the I/O buffers */
 
-  dd.buffer = malloc(dd.sectsize);
-  if (!dd.buffer)
+  dd.buffer  = dd_alloc(&dd, dd.sectsize * dd.nbuffers);
+  dd.lengths = malloc(dd.nbuffers * sizeof(size_t));
+  if (!dd.buffer || !dd.lengths)
     {
       fprintf(stderr, "%s: failed to malloc: %s\n", g_dd, strerror(errno));
-      goto errout_with_paths;
+      goto errout_with_alloc;
     }
 
   /* Open the input file */
@@ -470,53 +871,32 @@ int main(int argc, FAR char **argv)
   /* Then perform the data transfer */
 
 #ifdef CONFIG_SYSTEM_DD_STATS
-  clock_gettime(CLOCK_MONOTONIC, &ts0);
+  clock_gettime(CLOCK_MONOTONIC, &dd.start);
+  dd.report = dd.start;
 #endif
 
-  while (!dd.eof && sector < dd.nsectors)
+  ret = dd_copy(&dd);
+  if (ret < 0)
     {
-      /* Read one sector from from the input */
-
-      ret = dd_read(&dd);
-      if (ret < 0)
-        {
-          goto errout_with_outf;
-        }
-
-      /* Has the incoming data stream ended? */
-
-      if (dd.nbytes > 0)
-        {
-          /* Write one sector to the output file */
-
-          ret = dd_write(&dd);
-          if (ret < 0)
-            {
-              goto errout_with_outf;
-            }
-
-          /* Increment the sector number */
+      goto errout_with_outf;
+    }
 
-          sector++;
 #ifdef CONFIG_SYSTEM_DD_STATS
-          total += dd.nbytes;
-#endif
-        }
+  if (dd.progress)
+    {
+      dd_progress(&dd, true);
     }
 
-  ret = OK;
-
-#ifdef CONFIG_SYSTEM_DD_STATS
   clock_gettime(CLOCK_MONOTONIC, &ts1);
 
   elapsed  = (ts1.tv_sec * NSEC_PER_SEC) + ts1.tv_nsec;
-  elapsed -= (ts0.tv_sec * NSEC_PER_SEC) + ts0.tv_nsec;
+  elapsed -= (dd.start.tv_sec * NSEC_PER_SEC) + dd.start.tv_nsec;
   elapsed /= NSEC_PER_USEC; /* usec */
 
   fprintf(stderr, "%" PRIu64 " bytes (%" PRIu32 " blocks) copied, %u usec, ",
-         total, sector, (unsigned int)elapsed);
+         dd.total, dd.sectors, (unsigned int)elapsed);
   fprintf(stderr, "%u KB/s\n" ,
-         (unsigned int)(((double)total / 1024)
+         (unsigned int)(((double)dd.total / 1024)
          / ((double)elapsed / USEC_PER_SEC)));
 #endif
 
@@ -548,6 +928,7 @@ errout_with_inf:
     }
 
 errout_with_alloc:
+  free(dd.lengths);
   free(dd.buffer);
 
 errout_with_paths:
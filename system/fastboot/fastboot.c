@@ -33,12 +33,15 @@
 #include <errno.h>
 #include <fcntl.h>
 #include <inttypes.h>
+#include <pthread.h>
+#include <semaphore.h>
 #include <stdbool.h>
 #include <stdlib.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <string.h>
 #include <syslog.h>
+#include <time.h>
 #include <unistd.h>
 
 #include <netinet/in.h>
@@ -79,6 +82,11 @@
 #define FASTBOOT_SPARSE_HEADER      sizeof(struct fastboot_sparse_header_s)
 #define FASTBOOT_CHUNK_HEADER       sizeof(struct fastboot_chunk_header_s)
 
+#ifdef CONFIG_SYSTEM_FASTBOOTD_STREAM
+#  define FASTBOOT_STREAM_BUFSIZE   CONFIG_SYSTEM_FASTBOOTD_STREAM_BUFSIZE
+#  define FASTBOOT_STREAM_NBUFFERS  CONFIG_SYSTEM_FASTBOOTD_STREAM_NBUFFERS
+#endif
+
 /* Fastboot TCP Protocol v1
  *
  *   handshake: chars "FB" followed by a 2-digit base-10 ASCII version number
@@ -132,6 +140,58 @@ struct fastboot_chunk_header_s
   uint32_t total_sz;        /* in bytes of chunk input file including chunk header and data */
 };
 
+#ifdef CONFIG_SYSTEM_FASTBOOTD_STREAM
+enum fastboot_stream_state_e
+{
+  FASTBOOT_STREAM_MAGIC,          /* Waiting for the first 4 bytes */
+  FASTBOOT_STREAM_RAW_IMAGE,      /* Not a sparse image, write as is */
+  FASTBOOT_STREAM_SPARSE_HEADER,  /* Receiving the sparse header */
+  FASTBOOT_STREAM_CHUNK_HEADER,   /* Receiving a chunk header */
+  FASTBOOT_STREAM_CHUNK_RAW,      /* Writing the data of a raw chunk */
+  FASTBOOT_STREAM_CHUNK_FILL,     /* Receiving the fill word */
+  FASTBOOT_STREAM_SKIP,           /* Skipping the data of a chunk */
+  FASTBOOT_STREAM_DONE            /* All the chunks were parsed */
+};
+
+/* State of "oem stream": the target partition, the ring of buffers shared
+ * by the download and the writer thread, and the sparse image parser.
+ */
+
+struct fastboot_stream_s
+{
+  char name[NAME_MAX + 1];
+  int fd;
+  uint64_t size;
+  bool done;
+  int result;
+
+  /* Ring of FASTBOOT_STREAM_NBUFFERS buffers, a zero length marks the end
+   * of the download.
+   */
+
+  FAR uint8_t *ring;
+  size_t len[FASTBOOT_STREAM_NBUFFERS];
+  sem_t empty;
+  sem_t full;
+
+  /* Sparse image parser */
+
+  enum fastboot_stream_state_e state;
+  struct fastboot_sparse_header_s sparse;
+  struct fastboot_chunk_header_s chunk;
+  uint8_t header[FASTBOOT_SPARSE_HEADER];
+  size_t headerlen;
+  uint32_t chunks;
+  uint64_t left;
+  uint64_t offset;
+
+  /* Raw data waiting to be written at 'offset' */
+
+  FAR uint8_t *stage;
+  size_t staged;
+};
+#endif
+
 struct fastboot_mem_s
 {
   FAR void *addr;
@@ -178,6 +238,9 @@ struct fastboot_ctx_s
   FAR struct fastboot_var_s *varlist;
   CODE int (*upload_func)(FAR struct fastboot_ctx_s *);
   FAR const struct fastboot_transport_ops_s *ops;
+#ifdef CONFIG_SYSTEM_FASTBOOTD_STREAM
+  FAR struct fastboot_stream_s *stream;
+#endif
   struct
     {
       size_t size;
@@ -226,6 +289,10 @@ static void fastboot_filedump(FAR struct fastboot_ctx_s *ctx,
 static void fastboot_shell(FAR struct fastboot_ctx_s *ctx,
                            FAR const char *arg);
 #endif
+#ifdef CONFIG_SYSTEM_FASTBOOTD_STREAM
+static void fastboot_stream(FAR struct fastboot_ctx_s *ctx,
+                            FAR const char *arg);
+#endif
 #ifdef CONFIG_BOARDCTL_SWITCH_BOOT
 static void fastboot_switchboot(FAR struct fastboot_ctx_s *context,
                                 FAR const char *arg);
@@ -276,6 +343,9 @@ static const struct fastboot_cmd_s g_oem_cmd[] =
 #ifdef CONFIG_SYSTEM_FASTBOOTD_SHELL
   { "shell",              fastboot_shell            },
 #endif
+#ifdef CONFIG_SYSTEM_FASTBOOTD_STREAM
+  { "stream",             fastboot_stream           },
+#endif
 #ifdef CONFIG_BOARDCTL_SWITCH_BOOT
   { "switchboot",         fastboot_switchboot       },
 #endif
@@ -522,7 +592,11 @@ static int fastboot_flash_program(FAR struct fastboot_ctx_s *ctx, int fd)
             break;
           case FASTBOOT_CHUNK_FILL:
             {
-              uint32_t fill_data = be32toh(*(FAR uint32_t *)chunk_ptr);
+              /* Replicate the fill word byte for byte, as the streaming
+               * path does
+               */
+
+              uint32_t fill_data = *(FAR uint32_t *)chunk_ptr;
               uint32_t chunk_size = chunk->chunk_sz * sparse->blk_sz;
               ret = ffastboot_flash_fill(fd, ctx->download_offset, fill_data,
                                          sparse->blk_sz, chunk->chunk_sz);
@@ -555,12 +629,589 @@ end:
   return ret;
 }
 
+#ifdef CONFIG_SYSTEM_FASTBOOTD_STREAM
+static void fastboot_stream_free(FAR struct fastboot_ctx_s *ctx)
+{
+  FAR struct fastboot_stream_s *stream = ctx->stream;
+
+  if (stream != NULL)
+    {
+      fastboot_flash_close(stream->fd);
+      sem_destroy(&stream->empty);
+      sem_destroy(&stream->full);
+      free(stream);
+      ctx->stream = NULL;
+    }
+}
+
+/* Write the staged raw data at the current output offset */
+
+static int fastboot_stream_flush(FAR struct fastboot_stream_s *stream)
+{
+  int ret;
+
+  if (stream->staged == 0)
+    {
+      return OK;
+    }
+
+  if (stream->offset + stream->staged > stream->size)
+    {
+      fb_err("Image larger than the partition\n");
+      return -ENOSPC;
+    }
+
+  ret = fastboot_flash_write(stream->fd, stream->offset, stream->stage,
+                             stream->staged);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  stream->offset += stream->staged;
+  stream->staged  = 0;
+  return OK;
+}
+
+/* Copy raw data to the stage, writing it out each time the stage is full.
+ * Raw chunks start on a block boundary, so all the writes but the last
+ * one of a chunk are aligned and a multiple of the stage size.
+ */
+
+static int fastboot_stream_stage(FAR struct fastboot_stream_s *stream,
+                                 FAR const uint8_t *data, size_t len)
+{
+  int ret;
+
+  while (len > 0)
+    {
+      size_t n = MIN(len, FASTBOOT_STREAM_BUFSIZE - stream->staged);
+
+      memcpy(stream->stage + stream->staged, data, n);
+      stream->staged += n;
+      data += n;
+      len -= n;
+
+      if (stream->staged == FASTBOOT_STREAM_BUFSIZE)
+        {
+          ret = fastboot_stream_flush(stream);
+          if (ret < 0)
+            {
+              return ret;
+            }
+        }
+    }
+
+  return OK;
+}
+
+static int fastboot_stream_fill(FAR struct fastboot_stream_s *stream,
+                                uint64_t size)
+{
+  size_t i;
+  int ret;
+
+  if (stream->offset + size > stream->size)
+    {
+      fb_err("Image larger than the partition\n");
+      return -ENOSPC;
+    }
+
+  /* The fill word is stored in the image as it is written to flash */
+
+  for (i = 0; i < FASTBOOT_STREAM_BUFSIZE; i += sizeof(uint32_t))
+    {
+      memcpy(stream->stage + i, stream->header, sizeof(uint32_t));
+    }
+
+  while (size > 0)
+    {
+      size_t n = MIN(size, FASTBOOT_STREAM_BUFSIZE);
+
+      ret = fastboot_flash_write(stream->fd, stream->offset, stream->stage,
+                                 n);
+      if (ret < 0)
+        {
+          return ret;
+        }
+
+      stream->offset += n;
+      size -= n;
+    }
+
+  return OK;
+}
+
+static void fastboot_stream_next_chunk(FAR struct fastboot_stream_s *stream)
+{
+  if (stream->chunks == 0)
+    {
+      stream->state = FASTBOOT_STREAM_DONE;
+    }
+  else
+    {
+      stream->chunks--;
+      stream->state = FASTBOOT_STREAM_CHUNK_HEADER;
+    }
+}
+
+/* Act on a complete header, or on the 4 bytes of data of a fill chunk */
+
+static int fastboot_stream_header(FAR struct fastboot_stream_s *stream)
+{
+  FAR struct fastboot_sparse_header_s *sparse = &stream->sparse;
+  FAR struct fastboot_chunk_header_s *chunk = &stream->chunk;
+  uint64_t size;
+  uint32_t data;
+
+  switch (stream->state)
+    {
+      case FASTBOOT_STREAM_MAGIC:
+        memcpy(&data, stream->header, sizeof(data));
+        if (data != FASTBOOT_SPARSE_MAGIC)
+          {
+            /* No sparse header, the image is written as is */
+
+            stream->state = FASTBOOT_STREAM_RAW_IMAGE;
+            return fastboot_stream_stage(stream, stream->header,
+                                         sizeof(uint32_t));
+          }
+
+        stream->state = FASTBOOT_STREAM_SPARSE_HEADER;
+        return OK;
+
+      case FASTBOOT_STREAM_SPARSE_HEADER:
+        memcpy(sparse, stream->header, FASTBOOT_SPARSE_HEADER);
+        if (sparse->major_version != 1 ||
+            sparse->file_hdr_sz != FASTBOOT_SPARSE_HEADER ||
+            sparse->chunk_hdr_sz != FASTBOOT_CHUNK_HEADER ||
+            sparse->blk_sz == 0 || sparse->blk_sz % 4 != 0)
+          {
+            fb_err("Unsupported sparse image\n");
+            return -EINVAL;
+          }
+
+        stream->chunks = sparse->total_chunks;
+        fastboot_stream_next_chunk(stream);
+        return OK;
+
+      case FASTBOOT_STREAM_CHUNK_HEADER:
+        memcpy(chunk, stream->header, FASTBOOT_CHUNK_HEADER);
+        if (chunk->total_sz < FASTBOOT_CHUNK_HEADER)
+          {
+            fb_err("Invalid chunk size:%" PRIu32 "\n", chunk->total_sz);
+            return -EINVAL;
+          }
+
+        size = (uint64_t)chunk->chunk_sz * sparse->blk_sz;
+        data = chunk->total_sz - FASTBOOT_CHUNK_HEADER;
+
+        switch (chunk->chunk_type)
+          {
+            case FASTBOOT_CHUNK_RAW:
+              if (data != size)
+                {
+                  fb_err("Invalid raw chunk size:%" PRIu32 "\n", data);
+                  return -EINVAL;
+                }
+
+              stream->left  = size;
+              stream->state = FASTBOOT_STREAM_CHUNK_RAW;
+              break;
+
+            case FASTBOOT_CHUNK_FILL:
+              if (data != sizeof(uint32_t))
+                {
+                  fb_err("Invalid fill chunk size:%" PRIu32 "\n", data);
+                  return -EINVAL;
+                }
+
+              stream->state = FASTBOOT_STREAM_CHUNK_FILL;
+              return OK;
+
+            case FASTBOOT_CHUNK_DONT_CARE:
+              stream->offset += size;
+              stream->left    = data;
+              stream->state   = FASTBOOT_STREAM_SKIP;
+              break;
+
+            default:
+              fb_err("Error chunk type:%d, skip\n", chunk->chunk_type);
+
+              /* Fall through */
+
+            case FASTBOOT_CHUNK_CRC32:
+              stream->left  = data;
+              stream->state = FASTBOOT_STREAM_SKIP;
+              break;
+          }
+
+        if (stream->left == 0)
+          {
+            fastboot_stream_next_chunk(stream);
+          }
+
+        return OK;
+
+      case FASTBOOT_STREAM_CHUNK_FILL:
+        size = (uint64_t)chunk->chunk_sz * sparse->blk_sz;
+        fastboot_stream_next_chunk(stream);
+        return fastboot_stream_fill(stream, size);
+
+      default:
+        return -EINVAL;
+    }
+}
+
+/* Parse the next piece of the downloaded image and write it out */
+
+static int fastboot_stream_parse(FAR struct fastboot_stream_s *stream,
+                                 FAR const uint8_t *data, size_t len)
+{
+  size_t need;
+  size_t n;
+  int ret = OK;
+
+  while (len > 0 && ret >= 0)
+    {
+      switch (stream->state)
+        {
+          case FASTBOOT_STREAM_MAGIC:
+          case FASTBOOT_STREAM_SPARSE_HEADER:
+          case FASTBOOT_STREAM_CHUNK_HEADER:
+          case FASTBOOT_STREAM_CHUNK_FILL:
+            if (stream->state == FASTBOOT_STREAM_SPARSE_HEADER)
+              {
+                need = FASTBOOT_SPARSE_HEADER;
+              }
+            else if (stream->state == FASTBOOT_STREAM_CHUNK_HEADER)
+              {
+                need = FASTBOOT_CHUNK_HEADER;
+              }
+            else
+              {
+                need = sizeof(uint32_t);
+              }
+
+            n = MIN(len, need - stream->headerlen);
+            memcpy(stream->header + stream->headerlen, data, n);
+            stream->headerlen += n;
+
+            if (stream->headerlen == need)
+              {
+                /* The sparse header starts with the magic */
+
+                if (stream->state != FASTBOOT_STREAM_MAGIC)
+                  {
+                    stream->headerlen = 0;
+                  }
+
+                ret = fastboot_stream_header(stream);
+              }
+
+            break;
+
+          case FASTBOOT_STREAM_RAW_IMAGE:
+            n = len;
+            ret = fastboot_stream_stage(stream, data, n);
+            break;
+
+          case FASTBOOT_STREAM_CHUNK_RAW:
+            n = MIN(len, stream->left);
+            ret = fastboot_stream_stage(stream, data, n);
+            stream->left -= n;
+            if (stream->left == 0 && ret >= 0)
+              {
+                ret = fastboot_stream_flush(stream);
+                fastboot_stream_next_chunk(stream);
+              }
+
+            break;
+
+          case FASTBOOT_STREAM_SKIP:
+            n = MIN(len, stream->left);
+            stream->left -= n;
+            if (stream->left == 0)
+              {
+                fastboot_stream_next_chunk(stream);
+              }
+
+            break;
+
+          default:
+
+            /* Ignore anything after the last chunk */
+
+            n = len;
+            break;
+        }
+
+      data += n;
+      len -= n;
+    }
+
+  return ret;
+}
+
+/* Consume the ring buffers filled by fastboot_stream_download() until the
+ * zero length buffer that marks the end of the download.  After an error,
+ * the rest of the download is drained without being written.
+ */
+
+static FAR void *fastboot_stream_writer(FAR void *arg)
+{
+  FAR struct fastboot_stream_s *stream = arg;
+  size_t index = 0;
+  size_t len;
+
+  for (; ; )
+    {
+      sem_wait(&stream->full);
+      len = stream->len[index];
+      if (len == 0)
+        {
+          break;
+        }
+
+      if (stream->result >= 0)
+        {
+          stream->result =
+            fastboot_stream_parse(stream, stream->ring +
+                                  index * FASTBOOT_STREAM_BUFSIZE, len);
+        }
+
+      sem_post(&stream->empty);
+      index = (index + 1) % FASTBOOT_STREAM_NBUFFERS;
+    }
+
+  /* Give back the buffer of the end marker for the next download */
+
+  sem_post(&stream->empty);
+
+  if (stream->result >= 0)
+    {
+      if (stream->state == FASTBOOT_STREAM_MAGIC)
+        {
+          /* An image shorter than the magic */
+
+          stream->result = fastboot_stream_stage(stream, stream->header,
+                                                 stream->headerlen);
+        }
+      else if (stream->state != FASTBOOT_STREAM_RAW_IMAGE &&
+               stream->state != FASTBOOT_STREAM_DONE)
+        {
+          fb_err("Truncated sparse image\n");
+          stream->result = -EINVAL;
+        }
+
+      if (stream->result >= 0)
+        {
+          stream->result = fastboot_stream_flush(stream);
+        }
+    }
+
+  return NULL;
+}
+
+/* Receive the download into a ring of buffers, while a writer thread
+ * parses and programs the buffers already received.
+ */
+
+static void fastboot_stream_download(FAR struct fastboot_ctx_s *ctx,
+                                     size_t len)
+{
+  FAR struct fastboot_stream_s *stream = ctx->stream;
+  struct timespec start;
+  struct timespec end;
+  pthread_t writer;
+  size_t index = 0;
+  size_t total = len;
+  int ret;
+
+  stream->state     = FASTBOOT_STREAM_MAGIC;
+  stream->headerlen = 0;
+  stream->staged    = 0;
+  stream->offset    = 0;
+  stream->result    = OK;
+  stream->done      = false;
+
+  clock_gettime(CLOCK_MONOTONIC, &start);
+
+  ret = pthread_create(&writer, NULL, fastboot_stream_writer, stream);
+  if (ret != 0)
+    {
+      fastboot_fail(ctx, "Stream writer failure");
+      return;
+    }
+
+  while (len > 0)
+    {
+      FAR uint8_t *buffer = stream->ring + index * FASTBOOT_STREAM_BUFSIZE;
+      size_t size = MIN(len, FASTBOOT_STREAM_BUFSIZE);
+      size_t received = 0;
+
+      sem_wait(&stream->empty);
+
+      /* Fill the whole buffer, so that most writes are of full blocks */
+
+      while (received < size)
+        {
+          ssize_t r = ctx->ops->read(ctx, buffer + received,
+                                     size - received);
+          if (r < 0)
+            {
+              if (errno == EAGAIN)
+                {
+                  continue;
+                }
+
+              ret = r;
+              break;
+            }
+
+          received += r;
+        }
+
+      if (ret < 0)
+        {
+          sem_post(&stream->empty);
+          break;
+        }
+
+      stream->len[index] = size;
+      sem_post(&stream->full);
+      index = (index + 1) % FASTBOOT_STREAM_NBUFFERS;
+      len -= size;
+    }
+
+  /* Send the end of the download and wait for the writer to finish */
+
+  sem_wait(&stream->empty);
+  stream->len[index] = 0;
+  sem_post(&stream->full);
+  pthread_join(writer, NULL);
+
+  clock_gettime(CLOCK_MONOTONIC, &end);
+
+  if (ret < 0)
+    {
+      fb_err("fastboot_download usb read error\n");
+      return;
+    }
+
+  if (stream->result < 0)
+    {
+      fastboot_fail(ctx, "Image flash failure");
+      return;
+    }
+
+  fb_info("Streamed %zu bytes to %s in %" PRIu64 " ms\n", total,
+          stream->name,
+          ((uint64_t)(end.tv_sec - start.tv_sec) * 1000000000 +
+           end.tv_nsec - start.tv_nsec) / 1000000);
+
+  stream->done = true;
+  fastboot_okay(ctx, "");
+}
+
+/* The image of the last download is already in flash, so "flash" only has
+ * to check that it went to the requested partition.
+ */
+
+static void fastboot_stream_flash(FAR struct fastboot_ctx_s *ctx,
+                                  FAR const char *arg)
+{
+  FAR struct fastboot_stream_s *stream = ctx->stream;
+
+  if (strcmp(arg, stream->name) != 0)
+    {
+      fastboot_fail(ctx, "Streaming to %s", stream->name);
+      return;
+    }
+
+  if (!stream->done)
+    {
+      fastboot_fail(ctx, "No image streamed");
+      return;
+    }
+
+  stream->done = false;
+  fsync(stream->fd);
+  fastboot_okay(ctx, "");
+}
+
+/* Usage(host):
+ *   fastboot oem stream <partition>
+ *   fastboot flash <partition> <image>
+ *   fastboot oem stream
+ *
+ * While streaming is enabled, downloads are written to the partition as
+ * they arrive, and may be as large as the partition.
+ */
+
+static void fastboot_stream(FAR struct fastboot_ctx_s *ctx,
+                            FAR const char *arg)
+{
+  FAR struct fastboot_stream_s *stream;
+  char blkdev[PATH_MAX];
+  struct stat sb;
+
+  fastboot_stream_free(ctx);
+
+  if (arg == NULL || *arg == '\0')
+    {
+      fastboot_okay(ctx, "");
+      return;
+    }
+
+  stream = malloc(sizeof(*stream) +
+                  (FASTBOOT_STREAM_NBUFFERS + 1) * FASTBOOT_STREAM_BUFSIZE);
+  if (stream == NULL)
+    {
+      fastboot_fail(ctx, "Not enough memory");
+      return;
+    }
+
+  strlcpy(stream->name, arg, sizeof(stream->name));
+  stream->stage = (FAR uint8_t *)(stream + 1);
+  stream->ring  = stream->stage + FASTBOOT_STREAM_BUFSIZE;
+  stream->done  = false;
+  sem_init(&stream->empty, 0, FASTBOOT_STREAM_NBUFFERS);
+  sem_init(&stream->full, 0, 0);
+
+  snprintf(blkdev, PATH_MAX, FASTBOOT_BLKDEV, arg);
+  stream->fd = fastboot_flash_open(blkdev);
+  ctx->stream = stream;
+
+  if (stream->fd < 0)
+    {
+      fastboot_stream_free(ctx);
+      fastboot_fail(ctx, "Flash open failure");
+      return;
+    }
+
+  stream->size = fstat(stream->fd, &sb) == 0 && sb.st_size > 0 ?
+                 sb.st_size : ctx->download_max;
+
+  fb_info("Stream to %s, %" PRIu64 " bytes\n", blkdev, stream->size);
+  fastboot_okay(ctx, "");
+}
+#endif
+
 static void fastboot_flash(FAR struct fastboot_ctx_s *ctx,
                            FAR const char *arg)
 {
   char blkdev[PATH_MAX];
   int ret;
 
+#ifdef CONFIG_SYSTEM_FASTBOOTD_STREAM
+  if (ctx->stream != NULL)
+    {
+      fastboot_stream_flash(ctx, arg);
+      return;
+    }
+#endif
+
   snprintf(blkdev, PATH_MAX, FASTBOOT_BLKDEV, arg);
 
   if (ctx->flash_fd < 0)
@@ -653,7 +1304,11 @@ static void fastboot_download(FAR struct fastboot_ctx_s *ctx,
   int ret;
 
   len = strtoul(arg, NULL, 16);
+#ifdef CONFIG_SYSTEM_FASTBOOTD_STREAM
+  if (ctx->stream != NULL ? len > ctx->stream->size : len > ctx->download_max)
+#else
   if (len > ctx->download_max)
+#endif
     {
       fastboot_fail(ctx, "Data too large");
       return;
@@ -667,6 +1322,14 @@ static void fastboot_download(FAR struct fastboot_ctx_s *ctx,
       return;
     }
 
+#ifdef CONFIG_SYSTEM_FASTBOOTD_STREAM
+  if (ctx->stream != NULL)
+    {
+      fastboot_stream_download(ctx, len);
+      return;
+    }
+#endif
+
   download = ctx->download_buffer;
   ctx->download_size = len;
 
@@ -698,6 +1361,18 @@ static void fastboot_getvar(FAR struct fastboot_ctx_s *ctx,
   FAR struct fastboot_var_s *var;
   char buffer[FASTBOOT_MSG_LEN];
 
+#ifdef CONFIG_SYSTEM_FASTBOOTD_STREAM
+  /* A streamed download is only limited by the size of the partition */
+
+  if (ctx->stream != NULL && !strcmp(arg, "max-download-size"))
+    {
+      snprintf(buffer, sizeof(buffer), "0x%08" PRIx64,
+               MIN(ctx->stream->size, UINT32_MAX));
+      fastboot_okay(ctx, buffer);
+      return;
+    }
+#endif
+
   for (var = ctx->varlist; var != NULL; var = var->next)
     {
       if (!strcmp(var->name, arg))
@@ -1492,6 +2167,9 @@ static int fastboot_context_initialize(FAR struct fastboot_ctx_s *ctx,
       ctx->ops             = &g_tran_ops[nctx];
       ctx->tran_fd[0]      = -1;
       ctx->tran_fd[1]      = -1;
+#ifdef CONFIG_SYSTEM_FASTBOOTD_STREAM
+      ctx->stream          = NULL;
+#endif
 
       ctx->download_buffer = malloc(CONFIG_SYSTEM_FASTBOOTD_DOWNLOAD_MAX);
       if (ctx->download_buffer == NULL)
@@ -1522,6 +2200,10 @@ static void fastboot_context_deinit(FAR struct fastboot_ctx_s *ctx,
           ctx->ops->deinit(ctx);
           free(ctx->download_buffer);
         }
+
+#ifdef CONFIG_SYSTEM_FASTBOOTD_STREAM
+      fastboot_stream_free(ctx);
+#endif
     }
 }
 
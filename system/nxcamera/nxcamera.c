@@ -37,6 +37,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 #include <unistd.h>
 #include <poll.h>
 
@@ -90,21 +91,194 @@ static void pan_display(int fb_device, FAR struct fb_planeinfo_s *plane_info)
     }
 }
 
+/****************************************************************************
+ * Name: nxcamera_convsize
+ *
+ *   Returns the size of the intermediate frame needed to show the captured
+ *   format on the display, or 0 if the frame is converted in one pass.
+ *
+ ****************************************************************************/
+
+static size_t nxcamera_convsize(FAR struct nxcamera_s *pcam)
+{
+#ifdef CONFIG_LIBYUV
+  /* libyuv has no single-pass converter from most formats to RGB565, so
+   * those go through I420.
+   */
+
+  if (pcam->display_vinfo.fmt == FB_FMT_RGB16_565 &&
+      pcam->fmt.fmt.pix.pixelformat != V4L2_PIX_FMT_YUV420 &&
+      pcam->fmt.fmt.pix.pixelformat != V4L2_PIX_FMT_NV12)
+    {
+      return pcam->fmt.fmt.pix.width * pcam->fmt.fmt.pix.height * 3 / 2;
+    }
+#endif
+
+  return 0;
+}
+
+#ifndef CONFIG_LIBYUV
+/****************************************************************************
+ * Name: nxcamera_clamp
+ ****************************************************************************/
+
+static inline uint8_t nxcamera_clamp(int value)
+{
+  return value < 0 ? 0 : value > 255 ? 255 : value;
+}
+
+/****************************************************************************
+ * Name: nxcamera_putpixel
+ *
+ *   Converts one pixel from YUV (BT.601, limited range) to the display
+ *   format.  rd, gd and bd are the chroma terms shared by a pixel pair.
+ *   Returns the position of the next pixel.
+ *
+ ****************************************************************************/
+
+static inline FAR uint8_t *nxcamera_putpixel(FAR uint8_t *dst, bool rgb565,
+                                             int y, int rd, int gd, int bd)
+{
+  int     c = 298 * (y - 16);
+  uint8_t r = nxcamera_clamp((c + rd) >> 8);
+  uint8_t g = nxcamera_clamp((c + gd) >> 8);
+  uint8_t b = nxcamera_clamp((c + bd) >> 8);
+
+  if (rgb565)
+    {
+      *(FAR uint16_t *)dst = ((r & 0xf8) << 8) | ((g & 0xfc) << 3) |
+                             (b >> 3);
+      return dst + 2;
+    }
+
+  *(FAR uint32_t *)dst = 0xff000000 | (r << 16) | (g << 8) | b;
+  return dst + 4;
+}
+
+/****************************************************************************
+ * Name: nxcamera_convert
+ *
+ *   Scalar single-pass conversion from YUYV, UYVY or I420 to RGB565 or
+ *   RGB32, used when libyuv is not available.  The frame is clipped to the
+ *   display.  Returns -ENOSYS if the formats are not supported.
+ *
+ ****************************************************************************/
+
+static int nxcamera_convert(FAR struct nxcamera_s *pcam,
+                            FAR const uint8_t *src)
+{
+  uint32_t    pixfmt = pcam->fmt.fmt.pix.pixelformat;
+  uint32_t    srcw   = pcam->fmt.fmt.pix.width;
+  uint32_t    srch   = pcam->fmt.fmt.pix.height;
+  uint32_t    width  = MIN(srcw, pcam->display_vinfo.xres) & ~1;
+  uint32_t    height = MIN(srch, pcam->display_vinfo.yres);
+  FAR uint8_t *fbmem = pcam->display_pinfo.fbmem;
+  bool        rgb565;
+  int         ystep;
+  int         cstep;
+  uint32_t    row;
+  uint32_t    col;
+
+  if (pcam->display_vinfo.fmt == FB_FMT_RGB16_565)
+    {
+      rgb565 = true;
+    }
+  else if (pcam->display_vinfo.fmt == FB_FMT_RGB32)
+    {
+      rgb565 = false;
+    }
+  else
+    {
+      return -ENOSYS;
+    }
+
+  if (pixfmt == V4L2_PIX_FMT_YUYV || pixfmt == V4L2_PIX_FMT_UYVY)
+    {
+      ystep = 2;
+      cstep = 4;
+    }
+  else if (pixfmt == V4L2_PIX_FMT_YUV420)
+    {
+      ystep = 1;
+      cstep = 1;
+    }
+  else
+    {
+      return -ENOSYS;
+    }
+
+  for (row = 0; row < height; row++)
+    {
+      FAR uint8_t       *dst = fbmem + row * pcam->display_pinfo.stride;
+      FAR const uint8_t *py;
+      FAR const uint8_t *pu;
+      FAR const uint8_t *pv;
+
+      if (pixfmt == V4L2_PIX_FMT_YUYV)
+        {
+          py = src + row * srcw * 2;
+          pu = py + 1;
+          pv = py + 3;
+        }
+      else if (pixfmt == V4L2_PIX_FMT_UYVY)
+        {
+          pu = src + row * srcw * 2;
+          py = pu + 1;
+          pv = pu + 2;
+        }
+      else
+        {
+          py = src + row * srcw;
+          pu = src + srcw * srch + (row / 2) * (srcw / 2);
+          pv = pu + (srcw / 2) * (srch / 2);
+        }
+
+      for (col = 0; col < width; col += 2)
+        {
+          int d  = *pu - 128;
+          int e  = *pv - 128;
+          int rd = 409 * e + 128;
+          int gd = -100 * d - 208 * e + 128;
+          int bd = 516 * d + 128;
+
+          dst = nxcamera_putpixel(dst, rgb565, py[0], rd, gd, bd);
+          dst = nxcamera_putpixel(dst, rgb565, py[ystep], rd, gd, bd);
+
+          py += 2 * ystep;
+          pu += cstep;
+          pv += cstep;
+        }
+    }
+
+  return 0;
+}
+#endif
+
+/****************************************************************************
+ * Name: show_image
+ ****************************************************************************/
+
 static int show_image(FAR struct nxcamera_s *pcam, FAR v4l2_buffer_t *buf)
 {
+  FAR uint8_t *src = pcam->bufs[buf->index];
 #ifdef CONFIG_LIBYUV
+  uint32_t width  = pcam->fmt.fmt.pix.width;
+  uint32_t height = pcam->fmt.fmt.pix.height;
+  FAR uint8_t *dst;
+  int ret;
+
   if (pcam->display_vinfo.fmt == FB_FMT_RGB32)
     {
-      return CONVERT_TO_ARGB(pcam->bufs[buf->index],
+      return CONVERT_TO_ARGB(src,
                              pcam->buf_sizes[buf->index],
                              pcam->display_pinfo.fbmem,
                              pcam->display_pinfo.stride,
                              0,
                              0,
-                             pcam->fmt.fmt.pix.width,
-                             pcam->fmt.fmt.pix.height,
-                             pcam->fmt.fmt.pix.width,
-                             pcam->fmt.fmt.pix.height,
+                             width,
+                             height,
+                             width,
+                             height,
                              0,
                              pcam->fmt.fmt.pix.pixelformat);
     }
@@ -112,87 +286,107 @@ static int show_image(FAR struct nxcamera_s *pcam, FAR v4l2_buffer_t *buf)
     {
       if (pcam->fmt.fmt.pix.pixelformat == V4L2_PIX_FMT_YUV420)
         {
-          return CONVERT_FROM_I420(pcam->bufs[buf->index],
-                                   pcam->fmt.fmt.pix.width,
-                                   &pcam->bufs[buf->index][
-                                              pcam->fmt.fmt.pix.width *
-                                              pcam->fmt.fmt.pix.height],
-                                   pcam->fmt.fmt.pix.width / 2,
-                                   &pcam->bufs[buf->index][
-                                        pcam->fmt.fmt.pix.width *
-                                        pcam->fmt.fmt.pix.height * 5 / 4],
-                                   pcam->fmt.fmt.pix.width / 2,
+          return CONVERT_FROM_I420(src,
+                                   width,
+                                   &src[width * height],
+                                   width / 2,
+                                   &src[width * height * 5 / 4],
+                                   width / 2,
                                    pcam->display_pinfo.fbmem,
                                    pcam->display_pinfo.stride,
-                                   pcam->fmt.fmt.pix.width,
-                                   pcam->fmt.fmt.pix.height,
+                                   width,
+                                   height,
                                    V4L2_PIX_FMT_RGB565);
         }
-      else
+      else if (pcam->fmt.fmt.pix.pixelformat == V4L2_PIX_FMT_NV12)
         {
-          int ret;
-          FAR uint8_t *dst = malloc(pcam->fmt.fmt.pix.width *
-                                    pcam->fmt.fmt.pix.height * 3 / 2);
-          if (!dst)
-            {
-              return -ENOMEM;
-            }
-
-          ret = CONVERT_TO_I420(pcam->bufs[buf->index],
-                                pcam->buf_sizes[buf->index],
-                                dst,
-                                pcam->fmt.fmt.pix.width,
-                                &dst[pcam->fmt.fmt.pix.width *
-                                          pcam->fmt.fmt.pix.height],
-                                pcam->fmt.fmt.pix.width / 2,
-                                &dst[pcam->fmt.fmt.pix.width *
-                                          pcam->fmt.fmt.pix.height * 5 / 4],
-                                pcam->fmt.fmt.pix.width / 2,
-                                0,
-                                0,
-                                pcam->fmt.fmt.pix.width,
-                                pcam->fmt.fmt.pix.height,
-                                pcam->fmt.fmt.pix.width,
-                                pcam->fmt.fmt.pix.height,
-                                0,
-                                pcam->fmt.fmt.pix.pixelformat);
-          if (ret < 0)
-            {
-              goto err;
-            }
-
-          ret = CONVERT_FROM_I420(dst,
-                                  pcam->fmt.fmt.pix.width,
-                                  &dst[pcam->fmt.fmt.pix.width *
-                                              pcam->fmt.fmt.pix.height],
-                                  pcam->fmt.fmt.pix.width / 2,
-                                  &dst[pcam->fmt.fmt.pix.width *
-                                       pcam->fmt.fmt.pix.height * 5 / 4],
-                                  pcam->fmt.fmt.pix.width / 2,
-                                  pcam->display_pinfo.fbmem,
-                                  pcam->display_pinfo.stride,
-                                  pcam->fmt.fmt.pix.width,
-                                  pcam->fmt.fmt.pix.height,
-                                  V4L2_PIX_FMT_RGB565);
-          if (ret < 0)
-            {
-              goto err;
-            }
+          return NV12ToRGB565(src,
+                              width,
+                              &src[width * height],
+                              width,
+                              pcam->display_pinfo.fbmem,
+                              pcam->display_pinfo.stride,
+                              width,
+                              height);
+        }
 
-err:
-          free(dst);
+      /* Convert to I420 in the intermediate frame kept for the stream */
+
+      dst = pcam->convbuf;
+      DEBUGASSERT(dst != NULL);
+
+      ret = CONVERT_TO_I420(src,
+                            pcam->buf_sizes[buf->index],
+                            dst,
+                            width,
+                            &dst[width * height],
+                            width / 2,
+                            &dst[width * height * 5 / 4],
+                            width / 2,
+                            0,
+                            0,
+                            width,
+                            height,
+                            width,
+                            height,
+                            0,
+                            pcam->fmt.fmt.pix.pixelformat);
+      if (ret < 0)
+        {
           return ret;
         }
+
+      return CONVERT_FROM_I420(dst,
+                               width,
+                               &dst[width * height],
+                               width / 2,
+                               &dst[width * height * 5 / 4],
+                               width / 2,
+                               pcam->display_pinfo.fbmem,
+                               pcam->display_pinfo.stride,
+                               width,
+                               height,
+                               V4L2_PIX_FMT_RGB565);
     }
 
   return 0;
 #else
-  FAR uint32_t *pbuf = (FAR uint32_t *)pcam->bufs[buf->index];
-  vinfo("show image from %p: %" PRIx32 " %" PRIx32, pbuf, pbuf[0], pbuf[1]);
+  if (nxcamera_convert(pcam, src) < 0)
+    {
+      FAR uint32_t *pbuf = (FAR uint32_t *)src;
+      vinfo("show image from %p: %" PRIx32 " %" PRIx32, pbuf, pbuf[0],
+            pbuf[1]);
+    }
+
   return 0;
 #endif
 }
 
+/****************************************************************************
+ * Name: nxcamera_updatestats
+ *
+ *   Accounts the conversion time of one frame.
+ *
+ ****************************************************************************/
+
+static void nxcamera_updatestats(FAR struct nxcamera_s *pcam,
+                                 FAR const struct timespec *start)
+{
+  struct timespec end;
+  uint32_t us;
+
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  us = (end.tv_sec - start->tv_sec) * 1000000 +
+       (end.tv_nsec - start->tv_nsec) / 1000;
+
+  pthread_mutex_lock(&pcam->mutex);
+  pcam->stats.frames++;
+  pcam->stats.total_us += us;
+  pcam->stats.min_us    = MIN(pcam->stats.min_us, us);
+  pcam->stats.max_us    = MAX(pcam->stats.max_us, us);
+  pthread_mutex_unlock(&pcam->mutex);
+}
+
 /****************************************************************************
  * Name: nxcamera_opendevice
  *
@@ -317,6 +511,7 @@ static void *nxcamera_loopthread(pthread_addr_t pvarg)
   int                     i;
   int                     ret;
   struct v4l2_buffer      buf;
+  struct timespec         start;
   uint32_t                type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
 
   vinfo("Entry\n");
@@ -400,6 +595,8 @@ static void *nxcamera_loopthread(pthread_addr_t pvarg)
           goto err_out;
         }
 
+      clock_gettime(CLOCK_MONOTONIC, &start);
+
       ret = show_image(pcam, &buf);
       if (ret < 0)
         {
@@ -407,6 +604,8 @@ static void *nxcamera_loopthread(pthread_addr_t pvarg)
           goto err_out;
         }
 
+      nxcamera_updatestats(pcam, &start);
+
       if (pcam->display_pinfo.yres_virtual > pcam->display_vinfo.yres)
         {
           pan_display(pcam->display_fd, &pcam->display_pinfo);
@@ -443,6 +642,10 @@ err_out:
 
   free(pcam->bufs);
   free(pcam->buf_sizes);
+  free(pcam->convbuf);
+  pcam->bufs      = NULL;
+  pcam->buf_sizes = NULL;
+  pcam->convbuf   = NULL;
   pthread_mutex_unlock(&pcam->mutex);     /* Unlock the mutex */
 
   vinfo("Exit\n");
@@ -677,6 +880,7 @@ int nxcamera_stream(FAR struct nxcamera_s *pcam,
   struct v4l2_buffer         buf;
   struct v4l2_requestbuffers req;
   struct v4l2_streamparm     param;
+  size_t                     convsize;
 
   DEBUGASSERT(pcam != NULL);
 
@@ -732,6 +936,19 @@ int nxcamera_stream(FAR struct nxcamera_s *pcam,
       return ret;
     }
 
+  /* Allocate the intermediate frame once for the whole stream */
+
+  convsize = nxcamera_convsize(pcam);
+  if (convsize > 0)
+    {
+      pcam->convbuf = malloc(convsize);
+      if (pcam->convbuf == NULL)
+        {
+          verr("Cannot allocate conversion buffer\n");
+          return -ENOMEM;
+        }
+    }
+
   /* VIDIOC_REQBUFS initiate user pointer I/O */
 
   memset(&req, 0, sizeof(req));
@@ -744,13 +961,14 @@ int nxcamera_stream(FAR struct nxcamera_s *pcam,
     {
       ret = -errno;
       verr("VIDIOC_REQBUFS failed: %d\n", ret);
-      return ret;
+      goto err_out;
     }
 
   if (req.count < 2)
     {
       verr("VIDIOC_REQBUFS failed: not enough buffers\n");
-      return -ENOMEM;
+      ret = -ENOMEM;
+      goto err_out;
     }
 
   pcam->nbuffers  = req.count;
@@ -818,6 +1036,11 @@ int nxcamera_stream(FAR struct nxcamera_s *pcam,
 
   nxcamera_jointhread(pcam);
 
+  pthread_mutex_lock(&pcam->mutex);
+  memset(&pcam->stats, 0, sizeof(pcam->stats));
+  pcam->stats.min_us = UINT32_MAX;
+  pthread_mutex_unlock(&pcam->mutex);
+
   pthread_attr_init(&tattr);
   sparam.sched_priority = sched_get_priority_max(SCHED_FIFO) - 9;
   pthread_attr_setschedparam(&tattr, &sparam);
@@ -863,9 +1086,38 @@ err_out:
       free(pcam->buf_sizes);
     }
 
+  free(pcam->convbuf);
+  pcam->bufs      = NULL;
+  pcam->buf_sizes = NULL;
+  pcam->convbuf   = NULL;
   return ret;
 }
 
+/****************************************************************************
+ * Name: nxcamera_getstats
+ *
+ *   nxcamera_getstats() returns the frame conversion statistics of the
+ *   current stream, or of the last one if no stream is running.
+ *
+ ****************************************************************************/
+
+int nxcamera_getstats(FAR struct nxcamera_s *pcam,
+                      FAR struct nxcamera_stats_s *stats)
+{
+  DEBUGASSERT(pcam != NULL && stats != NULL);
+
+  pthread_mutex_lock(&pcam->mutex);
+  *stats = pcam->stats;
+  pthread_mutex_unlock(&pcam->mutex);
+
+  if (stats->frames == 0)
+    {
+      stats->min_us = 0;
+    }
+
+  return OK;
+}
+
 /****************************************************************************
  * Name: nxcamera_create
  *
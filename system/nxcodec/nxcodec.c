@@ -145,13 +145,20 @@ int nxcodec_init(FAR nxcodec_t *codec)
       goto err0;
     }
 
+  ret = nxcodec_context_open_input(&codec->output);
+  if (ret < 0)
+    {
+      printf("nxcodec can't allocate input buffer\n");
+      goto err1;
+    }
+
   codec->capture.format.type = codec->capture.type;
 
   ret = nxcodec_context_set_format(&codec->capture);
   if (ret < 0)
     {
       printf("nxcodec can't to set v4l2 capture format\n");
-      goto err1;
+      goto err2;
     }
 
   printf("nxcodec set capture format DONE\n");
@@ -163,11 +170,13 @@ int nxcodec_init(FAR nxcodec_t *codec)
       printf("nxcodec failed to open input file %s \n",
              codec->capture.filename);
       ret = -errno;
-      goto err1;
+      goto err2;
     }
 
   return 0;
 
+err2:
+  nxcodec_context_close_input(&codec->output);
 err1:
   close(codec->output.fd);
 err0:
@@ -255,6 +264,7 @@ int nxcodec_stop(FAR nxcodec_t *codec)
 
 int nxcodec_uninit(FAR nxcodec_t *codec)
 {
+  nxcodec_context_close_input(&codec->output);
   close(codec->capture.fd);
   close(codec->output.fd);
   close(codec->fd);
@@ -26,11 +26,15 @@
 
 #include <sys/ioctl.h>
 #include <sys/mman.h>
+#include <sys/stat.h>
+#include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <unistd.h>
 #include <fcntl.h>
 #include <errno.h>
+#include <string.h>
 
 #include <nuttx/nuttx.h>
 
@@ -126,59 +130,174 @@ static int nxcodec_context_read_yuv_data(FAR nxcodec_context_t *ctx,
   return 0;
 }
 
-static int nxcodec_context_read_h264_data(FAR nxcodec_context_t *ctx,
-                                          FAR char *buf,
-                                          FAR uint32_t *bytesused)
+/* Find the first 4-byte start code (00 00 00 01) in p[0..len).  Returns
+ * its offset, or len if there is none.  Four bytes are examined at a
+ * time: a start code beginning in a word must have a zero byte in it, so
+ * words without a zero byte are skipped in one step.
+ */
+
+static size_t nxcodec_context_find_startcode(FAR const uint8_t *p,
+                                             size_t len)
+{
+  size_t i = 0;
+  uint32_t w;
+
+  while (i + 4 <= len)
+    {
+      memcpy(&w, p + i, 4);
+      if (((w - 0x01010101) & ~w & 0x80808080) == 0)
+        {
+          i += 4;
+          continue;
+        }
+
+      /* No start code can begin at i..i+3 unless p[i + 3] is 0 or 1 */
+
+      if (p[i + 3] > 1)
+        {
+          i += 4;
+        }
+      else if (p[i + 3] == 0)
+        {
+          i++;
+        }
+      else if (p[i] == 0 && p[i + 1] == 0 && p[i + 2] == 0)
+        {
+          return i;
+        }
+      else
+        {
+          i += 4;
+        }
+    }
+
+  return len;
+}
+
+/* Move the unparsed bytes to the start of the read-ahead window and read
+ * until the window is full or the end of the file is reached.
+ */
+
+static int nxcodec_context_fill(FAR nxcodec_context_t *ctx)
 {
-  char start_code[4];
   ssize_t ret;
-  int size;
 
-  memset(start_code, 0, 4);
+  if (ctx->rmapped || ctx->reof)
+    {
+      return 0;
+    }
 
-  ret = read(ctx->fd, buf, 4);
-  if (ret <= 0)
+  if (ctx->rpos > 0)
     {
-      return -errno;
+      memmove(ctx->rbuf, ctx->rbuf + ctx->rpos, ctx->rlen - ctx->rpos);
+      ctx->rlen -= ctx->rpos;
+      ctx->rpos = 0;
     }
 
-  if (buf[0] == 0x00 && buf[1] == 0x00 &&
-      buf[2] == 0x00 && buf[3] == 0x01)
+  while (ctx->rlen < ctx->rbufsize)
     {
-      size = 4;
-      while (1)
+      ret = read(ctx->fd, ctx->rbuf + ctx->rlen, ctx->rbufsize - ctx->rlen);
+      if (ret < 0)
         {
-          ret = read(ctx->fd, buf + size, 1);
-          if (ret < 0)
-            {
-              return -errno;
-            }
-          else if (ret == 0)
+          if (errno == EINTR)
             {
-              break;
+              continue;
             }
 
-          start_code[0] = start_code[1];
-          start_code[1] = start_code[2];
-          start_code[2] = start_code[3];
-          start_code[3] = *(buf + size);
-          size++;
+          return -errno;
+        }
+      else if (ret == 0)
+        {
+          ctx->reof = true;
+          break;
+        }
 
-          if (start_code[0] == 0x00 && start_code[1] == 0x00 &&
-              start_code[2] == 0x00 && start_code[3] == 0x01)
-            {
-              size -= 4;
-              lseek(ctx->fd, -4, SEEK_CUR);
-              break;
-            }
+      ctx->rlen += ret;
+    }
+
+  return 0;
+}
+
+/* Copy the next NAL unit, including its start code, into an OUTPUT
+ * buffer.  NAL units are delimited by 4-byte start codes.
+ */
+
+static int nxcodec_context_read_h264_data(FAR nxcodec_context_t *ctx,
+                                          FAR char *buf, size_t buflen,
+                                          FAR uint32_t *bytesused)
+{
+  FAR const uint8_t *p;
+  size_t scan = 4;
+  size_t size = 0;
+  size_t off;
+  size_t n;
+  int ret;
+
+  if (ctx->rlen - ctx->rpos < 4)
+    {
+      ret = nxcodec_context_fill(ctx);
+      if (ret < 0)
+        {
+          return ret;
+        }
+
+      if (ctx->rlen == ctx->rpos)
+        {
+          return -ENODATA;
         }
     }
-  else
+
+  p = ctx->rbuf + ctx->rpos;
+  if (ctx->rlen - ctx->rpos < 4 ||
+      p[0] != 0x00 || p[1] != 0x00 || p[2] != 0x00 || p[3] != 0x01)
     {
       return -EINVAL;
     }
 
-  *bytesused = size;
+  while (1)
+    {
+      n   = ctx->rlen - ctx->rpos;
+      off = nxcodec_context_find_startcode(ctx->rbuf + ctx->rpos + scan,
+                                           n - scan);
+      if (off < n - scan || ctx->rmapped || ctx->reof)
+        {
+          /* The NAL unit ends at the next start code or the end of file */
+
+          n = scan + off;
+          break;
+        }
+
+      /* The window holds no further start code.  Move all but the last
+       * three bytes, which may begin one, to the OUTPUT buffer and read
+       * more.
+       */
+
+      n -= 3;
+      if (size + n > buflen)
+        {
+          return -ENOBUFS;
+        }
+
+      memcpy(buf + size, ctx->rbuf + ctx->rpos, n);
+      size      += n;
+      ctx->rpos += n;
+      scan       = 0;
+
+      ret = nxcodec_context_fill(ctx);
+      if (ret < 0)
+        {
+          return ret;
+        }
+    }
+
+  if (size + n > buflen)
+    {
+      return -ENOBUFS;
+    }
+
+  memcpy(buf + size, ctx->rbuf + ctx->rpos, n);
+  ctx->rpos += n;
+  *bytesused = size + n;
 
   return 0;
 }
@@ -210,6 +329,7 @@ int nxcodec_context_enqueue_frame(FAR nxcodec_context_t *ctx)
     {
       ret = nxcodec_context_read_h264_data(ctx,
                                            buf->addr,
+                                           buf->length,
                                            &buf->buf.bytesused);
       if (ret < 0)
         {
@@ -385,6 +505,63 @@ error:
   return -errno;
 }
 
+int nxcodec_context_open_input(FAR nxcodec_context_t *ctx)
+{
+#ifdef CONFIG_SYSTEM_NXCODEC_MMAP
+  struct stat st;
+#endif
+
+  ctx->rbuf    = NULL;
+  ctx->rlen    = 0;
+  ctx->rpos    = 0;
+  ctx->rmapped = false;
+  ctx->reof    = false;
+
+  if (ctx->format.fmt.pix.pixelformat != V4L2_PIX_FMT_H264)
+    {
+      return 0;
+    }
+
+#ifdef CONFIG_SYSTEM_NXCODEC_MMAP
+  if (fstat(ctx->fd, &st) == 0 && st.st_size > 0)
+    {
+      FAR void *addr = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE,
+                            ctx->fd, 0);
+      if (addr != MAP_FAILED)
+        {
+          ctx->rbuf     = addr;
+          ctx->rbufsize = st.st_size;
+          ctx->rlen     = st.st_size;
+          ctx->rmapped  = true;
+          return 0;
+        }
+    }
+#endif
+
+  ctx->rbufsize = CONFIG_SYSTEM_NXCODEC_READAHEAD;
+  ctx->rbuf     = malloc(ctx->rbufsize);
+  if (!ctx->rbuf)
+    {
+      return -ENOMEM;
+    }
+
+  return 0;
+}
+
+void nxcodec_context_close_input(FAR nxcodec_context_t *ctx)
+{
+  if (ctx->rmapped)
+    {
+      munmap(ctx->rbuf, ctx->rbufsize);
+    }
+  else
+    {
+      free(ctx->rbuf);
+    }
+
+  ctx->rbuf = NULL;
+}
+
 void nxcodec_context_uninit(FAR nxcodec_context_t *ctx)
 {
   int i;
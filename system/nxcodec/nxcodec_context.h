@@ -49,6 +49,15 @@ typedef struct nxcodec_context_s
   struct v4l2_format        format;
   FAR nxcodec_context_buf_t *buf;
   int                       nbuffers;
+
+  /* Input bitstream window, either read ahead or the mapped file */
+
+  FAR uint8_t               *rbuf;
+  size_t                    rbufsize;
+  size_t                    rlen;
+  size_t                    rpos;
+  bool                      rmapped;
+  bool                      reof;
 } nxcodec_context_t;
 
 /****************************************************************************
@@ -56,6 +65,8 @@ typedef struct nxcodec_context_s
  ****************************************************************************/
 
 int nxcodec_context_init(FAR nxcodec_context_t *ctx);
+int nxcodec_context_open_input(FAR nxcodec_context_t *ctx);
+void nxcodec_context_close_input(FAR nxcodec_context_t *ctx);
 int nxcodec_context_set_status(FAR nxcodec_context_t *ctx, uint32_t cmd);
 int nxcodec_context_enqueue_frame(FAR nxcodec_context_t *ctx);
 int nxcodec_context_dequeue_frame(FAR nxcodec_context_t *ctx);
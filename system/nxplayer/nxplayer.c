@@ -43,6 +43,7 @@
 #include <sys/ioctl.h>
 #include <sys/types.h>
 #include <sys/param.h>
+#include <time.h>
 #include <unistd.h>
 #ifdef CONFIG_NXPLAYER_HTTP_STREAMING_SUPPORT
 #  include <sys/time.h>
@@ -72,6 +73,10 @@
 #  define CONFIG_NXPLAYER_PLAYTHREAD_STACKSIZE    1500
 #endif
 
+#ifndef CONFIG_NXPLAYER_PREFETCH_STACKSIZE
+#  define CONFIG_NXPLAYER_PREFETCH_STACKSIZE      1500
+#endif
+
 /****************************************************************************
  * Private Types
  ****************************************************************************/
@@ -85,6 +90,30 @@ struct nxplayer_ext_fmt_s
 };
 #endif
 
+#ifdef CONFIG_NXPLAYER_PREFETCH
+/* State of the reader thread.  The chunks form a ring: the reader fills
+ * the chunk after the last filled one and the play thread consumes from
+ * head.
+ */
+
+struct nxplayer_prefetch_s
+{
+  FAR struct nxplayer_s  *pplayer;   /* Owning player */
+  FAR const struct nxplayer_dec_ops_s *ops; /* Decoder fill hook */
+  int                     fd;        /* Media file being read */
+  pthread_t               id;        /* Thread ID of the reader */
+  pthread_mutex_t         lock;      /* Protects the fields below */
+  pthread_cond_t          cond;      /* Signalled when the ring changes */
+  FAR struct ap_buffer_s *chunks;    /* Ring of read-ahead buffers */
+  FAR uint8_t            *data;      /* Sample memory of all chunks */
+  int                     nchunks;   /* Number of chunks in the ring */
+  int                     head;      /* Next chunk to consume */
+  int                     count;     /* Number of filled chunks */
+  bool                    eof;       /* The reader has read the last chunk */
+  bool                    stop;      /* The reader must exit */
+};
+#endif
+
 /****************************************************************************
  * Private Function Prototypes
  ****************************************************************************/
@@ -696,6 +725,289 @@ static int nxplayer_filltone(FAR struct nxplayer_tone_s *tone,
   return 0;
 }
 
+/****************************************************************************
+ * Name: nxplayer_prefetchthread
+ *
+ *   This is the reader thread.  It reads the media file into free chunks
+ *   of the read-ahead ring until the end of the file or until it is told
+ *   to stop.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NXPLAYER_PREFETCH
+static FAR void *nxplayer_prefetchthread(pthread_addr_t pvarg)
+{
+  FAR struct nxplayer_prefetch_s *pf =
+    (FAR struct nxplayer_prefetch_s *)pvarg;
+  FAR struct nxplayer_s *pplayer = pf->pplayer;
+  FAR struct ap_buffer_s *chunk;
+  struct timespec start;
+  struct timespec end;
+  uint32_t elapsed;
+  int ret;
+
+  for (; ; )
+    {
+      /* Wait for a free chunk */
+
+      pthread_mutex_lock(&pf->lock);
+      while (!pf->stop && pf->count == pf->nchunks)
+        {
+          pthread_cond_wait(&pf->cond, &pf->lock);
+        }
+
+      if (pf->stop)
+        {
+          pthread_mutex_unlock(&pf->lock);
+          break;
+        }
+
+      /* The play thread never touches a chunk that is not filled, so it
+       * can be read without holding the lock.
+       */
+
+      chunk = &pf->chunks[(pf->head + pf->count) % pf->nchunks];
+      pthread_mutex_unlock(&pf->lock);
+
+      clock_gettime(CLOCK_MONOTONIC, &start);
+      ret = pf->ops->fill_data(pf->fd, chunk);
+      clock_gettime(CLOCK_MONOTONIC, &end);
+
+      elapsed = (end.tv_sec - start.tv_sec) * 1000000 +
+                (end.tv_nsec - start.tv_nsec) / 1000;
+
+      pthread_mutex_lock(&pplayer->mutex);
+      if (elapsed > pplayer->stats.maxread_us)
+        {
+          pplayer->stats.maxread_us = elapsed;
+        }
+
+      pthread_mutex_unlock(&pplayer->mutex);
+
+      /* The chunk is passed on even at the end of the file, since it
+       * carries the AUDIO_APB_FINAL flag.
+       */
+
+      pthread_mutex_lock(&pf->lock);
+      pf->count++;
+      if (ret < 0)
+        {
+          pf->eof = true;
+        }
+
+      pthread_cond_broadcast(&pf->cond);
+      pthread_mutex_unlock(&pf->lock);
+
+      if (ret < 0)
+        {
+          break;
+        }
+    }
+
+  return NULL;
+}
+
+/****************************************************************************
+ * Name: nxplayer_freeprefetch
+ *
+ *   Release the memory of the read-ahead state.
+ *
+ ****************************************************************************/
+
+static void nxplayer_freeprefetch(FAR struct nxplayer_prefetch_s *pf)
+{
+  pthread_cond_destroy(&pf->cond);
+  pthread_mutex_destroy(&pf->lock);
+  free(pf->data);
+  free(pf->chunks);
+  free(pf);
+}
+
+/****************************************************************************
+ * Name: nxplayer_startprefetch
+ *
+ *   Start the reader thread on the open media file.  The chunks are
+ *   sized like the audio device buffers.  If the reader cannot be started,
+ *   the play thread reads the file itself.
+ *
+ ****************************************************************************/
+
+static int nxplayer_startprefetch(FAR struct nxplayer_s *pplayer,
+                                  apb_samp_t bufsize)
+{
+  FAR struct nxplayer_prefetch_s *pf;
+  struct sched_param sparam;
+  pthread_attr_t tattr;
+  int ret;
+  int x;
+
+  pf = (FAR struct nxplayer_prefetch_s *)
+    calloc(1, sizeof(struct nxplayer_prefetch_s));
+  if (pf == NULL)
+    {
+      return -ENOMEM;
+    }
+
+  pf->pplayer = pplayer;
+  pf->ops     = pplayer->ops;
+  pf->fd      = pplayer->fd;
+  pf->nchunks = MAX(2, CONFIG_NXPLAYER_PREFETCH_SIZE / bufsize);
+  pthread_mutex_init(&pf->lock, NULL);
+  pthread_cond_init(&pf->cond, NULL);
+
+  pf->chunks = (FAR struct ap_buffer_s *)
+    calloc(pf->nchunks, sizeof(struct ap_buffer_s));
+  pf->data   = (FAR uint8_t *)malloc(pf->nchunks * bufsize);
+  if (pf->chunks == NULL || pf->data == NULL)
+    {
+      ret = -ENOMEM;
+      goto errout;
+    }
+
+  for (x = 0; x < pf->nchunks; x++)
+    {
+      pf->chunks[x].samp      = &pf->data[x * bufsize];
+      pf->chunks[x].nmaxbytes = bufsize;
+    }
+
+  pthread_mutex_lock(&pplayer->mutex);
+  memset(&pplayer->stats, 0, sizeof(pplayer->stats));
+  pplayer->stats.lowwater = pf->nchunks;
+  pplayer->stats.nchunks  = pf->nchunks;
+  pthread_mutex_unlock(&pplayer->mutex);
+
+  /* Run the reader just below the play thread so that a long read never
+   * delays the refill of a dequeued buffer.
+   */
+
+  pthread_attr_init(&tattr);
+  sparam.sched_priority = sched_get_priority_max(SCHED_FIFO) - 10;
+  pthread_attr_setschedparam(&tattr, &sparam);
+  pthread_attr_setstacksize(&tattr, CONFIG_NXPLAYER_PREFETCH_STACKSIZE);
+
+  ret = pthread_create(&pf->id, &tattr, nxplayer_prefetchthread,
+                       (pthread_addr_t)pf);
+  pthread_attr_destroy(&tattr);
+  if (ret != OK)
+    {
+      auderr("ERROR: Failed to create reader thread: %d\n", ret);
+      ret = -ret;
+      goto errout;
+    }
+
+  pthread_setname_np(pf->id, "nxplayer_read");
+  pplayer->prefetch = pf;
+  return OK;
+
+errout:
+  nxplayer_freeprefetch(pf);
+  return ret;
+}
+
+/****************************************************************************
+ * Name: nxplayer_stopprefetch
+ *
+ *   Stop the reader thread, if it is running, and release the read-ahead
+ *   buffer.  This must be done before the media file is closed.
+ *
+ ****************************************************************************/
+
+static void nxplayer_stopprefetch(FAR struct nxplayer_s *pplayer)
+{
+  FAR struct nxplayer_prefetch_s *pf = pplayer->prefetch;
+
+  if (pf == NULL)
+    {
+      return;
+    }
+
+  pthread_mutex_lock(&pf->lock);
+  pf->stop = true;
+  pthread_cond_broadcast(&pf->cond);
+  pthread_mutex_unlock(&pf->lock);
+
+  /* A reader blocked in read() finishes that read first */
+
+  pthread_join(pf->id, NULL);
+
+  pplayer->prefetch = NULL;
+  nxplayer_freeprefetch(pf);
+}
+
+/****************************************************************************
+ * Name: nxplayer_readprefetch
+ *
+ *   Take the next chunk from the read-ahead ring and copy it into the
+ *   audio buffer.  The audio device owns its buffers, so the data cannot
+ *   be handed over without a copy.
+ *
+ ****************************************************************************/
+
+static int nxplayer_readprefetch(FAR struct nxplayer_s *pplayer,
+                                 FAR struct ap_buffer_s *apb)
+{
+  FAR struct nxplayer_prefetch_s *pf = pplayer->prefetch;
+  FAR struct ap_buffer_s *chunk;
+  bool underrun;
+  int level;
+
+  pthread_mutex_lock(&pf->lock);
+
+  level    = pf->count;
+  underrun = pf->count == 0 && !pf->eof;
+
+  while (pf->count == 0 && !pf->eof)
+    {
+      pthread_cond_wait(&pf->cond, &pf->lock);
+    }
+
+  if (pf->count == 0)
+    {
+      /* The reader has delivered the last chunk already */
+
+      pthread_mutex_unlock(&pf->lock);
+      return -ENODATA;
+    }
+
+  chunk = &pf->chunks[pf->head];
+  pthread_mutex_unlock(&pf->lock);
+
+  /* The reader does not touch a filled chunk, so copy without the lock */
+
+  memcpy(apb->samp, chunk->samp, MIN(chunk->nbytes, apb->nmaxbytes));
+  apb->nbytes  = MIN(chunk->nbytes, apb->nmaxbytes);
+  apb->curbyte = 0;
+  apb->flags   = chunk->flags;
+
+  pthread_mutex_lock(&pf->lock);
+  pf->head = (pf->head + 1) % pf->nchunks;
+  pf->count--;
+  pthread_cond_broadcast(&pf->cond);
+  pthread_mutex_unlock(&pf->lock);
+
+  /* The initial fill of the audio device always finds the ring empty, so
+   * only count underruns once playback has started.
+   */
+
+  pthread_mutex_lock(&pplayer->mutex);
+  if (pplayer->state != NXPLAYER_STATE_IDLE)
+    {
+      if (underrun)
+        {
+          pplayer->stats.underruns++;
+        }
+
+      if ((uint32_t)level < pplayer->stats.lowwater)
+        {
+          pplayer->stats.lowwater = level;
+        }
+    }
+
+  pthread_mutex_unlock(&pplayer->mutex);
+  return OK;
+}
+#endif
+
 /****************************************************************************
  * Name: nxplayer_readbuffer
  *
@@ -723,6 +1035,13 @@ static int nxplayer_readbuffer(FAR struct nxplayer_s *pplayer,
       return -ENODATA;
     }
 
+#ifdef CONFIG_NXPLAYER_PREFETCH
+  if (pplayer->prefetch != NULL)
+    {
+      return nxplayer_readprefetch(pplayer, apb);
+    }
+#endif
+
   ret = pplayer->ops->fill_data(pplayer->fd, apb);
   if (ret < 0)
     {
@@ -892,6 +1211,16 @@ static FAR void *nxplayer_playthread(pthread_addr_t pvarg)
         }
     }
 
+#ifdef CONFIG_NXPLAYER_PREFETCH
+  /* Start reading ahead of the audio device */
+
+  if (!pplayer->tone.sample_rate && pplayer->fd >= 0 &&
+      nxplayer_startprefetch(pplayer, buffers[0]->nmaxbytes) < 0)
+    {
+      auderr("ERROR: Read-ahead disabled\n");
+    }
+#endif
+
   /* Fill up the pipeline with enqueued buffers */
 
   for (x = 0; x < buf_info.nbuffers; x++)
@@ -953,6 +1282,9 @@ static FAR void *nxplayer_playthread(pthread_addr_t pvarg)
                * file so that no further data is read.
                */
 
+#ifdef CONFIG_NXPLAYER_PREFETCH
+              nxplayer_stopprefetch(pplayer);
+#endif
               close(pplayer->fd);
               pplayer->fd = -1;
 
@@ -1125,6 +1457,9 @@ static FAR void *nxplayer_playthread(pthread_addr_t pvarg)
                          * Close the file so that no further data is read.
                          */
 
+#ifdef CONFIG_NXPLAYER_PREFETCH
+                        nxplayer_stopprefetch(pplayer);
+#endif
                         close(pplayer->fd);
                         pplayer->fd = -1;
 
@@ -1229,6 +1564,10 @@ err_out:
 
   /* Cleanup */
 
+#ifdef CONFIG_NXPLAYER_PREFETCH
+  nxplayer_stopprefetch(pplayer);
+#endif
+
   pthread_mutex_lock(&pplayer->mutex);
 
   /* Close the files */
@@ -2332,6 +2671,11 @@ FAR struct nxplayer_s *nxplayer_create(void)
 
   memset(&pplayer->tone, 0, sizeof(pplayer->tone));
 
+#ifdef CONFIG_NXPLAYER_PREFETCH
+  pplayer->prefetch = NULL;
+  memset(&pplayer->stats, 0, sizeof(pplayer->stats));
+#endif
+
 #ifdef CONFIG_NXPLAYER_INCLUDE_MEDIADIR
   strlcpy(pplayer->mediadir, CONFIG_NXPLAYER_DEFAULT_MEDIADIR,
           sizeof(pplayer->mediadir));
@@ -2400,6 +2744,28 @@ void nxplayer_reference(FAR struct nxplayer_s *pplayer)
   pthread_mutex_unlock(&pplayer->mutex);
 }
 
+/****************************************************************************
+ * Name: nxplayer_getstats
+ *
+ *   nxplayer_getstats() returns the read-ahead statistics of the current
+ *   or last playback.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NXPLAYER_PREFETCH
+int nxplayer_getstats(FAR struct nxplayer_s *pplayer,
+                      FAR struct nxplayer_stats_s *stats)
+{
+  DEBUGASSERT(pplayer != NULL && stats != NULL);
+
+  pthread_mutex_lock(&pplayer->mutex);
+  *stats = pplayer->stats;
+  pthread_mutex_unlock(&pplayer->mutex);
+
+  return OK;
+}
+#endif
+
 /****************************************************************************
  * Name: nxplayer_systemreset
  *
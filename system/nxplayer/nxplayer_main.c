@@ -89,6 +89,10 @@ static int nxplayer_cmd_resume(FAR struct nxplayer_s *pplayer, char *parg);
 static int nxplayer_cmd_mediadir(FAR struct nxplayer_s *pplayer, char *parg);
 #endif
 
+#ifdef CONFIG_NXPLAYER_PREFETCH
+static int nxplayer_cmd_stats(FAR struct nxplayer_s *pplayer, char *parg);
+#endif
+
 #ifndef CONFIG_AUDIO_EXCLUDE_STOP
 static int nxplayer_cmd_stop(FAR struct nxplayer_s *pplayer, char *parg);
 #endif
@@ -199,6 +203,14 @@ static struct mp_cmd_s g_nxplayer_cmds[] =
     NXPLAYER_HELP_TEXT("Resume playback")
   },
 #endif
+#ifdef CONFIG_NXPLAYER_PREFETCH
+  {
+    "stats",
+    "",
+    nxplayer_cmd_stats,
+    NXPLAYER_HELP_TEXT("Show read-ahead statistics")
+  },
+#endif
 #ifndef CONFIG_AUDIO_EXCLUDE_STOP
   {
     "stop",
@@ -588,6 +600,30 @@ static int nxplayer_cmd_mediadir(FAR struct nxplayer_s *pplayer, char *parg)
 }
 #endif
 
+/****************************************************************************
+ * Name: nxplayer_cmd_stats
+ *
+ *   nxplayer_cmd_stats() shows the read-ahead statistics of the current
+ *   or last playback.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NXPLAYER_PREFETCH
+static int nxplayer_cmd_stats(FAR struct nxplayer_s *pplayer, char *parg)
+{
+  struct nxplayer_stats_s stats;
+
+  nxplayer_getstats(pplayer, &stats);
+
+  printf("Chunks:     %" PRIu32 "\n", stats.nchunks);
+  printf("Low water:  %" PRIu32 "\n", stats.lowwater);
+  printf("Underruns:  %" PRIu32 "\n", stats.underruns);
+  printf("Max read:   %" PRIu32 " us\n", stats.maxread_us);
+
+  return OK;
+}
+#endif
+
 /****************************************************************************
  * Name: nxplayer_cmd_stop
  *
@@ -57,6 +57,14 @@
 #  define CONFIG_SYSTEM_SETTINGS_CACHE_TIME_MS 100
 #endif
 
+/* Key index: open addressing hash table with linear probing. It is kept
+ * at most half full, so probe sequences stay short.  Each slot holds the
+ * map position + 1, zero marks a free slot.
+ */
+
+#define INDEX_SIZE     (2 * CONFIG_SYSTEM_SETTINGS_MAP_SIZE)
+#define DIRTY_SIZE     ((CONFIG_SYSTEM_SETTINGS_MAP_SIZE + 7) / 8)
+
 /****************************************************************************
  * Private Types
  ****************************************************************************/
@@ -66,6 +74,13 @@
  ****************************************************************************/
 
 static int      sanity_check(FAR char *str);
+static uint32_t key_hash(FAR const char *key);
+static int      index_find(FAR const char *key);
+static void     index_insert(int idx);
+static void     index_rebuild(void);
+static void     dirty_set(int idx);
+static void     dirty_setall(void);
+static uint32_t setting_crc(FAR setting_t *setting);
 static uint32_t hash_calc(void);
 static int      get_setting(FAR char *key, FAR setting_t **setting);
 static size_t   get_string(FAR setting_t *setting, FAR char *buffer,
@@ -97,6 +112,9 @@ static struct
   uint32_t          hash;
   bool              wrpend;
   bool              initialized;
+  int               count;                 /* Used entries in the map */
+  uint16_t          index[INDEX_SIZE];     /* Key index */
+  uint8_t           dirty[DIRTY_SIZE];     /* Changed, not saved entries */
   storage_t         store[CONFIG_SYSTEM_SETTINGS_MAX_STORAGES];
   struct notify_s   notify[CONFIG_SYSTEM_SETTINGS_MAX_SIGNALS];
 #if defined(CONFIG_SYSTEM_SETTINGS_CACHED_SAVES)
@@ -112,22 +130,210 @@ setting_t map[CONFIG_SYSTEM_SETTINGS_MAP_SIZE];
  * Private Functions
  ****************************************************************************/
 
+/****************************************************************************
+ * Name: key_hash
+ *
+ * Description:
+ *    Calculates the index hash of a key (FNV-1a)
+ *
+ * Input Parameters:
+ *    key        - the key to hash
+ *
+ * Returned Value:
+ *   The key hash
+ *
+ ****************************************************************************/
+
+static uint32_t key_hash(FAR const char *key)
+{
+  uint32_t h = 2166136261u;
+  int i;
+
+  for (i = 0; i < CONFIG_SYSTEM_SETTINGS_KEY_SIZE && key[i] != '\0'; i++)
+    {
+      h ^= (uint8_t)key[i];
+      h *= 16777619u;
+    }
+
+  return h;
+}
+
+/****************************************************************************
+ * Name: index_find
+ *
+ * Description:
+ *    Looks up a key in the key index
+ *
+ * Input Parameters:
+ *    key        - key of the required setting
+ *
+ * Returned Value:
+ *   Position of the setting in the map, or -1 if not found
+ *
+ ****************************************************************************/
+
+static int index_find(FAR const char *key)
+{
+  uint32_t pos = key_hash(key) % INDEX_SIZE;
+  int idx;
+
+  while (g_settings.index[pos] != 0)
+    {
+      idx = g_settings.index[pos] - 1;
+      if (strncmp(map[idx].key, key, CONFIG_SYSTEM_SETTINGS_KEY_SIZE) == 0)
+        {
+          return idx;
+        }
+
+      pos = (pos + 1) % INDEX_SIZE;
+    }
+
+  return -1;
+}
+
+/****************************************************************************
+ * Name: index_insert
+ *
+ * Description:
+ *    Adds a map entry to the key index
+ *
+ * Input Parameters:
+ *    idx        - position of the setting in the map
+ *
+ * Returned Value:
+ *   None
+ *
+ ****************************************************************************/
+
+static void index_insert(int idx)
+{
+  uint32_t pos = key_hash(map[idx].key) % INDEX_SIZE;
+
+  while (g_settings.index[pos] != 0)
+    {
+      pos = (pos + 1) % INDEX_SIZE;
+    }
+
+  g_settings.index[pos] = idx + 1;
+}
+
+/****************************************************************************
+ * Name: index_rebuild
+ *
+ * Description:
+ *    Rebuilds the key index from the map. Must be called whenever the map
+ *    was changed in bulk (loaded from a storage or cleared).
+ *
+ * Input Parameters:
+ *    none
+ *
+ * Returned Value:
+ *   None
+ *
+ ****************************************************************************/
+
+static void index_rebuild(void)
+{
+  int i;
+
+  memset(g_settings.index, 0, sizeof(g_settings.index));
+
+  for (i = 0; i < CONFIG_SYSTEM_SETTINGS_MAP_SIZE; i++)
+    {
+      if (map[i].type == SETTING_EMPTY)
+        {
+          break;
+        }
+
+      index_insert(i);
+    }
+
+  g_settings.count = i;
+}
+
+/****************************************************************************
+ * Name: dirty_set
+ *
+ * Description:
+ *    Marks a map entry as changed since the last save
+ *
+ * Input Parameters:
+ *    idx        - position of the setting in the map
+ *
+ * Returned Value:
+ *   None
+ *
+ ****************************************************************************/
+
+static void dirty_set(int idx)
+{
+  g_settings.dirty[idx / 8] |= 1 << (idx % 8);
+}
+
+/****************************************************************************
+ * Name: dirty_setall
+ *
+ * Description:
+ *    Marks all map entries as changed since the last save
+ *
+ * Input Parameters:
+ *    none
+ *
+ * Returned Value:
+ *   None
+ *
+ ****************************************************************************/
+
+static void dirty_setall(void)
+{
+  memset(g_settings.dirty, 0xff, sizeof(g_settings.dirty));
+}
+
+/****************************************************************************
+ * Name: setting_crc
+ *
+ * Description:
+ *    Calculates the crc32 of a single setting
+ *
+ * Input Parameters:
+ *    setting    - pointer to the setting
+ *
+ * Returned Value:
+ *   crc32 of the setting
+ *
+ ****************************************************************************/
+
+static uint32_t setting_crc(FAR setting_t *setting)
+{
+  return crc32((FAR uint8_t *)setting, sizeof(setting_t));
+}
+
 /****************************************************************************
  * Name: hash_calc
  *
  * Description:
- *    Gets a setting for a string value
+ *    Calculates the hash of the whole map.  The hash is the XOR of the
+ *    crc32 of every used setting, so it can be updated incrementally when a
+ *    single setting changes.
  *
  * Input Parameters:
  *    none
  * Returned Value:
- *   crc32 hash of all the settings
+ *   hash of all the settings
  *
  ****************************************************************************/
 
 static uint32_t hash_calc(void)
 {
-  return crc32((FAR uint8_t *)map, sizeof(map));
+  uint32_t h = 0;
+  int i;
+
+  for (i = 0; i < g_settings.count; i++)
+    {
+      h ^= setting_crc(&map[i]);
+    }
+
+  return h;
 }
 
 /****************************************************************************
@@ -159,23 +365,15 @@ static int get_setting(FAR char *key, FAR setting_t **setting)
       goto exit;
     }
 
-  for (i = 0; i < CONFIG_SYSTEM_SETTINGS_MAP_SIZE; i++)
+  i = index_find(key);
+  if (i < 0)
     {
-      if (map[i].type == SETTING_EMPTY)
-        {
-          ret = -ENOENT;
-          goto exit;
-        }
-
-      if (strncmp(map[i].key, key, CONFIG_SYSTEM_SETTINGS_KEY_SIZE) == 0)
-        {
-          *setting = &map[i];
-          goto exit;
-        }
+      *setting = NULL;
+      ret = -ENOENT;
+      goto exit;
     }
 
-  *setting = NULL;
-  ret = -ENOENT;
+  *setting = &map[i];
 
 exit:
   return ret;
@@ -685,6 +883,7 @@ static void signotify(void)
 
 static void dump_cache_locked(FAR bool *wrpend)
 {
+  bool saved = true;
   int i;
 
   for (i = 0; i < CONFIG_SYSTEM_SETTINGS_MAX_STORAGES; i++)
@@ -692,10 +891,22 @@ static void dump_cache_locked(FAR bool *wrpend)
       if ((g_settings.store[i].file[0] != '\0') &&
            g_settings.store[i].save_fn)
         {
-          (void)g_settings.store[i].save_fn(g_settings.store[i].file);
+          if (g_settings.store[i].save_fn(g_settings.store[i].file) < 0)
+            {
+              saved = false;
+            }
         }
     }
 
+  /* Keep the dirty entries if any storage failed, so that the next save
+   * writes them again.
+   */
+
+  if (saved)
+    {
+      memset(g_settings.dirty, 0, sizeof(g_settings.dirty));
+    }
+
   *wrpend = false;
 }
 
@@ -764,6 +975,27 @@ static int sanity_check(FAR char *str)
  * Public Functions
  ****************************************************************************/
 
+/****************************************************************************
+ * Name: settings_isdirty
+ *
+ * Description:
+ *    Checks if a map entry has changed since the last save.  Used by the
+ *    storages that only write out the changed entries.  The caller must
+ *    hold g_settings.mtx (i.e. be called from a save function).
+ *
+ * Input Parameters:
+ *    idx        - position of the setting in the map
+ *
+ * Returned Value:
+ *   true if the entry has changed
+ *
+ ****************************************************************************/
+
+bool settings_isdirty(int idx)
+{
+  return (g_settings.dirty[idx / 8] & (1 << (idx % 8))) != 0;
+}
+
 /****************************************************************************
  * Name: settings_init
  *
@@ -788,6 +1020,9 @@ void settings_init(void)
   memset(map, 0, sizeof(map));
   memset(g_settings.store, 0, sizeof(g_settings.store));
   memset(g_settings.notify, 0, sizeof(g_settings.notify));
+  memset(g_settings.index, 0, sizeof(g_settings.index));
+  memset(g_settings.dirty, 0, sizeof(g_settings.dirty));
+  g_settings.count = 0;
 
 #if defined(CONFIG_SYSTEM_SETTINGS_CACHED_SAVES)
   memset(&g_settings.sev, 0, sizeof(struct sigevent));
@@ -884,6 +1119,13 @@ int settings_setstorage(FAR char *file, enum storage_type_e type)
       }
       break;
 
+    case STORAGE_JOURNAL:
+      {
+        storage->load_fn = load_journal;
+        storage->save_fn = save_journal;
+      }
+      break;
+
     default:
       {
         assert(0);
@@ -893,6 +1135,9 @@ int settings_setstorage(FAR char *file, enum storage_type_e type)
 
   ret = storage->load_fn(storage->file);
 
+  /* Loading may have added or changed any entry */
+
+  index_rebuild();
   h = hash_calc();
 
   /* Only save if there are more than 1 storages. */
@@ -900,6 +1145,7 @@ int settings_setstorage(FAR char *file, enum storage_type_e type)
   if ((storage != &g_settings.store[0]) && ((h != g_settings.hash) ||
       (access(file, F_OK) != 0)))
     {
+      dirty_setall();
       signotify();
       save();
     }
@@ -946,10 +1192,12 @@ int settings_sync(bool wait_dump)
       goto done;
     }
 
+  index_rebuild();
   h = hash_calc();
   if (h != g_settings.hash)
     {
       g_settings.hash = h;
+      dirty_setall();
       signotify();
       save();
     }
@@ -1086,8 +1334,11 @@ int settings_clear(void)
     }
 
   memset(map, 0, sizeof(map));
+  memset(g_settings.index, 0, sizeof(g_settings.index));
+  g_settings.count = 0;
   g_settings.hash = 0;
 
+  dirty_setall();
   save();
 
   pthread_mutex_unlock(&g_settings.mtx);
@@ -1151,26 +1402,25 @@ int settings_create(FAR char *key, enum settings_type_e type, ...)
       return ret;
     }
 
-  for (j = 0; j < CONFIG_SYSTEM_SETTINGS_MAP_SIZE; j++)
+  j = index_find(key);
+  if (j >= 0)
     {
-      if (strncmp(key, map[j].key, CONFIG_SYSTEM_SETTINGS_KEY_SIZE) == 0)
-        {
-          setting = &map[j];
+      setting = &map[j];
 
-          /* We found a setting with this key name */
+      /* We found a setting with this key name */
 
-          goto errout;
-        }
+      goto errout;
+    }
 
-      if (map[j].type == SETTING_EMPTY)
-        {
-          setting = &map[j];
-          strlcpy(setting->key, key, CONFIG_SYSTEM_SETTINGS_KEY_SIZE);
+  /* Used entries are always packed at the start of the map */
 
-          /* This setting is empty/unused - we can use it */
+  j = g_settings.count;
+  if (j < CONFIG_SYSTEM_SETTINGS_MAP_SIZE)
+    {
+      setting = &map[j];
+      strlcpy(setting->key, key, CONFIG_SYSTEM_SETTINGS_KEY_SIZE);
 
-         break;
-        }
+      /* This setting is empty/unused - we can use it */
     }
 
   if (setting == NULL)
@@ -1287,7 +1537,10 @@ int settings_create(FAR char *key, enum settings_type_e type, ...)
         }
       else
         {
-          g_settings.hash = hash_calc();
+          index_insert(j);
+          g_settings.count++;
+          g_settings.hash ^= setting_crc(setting);
+          dirty_set(j);
           save();
         }
     }
@@ -1455,6 +1708,7 @@ int settings_set(FAR char *key, enum settings_type_e type, ...)
 {
   int ret;
   FAR setting_t *setting = NULL;
+  uint32_t old;
   uint32_t h;
 
   assert(g_settings.initialized);
@@ -1473,6 +1727,8 @@ int settings_set(FAR char *key, enum settings_type_e type, ...)
       goto errout;
     }
 
+  old = setting_crc(setting);
+
   va_list ap;
   va_start(ap, type);
 
@@ -1524,10 +1780,13 @@ int settings_set(FAR char *key, enum settings_type_e type, ...)
 
   if (ret >= 0)
     {
-      h = hash_calc();
-      if (h != g_settings.hash)
+      /* Only the changed setting needs to be checked */
+
+      h = setting_crc(setting);
+      if (h != old)
         {
-          g_settings.hash = h;
+          g_settings.hash ^= old ^ h;
+          dirty_set(setting - map);
 
           signotify();
           save();
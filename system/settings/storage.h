@@ -56,10 +56,19 @@ int save_text(FAR char *file);
 int load_bin(FAR char *file);
 int save_bin(FAR char *file);
 
+/* Journal storage. */
+
+int load_journal(FAR char *file);
+int save_journal(FAR char *file);
+
 /* EEPROM storage. */
 
 int load_eeprom(FAR char *file);
 int save_eeprom(FAR char *file);
 
+/* Settings map state, for storages that save only changed entries. */
+
+bool settings_isdirty(int idx);
+
 #endif /* SETTINGS_STORAGE_H_*/
 
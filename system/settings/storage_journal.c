@@ -0,0 +1,426 @@
+/****************************************************************************
+ * apps/system/settings/storage_journal.c
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include "system/settings.h"
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <nuttx/crc32.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <nuttx/config.h>
+#include <sys/types.h>
+
+#include "storage.h"
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* The journal is a header followed by records appended in order of
+ * change.  On load, later records for the same key override earlier ones.
+ * Once the file would grow past the configured size it is compacted, i.e.
+ * rewritten with a single record per setting.
+ */
+
+#define JOURNAL_MAGIC  0x4c4e4a53  /* "SJNL" */
+#define JOURNAL_TMP    ".tmp"
+
+#ifndef CONFIG_SYSTEM_SETTINGS_JOURNAL_SIZE
+#  define CONFIG_SYSTEM_SETTINGS_JOURNAL_SIZE 4096
+#endif
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+struct journal_hdr_s
+{
+  uint32_t magic;
+  uint16_t recsize;   /* Size of the setting in each record */
+  uint16_t reserved;
+};
+
+struct journal_rec_s
+{
+  setting_t setting;
+  uint32_t  crc;      /* crc32 of the setting */
+};
+
+/****************************************************************************
+ * Private Function Prototypes
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: getsetting
+ *
+ * Description:
+ *    Gets the setting information from a given key.
+ *
+ * Input Parameters:
+ *    key        - key of the required setting
+ *
+ * Returned Value:
+ *   The setting
+ *
+ ****************************************************************************/
+
+FAR static setting_t *getsetting(FAR char *key);
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+/****************************************************************************
+ * Public Data
+ ****************************************************************************/
+
+extern setting_t map[CONFIG_SYSTEM_SETTINGS_MAP_SIZE];
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: getsetting
+ *
+ * Description:
+ *    Gets the setting information from a given key.
+ *
+ * Input Parameters:
+ *    key        - key of the required setting
+ *
+ * Returned Value:
+ *   The setting
+ *
+ ****************************************************************************/
+
+FAR static setting_t *getsetting(FAR char *key)
+{
+  int i;
+  size_t keylen;
+
+  keylen = strnlen(key, CONFIG_SYSTEM_SETTINGS_KEY_SIZE);
+  if (keylen >= CONFIG_SYSTEM_SETTINGS_KEY_SIZE)
+    {
+      return NULL;
+    }
+
+  for (i = 0; i < CONFIG_SYSTEM_SETTINGS_MAP_SIZE; i++)
+    {
+      FAR setting_t *setting = &map[i];
+
+      if (strncmp(key, setting->key, CONFIG_SYSTEM_SETTINGS_KEY_SIZE) == 0)
+        {
+          return setting;
+        }
+
+      if (setting->type == SETTING_EMPTY)
+        {
+          return setting;
+        }
+    }
+
+  return NULL;
+}
+
+/****************************************************************************
+ * Name: write_rec
+ *
+ * Description:
+ *    Writes a single journal record for a setting.
+ *
+ * Input Parameters:
+ *    fd               - the file to write to
+ *    setting          - the setting to write
+ *
+ * Returned Value:
+ *   Success or negated failure code
+ *
+ ****************************************************************************/
+
+static int write_rec(int fd, FAR setting_t *setting)
+{
+  struct journal_rec_s rec;
+
+  memcpy(&rec.setting, setting, sizeof(setting_t));
+  rec.crc = crc32((FAR uint8_t *)setting, sizeof(setting_t));
+
+  if (write(fd, &rec, sizeof(rec)) != sizeof(rec))
+    {
+      return -EIO;
+    }
+
+  return OK;
+}
+
+/****************************************************************************
+ * Name: compact
+ *
+ * Description:
+ *    Rewrites the journal with a single record per setting.  The new
+ *    journal is written to a temporary file first and then renamed, so a
+ *    power loss during compaction leaves the old journal intact.
+ *
+ * Input Parameters:
+ *    file             - the filename of the storage to use
+ *
+ * Returned Value:
+ *   Success or negated failure code
+ *
+ ****************************************************************************/
+
+static int compact(FAR char *file)
+{
+  char tmp[CONFIG_SYSTEM_SETTINGS_MAX_FILENAME + sizeof(JOURNAL_TMP)];
+  struct journal_hdr_s hdr;
+  int ret = OK;
+  int fd;
+  int i;
+
+  snprintf(tmp, sizeof(tmp), "%s" JOURNAL_TMP, file);
+
+  fd = open(tmp, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+  if (fd < 0)
+    {
+      return -ENODEV;
+    }
+
+  hdr.magic    = JOURNAL_MAGIC;
+  hdr.recsize  = sizeof(setting_t);
+  hdr.reserved = 0;
+
+  if (write(fd, &hdr, sizeof(hdr)) != sizeof(hdr))
+    {
+      ret = -EIO;
+      goto abort;
+    }
+
+  for (i = 0; i < CONFIG_SYSTEM_SETTINGS_MAP_SIZE; i++)
+    {
+      if (map[i].type == SETTING_EMPTY)
+        {
+          break;
+        }
+
+      ret = write_rec(fd, &map[i]);
+      if (ret < 0)
+        {
+          goto abort;
+        }
+    }
+
+  fsync(fd);
+  close(fd);
+
+  if (rename(tmp, file) < 0)
+    {
+      ret = -errno;
+      unlink(tmp);
+    }
+
+  return ret;
+
+abort:
+  close(fd);
+  unlink(tmp);
+  return ret;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: load_journal
+ *
+ * Description:
+ *    Loads settings by replaying a journal storage file.  A record that is
+ *    truncated or fails its CRC (e.g. after a power loss during append)
+ *    ends the journal, and the file is cut back to the last good record.
+ *
+ * Input Parameters:
+ *    file             - the filename of the storage to use
+ *
+ * Returned Value:
+ *   Success or negated failure code
+ *
+ ****************************************************************************/
+
+int load_journal(FAR char *file)
+{
+  struct journal_hdr_s hdr;
+  struct journal_rec_s rec;
+  FAR setting_t *slot;
+  off_t offset;
+  int ret = OK;
+  int fd;
+
+  fd = open(file, O_RDWR);
+  if (fd < 0)
+    {
+      return -ENOENT;
+    }
+
+  if ((read(fd, &hdr, sizeof(hdr)) != sizeof(hdr)) ||
+      (hdr.magic != JOURNAL_MAGIC) || (hdr.recsize != sizeof(setting_t)))
+    {
+      ret = -EBADMSG;
+      goto abort; /* Just exit - the settings aren't valid */
+    }
+
+  offset = sizeof(hdr);
+
+  while (read(fd, &rec, sizeof(rec)) == sizeof(rec))
+    {
+      if (rec.crc != crc32((FAR uint8_t *)&rec.setting, sizeof(setting_t)))
+        {
+          break;
+        }
+
+      offset += sizeof(rec);
+
+      if (rec.setting.type == SETTING_STRING &&
+          strnlen(rec.setting.val.s, CONFIG_SYSTEM_SETTINGS_VALUE_SIZE) >=
+          CONFIG_SYSTEM_SETTINGS_VALUE_SIZE)
+        {
+          continue;
+        }
+
+      slot = getsetting(rec.setting.key);
+      if (slot == NULL)
+        {
+          continue;
+        }
+
+      memcpy(slot, &rec.setting, sizeof(setting_t));
+    }
+
+  /* Drop a torn tail so new records are appended after valid data */
+
+  if (lseek(fd, 0, SEEK_END) > offset)
+    {
+      ftruncate(fd, offset);
+    }
+
+abort:
+  close(fd);
+  return ret;
+}
+
+/****************************************************************************
+ * Name: save_journal
+ *
+ * Description:
+ *    Appends a record for every setting changed since the last save.  The
+ *    journal is compacted instead if it is empty or would grow past
+ *    CONFIG_SYSTEM_SETTINGS_JOURNAL_SIZE.
+ *
+ * Input Parameters:
+ *    file             - the filename of the storage to use
+ *
+ * Returned Value:
+ *   Success or negated failure code
+ *
+ ****************************************************************************/
+
+int save_journal(FAR char *file)
+{
+  off_t size;
+  int ndirty = 0;
+  int count = 0;
+  int ret = OK;
+  int fd;
+  int i;
+
+  for (i = 0; i < CONFIG_SYSTEM_SETTINGS_MAP_SIZE; i++)
+    {
+      if (map[i].type == SETTING_EMPTY)
+        {
+          break;
+        }
+
+      if (settings_isdirty(i))
+        {
+          ndirty++;
+        }
+
+      count++;
+    }
+
+  fd = open(file, O_WRONLY | O_CREAT | O_APPEND, 0666);
+  if (fd < 0)
+    {
+      return -ENODEV;
+    }
+
+  size = lseek(fd, 0, SEEK_END);
+
+  /* A cleared map or a bulk change is cheaper to write out in full */
+
+  if ((size < (off_t)sizeof(struct journal_hdr_s)) || (count == 0) ||
+      (ndirty == count) ||
+      (size + ndirty * sizeof(struct journal_rec_s) >
+       CONFIG_SYSTEM_SETTINGS_JOURNAL_SIZE))
+    {
+      close(fd);
+      return compact(file);
+    }
+
+  for (i = 0; i < count; i++)
+    {
+      if (settings_isdirty(i))
+        {
+          ret = write_rec(fd, &map[i]);
+          if (ret < 0)
+            {
+              break;
+            }
+        }
+    }
+
+  /* Never leave a torn record behind: load_journal() stops at it, which
+   * would hide every record appended by later saves.
+   */
+
+  if (ret < 0)
+    {
+      if (ftruncate(fd, size) < 0)
+        {
+          close(fd);
+          return compact(file);
+        }
+    }
+  else
+    {
+      fsync(fd);
+    }
+
+  close(fd);
+  return ret;
+}
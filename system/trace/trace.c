@@ -234,6 +234,64 @@ static int trace_cmd_dump(FAR const char *name, int index, int argc,
 }
 #endif
 
+/****************************************************************************
+ * Name: trace_cmd_stream
+ ****************************************************************************/
+
+#ifdef CONFIG_SYSTEM_TRACE_STREAM
+static int trace_cmd_stream(FAR const char *name, int index, int argc,
+                            FAR char **argv, int notectlfd)
+{
+  FAR const char *path = "-";
+  size_t bufsize = CONFIG_SYSTEM_TRACE_STREAM_BUFSIZE;
+  unsigned int period = CONFIG_SYSTEM_TRACE_STREAM_PERIOD;
+  bool binary = false;
+
+  /* Usage: trace stream [-b][-s <bufsize>][-p <period>][<filename>]
+   *        trace stream stop
+   */
+
+  if (index < argc && strcmp(argv[index], "stop") == 0)
+    {
+      /* Stop tracing first, so that the final drain gets all notes */
+
+      notectl_enable(name, false, notectlfd);
+      return trace_stream_stop() < 0 ? ERROR : index + 1;
+    }
+
+  if (index < argc && strcmp(argv[index], "-b") == 0)
+    {
+      binary = true;
+      index++;
+    }
+
+  if (index + 1 < argc && strcmp(argv[index], "-s") == 0)
+    {
+      bufsize = strtoul(argv[index + 1], NULL, 0);
+      index += 2;
+    }
+
+  if (index + 1 < argc && strcmp(argv[index], "-p") == 0)
+    {
+      period = strtoul(argv[index + 1], NULL, 0);
+      index += 2;
+    }
+
+  if (index < argc)
+    {
+      path = argv[index++];
+    }
+
+  if (trace_stream_start(path, binary, bufsize, period) < 0)
+    {
+      return ERROR;
+    }
+
+  notectl_enable(name, true, notectlfd);
+  return index;
+}
+#endif
+
 /****************************************************************************
  * Name: trace_cmd_cmd
  ****************************************************************************/
@@ -818,6 +876,13 @@ static void show_usage(void)
 #ifdef CONFIG_DRIVERS_NOTERAM
           " dump    [-b][-c][<filename>]        :"
                                 " Output the trace result\n"
+#endif
+#ifdef CONFIG_SYSTEM_TRACE_STREAM
+          " stream  [-b][-s <size>][-p <ms>][<filename>|tcp:<ip>:<port>]\n"
+          "                                     :"
+                                " Stream the trace in the background\n"
+          " stream  stop                        :"
+                                " Stop streaming the trace\n"
 #endif
           " mode    [{+|-}{o|w|s|a|i|d}...]     :"
                                 " Set task trace options\n"
@@ -898,6 +963,12 @@ int main(int argc, FAR char *argv[])
           i = trace_cmd_dump(name, i + 1, argc, argv, notectlfd);
         }
 #endif
+#ifdef CONFIG_SYSTEM_TRACE_STREAM
+      else if (strcmp(argv[i], "stream") == 0)
+        {
+          i = trace_cmd_stream(name, i + 1, argc, argv, notectlfd);
+        }
+#endif
 #ifdef CONFIG_SYSTEM_SYSTEM
       else if (strcmp(argv[i], "cmd") == 0)
         {
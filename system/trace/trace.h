@@ -98,6 +98,32 @@ void trace_dump_set_overwrite(bool mode);
 
 #endif /* CONFIG_DRIVERS_NOTERAM */
 
+#ifdef CONFIG_SYSTEM_TRACE_STREAM
+
+/****************************************************************************
+ * Name: trace_stream_start
+ *
+ * Description:
+ *   Start a background task which continuously drains the note buffer
+ *   to a file, stdout ('-') or a TCP connection (tcp:<ipaddr>:<port>)
+ *
+ ****************************************************************************/
+
+int trace_stream_start(FAR const char *path, bool binary, size_t bufsize,
+                       unsigned int period);
+
+/****************************************************************************
+ * Name: trace_stream_stop
+ *
+ * Description:
+ *   Stop the background stream task and wait for it to exit
+ *
+ ****************************************************************************/
+
+int trace_stream_stop(void);
+
+#endif /* CONFIG_SYSTEM_TRACE_STREAM */
+
 #undef EXTERN
 #ifdef __cplusplus
 }
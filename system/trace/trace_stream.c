@@ -0,0 +1,447 @@
+/****************************************************************************
+ * apps/system/trace/trace_stream.c
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+#include <nuttx/note/noteram_driver.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <sched.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <time.h>
+#include <unistd.h>
+
+#ifdef CONFIG_NET_TCP
+#  include <arpa/inet.h>
+#  include <netinet/in.h>
+#  include <sys/socket.h>
+#endif
+
+#include "trace.h"
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Half of the buffer must hold the largest note, which the driver limits
+ * to 255 bytes.  Stay well above that to keep the number of reads low.
+ */
+
+#define TRACE_STREAM_MINBUF 1024
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+struct trace_stream_s
+{
+  volatile bool started;
+  volatile bool stop;
+  pid_t         pid;
+
+  /* Configuration passed to the daemon */
+
+  char          path[PATH_MAX];
+  bool          binary;
+  size_t        bufsize;
+  unsigned int  period;
+
+  /* Statistics */
+
+  uint64_t      bytes;
+  uint32_t      reads;
+  uint32_t      writes;
+  uint32_t      overflows;
+};
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static struct trace_stream_s g_trace_stream;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: trace_stream_open
+ *
+ * Description:
+ *   Open the stream output.  <path> is either a file name, '-' for stdout
+ *   or, if TCP is available, tcp:<ipaddr>:<port> to send the stream to a
+ *   remote host.
+ *
+ ****************************************************************************/
+
+static int trace_stream_open(FAR const char *path)
+{
+#ifdef CONFIG_NET_TCP
+  struct sockaddr_in addr;
+  char host[INET_ADDRSTRLEN];
+  FAR const char *port;
+  int sd;
+#endif
+
+  if (strcmp(path, "-") == 0)
+    {
+      return dup(STDOUT_FILENO);
+    }
+
+#ifdef CONFIG_NET_TCP
+  if (strncmp(path, "tcp:", 4) == 0)
+    {
+      path += 4;
+      port  = strchr(path, ':');
+      if (port == NULL || port - path >= sizeof(host))
+        {
+          errno = EINVAL;
+          return ERROR;
+        }
+
+      strlcpy(host, path, port - path + 1);
+
+      memset(&addr, 0, sizeof(addr));
+      addr.sin_family = AF_INET;
+      addr.sin_port   = htons(atoi(port + 1));
+      if (inet_pton(AF_INET, host, &addr.sin_addr) != 1)
+        {
+          errno = EINVAL;
+          return ERROR;
+        }
+
+      sd = socket(AF_INET, SOCK_STREAM, 0);
+      if (sd < 0)
+        {
+          return ERROR;
+        }
+
+      if (connect(sd, (FAR struct sockaddr *)&addr, sizeof(addr)) < 0)
+        {
+          close(sd);
+          return ERROR;
+        }
+
+      return sd;
+    }
+#endif
+
+  return open(path, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+}
+
+/****************************************************************************
+ * Name: trace_stream_flush
+ ****************************************************************************/
+
+static int trace_stream_flush(int outfd, FAR const uint8_t *buf,
+                              size_t len)
+{
+  ssize_t ret;
+
+  while (len > 0)
+    {
+      ret = write(outfd, buf, len);
+      if (ret < 0)
+        {
+          if (errno == EINTR)
+            {
+              continue;
+            }
+
+          return -errno;
+        }
+
+      buf += ret;
+      len -= ret;
+    }
+
+  g_trace_stream.writes++;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: trace_stream_daemon
+ *
+ * Description:
+ *   Continuously drain the note RAM buffer to the stream output.  Notes
+ *   are batched into one large buffer which is written out once it is
+ *   half full or when the note buffer was drained.  Each read is done into
+ *   at least half of the buffer, so complete notes always fit.
+ *
+ ****************************************************************************/
+
+static int trace_stream_daemon(int argc, FAR char *argv[])
+{
+  FAR struct trace_stream_s *st = &g_trace_stream;
+  struct timespec start;
+  struct timespec end;
+  FAR uint8_t *buf;
+  unsigned int mode;
+  uint64_t elapsed;
+  size_t len = 0;
+  ssize_t nread;
+  int exitcode = EXIT_FAILURE;
+  int outfd;
+  int fd;
+  int ret;
+
+  buf = malloc(st->bufsize);
+  if (buf == NULL)
+    {
+      fprintf(stderr, "trace stream: cannot allocate %zu bytes\n",
+              st->bufsize);
+      goto errout;
+    }
+
+  fd = open("/dev/note/ram", O_RDONLY);
+  if (fd < 0)
+    {
+      fprintf(stderr, "trace stream: cannot open /dev/note/ram\n");
+      goto errout_with_buf;
+    }
+
+  if (st->binary)
+    {
+      mode = NOTERAM_MODE_READ_BINARY;
+      ret = ioctl(fd, NOTERAM_SETREADMODE, &mode);
+      if (ret < 0)
+        {
+          fprintf(stderr, "trace stream: cannot set read mode\n");
+          goto errout_with_fd;
+        }
+    }
+
+  /* Don't let the note buffer overwrite unread notes.  When it fills up,
+   * the driver stops recording and reports an overflow instead, which is
+   * counted and re-armed below.
+   */
+
+  mode = NOTERAM_MODE_OVERWRITE_DISABLE;
+  ioctl(fd, NOTERAM_SETMODE, (unsigned long)&mode);
+
+  outfd = trace_stream_open(st->path);
+  if (outfd < 0)
+    {
+      fprintf(stderr, "trace stream: cannot open '%s': %d\n",
+              st->path, errno);
+      goto errout_with_fd;
+    }
+
+  printf("trace stream: started: %d\n", st->pid);
+  clock_gettime(CLOCK_MONOTONIC, &start);
+
+  while (1)
+    {
+      /* Keep at least half of the buffer free for the next read */
+
+      if (len > st->bufsize / 2)
+        {
+          ret = trace_stream_flush(outfd, buf, len);
+          if (ret < 0)
+            {
+              fprintf(stderr, "trace stream: write error: %d\n", ret);
+              goto errout_with_outfd;
+            }
+
+          len = 0;
+        }
+
+      nread = read(fd, buf + len, st->bufsize - len);
+      if (nread < 0)
+        {
+          if (errno == EINTR)
+            {
+              continue;
+            }
+
+          fprintf(stderr, "trace stream: read error: %d\n", errno);
+          goto errout_with_outfd;
+        }
+      else if (nread > 0)
+        {
+          len += nread;
+          st->bytes += nread;
+          st->reads++;
+          continue;
+        }
+
+      /* The note buffer is drained, write out what we have */
+
+      if (len > 0)
+        {
+          ret = trace_stream_flush(outfd, buf, len);
+          if (ret < 0)
+            {
+              fprintf(stderr, "trace stream: write error: %d\n", ret);
+              goto errout_with_outfd;
+            }
+
+          len = 0;
+        }
+
+      /* Count and re-arm the note buffer overflow */
+
+      mode = 0;
+      ioctl(fd, NOTERAM_GETMODE, (unsigned long)&mode);
+      if (mode == NOTERAM_MODE_OVERWRITE_OVERFLOW)
+        {
+          st->overflows++;
+          mode = NOTERAM_MODE_OVERWRITE_DISABLE;
+          ioctl(fd, NOTERAM_SETMODE, (unsigned long)&mode);
+        }
+
+      if (st->stop)
+        {
+          break;
+        }
+
+      usleep(st->period * 1000);
+    }
+
+  exitcode = EXIT_SUCCESS;
+
+errout_with_outfd:
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  elapsed = (end.tv_sec - start.tv_sec) * 1000ull +
+            (end.tv_nsec - start.tv_nsec) / 1000000;
+
+  printf("trace stream: stopped: %" PRIu64 " bytes in %" PRIu64 " ms"
+         " (%" PRIu64 " B/s), %" PRIu32 " reads, %" PRIu32 " writes,"
+         " %" PRIu32 " overflows\n",
+         st->bytes, elapsed,
+         elapsed > 0 ? st->bytes * 1000 / elapsed : 0,
+         st->reads, st->writes, st->overflows);
+
+  close(outfd);
+
+errout_with_fd:
+  close(fd);
+
+errout_with_buf:
+  free(buf);
+
+errout:
+  st->stop    = false;
+  st->started = false;
+  return exitcode;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: trace_stream_start
+ *
+ * Description:
+ *   Start the background trace stream daemon.
+ *
+ ****************************************************************************/
+
+int trace_stream_start(FAR const char *path, bool binary, size_t bufsize,
+                       unsigned int period)
+{
+  FAR struct trace_stream_s *st = &g_trace_stream;
+  int ret;
+
+  if (bufsize < TRACE_STREAM_MINBUF)
+    {
+      fprintf(stderr, "trace stream: buffer too small: %zu < %d\n",
+              bufsize, TRACE_STREAM_MINBUF);
+      return -EINVAL;
+    }
+
+  sched_lock();
+  if (st->started)
+    {
+      sched_unlock();
+      fprintf(stderr, "trace stream: already running: %d\n", st->pid);
+      return -EBUSY;
+    }
+
+  strlcpy(st->path, path, sizeof(st->path));
+  st->binary    = binary;
+  st->bufsize   = bufsize;
+  st->period    = period;
+  st->bytes     = 0;
+  st->reads     = 0;
+  st->writes    = 0;
+  st->overflows = 0;
+  st->started   = true;
+  st->stop      = false;
+
+  ret = task_create("trace_stream", CONFIG_SYSTEM_TRACE_STREAM_PRIORITY,
+                    CONFIG_SYSTEM_TRACE_STREAM_STACKSIZE,
+                    trace_stream_daemon, NULL);
+  if (ret < 0)
+    {
+      ret = -errno;
+      st->started = false;
+      fprintf(stderr, "trace stream: cannot start daemon: %d\n", ret);
+    }
+  else
+    {
+      st->pid = ret;
+      ret = OK;
+    }
+
+  sched_unlock();
+  return ret;
+}
+
+/****************************************************************************
+ * Name: trace_stream_stop
+ *
+ * Description:
+ *   Stop the background trace stream daemon.  The daemon drains the note
+ *   buffer once more and reports the statistics before it exits.
+ *
+ ****************************************************************************/
+
+int trace_stream_stop(void)
+{
+  FAR struct trace_stream_s *st = &g_trace_stream;
+
+  if (!st->started)
+    {
+      fprintf(stderr, "trace stream: not running\n");
+      return -ESRCH;
+    }
+
+  st->stop = true;
+
+  while (st->started)
+    {
+      usleep(st->period * 1000);
+    }
+
+  return OK;
+}
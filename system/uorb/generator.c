@@ -27,6 +27,7 @@
 
 #include <ctype.h>
 #include <uORB/uORB.h>
+#include <uORB/log.h>
 
 /****************************************************************************
  * Pre-processor Definitions
@@ -44,6 +45,13 @@ struct sensor_gen_info_s
   FAR FILE           *file;
 };
 
+struct sensor_log_topic_s
+{
+  FAR const struct orb_metadata *meta;  /* NULL if not replayed */
+  int                            instance;
+  int                            fd;
+};
+
 /****************************************************************************
  * Private Data
  ****************************************************************************/
@@ -69,7 +77,9 @@ generator <command> [arguments...]\n\
 \t[-r <val> ]  The rate for playing fake data is only valid\
  when parameter 's' is used. default:10hz.\n\
 \t[-s <val> ]  Playback fake data.\n\
-\t[-t <val> ]  Playback topic.\n\
+\t[-t <val> ]  Playback topic, optional for binary logs.\n\
+\t[-x <val> ]  Binary log playback speed (0: no delay), default: 1\n\
+\t[-o <val> ]  Binary log start offset in seconds, default: 0\n\
 \t e.g.:\n\
 \t\tsim - sensor_accel0:\n\
 \t\t  uorb_generator -n 100 -r 5 -s -t sensor_accel0 timestamp:23191100,\
@@ -79,7 +89,9 @@ x:0.1,y:9.7,z:0.81,temperature:22.15\n\n\
 pressure:999.12,temperature:26.34\n\n\
 \t\tfiles - sensor_accel1\n\
 \t\t  uorb_generator -f /data/uorb/20240823061723/sensor_accel0.csv\
- -t sensor_accel1\
+ -t sensor_accel1\n\n\
+\t\tbinary log - all topics at twice the speed, from 10s on\n\
+\t\t  uorb_generator -f /data/uorb/20240823061723/uorb.ulg -x 2 -o 10\
 \t\t\n\
   ");
 }
@@ -245,6 +257,306 @@ out_line:
   return ret;
 }
 
+/****************************************************************************
+ * Name: replay_log_seek
+ *
+ * Description:
+ *   Find the data range of a binary log and, if an index is present,
+ *   seek to the last block that starts before the given time offset.
+ *
+ * Input Parameters:
+ *   file     Binary log, positioned at the first block.
+ *   offset   Start offset from the first sample in microseconds.
+ *   end      Returned file offset of the end of the sample data.
+ *   start    Returned timestamp that playback starts at, 0 if unknown
+ *            (then the samples before the offset are skipped on the fly).
+ *
+ * Returned Value:
+ *   0 on success, otherwise negative errno.
+ ****************************************************************************/
+
+static int replay_log_seek(FAR FILE *file, orb_abstime offset,
+                           FAR off_t *end, FAR orb_abstime *start)
+{
+  struct orb_log_trailer_s trailer;
+  struct orb_log_index_s entry;
+  orb_abstime target;
+  off_t data;
+  off_t size;
+  uint32_t low;
+  uint32_t high;
+  uint32_t mid;
+
+  data   = ftello(file);
+  *start = 0;
+
+  if (fseeko(file, 0, SEEK_END) < 0)
+    {
+      return -errno;
+    }
+
+  size = ftello(file);
+  *end = size;
+
+  if (size < data + (off_t)sizeof(trailer) ||
+      fseeko(file, -(off_t)sizeof(trailer), SEEK_END) < 0 ||
+      fread(&trailer, sizeof(trailer), 1, file) != 1 ||
+      trailer.magic != ORB_LOG_INDEX_MAGIC ||
+      trailer.offset < data || trailer.offset > size)
+    {
+      /* Recording was interrupted, the log can only be read in order */
+
+      return fseeko(file, data, SEEK_SET) < 0 ? -errno : OK;
+    }
+
+  *end = trailer.offset;
+
+  if (offset == 0 || trailer.nindex == 0 ||
+      fseeko(file, trailer.offset, SEEK_SET) < 0 ||
+      fread(&entry, sizeof(entry), 1, file) != 1)
+    {
+      return fseeko(file, data, SEEK_SET) < 0 ? -errno : OK;
+    }
+
+  /* Binary search for the last block starting at or before the target */
+
+  target = entry.timestamp + offset;
+  *start = target;
+  low    = 0;
+  high   = trailer.nindex - 1;
+
+  while (low < high)
+    {
+      mid = low + (high - low + 1) / 2;
+
+      if (fseeko(file, trailer.offset + (off_t)mid * sizeof(entry),
+                 SEEK_SET) < 0 ||
+          fread(&entry, sizeof(entry), 1, file) != 1)
+        {
+          return -EIO;
+        }
+
+      if (entry.timestamp <= target)
+        {
+          low = mid;
+        }
+      else
+        {
+          high = mid - 1;
+        }
+    }
+
+  if (fseeko(file, trailer.offset + (off_t)low * sizeof(entry),
+             SEEK_SET) < 0 ||
+      fread(&entry, sizeof(entry), 1, file) != 1)
+    {
+      return -EIO;
+    }
+
+  return fseeko(file, entry.offset, SEEK_SET) < 0 ? -errno : OK;
+}
+
+/****************************************************************************
+ * Name: replay_log_worker
+ *
+ * Description:
+ *   Playback a binary log.  Samples are published at their recorded
+ *   timestamps relative to the start of playback, scaled by the speed.
+ *   Timing is against an absolute start time, so sleep overhead doesn't
+ *   accumulate.
+ *
+ * Input Parameters:
+ *   file       Binary log, positioned after the magic.
+ *   sensor_gen Only replay this topic and publish to its instance, or
+ *              NULL to replay all topics on their recorded instances.
+ *   speed      Playback speed factor, 0 to publish without delay.
+ *   offset     Start offset in microseconds.
+ *
+ * Returned Value:
+ *   0 on success, otherwise negative errno.
+ ****************************************************************************/
+
+static int replay_log_worker(FAR FILE *file,
+                             FAR struct sensor_gen_info_s *sensor_gen,
+                             float speed, orb_abstime offset)
+{
+  FAR struct sensor_log_topic_s *topics;
+  struct orb_log_header_s header;
+  struct orb_log_sample_s sample;
+  struct orb_log_topic_s topic;
+  char name[UINT8_MAX + 1];
+  orb_abstime base_time = 0;
+  orb_abstime base_ts = 0;
+  orb_abstime target;
+  orb_abstime start;
+  orb_abstime now;
+  orb_abstime ts;
+  FAR uint8_t *data;
+  uint16_t maxsize = sizeof(orb_abstime);
+  bool is_first = true;
+  off_t pos;
+  off_t end;
+  int ret = OK;
+  int i;
+
+  if (fread(&header.version, sizeof(header) - sizeof(header.magic), 1,
+            file) != 1 || header.version != ORB_LOG_VERSION)
+    {
+      uorbinfo_raw("Playback file format error!");
+      return -EINVAL;
+    }
+
+  topics = calloc(header.ntopics, sizeof(*topics));
+  if (topics == NULL && header.ntopics > 0)
+    {
+      return -ENOMEM;
+    }
+
+  /* Match the recorded schemas with the built-in topics */
+
+  for (i = 0; i < header.ntopics; i++)
+    {
+      topics[i].fd = -1;
+
+      if (fread(&topic, sizeof(topic), 1, file) != 1 ||
+          fread(name, topic.namelen, 1, file) != 1 ||
+          fseeko(file, topic.fmtlen, SEEK_CUR) < 0)
+        {
+          uorbinfo_raw("Playback file format error!");
+          ret = -EINVAL;
+          goto out_topics;
+        }
+
+      name[topic.namelen] = '\0';
+      topics[i].meta = orb_get_meta(name);
+      topics[i].instance = topic.instance;
+
+      if (topics[i].meta == NULL || topics[i].meta->o_size != topic.size)
+        {
+          uorbinfo_raw("[ignore] Topic %s%d is unknown or changed!",
+                       name, topic.instance);
+          topics[i].meta = NULL;
+        }
+      else if (sensor_gen != NULL)
+        {
+          if (topics[i].meta != sensor_gen->obj.meta)
+            {
+              topics[i].meta = NULL;
+            }
+          else
+            {
+              topics[i].instance = sensor_gen->obj.instance;
+            }
+        }
+
+      if (topic.size > maxsize)
+        {
+          maxsize = topic.size;
+        }
+    }
+
+  data = malloc(maxsize);
+  if (data == NULL)
+    {
+      ret = -ENOMEM;
+      goto out_topics;
+    }
+
+  ret = replay_log_seek(file, offset, &end, &start);
+  if (ret < 0)
+    {
+      goto out_data;
+    }
+
+  /* Advertise without initial data, playback publishes the first one */
+
+  for (i = 0; i < header.ntopics; i++)
+    {
+      if (topics[i].meta != NULL)
+        {
+          topics[i].fd = orb_advertise_multi_queue_persist(
+                           topics[i].meta, NULL, &topics[i].instance, 1);
+          if (topics[i].fd < 0)
+            {
+              uorbinfo_raw("Playback orb advertise failed[%d]!",
+                           topics[i].fd);
+              ret = topics[i].fd;
+              goto out_fds;
+            }
+        }
+    }
+
+  pos = ftello(file);
+
+  while (pos + (off_t)sizeof(sample) <= end && !g_gen_should_exit)
+    {
+      if (fread(&sample, sizeof(sample), 1, file) != 1 ||
+          sample.size > maxsize || sample.size < sizeof(orb_abstime) ||
+          pos + (off_t)(sizeof(sample) + sample.size) > end ||
+          fread(data, sample.size, 1, file) != 1)
+        {
+          break;
+        }
+
+      pos += sizeof(sample) + sample.size;
+
+      if (sample.id >= header.ntopics || topics[sample.id].fd < 0)
+        {
+          continue;
+        }
+
+      memcpy(&ts, data, sizeof(ts));
+      if (start == 0)
+        {
+          start = ts + offset;
+        }
+
+      if (ts < start)
+        {
+          continue;
+        }
+
+      if (is_first)
+        {
+          base_time = orb_absolute_time();
+          base_ts   = ts;
+          is_first  = false;
+        }
+      else if (speed > 0 && ts > base_ts)
+        {
+          target = base_time + (orb_abstime)((ts - base_ts) / speed);
+          now    = orb_absolute_time();
+          if (target > now)
+            {
+              nxsig_usleep(target - now);
+            }
+        }
+
+      if (OK != orb_publish(topics[sample.id].meta, topics[sample.id].fd,
+                            data))
+        {
+          uorbinfo_raw("Topic publish error!");
+          ret = ERROR;
+          break;
+        }
+    }
+
+out_fds:
+  for (i = 0; i < header.ntopics; i++)
+    {
+      if (topics[i].fd >= 0)
+        {
+          orb_unadvertise(topics[i].fd);
+        }
+    }
+
+out_data:
+  free(data);
+out_topics:
+  free(topics);
+  return ret;
+}
+
 /****************************************************************************
  * Name: fake_worker
  *
@@ -330,6 +642,9 @@ int main(int argc, FAR char *argv[])
 {
   struct sensor_gen_info_s sensor_tmp;
   float topic_rate = 0.0f;
+  float speed      = 1.0f;
+  float offset     = 0.0f;
+  uint32_t magic;
   FAR char *filter = NULL;
   FAR char *topic  = NULL;
   FAR char *path   = NULL;
@@ -344,7 +659,7 @@ int main(int argc, FAR char *argv[])
       return 1;
     }
 
-  while ((opt = getopt(argc, argv, "f:t:r:n:sh")) != -1)
+  while ((opt = getopt(argc, argv, "f:t:r:n:x:o:sh")) != -1)
     {
       switch (opt)
         {
@@ -372,6 +687,22 @@ int main(int argc, FAR char *argv[])
               }
             break;
 
+          case 'x':
+            speed = atof(optarg);
+            if (speed < 0)
+              {
+                goto error;
+              }
+            break;
+
+          case 'o':
+            offset = atof(optarg);
+            if (offset < 0)
+              {
+                goto error;
+              }
+            break;
+
           case 's':
             sim = true;
             break;
@@ -387,10 +718,13 @@ int main(int argc, FAR char *argv[])
       filter = argv[optind];
     }
 
-  ret = get_play_orb_id(topic, &sensor_tmp);
-  if (ret < 0)
+  if (topic != NULL || sim)
     {
-      return ERROR;
+      ret = get_play_orb_id(topic, &sensor_tmp);
+      if (ret < 0)
+        {
+          return ERROR;
+        }
     }
 
   if (sim)
@@ -406,7 +740,26 @@ int main(int argc, FAR char *argv[])
           return ERROR;
         }
 
-      ret = replay_worker(&sensor_tmp);
+      setvbuf(sensor_tmp.file, NULL, _IOFBF, GENERATOR_CACHE_BUFF);
+
+      if (fread(&magic, sizeof(magic), 1, sensor_tmp.file) == 1 &&
+          magic == ORB_LOG_MAGIC)
+        {
+          ret = replay_log_worker(sensor_tmp.file,
+                                  topic ? &sensor_tmp : NULL, speed,
+                                  (orb_abstime)(offset * 1000000));
+        }
+      else if (topic == NULL)
+        {
+          uorbinfo_raw("The entered built-in topic name is NULL.");
+          ret = ERROR;
+        }
+      else
+        {
+          rewind(sensor_tmp.file);
+          ret = replay_worker(&sensor_tmp);
+        }
+
       fclose(sensor_tmp.file);
     }
 
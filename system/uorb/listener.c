@@ -29,6 +29,7 @@
 #include <dirent.h>
 #include <inttypes.h>
 #include <poll.h>
+#include <pthread.h>
 #include <signal.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -40,6 +41,7 @@
 #include <fcntl.h>
 
 #include <uORB/uORB.h>
+#include <uORB/log.h>
 
 /****************************************************************************
  * Pre-processor Definitions
@@ -49,6 +51,10 @@
 #define ORB_TOP_WAIT_TIME  1000
 #define ORB_DATA_DIR       "/data/uorb/"
 
+#ifndef CONFIG_UORB_LISTENER_LOG_BUFSIZE
+#  define CONFIG_UORB_LISTENER_LOG_BUFSIZE 8192
+#endif
+
 #if defined(CONFIG_UORB_FORMAT) && !defined(CONFIG_LIBC_FLOATINGPOINT)
 #error "Enable CONFIG_LIBC_FLOATINGPOINT, required to see debug output"
 #endif
@@ -69,6 +75,30 @@ struct listen_object_s
 
 SLIST_HEAD(listen_list_s, listen_object_s);
 
+/* Binary log writer.  Samples are copied straight into one of two block
+ * buffers, and full blocks are written out by a separate thread, so slow
+ * storage doesn't stall the subscriber loop until both blocks are busy.
+ */
+
+struct listen_log_s
+{
+  pthread_t       thread;
+  pthread_mutex_t lock;
+  pthread_cond_t  cond;
+  FAR uint8_t    *buf[2];     /* Block buffers */
+  size_t          len[2];     /* Bytes used in each block */
+  orb_abstime     first[2];   /* Timestamp of the first sample per block */
+  bool            busy[2];    /* Block is queued for the writer */
+  int             active;     /* Block being filled */
+  bool            exit;
+  int             fd;
+  int             error;
+  uint32_t        offset;     /* File offset of the next block */
+  FAR struct orb_log_index_s *index;
+  uint32_t        nindex;
+  uint32_t        maxindex;
+};
+
 /****************************************************************************
  * Private Function Prototypes
  ****************************************************************************/
@@ -84,7 +114,8 @@ static int listener_print(FAR const struct orb_metadata *meta, int fd);
 static void listener_monitor(FAR struct listen_list_s *objlist,
                              int nb_objects, float topic_rate,
                              int topic_latency, int nb_msgs,
-                             int timeout, bool record, bool nonwakeup);
+                             int timeout, bool record, bool binary,
+                             bool nonwakeup);
 static int listener_update(FAR struct listen_list_s *objlist,
                            FAR struct orb_object *object);
 static void listener_top(FAR struct listen_list_s *objlist,
@@ -93,6 +124,13 @@ static void listener_top(FAR struct listen_list_s *objlist,
 static int listener_create_dir(FAR char *dir, size_t size);
 static int listener_record(FAR const struct orb_metadata *meta, int fd,
                            FAR FILE *file);
+static int listener_log_open(FAR struct listen_log_s *log,
+                             FAR const char *path,
+                             FAR struct listen_list_s *objlist);
+static int listener_log_record(FAR struct listen_log_s *log, uint16_t id,
+                               FAR const struct orb_metadata *meta,
+                               int fd);
+static void listener_log_close(FAR struct listen_log_s *log);
 
 /****************************************************************************
  * Private Data
@@ -131,6 +169,7 @@ listener <command> [arguments...]\n\
 \t<topics_name> Topic name. Multi name are separated by ','\n\
 \t[-h       ]  Listener commands help\n\
 \t[-s       ]  Record uorb data to file\n\
+\t[-B       ]  Record uorb data of all topics to one binary log\n\
 \t[-n <val> ]  Number of messages, default: 0\n\
 \t[-r <val> ]  Subscription rate (unlimited if 0), default: 0\n\
 \t[-b <val> ]  Subscription maximum report latency in us(unlimited if 0),\n\
@@ -787,6 +826,371 @@ static int listener_record(FAR const struct orb_metadata *meta, int fd,
   return ret;
 }
 
+/****************************************************************************
+ * Name: listener_log_thread
+ *
+ * Description:
+ *   Write queued blocks to the log file and index them.
+ *
+ * Input Parameters:
+ *   arg    The binary log.
+ *
+ * Returned Value:
+ *   NULL.
+ ****************************************************************************/
+
+static FAR void *listener_log_thread(FAR void *arg)
+{
+  FAR struct listen_log_s *log = arg;
+  FAR struct orb_log_index_s *index;
+  FAR const uint8_t *buf;
+  ssize_t ret;
+  size_t len;
+  int wr = 0;
+
+  pthread_mutex_lock(&log->lock);
+
+  while (1)
+    {
+      while (!log->busy[wr] && !log->exit)
+        {
+          pthread_cond_wait(&log->cond, &log->lock);
+        }
+
+      if (!log->busy[wr])
+        {
+          break;
+        }
+
+      pthread_mutex_unlock(&log->lock);
+
+      /* Grow the index by doubling, so appends stay cheap */
+
+      if (log->nindex == log->maxindex)
+        {
+          index = realloc(log->index, (log->maxindex ? log->maxindex * 2 :
+                                       64) * sizeof(*index));
+          if (index != NULL)
+            {
+              log->index     = index;
+              log->maxindex  = log->maxindex ? log->maxindex * 2 : 64;
+            }
+        }
+
+      if (log->nindex < log->maxindex)
+        {
+          log->index[log->nindex].timestamp = log->first[wr];
+          log->index[log->nindex].offset    = log->offset;
+          log->index[log->nindex].reserved  = 0;
+          log->nindex++;
+        }
+
+      buf = log->buf[wr];
+      len = log->len[wr];
+      log->offset += len;
+
+      while (len > 0)
+        {
+          ret = write(log->fd, buf, len);
+          if (ret < 0)
+            {
+              if (errno == EINTR)
+                {
+                  continue;
+                }
+
+              log->error = -errno;
+              break;
+            }
+
+          buf += ret;
+          len -= ret;
+        }
+
+      pthread_mutex_lock(&log->lock);
+      log->len[wr]  = 0;
+      log->busy[wr] = false;
+      pthread_cond_signal(&log->cond);
+      wr ^= 1;
+    }
+
+  pthread_mutex_unlock(&log->lock);
+  return NULL;
+}
+
+/****************************************************************************
+ * Name: listener_log_submit
+ *
+ * Description:
+ *   Queue the active block for writing and switch to the other block,
+ *   waiting for the writer if it is still busy with it.
+ *
+ * Input Parameters:
+ *   log    The binary log.
+ *
+ * Returned Value:
+ *   None.
+ ****************************************************************************/
+
+static void listener_log_submit(FAR struct listen_log_s *log)
+{
+  pthread_mutex_lock(&log->lock);
+
+  log->busy[log->active] = true;
+  log->active ^= 1;
+  pthread_cond_signal(&log->cond);
+
+  while (log->busy[log->active])
+    {
+      pthread_cond_wait(&log->cond, &log->lock);
+    }
+
+  pthread_mutex_unlock(&log->lock);
+}
+
+/****************************************************************************
+ * Name: listener_log_open
+ *
+ * Description:
+ *   Create a binary log, write the topic schemas and start the writer.
+ *
+ * Input Parameters:
+ *   log      The binary log.
+ *   path     Path of the log file.
+ *   objlist  Recorded objects, the topic id is the position in the list.
+ *
+ * Returned Value:
+ *   0 on success, otherwise negative errno.
+ ****************************************************************************/
+
+static int listener_log_open(FAR struct listen_log_s *log,
+                             FAR const char *path,
+                             FAR struct listen_list_s *objlist)
+{
+  FAR struct listen_object_s *tmp;
+  struct orb_log_header_s header;
+  struct orb_log_topic_s topic;
+  FAR const char *fmt;
+  uint16_t id = 0;
+  size_t len;
+  int ret;
+
+  memset(log, 0, sizeof(*log));
+
+  log->buf[0] = malloc(2 * CONFIG_UORB_LISTENER_LOG_BUFSIZE);
+  if (log->buf[0] == NULL)
+    {
+      return -ENOMEM;
+    }
+
+  log->buf[1] = log->buf[0] + CONFIG_UORB_LISTENER_LOG_BUFSIZE;
+
+  log->fd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0666);
+  if (log->fd < 0)
+    {
+      ret = -errno;
+      goto errout_with_buf;
+    }
+
+  header.magic   = ORB_LOG_MAGIC;
+  header.version = ORB_LOG_VERSION;
+  header.ntopics = 0;
+
+  SLIST_FOREACH(tmp, objlist, node)
+    {
+      header.ntopics++;
+    }
+
+  /* The schemas are small, stage them in the first block */
+
+  memcpy(log->buf[0], &header, sizeof(header));
+  len = sizeof(header);
+
+  SLIST_FOREACH(tmp, objlist, node)
+    {
+#ifdef CONFIG_UORB_FORMAT
+      fmt = tmp->object.meta->o_format ? tmp->object.meta->o_format : "";
+#else
+      fmt = "";
+#endif
+
+      topic.id       = id++;
+      topic.size     = tmp->object.meta->o_size;
+      topic.instance = tmp->object.instance;
+      topic.namelen  = strlen(tmp->object.meta->o_name);
+      topic.fmtlen   = strlen(fmt);
+
+      if (len + sizeof(topic) + topic.namelen + topic.fmtlen >
+          CONFIG_UORB_LISTENER_LOG_BUFSIZE)
+        {
+          if (write(log->fd, log->buf[0], len) != len)
+            {
+              ret = -EIO;
+              goto errout_with_fd;
+            }
+
+          log->offset += len;
+          len = 0;
+        }
+
+      memcpy(log->buf[0] + len, &topic, sizeof(topic));
+      len += sizeof(topic);
+      memcpy(log->buf[0] + len, tmp->object.meta->o_name, topic.namelen);
+      len += topic.namelen;
+      memcpy(log->buf[0] + len, fmt, topic.fmtlen);
+      len += topic.fmtlen;
+    }
+
+  if (write(log->fd, log->buf[0], len) != len)
+    {
+      ret = -EIO;
+      goto errout_with_fd;
+    }
+
+  log->offset += len;
+
+  pthread_mutex_init(&log->lock, NULL);
+  pthread_cond_init(&log->cond, NULL);
+
+  ret = pthread_create(&log->thread, NULL, listener_log_thread, log);
+  if (ret != 0)
+    {
+      ret = -ret;
+      pthread_cond_destroy(&log->cond);
+      pthread_mutex_destroy(&log->lock);
+      goto errout_with_fd;
+    }
+
+  return OK;
+
+errout_with_fd:
+  close(log->fd);
+  unlink(path);
+errout_with_buf:
+  free(log->buf[0]);
+  log->buf[0] = NULL;
+  return ret;
+}
+
+/****************************************************************************
+ * Name: listener_log_record
+ *
+ * Description:
+ *   Copy a topic sample straight into the active block.
+ *
+ * Input Parameters:
+ *   log    The binary log.
+ *   id     Topic id in the log.
+ *   meta   The uORB metadata.
+ *   fd     Subscriber handle.
+ *
+ * Returned Value:
+ *   0 on success copy, otherwise negative errno
+ ****************************************************************************/
+
+static int listener_log_record(FAR struct listen_log_s *log, uint16_t id,
+                               FAR const struct orb_metadata *meta, int fd)
+{
+  struct orb_log_sample_s sample;
+  FAR uint8_t *ptr;
+  size_t need;
+  int ret;
+
+  if (log->error < 0)
+    {
+      return log->error;
+    }
+
+  need = sizeof(sample) + meta->o_size;
+  if (need > CONFIG_UORB_LISTENER_LOG_BUFSIZE)
+    {
+      return -E2BIG;
+    }
+
+  if (log->len[log->active] + need > CONFIG_UORB_LISTENER_LOG_BUFSIZE)
+    {
+      listener_log_submit(log);
+    }
+
+  ptr = log->buf[log->active] + log->len[log->active];
+
+  ret = orb_copy(meta, fd, ptr + sizeof(sample));
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  sample.id   = id;
+  sample.size = meta->o_size;
+  memcpy(ptr, &sample, sizeof(sample));
+
+  if (log->len[log->active] == 0)
+    {
+      memcpy(&log->first[log->active], ptr + sizeof(sample),
+             sizeof(orb_abstime));
+    }
+
+  log->len[log->active] += need;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: listener_log_close
+ *
+ * Description:
+ *   Flush the last block, stop the writer and append the time index.
+ *
+ * Input Parameters:
+ *   log    The binary log.
+ *
+ * Returned Value:
+ *   None.
+ ****************************************************************************/
+
+static void listener_log_close(FAR struct listen_log_s *log)
+{
+  struct orb_log_trailer_s trailer;
+  size_t len;
+
+  if (log->buf[0] == NULL)
+    {
+      return;
+    }
+
+  if (log->len[log->active] > 0)
+    {
+      listener_log_submit(log);
+    }
+
+  pthread_mutex_lock(&log->lock);
+  log->exit = true;
+  pthread_cond_signal(&log->cond);
+  pthread_mutex_unlock(&log->lock);
+
+  pthread_join(log->thread, NULL);
+  pthread_cond_destroy(&log->cond);
+  pthread_mutex_destroy(&log->lock);
+
+  if (log->error < 0)
+    {
+      uorbinfo_raw("Binary log write failed:%d", log->error);
+    }
+
+  len = log->nindex * sizeof(struct orb_log_index_s);
+  if (len == 0 || write(log->fd, log->index, len) == len)
+    {
+      trailer.offset = log->offset;
+      trailer.nindex = log->nindex;
+      trailer.magic  = ORB_LOG_INDEX_MAGIC;
+      write(log->fd, &trailer, sizeof(trailer));
+    }
+
+  close(log->fd);
+  free(log->index);
+  free(log->buf[0]);
+  log->buf[0] = NULL;
+}
+
 /****************************************************************************
  * Name: listener_monitor
  *
@@ -800,6 +1204,8 @@ static int listener_record(FAR const struct orb_metadata *meta, int fd,
  *   topic_latency  Subscribe report latency.
  *   nb_msgs        Subscribe amount of messages.
  *   timeout        Maximum poll waiting time(microseconds).
+ *   record         Record the data to csv files instead of printing it.
+ *   binary         Record the data to one binary log instead.
  *
  * Returned Value:
  *   None
@@ -808,8 +1214,10 @@ static int listener_record(FAR const struct orb_metadata *meta, int fd,
 static void listener_monitor(FAR struct listen_list_s *objlist,
                              int nb_objects, float topic_rate,
                              int topic_latency, int nb_msgs,
-                             int timeout, bool record, bool nonwakeup)
+                             int timeout, bool record, bool binary,
+                             bool nonwakeup)
 {
+  struct listen_log_s log;
   FAR struct pollfd *fds;
   char path[PATH_MAX];
   FAR int *recv_msgs;
@@ -865,7 +1273,23 @@ static void listener_monitor(FAR struct listen_list_s *objlist,
       i++;
     }
 
-  if (record)
+  log.buf[0] = NULL;
+
+  if (binary)
+    {
+      listener_create_dir(path, sizeof(path));
+      strlcat(path, "uorb" ORB_LOG_SUFFIX, sizeof(path));
+
+      if (listener_log_open(&log, path, objlist) < 0)
+        {
+          uorbinfo_raw("file creat failed!path:%s", path);
+        }
+      else
+        {
+          uorbinfo_raw("creat file:[%s]", path);
+        }
+    }
+  else if (record)
     {
       listener_create_dir(path, sizeof(path));
       dir = path + strlen(path);
@@ -907,7 +1331,16 @@ static void listener_monitor(FAR struct listen_list_s *objlist,
                   nb_recv_msgs++;
                   recv_msgs[i]++;
 
-                  if (tmp->file != NULL)
+                  if (log.buf[0] != NULL)
+                    {
+                      if (listener_log_record(&log, i, tmp->object.meta,
+                                              fds[i].fd) < 0)
+                        {
+                          uorberr("Listener record %s data failed!",
+                                  tmp->object.meta->o_name);
+                        }
+                    }
+                  else if (tmp->file != NULL)
                     {
                       if (listener_record(tmp->object.meta, fds[i].fd,
                                           tmp->file) < 0)
@@ -971,6 +1404,8 @@ static void listener_monitor(FAR struct listen_list_s *objlist,
       i++;
     }
 
+  listener_log_close(&log);
+
   uorbinfo_raw("Total number of received Message:%d/%d",
                nb_recv_msgs, nb_msgs ? nb_msgs : nb_recv_msgs);
   free(fds);
@@ -1080,6 +1515,7 @@ int main(int argc, FAR char *argv[])
   bool info         = false;
   bool flush        = false;
   bool record       = false;
+  bool binary       = false;
   bool nonwakeup    = false;
   bool only_once    = false;
   FAR char *filter  = NULL;
@@ -1094,7 +1530,7 @@ int main(int argc, FAR char *argv[])
 
   /* Pasrse Argument */
 
-  while ((ch = getopt(argc, argv, "r:b:n:t:Tfslhiu")) != EOF)
+  while ((ch = getopt(argc, argv, "r:b:n:t:TfsBlhiu")) != EOF)
     {
       switch (ch)
       {
@@ -1136,6 +1572,10 @@ int main(int argc, FAR char *argv[])
           break;
 #endif
 
+        case 'B':
+          binary = true;
+          break;
+
         case 'f':
           flush = true;
           break;
@@ -1203,7 +1643,7 @@ int main(int argc, FAR char *argv[])
         }
 
       listener_monitor(&objlist, ret, topic_rate, topic_latency,
-                       nb_msgs, timeout, record, nonwakeup);
+                       nb_msgs, timeout, record, binary, nonwakeup);
     }
 
 exit:
@@ -0,0 +1,102 @@
+/****************************************************************************
+ * apps/system/uorb/uORB/log.h
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.  The
+ * ASF licenses this file to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance with the
+ * License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ *
+ ****************************************************************************/
+
+#ifndef __APP_SYSTEM_UORB_UORB_LOG_H
+#define __APP_SYSTEM_UORB_UORB_LOG_H
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <uORB/uORB.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Binary uORB log, written by the listener and replayed by the generator.
+ *
+ * File layout:
+ *
+ *   struct orb_log_header_s
+ *   struct orb_log_topic_s + name + format       (x header.ntopics)
+ *   blocks of struct orb_log_sample_s + data     (until index)
+ *   struct orb_log_index_s                       (x trailer.nindex)
+ *   struct orb_log_trailer_s
+ *
+ * Samples are written in blocks that never split a sample, and each index
+ * entry holds the file offset and first timestamp of a block.  Every topic
+ * data starts with its orb_abstime timestamp.  All structures are
+ * naturally aligned, so no packing is needed.  A log without a trailer
+ * (e.g. recording was interrupted) is still readable sequentially.
+ */
+
+#define ORB_LOG_MAGIC         0x474c524f  /* "ORLG" */
+#define ORB_LOG_INDEX_MAGIC   0x58495242  /* "BRIX" */
+#define ORB_LOG_VERSION       1
+#define ORB_LOG_SUFFIX        ".ulg"
+
+/****************************************************************************
+ * Public Types
+ ****************************************************************************/
+
+struct orb_log_header_s
+{
+  uint32_t magic;
+  uint16_t version;
+  uint16_t ntopics;
+};
+
+/* Per-topic schema, followed by namelen bytes of topic name and fmtlen
+ * bytes of format string (both without terminator).
+ */
+
+struct orb_log_topic_s
+{
+  uint16_t id;        /* Topic id used by the samples */
+  uint16_t size;      /* Topic data size */
+  uint8_t  instance;  /* Recorded topic instance */
+  uint8_t  namelen;
+  uint16_t fmtlen;
+};
+
+struct orb_log_sample_s
+{
+  uint16_t id;        /* Topic id, followed by the topic data */
+  uint16_t size;      /* Size of the topic data */
+};
+
+struct orb_log_index_s
+{
+  uint64_t timestamp; /* Timestamp of the first sample in the block */
+  uint32_t offset;    /* File offset of the block */
+  uint32_t reserved;
+};
+
+struct orb_log_trailer_s
+{
+  uint32_t offset;    /* File offset of the index */
+  uint32_t nindex;    /* Number of index entries */
+  uint32_t magic;
+};
+
+#endif /* __APP_SYSTEM_UORB_UORB_LOG_H */